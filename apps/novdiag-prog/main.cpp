@@ -156,6 +156,11 @@ auto printTypeDefs(const prog::Program& prog) -> void {
       std::cout << "  " << rang::fg::yellow << rang::style::bold << std::setw(nameColWidth)
                 << std::left << "lazy"
                 << " -> " << lazyDef.getResult() << rang::style::reset << '\n';
+    } else if (std::holds_alternative<prog::sym::ArrayDef>(typeDef)) {
+      const auto& arrayDef = std::get<prog::sym::ArrayDef>(typeDef);
+      std::cout << "  " << rang::fg::yellow << rang::style::bold << std::setw(nameColWidth)
+                << std::left << "array"
+                << " -> " << arrayDef.getElement() << rang::style::reset << '\n';
     }
   }
 }
@@ -4,13 +4,198 @@
 #include "vm/exec_state.hpp"
 #include "vm/platform_interface.hpp"
 #include "vm/vm.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
 #include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <limits>
+#include <string>
+
+// Name the functions of the assembly by its debug information ('name file:line'), functions
+// without debug information are named by their offset in the assembly by the profiles.
+static auto getFunctionLabels(const novasm::Assembly& assembly) -> vm::Profile::FunctionLabels {
+  auto labels = vm::Profile::FunctionLabels{};
+  if (const auto* debugInfo = assembly.getDebugInfo()) {
+    for (const auto& func : debugInfo->getFunctions()) {
+      auto label      = func.name;
+      const auto span = debugInfo->findSpan(func.ipBegin);
+      if (span) {
+        const auto file = filesystem::path{debugInfo->getFiles()[span->file]}.filename();
+        label += " " + file.string() + ":" + std::to_string(span->startLine);
+      }
+      labels[func.ipBegin].push_back(std::move(label));
+    }
+  }
+  return labels;
+}
+
+static auto writeHeapProfile(
+    const vm::HeapProfile& heapProfile,
+    const vm::Profile::FunctionLabels& labels,
+    const std::string& path) -> void {
+  auto heapProfileFs = std::ofstream{path};
+  heapProfile.writeReport(heapProfileFs, labels);
+  if (!heapProfileFs.good()) {
+    std::cerr << "Novus runtime [" PROJECT_VER "] - Failed to write heap profile: " << path << '\n';
+  }
+}
+
+// Largest values of the numeric options, options in KiB are limited so they fit in bytes.
+constexpr auto maxU32Option = static_cast<unsigned long>(std::numeric_limits<uint32_t>::max());
+constexpr auto maxKibOption = static_cast<unsigned long>(std::min<unsigned long long>(
+    std::numeric_limits<unsigned long>::max(), std::numeric_limits<size_t>::max() / 1024U));
+
+// Runtime option that takes a number, can be given as a flag or through an environment variable.
+struct NumericOption final {
+  const char* flag;
+  const char* envVar;
+  unsigned long maxValue;
+  bool allowZero;
+  void (*apply)(vm::Settings* settings, unsigned long value);
+};
+
+static const auto numericOptions = std::array<NumericOption, 10U>{{
+    {"--stack-limit", // KiB
+     "NOVRT_STACK_LIMIT",
+     maxKibOption,
+     false,
+     [](vm::Settings* s, unsigned long v) { s->stackLimit = static_cast<size_t>(v) * 1024U; }},
+    {"--profile-interval", // Microseconds
+     "NOVRT_PROFILE_INTERVAL",
+     maxU32Option,
+     false,
+     [](vm::Settings* s, unsigned long v) { s->profileIntervalUs = static_cast<uint32_t>(v); }},
+    {"--heap-profile-rate", // Bytes
+     "NOVRT_HEAP_PROFILE_RATE",
+     maxU32Option,
+     false,
+     [](vm::Settings* s, unsigned long v) { s->heapProfileRate = static_cast<uint32_t>(v); }},
+    {"--gc-heap-growth", // Percent
+     "NOVRT_GC_HEAP_GROWTH",
+     maxU32Option,
+     false,
+     [](vm::Settings* s, unsigned long v) { s->gcHeapGrowth = static_cast<uint32_t>(v); }},
+    {"--gc-min-heap", // KiB
+     "NOVRT_GC_MIN_HEAP",
+     maxKibOption,
+     true,
+     [](vm::Settings* s, unsigned long v) { s->gcMinHeap = static_cast<size_t>(v) * 1024U; }},
+    {"--gc-heap-limit", // KiB, zero for no limit.
+     "NOVRT_GC_HEAP_LIMIT",
+     maxKibOption,
+     true,
+     [](vm::Settings* s, unsigned long v) { s->gcHeapLimit = static_cast<size_t>(v) * 1024U; }},
+    {"--gc-idle-interval", // Milliseconds, zero to disable.
+     "NOVRT_GC_IDLE_INTERVAL",
+     maxU32Option,
+     true,
+     [](vm::Settings* s, unsigned long v) { s->gcIdleIntervalMs = static_cast<uint32_t>(v); }},
+    {"--gc-workers", // Zero for one per core.
+     "NOVRT_GC_WORKERS",
+     maxU32Option,
+     true,
+     [](vm::Settings* s, unsigned long v) { s->gcWorkers = static_cast<uint32_t>(v); }},
+    {"--threads", // Zero for one per core.
+     "NOVRT_THREADS",
+     maxU32Option,
+     true,
+     [](vm::Settings* s, unsigned long v) { s->threadPoolSize = static_cast<uint32_t>(v); }},
+    {"--heap-cache-pages",
+     "NOVRT_HEAP_CACHE_PAGES",
+     maxU32Option,
+     true,
+     [](vm::Settings* s, unsigned long v) { s->heapCachePages = static_cast<uint32_t>(v); }},
+}};
+
+// Parse and apply the value of a numeric option, only plain decimal numbers in the range of the
+// option are accepted ('strtoul' on its own also accepts leading whitespace, a sign and trailing
+// garbage). Prints an error and returns false if the value is invalid.
+static auto applyNumericOption(
+    const NumericOption& option, const char* name, const char* str, vm::Settings* settings)
+    -> bool {
+  auto valid = *str >= '0' && *str <= '9';
+  auto value = 0UL;
+  if (valid) {
+    char* end = nullptr;
+    errno     = 0;
+    value     = std::strtoul(str, &end, 10);
+    valid     = errno != ERANGE && *end == '\0' && value <= option.maxValue &&
+        (value != 0U || option.allowZero);
+  }
+  if (!valid) {
+    std::cerr << "Novus runtime [" PROJECT_VER "] - Invalid value for '" << name << "': '" << str
+              << "' (expected a " << (option.allowZero ? "non-negative" : "positive")
+              << " number up to " << option.maxValue << ")\n";
+    return false;
+  }
+  option.apply(settings, value);
+  return true;
+}
 
 auto main(int argc, char** argv) noexcept -> int {
 
   /* Note: Supports either reading a 'nova' assembly file as argment 1 or looking for a 'prog.nova'
-   * in current working directory. */
+   * in current working directory. Runtime options ('--jit', '--gc-pauses', '--stats',
+   * '--profile <file>', '--heap-profile <file>' and the numeric options above) can be given before
+   * the file. Numeric options can also be set through their environment variable, flags take
+   * precedence. Invalid numeric values and missing option values are reported and exit with a
+   * non-zero code. */
+
+  auto settings    = vm::Settings{};
+  auto gcPauses    = vm::PauseHistogram{};
+  auto memStats    = vm::MemoryStats{};
+  auto profile     = vm::Profile{};
+  auto profilePath = std::string{};
+  auto heapProfile = vm::HeapProfile{};
+  auto heapPath    = std::string{};
+  for (const auto& option : numericOptions) {
+    const auto* envVal = std::getenv(option.envVar);
+    if (envVal != nullptr && !applyNumericOption(option, option.envVar, envVal, &settings)) {
+      return 1;
+    }
+  }
+
+  auto optionArgs = 0;
+  for (; optionArgs + 1 < argc; ++optionArgs) {
+    const auto arg           = std::string{argv[optionArgs + 1]};
+    const auto numericOption = std::find_if(
+        numericOptions.begin(), numericOptions.end(), [&arg](const NumericOption& option) {
+          return arg == option.flag;
+        });
+    const auto hasValue =
+        numericOption != numericOptions.end() || arg == "--profile" || arg == "--heap-profile";
+    if (hasValue && optionArgs + 2 >= argc) {
+      std::cerr << "Novus runtime [" PROJECT_VER "] - Missing value for '" << arg << "'\n";
+      return 1;
+    }
+    if (numericOption != numericOptions.end()) {
+      if (!applyNumericOption(
+              *numericOption, numericOption->flag, argv[optionArgs + 2], &settings)) {
+        return 1;
+      }
+      ++optionArgs;
+    } else if (arg == "--jit") {
+      settings.jitEnabled = true;
+    } else if (arg == "--gc-pauses") {
+      settings.gcPauses = &gcPauses;
+    } else if (arg == "--stats") {
+      settings.memStats = &memStats;
+    } else if (arg == "--profile") {
+      settings.profile = &profile;
+      profilePath      = argv[optionArgs + 2];
+      ++optionArgs;
+    } else if (arg == "--heap-profile") {
+      settings.heapProfile = &heapProfile;
+      heapPath             = argv[optionArgs + 2];
+      ++optionArgs;
+    } else {
+      break;
+    }
+  }
+  argc -= optionArgs;
+  argv += optionArgs;
 
   auto implicitPath = true;
   auto progPath     = filesystem::path{"prog.nova"};
@@ -33,8 +218,11 @@ auto main(int argc, char** argv) noexcept -> int {
     return 1;
   }
 
-  const auto asmOutput =
-      novasm::deserialize(std::istreambuf_iterator<char>{fs}, std::istreambuf_iterator<char>{});
+  // Debug information is only needed to name the functions in the profiles.
+  const auto asmOutput = novasm::deserialize(
+      std::istreambuf_iterator<char>{fs},
+      std::istreambuf_iterator<char>{},
+      settings.profile != nullptr || settings.heapProfile != nullptr);
   if (!asmOutput) {
     std::cerr << "Novus runtime [" PROJECT_VER "] - Corrupt or incompatible 'nova' file\n";
     return 1;
@@ -47,10 +235,39 @@ auto main(int argc, char** argv) noexcept -> int {
   const auto vmEnvArgsCount = argc - consumedArgs;
   auto** const vmEnvArgs    = argv + consumedArgs;
 
+  const auto labels = settings.profile || settings.heapProfile
+      ? getFunctionLabels(*asmOutput)
+      : vm::Profile::FunctionLabels{};
+
+  // Overwrite the heap profile with a snapshot when receiving a 'SIGUSR1' signal.
+  if (settings.heapProfile) {
+    settings.heapProfileSnapshot = [&labels, &heapPath](const vm::HeapProfile& snapshot) {
+      writeHeapProfile(snapshot, labels, heapPath);
+    };
+  }
+
   auto iface = vm::PlatformInterface{vmEnvArgsCount, vmEnvArgs, stdin, stdout, stderr};
-  auto res   = vm::run(&asmOutput.value(), &iface);
+  auto res   = vm::run(&asmOutput.value(), &iface, settings);
   if (res > vm::ExecState::Failed) {
     std::cerr << "runtime error: " << res << '\n';
   }
+  if (settings.gcPauses) {
+    std::cerr << gcPauses;
+  }
+  if (settings.memStats) {
+    std::cerr << memStats;
+  }
+  if (settings.profile) {
+    // Write the samples as collapsed stacks.
+    auto profileFs = std::ofstream{profilePath};
+    profile.writeCollapsed(profileFs, labels);
+    if (!profileFs.good()) {
+      std::cerr << "Novus runtime [" PROJECT_VER "] - Failed to write profile: " << profilePath
+                << '\n';
+    }
+  }
+  if (settings.heapProfile) {
+    writeHeapProfile(heapProfile, labels, heapPath);
+  }
   return static_cast<int>(res);
 }
@@ -0,0 +1,78 @@
+#pragma once
+#include "novasm/assembler.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// Benchmark that measures how long it takes the vm to execute an assembly program.
+struct Benchmark final {
+  std::string name;
+  uint32_t iterations; // Amount of times the 'interesting' part of the program is executed.
+  std::function<novasm::Assembly()> build;
+};
+
+inline auto getBenchmarks() -> std::vector<Benchmark>& {
+  static auto benchmarks = std::vector<Benchmark>{};
+  return benchmarks;
+}
+
+inline auto registerBenchmark(
+    std::string name, uint32_t iterations, std::function<novasm::Assembly()> build) -> bool {
+  getBenchmarks().push_back(Benchmark{std::move(name), iterations, std::move(build)});
+  return true;
+}
+
+// Build a program that executes the given body 'iterations' times in a (tail-recursive) loop.
+// Note: The body has to leave the stack as it found it.
+inline auto buildLoop(uint32_t iterations, const std::function<void(novasm::Assembler*)>& body)
+    -> novasm::Assembly {
+  auto asmb = novasm::Assembler{};
+
+  asmb.label("entrypoint");
+  asmb.addLoadLitInt(static_cast<int32_t>(iterations));
+  asmb.addCall("loop", 1, novasm::CallMode::Normal);
+  asmb.addRet();
+
+  asmb.label("loop");
+  asmb.addStackLoad(0);
+  asmb.addLoadLitInt(0);
+  asmb.addCheckEqInt();
+  asmb.addJumpIf("loop-end");
+
+  body(&asmb);
+
+  asmb.addStackLoad(0);
+  asmb.addLoadLitInt(1);
+  asmb.addSubInt();
+  asmb.addCall("loop", 1, novasm::CallMode::Tail);
+
+  asmb.label("loop-end");
+  asmb.addLoadLitInt(0);
+  asmb.addRet();
+
+  asmb.setEntrypoint("entrypoint");
+  return asmb.close();
+}
+
+#define BENCH_CONCAT_INNER(A, B) A##B
+#define BENCH_CONCAT(A, B) BENCH_CONCAT_INNER(A, B)
+
+// Register a benchmark that executes the given body in a loop.
+#define BENCH_LOOP(NAME, ITERATIONS, BODY)                                                         \
+  static const auto BENCH_CONCAT(g_bench, __LINE__) = ::bench::registerBenchmark(                  \
+      NAME, ITERATIONS, []() { return ::bench::buildLoop(ITERATIONS, BODY); })
+
+// Register a benchmark that executes a custom program.
+#define BENCH_PROG(NAME, ITERATIONS, BUILD)                                                        \
+  static const auto BENCH_CONCAT(g_bench, __LINE__) = ::bench::registerBenchmark(                  \
+      NAME, ITERATIONS, []() {                                                                     \
+        auto asmb = novasm::Assembler{};                                                           \
+        (BUILD)(&asmb);                                                                            \
+        return asmb.close();                                                                       \
+      })
+
+} // namespace bench
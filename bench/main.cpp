@@ -0,0 +1,114 @@
+#include "helpers.hpp"
+#include "vm/exec_state.hpp"
+#include "vm/platform_interface.hpp"
+#include "vm/vm.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+
+/* Micro benchmarks for the novus runtime.
+ * Usage: novbench [filter] [--runs <count>] [--jit]
+ * Only benchmarks whose name contains the filter are executed, for each benchmark the best time
+ * out of all runs is reported. With '--jit' every benchmark is executed both in the interpreter
+ * and with the jit compiler enabled and the speedup is reported.
+ */
+
+// Best execution time out of all runs, or nothing if the program failed to execute.
+static auto measure(
+    const novasm::Assembly& assembly,
+    vm::PlatformInterface* iface,
+    int runs,
+    const vm::Settings& settings) -> std::optional<std::chrono::nanoseconds> {
+  auto best = std::chrono::nanoseconds::max();
+  for (auto run = 0; run != runs; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto res   = vm::run(&assembly, iface, settings);
+    const auto dur   = std::chrono::steady_clock::now() - start;
+    if (res != vm::ExecState::Success) {
+      return std::nullopt;
+    }
+    best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(dur));
+  }
+  return best;
+}
+
+static auto toMs(std::chrono::nanoseconds dur) -> double {
+  return static_cast<double>(dur.count()) / 1'000'000.0;
+}
+
+auto main(int argc, char** argv) -> int {
+  auto filter     = std::string{};
+  auto runs       = 5;
+  auto compareJit = false;
+  for (auto i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+      runs = std::max(1, std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--jit") == 0) {
+      compareJit = true;
+    } else {
+      filter = argv[i];
+    }
+  }
+
+  auto iface       = vm::PlatformInterface{0, nullptr, stdin, stdout, stderr};
+  auto jitSettings = vm::Settings{};
+  auto fail        = false;
+
+  jitSettings.jitEnabled = true;
+
+  if (compareJit) {
+    std::printf(
+        "%-40s %12s %12s %12s %12s\n",
+        "benchmark",
+        "iterations",
+        "interp (ms)",
+        "jit (ms)",
+        "speedup");
+  } else {
+    std::printf(
+        "%-40s %12s %12s %12s %12s\n",
+        "benchmark",
+        "iterations",
+        "best (ms)",
+        "ns / iter",
+        "iter / s");
+  }
+  for (const auto& benchmark : bench::getBenchmarks()) {
+    if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    const auto assembly = benchmark.build();
+
+    const auto best = measure(assembly, &iface, runs, vm::Settings{});
+    const auto jit  = compareJit ? measure(assembly, &iface, runs, jitSettings) : best;
+    if (!best || !jit) {
+      std::fprintf(stderr, "Benchmark '%s' failed to execute\n", benchmark.name.c_str());
+      fail = true;
+      continue;
+    }
+
+    if (compareJit) {
+      std::printf(
+          "%-40s %12u %12.3f %12.3f %11.2fx\n",
+          benchmark.name.c_str(),
+          benchmark.iterations,
+          toMs(*best),
+          toMs(*jit),
+          static_cast<double>(best->count()) / static_cast<double>(jit->count()));
+    } else {
+      const auto nsPerIter = static_cast<double>(best->count()) / benchmark.iterations;
+      std::printf(
+          "%-40s %12u %12.3f %12.2f %12.0f\n",
+          benchmark.name.c_str(),
+          benchmark.iterations,
+          toMs(*best),
+          nsPerIter,
+          1'000'000'000.0 / nsPerIter);
+    }
+  }
+  return fail ? 1 : 0;
+}
@@ -0,0 +1,211 @@
+#include "helpers.hpp"
+
+/* Instruction dispatch benchmarks, each benchmark executes a short sequence of instructions from
+ * one of the op-code categories (mirroring the 'tests/vm' categories) in a loop. */
+
+namespace bench {
+
+constexpr uint32_t dispatchIterations = 1'000'000;
+
+BENCH_LOOP("dispatch/literal", dispatchIterations, [](novasm::Assembler* asmb) {
+  asmb->addLoadLitInt(0);
+  asmb->addLoadLitInt(1);
+  asmb->addLoadLitInt(42);
+  asmb->addLoadLitInt(1337);
+  asmb->addLoadLitFloat(1.5F);
+  asmb->addLoadLitLong(42L);
+  asmb->addLoadLitIp("loop");
+  asmb->addPop();
+  asmb->addPop();
+  asmb->addPop();
+  asmb->addPop();
+  asmb->addPop();
+  asmb->addPop();
+  asmb->addPop();
+});
+
+BENCH_LOOP("dispatch/consts", dispatchIterations, [](novasm::Assembler* asmb) {
+  asmb->addStackAlloc(2);
+  asmb->addLoadLitInt(42);
+  asmb->addStackStore(1);
+  asmb->addStackLoad(0);
+  asmb->addStackStore(2);
+  asmb->addStackLoad(1);
+  asmb->addStackLoad(2);
+  asmb->addPop();
+  asmb->addPop();
+  asmb->addPop();
+  asmb->addPop();
+});
+
+BENCH_LOOP("dispatch/int_op", dispatchIterations, [](novasm::Assembler* asmb) {
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(3);
+  asmb->addAddInt();
+  asmb->addLoadLitInt(7);
+  asmb->addMulInt();
+  asmb->addLoadLitInt(5);
+  asmb->addSubInt();
+  asmb->addLoadLitInt(3);
+  asmb->addRemInt();
+  asmb->addNegInt();
+  asmb->addLoadLitInt(2);
+  asmb->addShiftLeftInt();
+  asmb->addLoadLitInt(255);
+  asmb->addAndInt();
+  asmb->addPop();
+});
+
+BENCH_LOOP("dispatch/int_check", dispatchIterations, [](novasm::Assembler* asmb) {
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(42);
+  asmb->addCheckEqInt();
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(42);
+  asmb->addCheckGtInt();
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(42);
+  asmb->addCheckLeInt();
+  asmb->addLogicInvInt();
+  asmb->addPop();
+  asmb->addPop();
+  asmb->addPop();
+});
+
+BENCH_LOOP("dispatch/stack_op", dispatchIterations, [](novasm::Assembler* asmb) {
+  asmb->addStackAlloc(1);
+  asmb->addStackAddInt(0, 0);
+  asmb->addStackStore(1);
+  asmb->addStackMulInt(0, 1);
+  asmb->addStackSubInt(1, 0);
+  asmb->addStackCheckLeInt(0, 1);
+  asmb->addPop();
+  asmb->addPop();
+  asmb->addPop();
+});
+
+BENCH_LOOP("dispatch/float_op", dispatchIterations, [](novasm::Assembler* asmb) {
+  asmb->addLoadLitFloat(1.5F);
+  asmb->addLoadLitFloat(2.25F);
+  asmb->addAddFloat();
+  asmb->addLoadLitFloat(3.0F);
+  asmb->addMulFloat();
+  asmb->addLoadLitFloat(0.5F);
+  asmb->addSubFloat();
+  asmb->addLoadLitFloat(2.0F);
+  asmb->addDivFloat();
+  asmb->addNegFloat();
+  asmb->addLoadLitFloat(1.0F);
+  asmb->addCheckGtFloat();
+  asmb->addPop();
+});
+
+BENCH_LOOP("dispatch/long_op", dispatchIterations, [](novasm::Assembler* asmb) {
+  asmb->addLoadLitLong(1'000'000'000'000L);
+  asmb->addLoadLitLong(3L);
+  asmb->addAddLong();
+  asmb->addLoadLitLong(7L);
+  asmb->addMulLong();
+  asmb->addLoadLitLong(5L);
+  asmb->addSubLong();
+  asmb->addLoadLitLong(3L);
+  asmb->addDivLong();
+  asmb->addLoadLitLong(42L);
+  asmb->addCheckGtLong();
+  asmb->addPop();
+});
+
+BENCH_LOOP("dispatch/long_op_neg", dispatchIterations, [](novasm::Assembler* asmb) {
+  asmb->addLoadLitLong(-1'000'000'000'000L);
+  asmb->addLoadLitLong(3L);
+  asmb->addSubLong();
+  asmb->addLoadLitLong(-7L);
+  asmb->addMulLong();
+  asmb->addLoadLitLong(5L);
+  asmb->addSubLong();
+  asmb->addLoadLitLong(-3L);
+  asmb->addDivLong();
+  asmb->addNegLong();
+  asmb->addLoadLitLong(-42L);
+  asmb->addCheckGtLong();
+  asmb->addPop();
+});
+
+BENCH_LOOP("dispatch/conv", dispatchIterations, [](novasm::Assembler* asmb) {
+  asmb->addStackLoad(0);
+  asmb->addConvIntFloat();
+  asmb->addConvFloatLong();
+  asmb->addConvLongFloat();
+  asmb->addConvFloatInt();
+  asmb->addConvIntLong();
+  asmb->addConvLongInt();
+  asmb->addConvIntChar();
+  asmb->addPop();
+});
+
+BENCH_LOOP("dispatch/string_op", dispatchIterations, [](novasm::Assembler* asmb) {
+  asmb->addLoadLitString("hello world");
+  asmb->addDup();
+  asmb->addLengthString();
+  asmb->addPop();
+  asmb->addLoadLitInt(4);
+  asmb->addIndexString();
+  asmb->addPop();
+});
+
+BENCH_LOOP("dispatch/struct_op", dispatchIterations, [](novasm::Assembler* asmb) {
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(42);
+  asmb->addMakeStruct(2);
+  asmb->addDup();
+  asmb->addStructLoadField(0);
+  asmb->addSwap();
+  asmb->addStructLoadField(1);
+  asmb->addAddInt();
+  asmb->addPop();
+});
+
+BENCH_LOOP("dispatch/jump", dispatchIterations, [](novasm::Assembler* asmb) {
+  asmb->addJump("jump-a");
+  asmb->label("jump-b");
+  asmb->addLoadLitInt(0);
+  asmb->addJumpIf("jump-a");
+  asmb->addJump("jump-c");
+  asmb->label("jump-a");
+  asmb->addLoadLitInt(1);
+  asmb->addJumpIf("jump-b");
+  asmb->label("jump-c");
+});
+
+BENCH_PROG("dispatch/call", dispatchIterations, [](novasm::Assembler* asmb) {
+  asmb->label("entrypoint");
+  asmb->addLoadLitInt(static_cast<int32_t>(dispatchIterations));
+  asmb->addCall("loop", 1, novasm::CallMode::Normal);
+  asmb->addRet();
+
+  asmb->label("loop");
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(0);
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("loop-end");
+
+  asmb->addStackLoad(0);
+  asmb->addCall("identity", 1, novasm::CallMode::Normal);
+  asmb->addLoadLitIp("identity");
+  asmb->addCallDyn(1, novasm::CallMode::Normal);
+  asmb->addLoadLitInt(1);
+  asmb->addSubInt();
+  asmb->addCall("loop", 1, novasm::CallMode::Tail);
+
+  asmb->label("loop-end");
+  asmb->addLoadLitInt(0);
+  asmb->addRet();
+
+  asmb->label("identity");
+  asmb->addStackLoad(0);
+  asmb->addRet();
+
+  asmb->setEntrypoint("entrypoint");
+});
+
+} // namespace bench
@@ -0,0 +1,99 @@
+#include "helpers.hpp"
+
+/* Fork benchmarks, measure the throughput of forked calls (the 'iter / s' column is the amount of
+ * forks per second). Each fork runs a trivial function so the overhead of scheduling the fork on
+ * the executor pool and waiting for its result dominates. */
+
+namespace bench {
+
+constexpr uint32_t forkJoinIterations = 100'000;
+constexpr int32_t forkTreeDepth       = 16;
+constexpr uint32_t forkTreeForks      = (2U << forkTreeDepth) - 2U;
+
+// Fork a call and wait for it in a loop, stack slot 0 holds the loop counter.
+static auto buildForkJoinLoop(novasm::Assembler* asmb) {
+  asmb->label("loop");
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(0);
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("loop-end");
+
+  asmb->addStackLoad(0);
+  asmb->addCall("identity", 1, novasm::CallMode::Forked);
+  asmb->addFutureBlock();
+  asmb->addPop();
+
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(1);
+  asmb->addSubInt();
+  asmb->addCall("loop", 1, novasm::CallMode::Tail);
+
+  asmb->label("loop-end");
+  asmb->addLoadLitInt(0);
+  asmb->addRet();
+
+  asmb->label("identity");
+  asmb->addStackLoad(0);
+  asmb->addRet();
+}
+
+// Forks from the main executor are queued on the shared queue of the pool.
+BENCH_PROG("fork/join", forkJoinIterations, [](novasm::Assembler* asmb) {
+  asmb->label("entrypoint");
+  asmb->addLoadLitInt(static_cast<int32_t>(forkJoinIterations));
+  asmb->addCall("loop", 1, novasm::CallMode::Normal);
+  asmb->addRet();
+
+  buildForkJoinLoop(asmb);
+  asmb->setEntrypoint("entrypoint");
+});
+
+// Forks from a pool thread are queued on its own queue, waiting for them runs them on the thread.
+BENCH_PROG("fork/join_nested", forkJoinIterations, [](novasm::Assembler* asmb) {
+  asmb->label("entrypoint");
+  asmb->addLoadLitInt(static_cast<int32_t>(forkJoinIterations));
+  asmb->addCall("loop", 1, novasm::CallMode::Forked);
+  asmb->addFutureBlock();
+  asmb->addRet();
+
+  buildForkJoinLoop(asmb);
+  asmb->setEntrypoint("entrypoint");
+});
+
+// Binary tree of forks, every fork forks two more until the depth reaches zero. Idle pool threads
+// steal the forks from the threads that are busy.
+BENCH_PROG("fork/tree", forkTreeForks, [](novasm::Assembler* asmb) {
+  asmb->label("entrypoint");
+  asmb->addLoadLitInt(forkTreeDepth);
+  asmb->addCall("tree", 1, novasm::CallMode::Normal);
+  asmb->addRet();
+
+  asmb->label("tree");
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(0);
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("tree-leaf");
+
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(1);
+  asmb->addSubInt();
+  asmb->addCall("tree", 1, novasm::CallMode::Forked);
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(1);
+  asmb->addSubInt();
+  asmb->addCall("tree", 1, novasm::CallMode::Forked);
+
+  asmb->addFutureBlock();
+  asmb->addSwap();
+  asmb->addFutureBlock();
+  asmb->addAddInt();
+  asmb->addRet();
+
+  asmb->label("tree-leaf");
+  asmb->addLoadLitInt(1);
+  asmb->addRet();
+
+  asmb->setEntrypoint("entrypoint");
+});
+
+} // namespace bench
@@ -0,0 +1,84 @@
+#include "helpers.hpp"
+
+/* Jit compiler benchmarks, each benchmark runs an arithmetic heavy loop that only consists of
+ * instructions that the jit compiler supports (so the whole loop can run as native code).
+ * Compare against the interpreter with: 'novbench jit/ --jit'. */
+
+namespace bench {
+
+constexpr uint32_t jitIterations = 10'000'000;
+
+// Build a program that executes the given body 'jitIterations' times in a (jump based) loop.
+// Note: Stack slot 0 holds the loop counter, the body can use slots 1 to 3.
+static auto buildJumpLoop(novasm::Assembler* asmb, const std::function<void()>& body) {
+  asmb->label("entrypoint");
+  asmb->addStackAlloc(4);
+  asmb->addLoadLitInt(static_cast<int32_t>(jitIterations));
+  asmb->addStackStore(0);
+
+  asmb->label("loop");
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(0);
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("loop-end");
+
+  body();
+
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(-1);
+  asmb->addAddInt();
+  asmb->addStackStore(0);
+  asmb->addJump("loop");
+
+  asmb->label("loop-end");
+  asmb->addLoadLitInt(0);
+  asmb->addRet();
+
+  asmb->setEntrypoint("entrypoint");
+}
+
+BENCH_PROG("jit/int_loop", jitIterations, [](novasm::Assembler* asmb) {
+  buildJumpLoop(asmb, [asmb]() {
+    // acc = (acc + i * 3) ^ i
+    asmb->addStackLoad(1);
+    asmb->addStackLoad(0);
+    asmb->addLoadLitInt(3);
+    asmb->addMulInt();
+    asmb->addAddInt();
+    asmb->addStackLoad(0);
+    asmb->addXorInt();
+    asmb->addStackStore(1);
+  });
+});
+
+BENCH_PROG("jit/int_check", jitIterations, [](novasm::Assembler* asmb) {
+  buildJumpLoop(asmb, [asmb]() {
+    // acc = acc + (i > 42) + (i < 1337)
+    asmb->addStackLoad(1);
+    asmb->addStackLoad(0);
+    asmb->addLoadLitInt(42);
+    asmb->addCheckGtInt();
+    asmb->addAddInt();
+    asmb->addStackLoad(0);
+    asmb->addLoadLitInt(1337);
+    asmb->addCheckLeInt();
+    asmb->addAddInt();
+    asmb->addStackStore(1);
+  });
+});
+
+BENCH_PROG("jit/float_loop", jitIterations, [](novasm::Assembler* asmb) {
+  buildJumpLoop(asmb, [asmb]() {
+    // x = x * 0.5 + 1.0
+    asmb->addLoadLitFloat(0.5F);
+    asmb->addStackStore(2);
+    asmb->addLoadLitFloat(1.0F);
+    asmb->addStackStore(3);
+    asmb->addStackMulFloat(1, 2);
+    asmb->addStackStore(1);
+    asmb->addStackAddFloat(1, 3);
+    asmb->addStackStore(1);
+  });
+});
+
+} // namespace bench
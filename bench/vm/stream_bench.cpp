@@ -0,0 +1,148 @@
+#include "helpers.hpp"
+#include <string>
+
+/* Stream benchmarks, measure how fast lines are read from a tcp connection over the loopback
+ * interface (the 'iter / s' column is the amount of lines per second). A forked sender writes the
+ * lines in blocks while the main executor reads them. The 'read_chars' variant reads the lines one
+ * character at a time (the way lines were read before the native 'StreamReadLine' call). */
+
+namespace bench {
+
+constexpr uint32_t streamLineCount      = 100'000;
+constexpr uint32_t streamLinesPerBlock  = 100;
+constexpr uint32_t streamBlockCount     = streamLineCount / streamLinesPerBlock;
+constexpr int32_t streamReadLinePort    = 8095;
+constexpr int32_t streamReadCharsPort   = 8096;
+constexpr const char* streamLineContent = "GET /index.html HTTP/1.1\r\n";
+
+// Start a server, fork a sender that connects to it and read the lines from the connection using
+// the given read function ('read-line' in the assembly, takes the stream and returns a string).
+static auto buildLoopbackRead(novasm::Assembler* asmb, int32_t port) {
+  asmb->label("entrypoint");
+  asmb->addStackAlloc(1);
+
+  asmb->addLoadLitInt(port);
+  asmb->addLoadLitInt(-1); // Backlog (-1 uses the default backlog).
+  asmb->addPCall(novasm::PCallCode::TcpStartServer);
+  asmb->addStackStore(0);
+
+  asmb->addLoadLitInt(static_cast<int32_t>(streamBlockCount));
+  asmb->addCall("send", 1, novasm::CallMode::Forked);
+
+  asmb->addLoadLitInt(static_cast<int32_t>(streamLineCount));
+  asmb->addStackLoad(0);
+  asmb->addPCall(novasm::PCallCode::TcpAcceptCon);
+  asmb->addCall("receive", 2, novasm::CallMode::Normal);
+  asmb->addPop();
+
+  asmb->addFutureBlock(); // Wait for the sender.
+  asmb->addRet();
+
+  // Receive 'count' lines (stack slot 0) from the stream (stack slot 1).
+  asmb->label("receive");
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(0);
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("receive-end");
+
+  asmb->addStackLoad(1);
+  asmb->addCall("read-line", 1, novasm::CallMode::Normal);
+  asmb->addPop();
+
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(1);
+  asmb->addSubInt();
+  asmb->addStackLoad(1);
+  asmb->addCall("receive", 2, novasm::CallMode::Tail);
+
+  asmb->label("receive-end");
+  asmb->addLoadLitInt(0);
+  asmb->addRet();
+
+  // Connect to the server and send 'count' blocks of lines (stack slot 0).
+  auto block = std::string{};
+  for (auto i = 0U; i != streamLinesPerBlock; ++i) {
+    block += streamLineContent;
+  }
+  asmb->label("send");
+  asmb->addStackAlloc(1);
+  asmb->addLoadLitString("127.0.0.1");
+  asmb->addLoadLitInt(port);
+  asmb->addPCall(novasm::PCallCode::TcpOpenCon);
+  asmb->addStackStore(1);
+
+  asmb->label("send-loop");
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(0);
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("send-end");
+
+  asmb->addStackLoad(1);
+  asmb->addLoadLitString(block);
+  asmb->addPCall(novasm::PCallCode::StreamWriteString);
+  asmb->addPop(); // Ignore the write result.
+
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(1);
+  asmb->addSubInt();
+  asmb->addStackStore(0);
+  asmb->addJump("send-loop");
+
+  asmb->label("send-end");
+  asmb->addLoadLitInt(0);
+  asmb->addRet();
+
+  asmb->setEntrypoint("entrypoint");
+}
+
+BENCH_PROG("stream/tcp_read_line", streamLineCount, [](novasm::Assembler* asmb) {
+  buildLoopbackRead(asmb, streamReadLinePort);
+
+  asmb->label("read-line");
+  asmb->addStackLoad(0);
+  asmb->addPCall(novasm::PCallCode::StreamReadLine);
+  asmb->addRet();
+});
+
+BENCH_PROG("stream/tcp_read_chars", streamLineCount, [](novasm::Assembler* asmb) {
+  buildLoopbackRead(asmb, streamReadCharsPort);
+
+  asmb->label("read-line");
+  asmb->addStackLoad(0);
+  asmb->addLoadLitString("");
+  asmb->addCall("read-chars", 2, novasm::CallMode::Tail);
+
+  // Append characters from the stream (stack slot 0) to the result (stack slot 1) until the end of
+  // the line, carriage returns are skipped.
+  asmb->label("read-chars");
+  asmb->addStackAlloc(1);
+  asmb->addStackLoad(0);
+  asmb->addPCall(novasm::PCallCode::StreamReadChar);
+  asmb->addStackStore(2);
+
+  asmb->addStackLoad(2);
+  asmb->addLoadLitInt('\n');
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("read-chars-end");
+  asmb->addStackLoad(2);
+  asmb->addLoadLitInt('\0'); // Connection ended.
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("read-chars-end");
+
+  asmb->addStackLoad(0);
+  asmb->addStackLoad(1);
+  asmb->addStackLoad(2);
+  asmb->addLoadLitInt('\r');
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("read-chars-skip");
+  asmb->addStackLoad(2);
+  asmb->addAppendChar();
+  asmb->label("read-chars-skip");
+  asmb->addCall("read-chars", 2, novasm::CallMode::Tail);
+
+  asmb->label("read-chars-end");
+  asmb->addStackLoad(1);
+  asmb->addRet();
+});
+
+} // namespace bench
@@ -0,0 +1,106 @@
+#include "helpers.hpp"
+
+/* String search benchmarks, each benchmark searches a 4 KiB string for a match at the end of it.
+ * 'string/scan_chars' searches for a character by indexing the string one character at a time
+ * (how the search functions in the standard library used to be implemented) as a baseline for the
+ * native search instructions. */
+
+namespace bench {
+
+constexpr uint32_t stringSearchIterations = 10'000;
+
+static auto getSearchText() -> const std::string& {
+  static const auto text = []() {
+    auto res = std::string{};
+    while (res.size() < 4096U) {
+      res += "the quick brown fox jumps over the lazy dog\t ";
+    }
+    return res + "lazy cat!";
+  }();
+  return text;
+}
+
+BENCH_PROG("string/scan_chars", stringSearchIterations, [](novasm::Assembler* asmb) {
+  // Stack slot 0 holds the loop counter and slot 1 the index in the string.
+  asmb->label("entrypoint");
+  asmb->addStackAlloc(2);
+  asmb->addLoadLitInt(static_cast<int32_t>(stringSearchIterations));
+  asmb->addStackStore(0);
+
+  asmb->label("loop");
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(0);
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("loop-end");
+
+  asmb->addLoadLitInt(0);
+  asmb->addStackStore(1);
+
+  asmb->label("scan");
+  asmb->addLoadLitString(getSearchText());
+  asmb->addStackLoad(1);
+  asmb->addIndexString();
+  asmb->addLoadLitInt('!');
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("scan-end");
+  asmb->addStackLoad(1);
+  asmb->addLoadLitInt(1);
+  asmb->addAddInt();
+  asmb->addStackStore(1);
+  asmb->addJump("scan");
+
+  asmb->label("scan-end");
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(-1);
+  asmb->addAddInt();
+  asmb->addStackStore(0);
+  asmb->addJump("loop");
+
+  asmb->label("loop-end");
+  asmb->addLoadLitInt(0);
+  asmb->addRet();
+
+  asmb->setEntrypoint("entrypoint");
+});
+
+BENCH_LOOP("string/index_of", stringSearchIterations, [](novasm::Assembler* asmb) {
+  asmb->addLoadLitString(getSearchText());
+  asmb->addLoadLitString("lazy cat");
+  asmb->addLoadLitInt(0);
+  asmb->addIndexOfString();
+  asmb->addPop();
+});
+
+BENCH_LOOP("string/index_of_last", stringSearchIterations, [](novasm::Assembler* asmb) {
+  asmb->addLoadLitString(getSearchText());
+  asmb->addLoadLitString("the quick!");
+  asmb->addLoadLitInt(1'000'000);
+  asmb->addIndexOfLastString();
+  asmb->addPop();
+});
+
+BENCH_LOOP("string/index_of_any", stringSearchIterations, [](novasm::Assembler* asmb) {
+  asmb->addLoadLitString(getSearchText());
+  asmb->addLoadLitString("!?");
+  asmb->addLoadLitInt(0);
+  asmb->addIndexOfAnyString();
+  asmb->addPop();
+});
+
+BENCH_LOOP("string/span", stringSearchIterations, [](novasm::Assembler* asmb) {
+  asmb->addLoadLitString(getSearchText());
+  asmb->addLoadLitString(" \tabcdefghijklmnopqrstuvwxyz");
+  asmb->addLoadLitInt(0);
+  asmb->addSpanString();
+  asmb->addPop();
+});
+
+BENCH_LOOP("string/starts_with", stringSearchIterations, [](novasm::Assembler* asmb) {
+  asmb->addLoadLitString(getSearchText());
+  asmb->addLoadLitString(getSearchText().substr(0, 4096));
+  asmb->addLoadLitInt(0);
+  asmb->addStartsWithString();
+  asmb->addPop();
+});
+
+} // namespace bench
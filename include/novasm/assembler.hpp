@@ -1,7 +1,9 @@
 #pragma once
 #include "novasm/assembly.hpp"
+#include "novasm/debug_info.hpp"
 #include "novasm/op_code.hpp"
 #include "novasm/pcall_code.hpp"
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -12,10 +14,12 @@ namespace novasm {
 enum class CallMode {
   Normal,
   Tail, // Tail calls are executed in the same stack frame (doesn't return to the current function).
-  Forked, // Forked calls are ran on a new executor (new thread).
+  Forked, // Forked calls are ran on a new executor (scheduled on the executor pool).
 };
 
 // Builder class to aid in generating novus assembly.
+// Note: Common instruction sequences are fused into 'super-instructions' as they are added (for
+// example 'StackLoad' followed by 'StructLoadField'), sequences are never fused across a label.
 class Assembler final {
 public:
   Assembler();
@@ -40,6 +44,19 @@ public:
   auto addStackStore(uint8_t offset) -> void;
   auto addStackLoad(uint8_t offset) -> void;
 
+  auto addStackAddInt(uint8_t lhsOffset, uint8_t rhsOffset) -> void;
+  auto addStackSubInt(uint8_t lhsOffset, uint8_t rhsOffset) -> void;
+  auto addStackMulInt(uint8_t lhsOffset, uint8_t rhsOffset) -> void;
+  auto addStackAddFloat(uint8_t lhsOffset, uint8_t rhsOffset) -> void;
+  auto addStackSubFloat(uint8_t lhsOffset, uint8_t rhsOffset) -> void;
+  auto addStackMulFloat(uint8_t lhsOffset, uint8_t rhsOffset) -> void;
+  auto addStackDivFloat(uint8_t lhsOffset, uint8_t rhsOffset) -> void;
+  auto addStackCheckEqInt(uint8_t lhsOffset, uint8_t rhsOffset) -> void;
+  auto addStackCheckGtInt(uint8_t lhsOffset, uint8_t rhsOffset) -> void;
+  auto addStackCheckLeInt(uint8_t lhsOffset, uint8_t rhsOffset) -> void;
+  auto addStackCheckGtFloat(uint8_t lhsOffset, uint8_t rhsOffset) -> void;
+  auto addStackCheckLeFloat(uint8_t lhsOffset, uint8_t rhsOffset) -> void;
+
   auto addAddInt() -> void;
   auto addAddLong() -> void;
   auto addAddFloat() -> void;
@@ -80,6 +97,15 @@ public:
   auto addLengthString() -> void;
   auto addIndexString() -> void;
   auto addSliceString() -> void;
+  auto addIndexOfString() -> void;
+  auto addIndexOfLastString() -> void;
+  auto addIndexOfAnyString() -> void;
+  auto addSpanString() -> void;
+  auto addStartsWithString() -> void;
+  auto addLengthArray() -> void;
+  auto addIndexArray() -> void;
+  auto addSliceArray() -> void;
+  auto addAddArray() -> void;
 
   auto addCheckEqInt() -> void;
   auto addCheckEqLong() -> void;
@@ -114,6 +140,11 @@ public:
   auto addStructLoadField(uint8_t fieldIndex) -> void;
   auto addStructStoreField(uint8_t fieldIndex) -> void;
 
+  auto addMakeArray() -> void;
+  auto addMakeArrayList() -> void;
+  auto addAllocArray() -> void;
+  auto addArrayStore() -> void;
+
   auto addJump(std::string label) -> void;
   auto addJumpIf(std::string label) -> void;
 
@@ -131,6 +162,17 @@ public:
 
   auto setEntrypoint(std::string label) -> void;
 
+  // Debug information: the instructions that are added are attributed to the current source span,
+  // an assembly only includes debug information if any files, spans or functions were recorded.
+  auto addSourceFile(std::string path) -> uint32_t;
+  auto setSourceSpan(std::optional<SourceSpan> span) -> void;
+  [[nodiscard]] auto getSourceSpan() const noexcept -> const std::optional<SourceSpan>&;
+
+  // Record the instructions that are added between 'beginFunction' and 'endFunction' as a function
+  // in the debug information.
+  auto beginFunction(std::string name) -> void;
+  auto endFunction() -> void;
+
   [[nodiscard]] auto close() -> Assembly;
   [[nodiscard]] auto getLabels() -> std::unordered_map<uint32_t, std::vector<std::string>>;
 
@@ -143,11 +185,24 @@ private:
   std::string m_entrypointLabel;
   std::unordered_map<std::string, uint32_t> m_labels;
   std::vector<std::pair<std::string, unsigned int>> m_labelTargets;
+  uint32_t m_prevOpOffset;
+  bool m_prevOpFusable;
+  DebugInfo m_debugInfo;
+  std::optional<SourceSpan> m_sourceSpan;
+  std::optional<std::pair<std::string, uint32_t>> m_function;
 
   [[nodiscard]] auto addLitString(const std::string& string) -> uint32_t;
   [[nodiscard]] auto getCurrentIpOffset() -> uint32_t;
+  [[nodiscard]] auto getPrevOp() -> std::optional<OpCode>;
+  [[nodiscard]] auto getPrevOpLitInt() -> int32_t;
+
+  auto fusePrevOp(OpCode opCode) -> void;
+  auto replacePrevOp(OpCode opCode) -> void;
+
+  auto addStackBinaryOp(OpCode opCode, uint8_t lhsOffset, uint8_t rhsOffset) -> void;
 
   auto writeOpCode(OpCode opCode) -> void;
+  auto writeSourceSpan() -> void;
   auto writeUInt8(uint8_t val) -> void;
   auto writeInt32(int32_t val) -> void;
   auto writeInt64(int64_t val) -> void;
@@ -1,5 +1,7 @@
 #pragma once
+#include "novasm/debug_info.hpp"
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -14,7 +16,8 @@ public:
       std::string compilerVersion,
       uint32_t entrypoint,
       std::vector<std::string> litStrings,
-      std::vector<uint8_t> instructions) noexcept;
+      std::vector<uint8_t> instructions,
+      std::optional<DebugInfo> debugInfo = std::nullopt) noexcept;
   Assembly(const Assembly& rhs)     = delete;
   Assembly(Assembly&& rhs) noexcept = default;
   ~Assembly() noexcept              = default;
@@ -36,11 +39,15 @@ public:
   [[nodiscard]] auto getOffset(const uint8_t* ip) const noexcept -> uint32_t;
   [[nodiscard]] auto isEnd(const uint8_t* ip) const noexcept -> bool;
 
+  // Debug information of the assembly, null if the assembly has none (or it was not loaded).
+  [[nodiscard]] auto getDebugInfo() const noexcept -> const DebugInfo*;
+
 private:
   std::string m_compilerVersion;
   uint32_t m_entrypoint;
   std::vector<std::string> m_litStrings;
   std::vector<uint8_t> m_instructions;
+  std::optional<DebugInfo> m_debugInfo;
 };
 
 } // namespace novasm
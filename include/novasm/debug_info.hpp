@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace novasm {
+
+// Range of text in a source file, lines and columns start at 1 and the end is inclusive.
+struct SourceSpan final {
+  uint32_t file; // Index into the files of the debug-info.
+  uint32_t startLine;
+  uint32_t startCol;
+  uint32_t endLine;
+  uint32_t endCol;
+
+  auto operator==(const SourceSpan& rhs) const noexcept -> bool;
+  auto operator!=(const SourceSpan& rhs) const noexcept -> bool;
+};
+
+// Optional debug information of an assembly, maps instructions back to the source they were
+// generated from.
+//
+// Spans are stored as ranges: a span entry applies to all instructions from its offset up to the
+// offset of the next entry, entries without a span mark instructions that have no source (for
+// example compiler generated helpers).
+class DebugInfo final {
+public:
+  struct SpanEntry final {
+    uint32_t ipOffset;
+    std::optional<SourceSpan> span;
+
+    auto operator==(const SpanEntry& rhs) const noexcept -> bool;
+    auto operator!=(const SpanEntry& rhs) const noexcept -> bool;
+  };
+
+  struct Function final {
+    std::string name;
+    uint32_t ipBegin;
+    uint32_t ipEnd; // Exclusive.
+
+    auto operator==(const Function& rhs) const noexcept -> bool;
+    auto operator!=(const Function& rhs) const noexcept -> bool;
+  };
+
+  DebugInfo() = default;
+
+  auto operator==(const DebugInfo& rhs) const noexcept -> bool;
+  auto operator!=(const DebugInfo& rhs) const noexcept -> bool;
+
+  auto addFile(std::string path) -> uint32_t;
+
+  // Note: Entries have to be added in order of increasing offset.
+  auto addSpan(uint32_t ipOffset, std::optional<SourceSpan> span) -> void;
+
+  // Remove the span entries that start at or after the given offset.
+  auto removeSpans(uint32_t ipOffset) -> void;
+
+  // Note: Functions have to be added in order of increasing offset and cannot overlap.
+  auto addFunction(std::string name, uint32_t ipBegin, uint32_t ipEnd) -> void;
+
+  [[nodiscard]] auto getFiles() const noexcept -> const std::vector<std::string>&;
+  [[nodiscard]] auto getSpans() const noexcept -> const std::vector<SpanEntry>&;
+  [[nodiscard]] auto getFunctions() const noexcept -> const std::vector<Function>&;
+
+  // Lookup the source span of the instruction at the given offset.
+  [[nodiscard]] auto findSpan(uint32_t ipOffset) const noexcept -> std::optional<SourceSpan>;
+
+  // Lookup the function that contains the instruction at the given offset.
+  [[nodiscard]] auto findFunction(uint32_t ipOffset) const noexcept -> const Function*;
+
+private:
+  std::vector<std::string> m_files;
+  std::vector<SpanEntry> m_spans;
+  std::vector<Function> m_functions;
+};
+
+} // namespace novasm
@@ -25,6 +25,8 @@ enum class OpCode : uint8_t {
   StackStore = 31, // [uint8] (any) -> ()     Store at a offset from the stack-frame start.
   StackLoad  = 32, // [uint8] ()    -> (any)  Load from a offset from the stack-frame start.
 
+  StackLoadStructField = 33, // [uint8, uint8] () -> (any) Load field y of the struct at offset x.
+
   AddInt        = 40, // [] (int, int)          -> (int)    Add two ints.
   AddLong       = 41, // [] (long, long)        -> (long)   Add two longs.
   AddFloat      = 42, // [] (float, float)      -> (float)  Add two floats.
@@ -66,6 +68,20 @@ enum class OpCode : uint8_t {
   IndexString   = 78, // [] (int, string)       -> (int)    Get char at index in string (ascii).
   SliceString   = 79, // [] (int, int, string)  -> (string) Substring from start to end (exclusive).
 
+  AddIntLit = 80, // [int32] (int) -> (int) Add an int literal to an int.
+
+  LengthArray = 81, // [] (array)             -> (int)   Get the amount of values in an array.
+  IndexArray  = 82, // [] (int, array)        -> (any)   Get value at index (fails if out of bounds).
+  SliceArray  = 83, // [] (int, int, array)   -> (array) Subarray from start to end (exclusive).
+  AddArray    = 84, // [] (array, array)      -> (array) Concatenate two arrays.
+
+  // String searches, take a start index (x), a string (y) and the string to search in (z).
+  IndexOfString     = 85, // [] (int, string, string) -> (int) Index of y in z at or after x.
+  IndexOfLastString = 86, // [] (int, string, string) -> (int) Index of y in z at or before x.
+  IndexOfAnyString  = 87, // [] (int, string, string) -> (int) Index of a char of y at or after x.
+  SpanString        = 88, // [] (int, string, string) -> (int) Index of a char not in y from x.
+  StartsWithString  = 89, // [] (int, string, string) -> (int) Check if z contains y at x.
+
   CheckEqInt        = 90, //  [] (int, int)               -> (int) Check ints equal.
   CheckEqLong       = 91, //  [] (long, long)             -> (int) Check long equal.
   CheckEqFloat      = 92, //  [] (float, float)           -> (int) Check floats equal.
@@ -93,14 +109,45 @@ enum class OpCode : uint8_t {
   ConvFloatChar   = 121, // [] (float) -> (int)      Convert float to char (ascii).
   ConvFloatLong   = 122, // [] (float) -> (long)     Convert float to long.
 
+  // Three-address variants that read both operands from offsets from the stack-frame start, the
+  // 'Store' variants store the result at offset z instead of pushing it.
+  StackAddInt        = 130, // [uint8, uint8]        () -> (int)   Add ints at offset x and y.
+  StackSubInt        = 131, // [uint8, uint8]        () -> (int)   Substract ints at x and y.
+  StackMulInt        = 132, // [uint8, uint8]        () -> (int)   Multiply ints at x and y.
+  StackAddFloat      = 133, // [uint8, uint8]        () -> (float) Add floats at x and y.
+  StackSubFloat      = 134, // [uint8, uint8]        () -> (float) Substract floats at x and y.
+  StackMulFloat      = 135, // [uint8, uint8]        () -> (float) Multiply floats at x and y.
+  StackDivFloat      = 136, // [uint8, uint8]        () -> (float) Divide floats at x and y.
+  StackCheckEqInt    = 137, // [uint8, uint8]        () -> (int)   Check ints at x and y equal.
+  StackCheckGtInt    = 138, // [uint8, uint8]        () -> (int)   Check int at x is greater.
+  StackCheckLeInt    = 139, // [uint8, uint8]        () -> (int)   Check int at x is less.
+  StackCheckGtFloat  = 140, // [uint8, uint8]        () -> (int)   Check float at x is greater.
+  StackCheckLeFloat  = 141, // [uint8, uint8]        () -> (int)   Check float at x is less.
+  StackAddIntStore   = 142, // [uint8, uint8, uint8] () -> ()      Add ints, store at z.
+  StackSubIntStore   = 143, // [uint8, uint8, uint8] () -> ()      Substract ints, store at z.
+  StackMulIntStore   = 144, // [uint8, uint8, uint8] () -> ()      Multiply ints, store at z.
+  StackAddFloatStore = 145, // [uint8, uint8, uint8] () -> ()      Add floats, store at z.
+  StackSubFloatStore = 146, // [uint8, uint8, uint8] () -> ()      Substract floats, store at z.
+  StackMulFloatStore = 147, // [uint8, uint8, uint8] () -> ()      Multiply floats, store at z.
+  StackDivFloatStore = 148, // [uint8, uint8, uint8] () -> ()      Divide floats, store at z.
+
   MakeStruct       = 190, // [uint8] (any ...)     -> (struct) Create structure containing x values.
   MakeNullStruct   = 191, // []      ()            -> struct   Create a struct without fields.
   StructLoadField  = 192, // [uint8] (struct)      -> (any)    Get value of field x in structure.
   StructStoreField = 193, // [uint8] (any, struct) -> ()       Store value at field x in structure.
+  StructPeekField  = 194, // [uint8] (struct)      -> (struct, any) Get field x, keep structure.
+
+  MakeArray      = 195, // [] (int, any ...)    -> (array) Create array containing x values.
+  MakeArrayList  = 196, // [] (struct)          -> (array) Create array from a list of structs.
+  AllocArray     = 197, // [] (int)             -> (array) Create array of x zero values.
+  ArrayStore     = 198, // [] (any, int, array) -> ()      Store value at index in a new array.
 
   Jump   = 220, // [ip] ()    -> () Jump to an instruction pointer.
   JumpIf = 221, // [ip] (int) -> () Jump to an instruction if int is not 0.
 
+  CheckEqIntJumpIf      = 222, // [ip]        (int, int) -> ()       Jump if ints are equal.
+  StructPeekFieldJumpIf = 223, // [uint8, ip] (struct)   -> (struct) Jump if field x is not 0.
+
   Call          = 230, // [uint8, ip] (any ...)             -> (any)    Call with x args.
   CallTail      = 231, // [uint8, ip] (any ...)             -> (any)    Tail-call with x args.
   CallForked    = 232, // [uint8, ip] (any ...)             -> (future) Fork-call with x args.
@@ -18,6 +18,8 @@ enum class PCallCode : uint8_t {
   StreamFlush        = 15, // (stream)         -> (int)     Flush any unwritten data, ret success.
   StreamSetOptions   = 16, // (int, stream)    -> (int)     Set options, returns success.
   StreamUnsetOptions = 17, // (int, stream)    -> (int)     Unset options, returns success.
+  StreamReadLine     = 18, // (stream)         -> (string)  Read until the end of the line.
+  StreamReadUntil    = 19, // (int, stream)    -> (string)  Read until the given character.
 
   FileOpenStream = 30, // (int, string) -> (stream)  Open a file at path with options.
   FileRemove     = 31, // (string)      -> (int)     Remove the file at path, returns success.
@@ -41,6 +43,8 @@ enum class PCallCode : uint8_t {
   ClockMicroSinceEpoch = 80, // () -> (long) Get the elapsed microseconds since unix epoch.
   ClockNanoSteady      = 81, // () -> (long) Get process steady clock in nanoseconds.
 
+  RuntimeMemStat = 90, // (int) -> (long) Get a memory statistic of the runtime by id.
+
   SleepNano = 240, // (long)         -> (long) Sleep the current executor for x nanoseconds.
   Assert    = 241, // (string, int)  -> (int) If condition is false: fail with message.
 };
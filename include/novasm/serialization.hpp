@@ -7,14 +7,18 @@ namespace novasm {
 // Version number for the binary representation of the novus assembly format.
 // Increase this when performing breaking changes to the format.
 // TODO(bastian): Add system for defining migrations.
-const uint16_t assemblyFormatVersion = 3U;
+const uint16_t assemblyFormatVersion = 7U;
 
 // Write a binary representation of the assembly file to the output iterator.
+// Note: Debug information is written as an optional section after the instructions, readers that
+// do not load it never have to read past the instructions.
 template <typename OutputItr>
 auto serialize(const Assembly& assembly, OutputItr outItr) noexcept -> OutputItr;
 
 // Read an assembly file in its binary from from the input iterator.
+// Debug information is only read when 'loadDebugInfo' is true.
 template <typename InputItrBegin, typename InputEndItr>
-auto deserialize(InputItrBegin begin, InputEndItr end) noexcept -> std::optional<Assembly>;
+auto deserialize(InputItrBegin begin, InputEndItr end, bool loadDebugInfo = false) noexcept
+    -> std::optional<Assembly>;
 
 } // namespace novasm
@@ -29,4 +29,8 @@ auto copyFunc(
     bool& modified,
     const RewriterFactory& rewriterFactory) -> bool;
 
+// Copy the source files from a program to another, the files keep their indices so the source spans
+// of copied expressions remain valid.
+auto copySourceFiles(const Program& from, Program* to) -> void;
+
 } // namespace prog
@@ -1,9 +1,11 @@
 #pragma once
 #include "prog/expr/node_kind.hpp"
 #include "prog/expr/node_visitor.hpp"
+#include "prog/expr/source_span.hpp"
 #include "prog/sym/type_id.hpp"
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 
 namespace prog::expr {
@@ -27,6 +29,10 @@ public:
 
   [[nodiscard]] auto getKind() const -> NodeKind;
 
+  // Source that the node was created from, not part of the node equality.
+  [[nodiscard]] auto getSourceSpan() const noexcept -> const std::optional<SourceSpan>&;
+  auto setSourceSpan(SourceSpan span) noexcept -> void;
+
   [[nodiscard]] virtual auto operator[](unsigned int) const -> const Node& = 0;
   [[nodiscard]] virtual auto getChildCount() const -> unsigned int         = 0;
   [[nodiscard]] virtual auto getType() const noexcept -> sym::TypeId       = 0;
@@ -48,8 +54,12 @@ public:
 protected:
   explicit Node(NodeKind kind);
 
+  // Copy the source span of this node to the given clone.
+  [[nodiscard]] auto copySourceSpan(std::unique_ptr<Node> clone) const -> std::unique_ptr<Node>;
+
 private:
   NodeKind m_kind;
+  std::optional<SourceSpan> m_sourceSpan;
 };
 
 using NodePtr = std::unique_ptr<Node>;
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+
+namespace prog::expr {
+
+// Range of source text that an expression was created from, lines and columns start at 1 and the
+// end is inclusive.
+struct SourceSpan final {
+  uint32_t file; // Index into the source files of the program.
+  uint32_t startLine;
+  uint32_t startCol;
+  uint32_t endLine;
+  uint32_t endCol;
+};
+
+} // namespace prog::expr
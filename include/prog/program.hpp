@@ -5,12 +5,15 @@
 #include "prog/sym/overload_options.hpp"
 #include "prog/sym/type_decl_table.hpp"
 #include "prog/sym/type_def_table.hpp"
+#include <optional>
 
 namespace prog {
 
 using OvFlags   = sym::OverloadFlags;
 using OvOptions = sym::OverloadOptions;
 
+const auto arrayMaxCtorArgs = 16U; // Maximum amount of values that an array constructor takes.
+
 // Representation of a full program. All types and references are resolved in this representation.
 // Contains types, functions and execute-statements (top-level function invocations).
 //
@@ -78,6 +81,11 @@ public:
   [[nodiscard]] auto getFuncCount() const -> unsigned int { return m_funcDecls.getCount(); }
   [[nodiscard]] auto getExecStmtCount() const -> unsigned int { return m_execStmts.size(); }
 
+  // Files that the program was created from, referenced by the source spans of expressions.
+  [[nodiscard]] auto getSourceFiles() const -> const std::vector<std::string>& {
+    return m_sourceFiles;
+  }
+
   [[nodiscard]] auto getInt() const noexcept -> sym::TypeId { return m_int; }
   [[nodiscard]] auto getLong() const noexcept -> sym::TypeId { return m_long; }
   [[nodiscard]] auto getFloat() const noexcept -> sym::TypeId { return m_float; }
@@ -138,6 +146,7 @@ public:
   auto declareDelegate(std::string name) -> sym::TypeId;
   auto declareFuture(std::string name) -> sym::TypeId;
   auto declareLazy(std::string name) -> sym::TypeId;
+  auto declareArray(std::string name) -> sym::TypeId;
   auto declarePureFunc(std::string name, sym::TypeSet input, sym::TypeId output) -> sym::FuncId;
   auto declareAction(std::string name, sym::TypeSet input, sym::TypeId output) -> sym::FuncId;
 
@@ -152,10 +161,17 @@ public:
       const std::vector<sym::TypeId>& aliases) -> void;
   auto defineFuture(sym::TypeId id, sym::TypeId result) -> void;
   auto defineLazy(sym::TypeId id, sym::TypeId result) -> void;
+  auto defineArray(
+      sym::TypeId id,
+      sym::TypeId element,
+      sym::TypeId generator,
+      std::optional<sym::TypeId> list) -> void;
   auto defineFunc(sym::FuncId id, sym::ConstDeclTable consts, expr::NodePtr expr) -> void;
 
   auto addExecStmt(sym::ConstDeclTable consts, expr::NodePtr expr) -> void;
 
+  auto addSourceFile(std::string path) -> uint32_t;
+
   auto updateFuncOutput(sym::FuncId funcId, sym::TypeId newOutput) -> void;
 
 private:
@@ -164,6 +180,7 @@ private:
   sym::TypeDefTable m_typeDefs;
   sym::FuncDefTable m_funcDefs;
   std::vector<sym::ExecStmt> m_execStmts;
+  std::vector<std::string> m_sourceFiles;
 
   sym::TypeId m_int;
   sym::TypeId m_long;
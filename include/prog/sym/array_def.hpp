@@ -0,0 +1,30 @@
+#pragma once
+#include "prog/sym/type_id.hpp"
+
+namespace prog::sym {
+
+// Definition of an array.
+// Array is an immutable contiguous sequence of values of the element type.
+class ArrayDef final {
+  friend class TypeDefTable;
+
+public:
+  ArrayDef()                        = delete;
+  ArrayDef(const ArrayDef& rhs)     = default;
+  ArrayDef(ArrayDef&& rhs) noexcept = default;
+  ~ArrayDef()                       = default;
+
+  auto operator=(const ArrayDef& rhs) -> ArrayDef& = delete;
+  auto operator=(ArrayDef&& rhs) noexcept -> ArrayDef& = delete;
+
+  [[nodiscard]] auto getId() const noexcept -> const TypeId&;
+  [[nodiscard]] auto getElement() const -> const TypeId&;
+
+private:
+  sym::TypeId m_id;
+  TypeId m_element;
+
+  ArrayDef(sym::TypeId id, TypeId element);
+};
+
+} // namespace prog::sym
@@ -80,6 +80,12 @@ enum class FuncKind {
   CheckEqString,  // Check if two strings are equal.
   CheckNEqString, // Check if two strings are not equal.
 
+  IndexOfString,     // Return the index of the first occurrence of a string (from a start index).
+  IndexOfLastString, // Return the index of the last occurrence of a string (before a start index).
+  IndexOfAnyString,  // Return the index of the first character that is in a set of characters.
+  SpanString,        // Return the index of the first character that is not in a set of characters.
+  StartsWithString,  // Check if a string contains another string at a specific offset.
+
   CombineChar,   // Combine two characters into a string.
   AppendChar,    // Append a character to a string.
   IncrementChar, // Increment a character.
@@ -113,6 +119,14 @@ enum class FuncKind {
 
   LazyGet, // Retreive the value for a lazy value.
 
+  MakeArray,         // Create a new array containing the arguments.
+  MakeArrayFromList, // Create a new array containing the values of a list.
+  MakeArrayGenerate, // Create a new array of size x by invoking a function for each index.
+  LengthArray,       // Return the amount of values in an array.
+  IndexArray,        // Return the value at a specific index into an array.
+  SliceArray,        // Return a subsection of an array, indicated by start and end.
+  AddArray,          // Concatenate two arrays.
+
   CheckEqUserType,  // Check if two user types are equal. Note: Backend will generate equality for
                     // all user-types.
   CheckNEqUserType, // Check if two user-types are not equal.
@@ -125,6 +139,8 @@ enum class FuncKind {
   ActionStreamFlush,        // Flush a stream to the underlying device.
   ActionStreamSetOptions,   // Set options for a stream.
   ActionStreamUnsetOptions, // Unset options for a stream.
+  ActionStreamReadLine,     // Read until the end of the line from a stream.
+  ActionStreamReadUntil,    // Read until the given character from a stream.
 
   ActionFileOpenStream, // Open a file stream.
   ActionFileRemove,     // Delete a file from the filesystem.
@@ -149,6 +165,8 @@ enum class FuncKind {
                               // (01-01-1970).
   ActionClockNanoSteady,      // Return a long of the amount of nanoseconds on the steady clock.
 
+  ActionRuntimeMemStat, // Return a long of a memory statistic (gc and allocator) of the runtime.
+
   ActionSleepNano, // Sleep the executor for x nanoseconds.
   ActionAssert,    // Assert a condition to be true (and fail the executor if it isn't).
   ActionFail,      // Fail the current executor (will return exit-code 1 from the application).
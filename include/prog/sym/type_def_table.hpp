@@ -1,4 +1,5 @@
 #pragma once
+#include "prog/sym/array_def.hpp"
 #include "prog/sym/delegate_def.hpp"
 #include "prog/sym/enum_def.hpp"
 #include "prog/sym/future_def.hpp"
@@ -16,8 +17,8 @@ namespace prog::sym {
 // Type definition table. Contains a defintiion for all user-types.
 class TypeDefTable final {
 public:
-  using TypeDef =
-      typename std::variant<StructDef, UnionDef, EnumDef, DelegateDef, FutureDef, LazyDef>;
+  using TypeDef = typename std::
+      variant<StructDef, UnionDef, EnumDef, DelegateDef, FutureDef, LazyDef, ArrayDef>;
   using Iterator = typename std::set<TypeId>::const_iterator;
 
   TypeDefTable()                        = default;
@@ -59,6 +60,8 @@ public:
 
   auto registerLazy(const sym::TypeDeclTable& typeTable, sym::TypeId id, TypeId result) -> void;
 
+  auto registerArray(const sym::TypeDeclTable& typeTable, sym::TypeId id, TypeId element) -> void;
+
   auto registerType(sym::TypeId id, TypeDef def) -> void;
 
 private:
@@ -17,6 +17,7 @@ enum class TypeKind {
   Delegate,
   Future,
   Lazy,
+  Array,
 };
 
 [[nodiscard]] auto isPrimitive(const TypeKind& kind) -> bool;
@@ -21,6 +21,7 @@ enum class ExecState : int8_t {
   DivByZero    = 6, // The executor has encountered a 'divide by zero' during execution.
   AssertFailed = 7, // An assert in the user programs has failed, note this is not an error-case for
                     // the vm itself.
+  IndexOutOfBounds = 8, // The executor has accessed an array outside of its bounds.
 };
 
 auto operator<<(std::ostream& out, const ExecState& rhs) noexcept -> std::ostream&;
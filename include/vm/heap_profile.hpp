@@ -0,0 +1,74 @@
+#pragma once
+#include "vm/profile.hpp"
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace vm {
+
+// Allocations of a program sampled by the heap profiler of the vm.
+// Allocations are sampled by bytes: on average one allocation is recorded per 'sampleRate'
+// allocated bytes, together with the instruction that made it (the allocation site). Samples are
+// weighted by the inverse of their chance to be sampled, so the counts and bytes are estimates of
+// all allocations. The garbage collector reports when sampled allocations are freed, the ones that
+// were not freed (yet) are retained. Sites are attributed to functions in the same way as the
+// samples of a 'Profile'.
+class HeapProfile final {
+public:
+  using FunctionLabels = Profile::FunctionLabels;
+
+  // Allocation site of allocations that were not made by an instruction.
+  static constexpr auto unknownSite = std::numeric_limits<uint32_t>::max();
+
+  struct Site final {
+    uint64_t allocCount;
+    uint64_t allocBytes;
+    uint64_t freedCount;
+    uint64_t freedBytes;
+
+    [[nodiscard]] auto getRetainedCount() const noexcept -> uint64_t {
+      return allocCount - freedCount;
+    }
+    [[nodiscard]] auto getRetainedBytes() const noexcept -> uint64_t {
+      return allocBytes - freedBytes;
+    }
+  };
+
+  // Instruction offset of the allocation site and the kind of the allocated ref.
+  using SiteKey = std::pair<uint32_t, uint8_t>;
+
+  HeapProfile() noexcept;
+
+  auto setSampleRate(uint32_t bytes) noexcept -> void { m_sampleRate = bytes; }
+  [[nodiscard]] auto getSampleRate() const noexcept -> uint32_t { return m_sampleRate; }
+
+  auto addAlloc(uint32_t ipOffset, uint8_t refKind, uint64_t count, uint64_t bytes) noexcept
+      -> void;
+  auto addFree(uint32_t ipOffset, uint8_t refKind, uint64_t count, uint64_t bytes) noexcept
+      -> void;
+  auto addFunction(uint32_t entryIpOffset) noexcept -> void;
+
+  [[nodiscard]] auto getSampleCount() const noexcept -> uint64_t { return m_sampleCount; }
+  [[nodiscard]] auto getSites() const noexcept -> const std::map<SiteKey, Site>& {
+    return m_sites;
+  }
+
+  // Offset of the entry of the function that contains the given instruction.
+  [[nodiscard]] auto getFunction(uint32_t ipOffset) const noexcept -> uint32_t;
+
+  // Write a report with a line per function (most allocated bytes first): the estimated bytes
+  // allocated, the bytes retained, the amount of allocations and the bytes per kind of ref.
+  // Functions are named by their first label, or 'func@<offset>' when they have none.
+  auto writeReport(std::ostream& out, const FunctionLabels& labels = {}) const noexcept -> void;
+
+private:
+  std::map<SiteKey, Site> m_sites;
+  std::vector<uint32_t> m_functions; // Sorted entry offsets.
+  uint64_t m_sampleCount;
+  uint32_t m_sampleRate;
+};
+
+} // namespace vm
@@ -0,0 +1,82 @@
+#pragma once
+#include "vm/pause_histogram.hpp"
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+
+namespace vm {
+
+// Statistics of the garbage collector and the memory allocator.
+//
+// Note: Programs can read the statistics through the 'RuntimeMemStat' platform call, the ids of
+// the statistics are part of that interface (see 'getById') and are mirrored in
+// 'novstd/runtime.nov'.
+class MemoryStats final {
+public:
+  enum class Counter : uint8_t {
+    Collections         = 0U,  // Garbage collections that have completed.
+    MajorCollections    = 1U,  // Collections that marked and swept the full heap.
+    PauseCount          = 2U,  // Times that the executors were paused by the collector.
+    PauseTotalNs        = 3U,  // Total time the executors were paused.
+    PauseMaxNs          = 4U,  // Longest single pause.
+    Allocations         = 5U,  // References allocated.
+    AllocatedBytes      = 6U,  // Bytes allocated for references (including their payloads).
+    LargeAllocations    = 7U,  // Allocations too big for the heap pages, made with 'malloc'.
+    LargeAllocatedBytes = 8U,  // Bytes allocated with 'malloc'.
+    PageCacheHits       = 9U,  // Allocations served from the page cached by the thread.
+    PageCacheMisses     = 10U, // Allocations that had to acquire a page from the allocator.
+    PagesMapped         = 11U, // Heap pages requested from the system.
+    PagesUnmapped       = 12U, // Heap pages returned to the system.
+    HeapPages           = 13U, // Heap pages currently owned by the allocator.
+    LiveRefs            = 14U, // References that have not been freed (yet).
+    FreedRefs           = 15U, // References freed by the collector.
+    HeapLiveBytes       = 16U, // Bytes of the heap that survived the last collection.
+    HeapTriggerBytes    = 17U, // Bytes to allocate after the last collection before the next one.
+  };
+
+  static constexpr auto counterCount   = 18U;
+  static constexpr auto refKindCount   = 11U;
+  static constexpr auto liveRefsIdBase = 32U; // Id of the live refs of the first ref kind.
+
+  MemoryStats() noexcept;
+
+  [[nodiscard]] auto get(Counter counter) const noexcept -> uint64_t {
+    return m_counters[static_cast<uint8_t>(counter)];
+  }
+
+  auto set(Counter counter, uint64_t value) noexcept -> void {
+    m_counters[static_cast<uint8_t>(counter)] = value;
+  }
+
+  // Live references per kind of reference (for example strings or structs).
+  [[nodiscard]] auto getLiveRefs(unsigned int refKind) const noexcept -> uint64_t {
+    return m_liveRefs[refKind];
+  }
+
+  auto setLiveRefs(unsigned int refKind, uint64_t value) noexcept -> void {
+    m_liveRefs[refKind] = value;
+  }
+
+  // Histogram of the pause times.
+  // Note: Only filled in the statistics of a completed execution.
+  [[nodiscard]] auto getPauses() const noexcept -> const PauseHistogram& { return m_pauses; }
+
+  auto setPauses(const PauseHistogram& pauses) noexcept -> void { m_pauses = pauses; }
+
+  // Lookup a statistic by id, ids below 'counterCount' are counters and ids starting at
+  // 'liveRefsIdBase' are the live references per kind. Returns nothing for unknown ids.
+  [[nodiscard]] auto getById(int32_t id) const noexcept -> std::optional<uint64_t>;
+
+  [[nodiscard]] static auto getName(Counter counter) noexcept -> const char*;
+  [[nodiscard]] static auto getRefKindName(unsigned int refKind) noexcept -> const char*;
+
+private:
+  std::array<uint64_t, counterCount> m_counters;
+  std::array<uint64_t, refKindCount> m_liveRefs;
+  PauseHistogram m_pauses;
+};
+
+auto operator<<(std::ostream& out, const MemoryStats& rhs) noexcept -> std::ostream&;
+
+} // namespace vm
@@ -0,0 +1,42 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <iostream>
+
+namespace vm {
+
+// Histogram of the pause times of the garbage collector (the time that executors are stopped).
+// Bucket 'i' counts the pauses that took less than '2^i' microseconds, the last bucket also counts
+// all longer pauses.
+class PauseHistogram final {
+public:
+  static constexpr auto bucketCount = 20U;
+
+  PauseHistogram() noexcept;
+
+  // Record a pause of the given duration.
+  auto add(uint64_t durationNs) noexcept -> void;
+
+  [[nodiscard]] auto getCount() const noexcept -> uint64_t { return m_count; }
+  [[nodiscard]] auto getTotalNs() const noexcept -> uint64_t { return m_totalNs; }
+  [[nodiscard]] auto getMaxNs() const noexcept -> uint64_t { return m_maxNs; }
+
+  [[nodiscard]] auto getBucket(unsigned int idx) const noexcept -> uint64_t {
+    return m_buckets[idx];
+  }
+
+  // Exclusive upper bound of the pause times counted by the bucket.
+  [[nodiscard]] static auto getBucketLimitUs(unsigned int idx) noexcept -> uint64_t {
+    return uint64_t{1U} << idx;
+  }
+
+private:
+  std::array<uint64_t, bucketCount> m_buckets;
+  uint64_t m_count;
+  uint64_t m_totalNs;
+  uint64_t m_maxNs;
+};
+
+auto operator<<(std::ostream& out, const PauseHistogram& rhs) noexcept -> std::ostream&;
+
+} // namespace vm
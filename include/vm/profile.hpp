@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vm {
+
+// Call-stacks of a program sampled by the profiler of the vm.
+// A stack is a list of instruction offsets in the assembly: the instruction that was executing
+// followed by the call instructions of the stack-frames that called it (innermost first). Samples
+// are attributed to functions, a function is the code from an entry (the entrypoint or the target
+// of a call) up to the next entry.
+class Profile final {
+public:
+  using Stack          = std::vector<uint32_t>;
+  using FunctionLabels = std::unordered_map<uint32_t, std::vector<std::string>>;
+
+  // Outermost entry of stacks that were deeper than the profiler records.
+  static constexpr auto truncatedFrame = std::numeric_limits<uint32_t>::max();
+
+  Profile() noexcept;
+
+  auto addSample(const Stack& stack) noexcept -> void;
+  auto addFunction(uint32_t entryIpOffset) noexcept -> void;
+
+  [[nodiscard]] auto getSampleCount() const noexcept -> uint64_t { return m_sampleCount; }
+  [[nodiscard]] auto getSamples() const noexcept -> const std::map<Stack, uint64_t>& {
+    return m_samples;
+  }
+
+  // Offset of the entry of the function that contains the given instruction.
+  [[nodiscard]] auto getFunction(uint32_t ipOffset) const noexcept -> uint32_t;
+
+  // Write the samples in the 'collapsed stacks' format (as used by flamegraph tools): a line per
+  // unique stack of functions, from the root to the leaf separated by ';', followed by the amount
+  // of samples. Functions are named by their first label, or 'func@<offset>' when they have none.
+  auto writeCollapsed(std::ostream& out, const FunctionLabels& labels = {}) const noexcept
+      -> void;
+
+private:
+  std::map<Stack, uint64_t> m_samples;
+  std::vector<uint32_t> m_functions; // Sorted entry offsets.
+  uint64_t m_sampleCount;
+};
+
+} // namespace vm
@@ -0,0 +1,74 @@
+#pragma once
+#include "vm/heap_profile.hpp"
+#include "vm/memory_stats.hpp"
+#include "vm/pause_histogram.hpp"
+#include "vm/profile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace vm {
+
+// Configuration for running a program in the vm.
+struct Settings final {
+  // Compile runs of simple instructions to native code before executing the program.
+  // Note: Ignored on platforms that the jit compiler does not support.
+  bool jitEnabled = false;
+
+  // Maximum size (in bytes) of the stack of an executor, executors that need more fail with a
+  // 'StackOverflow'. Stacks start small and grow on demand so this does not affect memory usage
+  // of executors that use less.
+  size_t stackLimit = 8U * 1024U * 1024U;
+
+  // Garbage collection is triggered once the program has allocated 'gcHeapGrowth' percent of the
+  // live heap (measured by the previous collection) since the previous collection, but not before
+  // it has allocated 'gcMinHeap' bytes. Higher values trade memory for less time collecting.
+  uint32_t gcHeapGrowth = 100U;
+  size_t gcMinHeap      = 4U * 1024U * 1024U;
+
+  // Soft limit on the size of the heap (in bytes), zero for no limit. Close to the limit the heap
+  // is collected more often, allocations do not fail because of it.
+  size_t gcHeapLimit = 0U;
+
+  // Collect the garbage of a program that has allocated since the last collection but did not
+  // trigger a new one in this many milliseconds (for example because it is waiting on io), zero to
+  // disable.
+  uint32_t gcIdleIntervalMs = 10'000U;
+
+  // Threads that mark and sweep in parallel (at most 8), zero for one per core.
+  uint32_t gcWorkers = 0U;
+
+  // Threads that the pool for forked calls aims to keep running, zero for one per core.
+  // Note: The pool is shared by all programs in the process, the last setting applies to all.
+  uint32_t threadPoolSize = 0U;
+
+  // Empty heap pages (64 KiB) to keep for reuse before returning them to the system.
+  uint32_t heapCachePages = 16U;
+
+  // Optional output, when set the pause times of the garbage collector are written to it when the
+  // execution is complete.
+  PauseHistogram* gcPauses = nullptr;
+
+  // Optional output, when set the statistics of the garbage collector and the memory allocator
+  // are written to it when the execution is complete.
+  MemoryStats* memStats = nullptr;
+
+  // Optional output, when set the program is profiled: every 'profileIntervalUs' microseconds the
+  // call-stacks of the running executors are sampled, the samples are written to it when the
+  // execution is complete.
+  Profile* profile           = nullptr;
+  uint32_t profileIntervalUs = 1000U;
+
+  // Optional output, when set the allocations of the program are sampled (on average one per
+  // 'heapProfileRate' allocated bytes) together with the instructions that made them, the heap
+  // profile is written to it when the execution is complete.
+  HeapProfile* heapProfile = nullptr;
+  uint32_t heapProfileRate = 512U * 1024U;
+
+  // Optional, called with a snapshot of the heap profile when the process receives a 'SIGUSR1'
+  // signal while the program is running. Only used when 'heapProfile' is set.
+  // Note: Called from a background thread, not supported on windows.
+  std::function<void(const HeapProfile&)> heapProfileSnapshot;
+};
+
+} // namespace vm
@@ -2,10 +2,14 @@
 #include "novasm/assembly.hpp"
 #include "vm/exec_state.hpp"
 #include "vm/platform_interface.hpp"
+#include "vm/settings.hpp"
 
 namespace vm {
 
 // Execute the given program. Will block until the execution is complete.
-auto run(const novasm::Assembly* assembly, PlatformInterface* iface) noexcept -> ExecState;
+auto run(
+    const novasm::Assembly* assembly,
+    PlatformInterface* iface,
+    const Settings& settings = Settings{}) noexcept -> ExecState;
 
 } // namespace vm
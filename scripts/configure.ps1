@@ -21,6 +21,8 @@
   Include compiler and runtime tests.
 .PARAMETER Lint
   Enable source linter.
+.PARAMETER Bench
+  Include runtime benchmarks.
 #>
 [cmdletbinding()]
 param(
@@ -30,7 +32,8 @@ param(
   [string]$Gen = "MinGW",
   [string]$Dir = "build",
   [switch]$Tests,
-  [switch]$Lint
+  [switch]$Lint,
+  [switch]$Bench
 )
 
 Set-StrictMode -Version Latest
@@ -57,7 +60,7 @@ function MapToCMakeGen([string] $gen) {
   }
 }
 
-function ConfigureProj([string] $type, [string] $gen, [string] $dir, [bool] $tests, [bool] $lint) {
+function ConfigureProj([string] $type, [string] $gen, [string] $dir, [bool] $tests, [bool] $lint, [bool] $bench) {
   if ([string]::IsNullOrEmpty($dir)) {
     Fail "No target directory provided"
   }
@@ -78,7 +81,8 @@ function ConfigureProj([string] $type, [string] $gen, [string] $dir, [bool] $tes
     -G "$(MapToCMakeGen $gen)" `
     -DCMAKE_BUILD_TYPE="$type" `
     -DBUILD_TESTING="$($tests ? "On" : "Off")" `
-    -DLINTING="$($lint ? "On" : "Off")"
+    -DLINTING="$($lint ? "On" : "Off")" `
+    -DBENCHMARKS="$($bench ? "On" : "Off")"
 
   if ($LASTEXITCODE -ne 0) {
     Fail "Configure failed"
@@ -88,5 +92,5 @@ function ConfigureProj([string] $type, [string] $gen, [string] $dir, [bool] $tes
 }
 
 # Run configuration.
-ConfigureProj $Type $Gen $Dir $Tests $Lint
+ConfigureProj $Type $Gen $Dir $Tests $Lint $Bench
 exit 0
@@ -54,10 +54,12 @@ configureProj()
   local dir="${2}"
   local testsMode="${3}"
   local lintMode="${4}"
+  local benchMode="${5}"
 
   verifyBuildTypeOption "${type}"
   verifyBoolOption "${testsMode}"
   verifyBoolOption "${lintMode}"
+  verifyBoolOption "${benchMode}"
 
   # Create target directory if it doesn't exist yet.
   test -d "${dir}" || mkdir -p "${dir}"
@@ -71,7 +73,8 @@ configureProj()
     -G "Unix Makefiles" \
     -DCMAKE_BUILD_TYPE="${type}" \
     -DBUILD_TESTING="${testsMode}" \
-    -DLINTING="${lintMode}"
+    -DLINTING="${lintMode}" \
+    -DBENCHMARKS="${benchMode}"
 
   info "Succesfully configured build directory '${dir}'"
 }
@@ -84,6 +87,7 @@ printUsage()
   echo "-d,--dir      Build directory, default: 'build'"
   echo "--tests       Include compiler and runtime tests"
   echo "--lint        Enable source linter"
+  echo "--bench       Include runtime benchmarks"
 }
 
 # Defaults.
@@ -91,6 +95,7 @@ buildType="Release"
 buildDir="build"
 testsMode="Off"
 lintMode="Off"
+benchMode="Off"
 
 # Parse options.
 while [[ $# -gt 0 ]]
@@ -117,6 +122,10 @@ do
       lintMode="On"
       shift 1
       ;;
+    --bench)
+      benchMode="On"
+      shift 1
+      ;;
     *)
       error "Unknown option '${1}'"
       printUsage
@@ -126,5 +135,5 @@ do
 done
 
 # Run configuration.
-configureProj "${buildType}" "${buildDir}" "${testsMode}" "${lintMode}"
+configureProj "${buildType}" "${buildDir}" "${testsMode}" "${lintMode}" "${benchMode}"
 exit 0
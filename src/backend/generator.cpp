@@ -1,4 +1,5 @@
 #include "backend/generator.hpp"
+#include "internal/gen_array.hpp"
 #include "internal/gen_expr.hpp"
 #include "internal/gen_type_eq.hpp"
 #include "internal/utilities.hpp"
@@ -29,6 +30,8 @@ generateFunc(novasm::Assembler* asmb, const prog::Program& program, const prog::
 
   const auto label = internal::getLabel(program, func.getId());
   asmb->label(label);
+  asmb->beginFunction(internal::getDisplayName(program, func.getId()));
+  asmb->setSourceSpan(internal::getSourceSpan(func.getExpr()));
 
   reserveConsts(asmb, func.getConsts());
 
@@ -42,6 +45,8 @@ generateFunc(novasm::Assembler* asmb, const prog::Program& program, const prog::
   // Note: Due to tail calls this return might never be executed.
   asmb->addRet();
 
+  asmb->setSourceSpan(std::nullopt);
+  asmb->endFunction();
   return label;
 }
 
@@ -51,6 +56,8 @@ static auto generateExecStmt(
 
   const auto label = asmb->generateLabel("exec-stmt");
   asmb->label(label);
+  asmb->beginFunction(label);
+  asmb->setSourceSpan(internal::getSourceSpan(exec.getExpr()));
 
   reserveConsts(asmb, exec.getConsts());
 
@@ -63,15 +70,25 @@ static auto generateExecStmt(
 
   asmb->addRet();
 
+  asmb->setSourceSpan(std::nullopt);
+  asmb->endFunction();
   return label;
 }
 
 auto generate(const prog::Program& program) -> std::pair<novasm::Assembly, InstructionLabels> {
   auto asmb = novasm::Assembler{};
 
+  // Register the source files in the same order so the file indices of source spans stay valid.
+  for (const auto& file : program.getSourceFiles()) {
+    asmb.addSourceFile(file);
+  }
+
   // Generate equality functions for user types (structs and unions).
   internal::genUserTypeEquality(&asmb, program);
 
+  // Generate helper functions for arrays.
+  internal::genArrayHelpers(&asmb, program);
+
   // Generate function definitons.
   for (auto funcItr = program.beginFuncDefs(); funcItr != program.endFuncDefs(); ++funcItr) {
     const auto& funcDef = program.getFuncDef(*funcItr);
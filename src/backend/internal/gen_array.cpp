@@ -0,0 +1,63 @@
+#include "gen_array.hpp"
+#include <algorithm>
+
+namespace backend::internal {
+
+auto getArrayGenerateLabel() -> std::string { return "array_generate"; }
+
+static auto genArrayGenerate(novasm::Assembler* asmb) -> void {
+  /* Takes the amount of values (const 0) and the generator function (const 1), creates an array
+  (const 2) and then calls the generator for each index (const 3) and stores the result. Storing
+  into the array is only valid because the array is not reachable by the program until we return
+  it. */
+
+  const auto loopLabel = asmb->generateLabel("array-generate-loop");
+  const auto bodyLabel = asmb->generateLabel("array-generate-body");
+
+  asmb->label(getArrayGenerateLabel());
+  asmb->addStackAlloc(2);
+
+  asmb->addStackLoad(0);
+  asmb->addAllocArray();
+  asmb->addStackStore(2);
+
+  asmb->addLoadLitInt(0);
+  asmb->addStackStore(3);
+
+  // Loop until the index reaches the length of the array.
+  asmb->label(loopLabel);
+  asmb->addStackLoad(3);
+  asmb->addStackLoad(2);
+  asmb->addLengthArray();
+  asmb->addCheckLeInt();
+  asmb->addJumpIf(bodyLabel);
+
+  asmb->addStackLoad(2);
+  asmb->addRet();
+
+  // Call the generator with the index and store the result in the array.
+  asmb->label(bodyLabel);
+  asmb->addStackLoad(2);
+  asmb->addStackLoad(3);
+  asmb->addStackLoad(3);
+  asmb->addStackLoad(1);
+  asmb->addCallDyn(1, novasm::CallMode::Normal);
+  asmb->addArrayStore();
+
+  asmb->addStackLoad(3);
+  asmb->addLoadLitInt(1);
+  asmb->addAddInt();
+  asmb->addStackStore(3);
+  asmb->addJump(loopLabel);
+}
+
+auto genArrayHelpers(novasm::Assembler* asmb, const prog::Program& prog) -> void {
+  const auto hasArrays = std::any_of(prog.beginTypeDecls(), prog.endTypeDecls(), [](const auto& t) {
+    return t.second.getKind() == prog::sym::TypeKind::Array;
+  });
+  if (hasArrays) {
+    genArrayGenerate(asmb);
+  }
+}
+
+} // namespace backend::internal
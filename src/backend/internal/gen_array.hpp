@@ -0,0 +1,13 @@
+#pragma once
+#include "novasm/assembler.hpp"
+#include "prog/program.hpp"
+
+namespace backend::internal {
+
+// Get a label to identify the (generated) function that creates arrays from a generator function.
+auto getArrayGenerateLabel() -> std::string;
+
+// Generate the array helper functions, only generated when the program contains array types.
+auto genArrayHelpers(novasm::Assembler* asmb, const prog::Program& prog) -> void;
+
+} // namespace backend::internal
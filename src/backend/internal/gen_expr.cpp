@@ -1,4 +1,5 @@
 #include "gen_expr.hpp"
+#include "gen_array.hpp"
 #include "gen_lazy.hpp"
 #include "prog/expr/nodes.hpp"
 #include "utilities.hpp"
@@ -96,6 +97,11 @@ auto GenExpr::visit(const prog::expr::CallExprNode& n) -> void {
     return;
   }
 
+  // Special handling for build-in operations on two constants.
+  if (genStackSlotOp(n, funcDecl.getKind())) {
+    return;
+  }
+
   // Push the arguments on the stack.
   for (auto i = 0U; i < n.getChildCount(); ++i) {
     genSubExpr(n[i], false);
@@ -335,6 +341,21 @@ auto GenExpr::visit(const prog::expr::CallExprNode& n) -> void {
   case prog::sym::FuncKind::SliceString:
     m_asmb->addSliceString();
     break;
+  case prog::sym::FuncKind::IndexOfString:
+    m_asmb->addIndexOfString();
+    break;
+  case prog::sym::FuncKind::IndexOfLastString:
+    m_asmb->addIndexOfLastString();
+    break;
+  case prog::sym::FuncKind::IndexOfAnyString:
+    m_asmb->addIndexOfAnyString();
+    break;
+  case prog::sym::FuncKind::SpanString:
+    m_asmb->addSpanString();
+    break;
+  case prog::sym::FuncKind::StartsWithString:
+    m_asmb->addStartsWithString();
+    break;
   case prog::sym::FuncKind::CheckEqString:
     m_asmb->addCheckEqString();
     break;
@@ -454,6 +475,30 @@ auto GenExpr::visit(const prog::expr::CallExprNode& n) -> void {
     break;
   }
 
+  case prog::sym::FuncKind::MakeArray:
+    m_asmb->addLoadLitInt(static_cast<int32_t>(n.getChildCount()));
+    m_asmb->addMakeArray();
+    break;
+  case prog::sym::FuncKind::MakeArrayFromList:
+    m_asmb->addMakeArrayList();
+    break;
+  case prog::sym::FuncKind::MakeArrayGenerate:
+    m_asmb->addCall(
+        getArrayGenerateLabel(), 2, m_tail ? novasm::CallMode::Tail : novasm::CallMode::Normal);
+    break;
+  case prog::sym::FuncKind::LengthArray:
+    m_asmb->addLengthArray();
+    break;
+  case prog::sym::FuncKind::IndexArray:
+    m_asmb->addIndexArray();
+    break;
+  case prog::sym::FuncKind::SliceArray:
+    m_asmb->addSliceArray();
+    break;
+  case prog::sym::FuncKind::AddArray:
+    m_asmb->addAddArray();
+    break;
+
   case prog::sym::FuncKind::CheckEqUserType:
   case prog::sym::FuncKind::CheckNEqUserType: {
     auto lhsType = n[0].getType();
@@ -497,6 +542,12 @@ auto GenExpr::visit(const prog::expr::CallExprNode& n) -> void {
   case prog::sym::FuncKind::ActionStreamUnsetOptions:
     m_asmb->addPCall(novasm::PCallCode::StreamUnsetOptions);
     break;
+  case prog::sym::FuncKind::ActionStreamReadLine:
+    m_asmb->addPCall(novasm::PCallCode::StreamReadLine);
+    break;
+  case prog::sym::FuncKind::ActionStreamReadUntil:
+    m_asmb->addPCall(novasm::PCallCode::StreamReadUntil);
+    break;
 
   case prog::sym::FuncKind::ActionFileOpenStream:
     m_asmb->addPCall(novasm::PCallCode::FileOpenStream);
@@ -552,6 +603,10 @@ auto GenExpr::visit(const prog::expr::CallExprNode& n) -> void {
     m_asmb->addPCall(novasm::PCallCode::ClockNanoSteady);
     break;
 
+  case prog::sym::FuncKind::ActionRuntimeMemStat:
+    m_asmb->addPCall(novasm::PCallCode::RuntimeMemStat);
+    break;
+
   case prog::sym::FuncKind::ActionSleepNano:
     m_asmb->addPCall(novasm::PCallCode::SleepNano);
     break;
@@ -889,11 +944,100 @@ auto GenExpr::makeUnion(const prog::expr::CallExprNode& n) -> void {
   m_asmb->addMakeStruct(2);
 }
 
+auto GenExpr::genStackSlotOp(const prog::expr::CallExprNode& n, prog::sym::FuncKind kind)
+    -> bool {
+  /* Operations where both operands are constants can read them directly from the stack-frame, saves
+  pushing (and then popping) both operands. */
+
+  if (n.getChildCount() != 2 || n[0].getKind() != prog::expr::NodeKind::Const ||
+      n[1].getKind() != prog::expr::NodeKind::Const) {
+    return false;
+  }
+  const auto* lhsConst = n[0].downcast<prog::expr::ConstExprNode>();
+  const auto* rhsConst = n[1].downcast<prog::expr::ConstExprNode>();
+  const auto lhs       = getConstOffset(m_constTable, lhsConst->getId());
+  const auto rhs       = getConstOffset(m_constTable, rhsConst->getId());
+
+  switch (kind) {
+  case prog::sym::FuncKind::AddInt:
+    m_asmb->addStackAddInt(lhs, rhs);
+    return true;
+  case prog::sym::FuncKind::SubInt:
+    m_asmb->addStackSubInt(lhs, rhs);
+    return true;
+  case prog::sym::FuncKind::MulInt:
+    m_asmb->addStackMulInt(lhs, rhs);
+    return true;
+  case prog::sym::FuncKind::CheckEqInt:
+  case prog::sym::FuncKind::CheckEqBool:
+    m_asmb->addStackCheckEqInt(lhs, rhs);
+    return true;
+  case prog::sym::FuncKind::CheckNEqInt:
+  case prog::sym::FuncKind::CheckNEqBool:
+    m_asmb->addStackCheckEqInt(lhs, rhs);
+    m_asmb->addLogicInvInt();
+    return true;
+  case prog::sym::FuncKind::CheckLeInt:
+    m_asmb->addStackCheckLeInt(lhs, rhs);
+    return true;
+  case prog::sym::FuncKind::CheckLeEqInt:
+    m_asmb->addStackCheckGtInt(lhs, rhs);
+    m_asmb->addLogicInvInt();
+    return true;
+  case prog::sym::FuncKind::CheckGtInt:
+    m_asmb->addStackCheckGtInt(lhs, rhs);
+    return true;
+  case prog::sym::FuncKind::CheckGtEqInt:
+    m_asmb->addStackCheckLeInt(lhs, rhs);
+    m_asmb->addLogicInvInt();
+    return true;
+
+  case prog::sym::FuncKind::AddFloat:
+    m_asmb->addStackAddFloat(lhs, rhs);
+    return true;
+  case prog::sym::FuncKind::SubFloat:
+    m_asmb->addStackSubFloat(lhs, rhs);
+    return true;
+  case prog::sym::FuncKind::MulFloat:
+    m_asmb->addStackMulFloat(lhs, rhs);
+    return true;
+  case prog::sym::FuncKind::DivFloat:
+    m_asmb->addStackDivFloat(lhs, rhs);
+    return true;
+  case prog::sym::FuncKind::CheckLeFloat:
+    m_asmb->addStackCheckLeFloat(lhs, rhs);
+    return true;
+  case prog::sym::FuncKind::CheckLeEqFloat:
+    m_asmb->addStackCheckGtFloat(lhs, rhs);
+    m_asmb->addLogicInvInt();
+    return true;
+  case prog::sym::FuncKind::CheckGtFloat:
+    m_asmb->addStackCheckGtFloat(lhs, rhs);
+    return true;
+  case prog::sym::FuncKind::CheckGtEqFloat:
+    m_asmb->addStackCheckLeFloat(lhs, rhs);
+    m_asmb->addLogicInvInt();
+    return true;
+
+  default:
+    return false;
+  }
+}
+
 auto GenExpr::genSubExpr(const prog::expr::Node& n, bool tail, unsigned int requestedValues)
     -> unsigned int {
 
+  // Attribute the instructions to the source of the expression, expressions without a source (for
+  // example ones created by the optimizer) are attributed to the source of their parent.
+  const auto parentSpan = m_asmb->getSourceSpan();
+  if (auto span = getSourceSpan(n)) {
+    m_asmb->setSourceSpan(span);
+  }
+
   auto genExpr = GenExpr{m_prog, m_asmb, m_constTable, m_curFunc, tail, requestedValues};
   n.accept(&genExpr);
+
+  m_asmb->setSourceSpan(parentSpan);
   return genExpr.m_valuesProduced;
 }
 
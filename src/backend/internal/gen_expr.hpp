@@ -59,6 +59,8 @@ private:
 
   auto makeUnion(const prog::expr::CallExprNode& n) -> void;
 
+  auto genStackSlotOp(const prog::expr::CallExprNode& n, prog::sym::FuncKind kind) -> bool;
+
   auto genSubExpr(const prog::expr::Node& n, bool tail, unsigned int requestedValues = 1)
       -> unsigned int;
 };
@@ -74,6 +74,7 @@ static auto genTypeEqualityEntry(
 
   case prog::sym::TypeKind::Struct:
   case prog::sym::TypeKind::Union:
+  case prog::sym::TypeKind::Array:
     asmb->addCall(getUserTypeEqLabel(prog, typeDecl.getId()), 2, novasm::CallMode::Normal);
     break;
   }
@@ -264,6 +265,70 @@ static auto genUnionEquality(
   asmb->addRet();
 }
 
+static auto genArrayEquality(
+    novasm::Assembler* asmb, const prog::Program& prog, const prog::sym::ArrayDef& arrayDef) {
+  asmb->label(getUserTypeEqLabel(prog, arrayDef.getId()));
+
+  /* Arrays are equal if they have the same length and all their values are equal. The index is
+  stored as const 2. */
+
+  const auto sameLengthLabel = asmb->generateLabel("array-same-length");
+  const auto loopLabel       = asmb->generateLabel("array-loop");
+  const auto bodyLabel       = asmb->generateLabel("array-body");
+  const auto sameValueLabel  = asmb->generateLabel("array-same-value");
+
+  asmb->addStackAlloc(1);
+
+  // Check if the lengths match.
+  asmb->addStackLoad(0);
+  asmb->addLengthArray();
+  asmb->addStackLoad(1);
+  asmb->addLengthArray();
+  asmb->addCheckEqInt();
+  asmb->addJumpIf(sameLengthLabel);
+
+  // If lengths do not match return false.
+  asmb->addLoadLitInt(0);
+  asmb->addRet();
+
+  asmb->label(sameLengthLabel);
+  asmb->addLoadLitInt(0);
+  asmb->addStackStore(2);
+
+  // Loop until the index reaches the length, if we get to the end all values are equal.
+  asmb->label(loopLabel);
+  asmb->addStackLoad(2);
+  asmb->addStackLoad(0);
+  asmb->addLengthArray();
+  asmb->addCheckLeInt();
+  asmb->addJumpIf(bodyLabel);
+
+  asmb->addLoadLitInt(1);
+  asmb->addRet();
+
+  // Check if the value at the index is equal.
+  asmb->label(bodyLabel);
+  asmb->addStackLoad(0);
+  asmb->addStackLoad(2);
+  asmb->addIndexArray();
+  asmb->addStackLoad(1);
+  asmb->addStackLoad(2);
+  asmb->addIndexArray();
+  genTypeEqualityEntry(asmb, prog, prog.getTypeDecl(arrayDef.getElement()));
+  asmb->addJumpIf(sameValueLabel);
+
+  // If values do not match return false.
+  asmb->addLoadLitInt(0);
+  asmb->addRet();
+
+  asmb->label(sameValueLabel);
+  asmb->addStackLoad(2);
+  asmb->addLoadLitInt(1);
+  asmb->addAddInt();
+  asmb->addStackStore(2);
+  asmb->addJump(loopLabel);
+}
+
 static auto addTypeAndNestedTypes(
     const prog::Program& prog, std::set<prog::sym::TypeId>* set, prog::sym::TypeId id) -> void {
 
@@ -279,6 +344,10 @@ static auto addTypeAndNestedTypes(
         addTypeAndNestedTypes(prog, set, t);
       }
     } break;
+    case prog::sym::TypeKind::Array: {
+      const auto& arrayDef = std::get<prog::sym::ArrayDef>(prog.getTypeDef(id));
+      addTypeAndNestedTypes(prog, set, arrayDef.getElement());
+    } break;
     default:
       break;
     }
@@ -308,6 +377,10 @@ auto genUserTypeEquality(novasm::Assembler* asmb, const prog::Program& prog) ->
       const auto& unionDef = std::get<prog::sym::UnionDef>(prog.getTypeDef(typeId));
       genUnionEquality(asmb, prog, unionDef);
     } break;
+    case prog::sym::TypeKind::Array: {
+      const auto& arrayDef = std::get<prog::sym::ArrayDef>(prog.getTypeDef(typeId));
+      genArrayEquality(asmb, prog, arrayDef);
+    } break;
     default:
       break;
     }
@@ -11,6 +11,28 @@ auto getLabel(const prog::Program& prog, prog::sym::FuncId funcId) -> std::strin
   return oss.str();
 }
 
+auto getDisplayName(const prog::Program& prog, prog::sym::FuncId funcId) -> std::string {
+  const auto& funcDecl = prog.getFuncDecl(funcId);
+  std::ostringstream oss;
+  oss << funcDecl.getName() << '(';
+  auto first = true;
+  for (const auto& type : funcDecl.getInput()) {
+    oss << (first ? "" : ", ") << prog.getTypeDecl(type).getName();
+    first = false;
+  }
+  oss << ')';
+  return oss.str();
+}
+
+auto getSourceSpan(const prog::expr::Node& n) -> std::optional<novasm::SourceSpan> {
+  const auto& span = n.getSourceSpan();
+  if (!span) {
+    return std::nullopt;
+  }
+  return novasm::SourceSpan{
+      span->file, span->startLine, span->startCol, span->endLine, span->endCol};
+}
+
 auto getUserTypeEqLabel(const prog::Program& prog, prog::sym::TypeId typeId) -> std::string {
   std::ostringstream oss;
   oss << "user_type_equality_" << prog.getTypeDecl(typeId).getName() << "_" << typeId;
@@ -1,4 +1,6 @@
 #pragma once
+#include "novasm/debug_info.hpp"
+#include "prog/expr/node.hpp"
 #include "prog/program.hpp"
 #include "prog/sym/const_id.hpp"
 #include "prog/sym/field_id.hpp"
@@ -11,6 +13,12 @@ namespace backend::internal {
 // Get a label to identify the function.
 auto getLabel(const prog::Program& prog, prog::sym::FuncId funcId) -> std::string;
 
+// Get a human readable name for the function (including its input types), for example 'fib(int)'.
+auto getDisplayName(const prog::Program& prog, prog::sym::FuncId funcId) -> std::string;
+
+// Get the span of source text that the expression was created from (if known).
+auto getSourceSpan(const prog::expr::Node& n) -> std::optional<novasm::SourceSpan>;
+
 // Get a label to identify the (generated) equality function for the user type.
 auto getUserTypeEqLabel(const prog::Program& prog, prog::sym::TypeId typeId) -> std::string;
 
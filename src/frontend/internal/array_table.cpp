@@ -0,0 +1,78 @@
+#include "array_table.hpp"
+#include "utilities.hpp"
+
+namespace frontend::internal {
+
+// Name of the list type template that arrays can be constructed from.
+const auto arrayListTemplateName = std::string{"List"};
+
+// Check if the type is a list of the given element type, meaning a union of an empty struct and a
+// struct of the element and the list itself. The vm walks these lists when creating an array.
+static auto isListOf(const prog::Program& prog, prog::sym::TypeId list, prog::sym::TypeId element)
+    -> bool {
+  if (!prog.hasTypeDef(list)) {
+    return false;
+  }
+  const auto* unionDef = std::get_if<prog::sym::UnionDef>(&prog.getTypeDef(list));
+  if (unionDef == nullptr || unionDef->getTypes().size() != 2U) {
+    return false;
+  }
+  auto hasNode = false;
+  auto hasEnd  = false;
+  for (const auto& type : unionDef->getTypes()) {
+    if (!prog.hasTypeDef(type)) {
+      return false;
+    }
+    const auto* structDef = std::get_if<prog::sym::StructDef>(&prog.getTypeDef(type));
+    if (structDef == nullptr) {
+      return false;
+    }
+    const auto& fields = structDef->getFields();
+    if (fields.getCount() == 0U) {
+      hasEnd = true;
+    } else if (fields.getCount() == 2U) {
+      auto fieldItr = fields.begin();
+      hasNode       = fieldItr->getType() == element && (++fieldItr)->getType() == list;
+    }
+  }
+  return hasNode && hasEnd;
+}
+
+auto ArrayTable::getArray(Context* ctx, prog::sym::TypeId element) -> prog::sym::TypeId {
+  // Try to find an existing array with the same element-type.
+  auto itr = m_arrays.find(element);
+  if (itr != m_arrays.end()) {
+    return itr->second;
+  }
+
+  // Declare a new array.
+  auto arrayName       = std::string{"__array_"} + getName(*ctx, element);
+  const auto arrayType = ctx->getProg()->declareArray(std::move(arrayName));
+  m_arrays.insert({element, arrayType});
+
+  // Arrays can be generated from a function that takes the index.
+  const auto generator = ctx->getDelegates()->getDelegate(
+      ctx, false, prog::sym::TypeSet{ctx->getProg()->getInt()}, element);
+
+  // Arrays can be constructed from lists, if the program contains a list type template.
+  auto list = std::optional<prog::sym::TypeId>{};
+  if (ctx->getTypeTemplates()->hasType(arrayListTemplateName)) {
+    const auto listInst = ctx->getTypeTemplates()->instantiate(
+        arrayListTemplateName, prog::sym::TypeSet{element});
+    if (listInst && (*listInst)->isSuccess() &&
+        isListOf(*ctx->getProg(), *(*listInst)->getType(), element)) {
+      list = (*listInst)->getType();
+    }
+  }
+
+  // Define the array.
+  ctx->getProg()->defineArray(arrayType, element, generator, list);
+
+  // Keep track of some extra information about the type.
+  ctx->declareTypeInfo(
+      arrayType, TypeInfo{ctx, "array", input::Span{0}, prog::sym::TypeSet{element}});
+
+  return arrayType;
+}
+
+} // namespace frontend::internal
@@ -0,0 +1,25 @@
+#pragma once
+#include "prog/program.hpp"
+#include <unordered_map>
+
+namespace frontend::internal {
+
+class Context;
+
+class ArrayTable final {
+public:
+  ArrayTable()                          = default;
+  ArrayTable(const ArrayTable& rhs)     = delete;
+  ArrayTable(ArrayTable&& rhs) noexcept = default;
+  ~ArrayTable()                         = default;
+
+  auto operator=(const ArrayTable& rhs) -> ArrayTable& = delete;
+  auto operator=(ArrayTable&& rhs) noexcept -> ArrayTable& = delete;
+
+  auto getArray(Context* ctx, prog::sym::TypeId element) -> prog::sym::TypeId;
+
+private:
+  std::unordered_map<prog::sym::TypeId, prog::sym::TypeId, prog::sym::TypeIdHasher> m_arrays;
+};
+
+} // namespace frontend::internal
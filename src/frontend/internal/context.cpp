@@ -11,6 +11,7 @@ Context::Context(
     DelegateTable* delegates,
     FutureTable* futures,
     LazyTable* lazies,
+    ArrayTable* arrays,
     TypeInfoMap* typeInfos,
     std::vector<Diag>* diags) :
     m_src{src},
@@ -20,6 +21,7 @@ Context::Context(
     m_delegates{delegates},
     m_futures{futures},
     m_lazies{lazies},
+    m_arrays{arrays},
     m_typeInfos{typeInfos},
     m_diags{diags} {
 
@@ -41,12 +43,18 @@ Context::Context(
   if (m_lazies == nullptr) {
     throw std::invalid_argument{"LazyTable cannot be null"};
   }
+  if (m_arrays == nullptr) {
+    throw std::invalid_argument{"ArrayTable cannot be null"};
+  }
   if (m_typeInfos == nullptr) {
     throw std::invalid_argument{"TypeInfoMap cannot be null"};
   }
   if (m_diags == nullptr) {
     throw std::invalid_argument{"Diagnostics vector cannot be null"};
   }
+
+  // Register the source so expressions created from it can refer back to it.
+  m_srcFile = m_prog->addSourceFile(src.getPath() ? src.getPath()->string() : src.getId());
 }
 
 auto Context::hasErrors() const noexcept -> bool { return !m_diags->empty(); }
@@ -65,6 +73,8 @@ auto Context::getFutures() const noexcept -> FutureTable* { return m_futures; }
 
 auto Context::getLazies() const noexcept -> LazyTable* { return m_lazies; }
 
+auto Context::getArrays() const noexcept -> ArrayTable* { return m_arrays; }
+
 auto Context::getTypeInfo(prog::sym::TypeId typeId) const noexcept -> std::optional<TypeInfo> {
   const auto itr = m_typeInfos->find(typeId);
   if (itr == m_typeInfos->end()) {
@@ -77,4 +87,14 @@ auto Context::declareTypeInfo(prog::sym::TypeId typeId, TypeInfo typeInfo) -> vo
   m_typeInfos->insert({typeId, std::move(typeInfo)});
 }
 
+auto Context::setSourceSpan(prog::expr::Node* expr, input::Span span) const noexcept -> void {
+  if (expr == nullptr || expr->getSourceSpan()) {
+    return;
+  }
+  const auto start = m_src.getTextPos(span.getStart());
+  const auto end   = m_src.getTextPos(span.getEnd());
+  expr->setSourceSpan(prog::expr::SourceSpan{
+      m_srcFile, start.getLine(), start.getCol(), end.getLine(), end.getCol()});
+}
+
 } // namespace frontend::internal
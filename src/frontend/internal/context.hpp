@@ -1,5 +1,6 @@
 #pragma once
 #include "frontend/diag.hpp"
+#include "internal/array_table.hpp"
 #include "internal/delegate_table.hpp"
 #include "internal/func_template_table.hpp"
 #include "internal/future_table.hpp"
@@ -26,6 +27,7 @@ public:
       DelegateTable* delegates,
       FutureTable* futures,
       LazyTable* lazies,
+      ArrayTable* arrays,
       TypeInfoMap* typeInfos,
       std::vector<Diag>* diags);
 
@@ -38,12 +40,16 @@ public:
   [[nodiscard]] auto getDelegates() const noexcept -> DelegateTable*;
   [[nodiscard]] auto getFutures() const noexcept -> FutureTable*;
   [[nodiscard]] auto getLazies() const noexcept -> LazyTable*;
+  [[nodiscard]] auto getArrays() const noexcept -> ArrayTable*;
 
   [[nodiscard]] auto getTypeInfo(prog::sym::TypeId typeId) const noexcept
       -> std::optional<TypeInfo>;
 
   auto declareTypeInfo(prog::sym::TypeId typeId, TypeInfo typeInfo) -> void;
 
+  // Attribute an expression to the given span of the source (unless it is attributed already).
+  auto setSourceSpan(prog::expr::Node* expr, input::Span span) const noexcept -> void;
+
   template <typename DiagConstructor, class... Args>
   auto reportDiag(DiagConstructor constructor, Args&&... args) -> void {
     m_diags->push_back(constructor(m_src, std::forward<Args>(args)...));
@@ -57,8 +63,10 @@ private:
   DelegateTable* m_delegates;
   FutureTable* m_futures;
   LazyTable* m_lazies;
+  ArrayTable* m_arrays;
   TypeInfoMap* m_typeInfos;
   std::vector<Diag>* m_diags;
+  uint32_t m_srcFile;
 };
 
 } // namespace frontend::internal
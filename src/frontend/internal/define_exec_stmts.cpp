@@ -29,6 +29,7 @@ auto DefineExecStmts::visit(const parse::ExecStmtNode& n) -> void {
     assert(m_ctx->hasErrors());
     return;
   }
+  m_ctx->setSourceSpan(getExpr.getValue().get(), n[0].getSpan());
 
   m_ctx->getProg()->addExecStmt(std::move(consts), std::move(getExpr.getValue()));
 }
@@ -38,6 +38,7 @@ auto defineFunc(
   auto getExpr = GetExpr{ctx, typeSubTable, &constBinder, funcRetType, funcSignature, getExprFlags};
   n[0].accept(&getExpr);
   auto expr = std::move(getExpr.getValue());
+  ctx->setSourceSpan(expr.get(), n[0].getSpan());
 
   // Report this diagnostic after processing the body so other errors have priority over this.
   if (funcRetType.isInfer()) {
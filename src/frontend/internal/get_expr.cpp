@@ -108,6 +108,7 @@ auto GetExpr::visit(const parse::AnonFuncExprNode& n) -> void {
     assert(m_ctx->hasErrors());
     return;
   }
+  m_ctx->setSourceSpan(getExpr.m_expr.get(), n[0].getSpan());
   auto expr = std::move(getExpr.m_expr);
 
   // Fail if return type inference failed.
@@ -764,6 +765,7 @@ auto GetExpr::getSubExpr(const parse::Node& n, prog::sym::TypeId typeHint, bool
 
   auto visitor = GetExpr{m_ctx, m_typeSubTable, m_constBinder, typeHint, m_selfSig, subExprFlags};
   n.accept(&visitor);
+  m_ctx->setSourceSpan(visitor.getValue().get(), n.getSpan());
   return std::move(visitor.getValue());
 }
 
@@ -786,6 +788,7 @@ auto GetExpr::getSubExpr(
 
   auto visitor = GetExpr{m_ctx, m_typeSubTable, m_constBinder, typeHint, m_selfSig, subExprFlags};
   n.accept(&visitor);
+  m_ctx->setSourceSpan(visitor.getValue().get(), n.getSpan());
 
   m_constBinder->setVisibleConsts(orgVisibleConsts);
   return std::move(visitor.getValue());
@@ -182,6 +182,7 @@ auto isReservedTypeName(const std::string& name) -> bool {
       "action",
       "future",
       "lazy",
+      "array",
   };
   return reservedTypes.find(name) != reservedTypes.end();
 }
@@ -292,6 +293,9 @@ auto instType(
   if (typeName == "lazy" && typeSet->getCount() == 1) {
     return ctx->getLazies()->getLazy(ctx, *typeSet->begin());
   }
+  if (typeName == "array" && typeSet->getCount() == 1) {
+    return ctx->getArrays()->getArray(ctx, *typeSet->begin());
+  }
 
   const auto typeInstantiation = ctx->getTypeTemplates()->instantiate(typeName, *typeSet);
   if (!typeInstantiation) {
@@ -6,7 +6,8 @@
 
 namespace novasm {
 
-Assembler::Assembler() : m_closed{false}, m_genLabelCounter{0U} {}
+Assembler::Assembler() :
+    m_closed{false}, m_genLabelCounter{0U}, m_prevOpOffset{0U}, m_prevOpFusable{false} {}
 
 auto Assembler::generateLabel(const std::string& prefix) -> std::string {
   std::ostringstream oss;
@@ -19,6 +20,8 @@ auto Assembler::label(std::string label) -> void {
   if (!m_labels.insert({std::move(label), getCurrentIpOffset()}).second) {
     throw std::invalid_argument{"Assembler already contains a label with the same name"};
   }
+  // Execution can jump to here, so we cannot fuse the next instruction with the previous.
+  m_prevOpFusable = false;
 }
 
 auto Assembler::addLoadLitInt(int32_t val) -> void {
@@ -62,7 +65,32 @@ auto Assembler::addStackAlloc(uint8_t amount) -> void {
 }
 
 auto Assembler::addStackStore(uint8_t offset) -> void {
-  writeOpCode(OpCode::StackStore);
+  // Three-address stack operations followed by a store, store the result directly.
+  switch (getPrevOp().value_or(OpCode::Fail)) {
+  case OpCode::StackAddInt:
+    fusePrevOp(OpCode::StackAddIntStore);
+    break;
+  case OpCode::StackSubInt:
+    fusePrevOp(OpCode::StackSubIntStore);
+    break;
+  case OpCode::StackMulInt:
+    fusePrevOp(OpCode::StackMulIntStore);
+    break;
+  case OpCode::StackAddFloat:
+    fusePrevOp(OpCode::StackAddFloatStore);
+    break;
+  case OpCode::StackSubFloat:
+    fusePrevOp(OpCode::StackSubFloatStore);
+    break;
+  case OpCode::StackMulFloat:
+    fusePrevOp(OpCode::StackMulFloatStore);
+    break;
+  case OpCode::StackDivFloat:
+    fusePrevOp(OpCode::StackDivFloatStore);
+    break;
+  default:
+    writeOpCode(OpCode::StackStore);
+  }
   writeUInt8(offset);
 }
 
@@ -71,7 +99,69 @@ auto Assembler::addStackLoad(uint8_t offset) -> void {
   writeUInt8(offset);
 }
 
-auto Assembler::addAddInt() -> void { writeOpCode(OpCode::AddInt); }
+auto Assembler::addStackAddInt(uint8_t lhsOffset, uint8_t rhsOffset) -> void {
+  addStackBinaryOp(OpCode::StackAddInt, lhsOffset, rhsOffset);
+}
+
+auto Assembler::addStackSubInt(uint8_t lhsOffset, uint8_t rhsOffset) -> void {
+  addStackBinaryOp(OpCode::StackSubInt, lhsOffset, rhsOffset);
+}
+
+auto Assembler::addStackMulInt(uint8_t lhsOffset, uint8_t rhsOffset) -> void {
+  addStackBinaryOp(OpCode::StackMulInt, lhsOffset, rhsOffset);
+}
+
+auto Assembler::addStackAddFloat(uint8_t lhsOffset, uint8_t rhsOffset) -> void {
+  addStackBinaryOp(OpCode::StackAddFloat, lhsOffset, rhsOffset);
+}
+
+auto Assembler::addStackSubFloat(uint8_t lhsOffset, uint8_t rhsOffset) -> void {
+  addStackBinaryOp(OpCode::StackSubFloat, lhsOffset, rhsOffset);
+}
+
+auto Assembler::addStackMulFloat(uint8_t lhsOffset, uint8_t rhsOffset) -> void {
+  addStackBinaryOp(OpCode::StackMulFloat, lhsOffset, rhsOffset);
+}
+
+auto Assembler::addStackDivFloat(uint8_t lhsOffset, uint8_t rhsOffset) -> void {
+  addStackBinaryOp(OpCode::StackDivFloat, lhsOffset, rhsOffset);
+}
+
+auto Assembler::addStackCheckEqInt(uint8_t lhsOffset, uint8_t rhsOffset) -> void {
+  addStackBinaryOp(OpCode::StackCheckEqInt, lhsOffset, rhsOffset);
+}
+
+auto Assembler::addStackCheckGtInt(uint8_t lhsOffset, uint8_t rhsOffset) -> void {
+  addStackBinaryOp(OpCode::StackCheckGtInt, lhsOffset, rhsOffset);
+}
+
+auto Assembler::addStackCheckLeInt(uint8_t lhsOffset, uint8_t rhsOffset) -> void {
+  addStackBinaryOp(OpCode::StackCheckLeInt, lhsOffset, rhsOffset);
+}
+
+auto Assembler::addStackCheckGtFloat(uint8_t lhsOffset, uint8_t rhsOffset) -> void {
+  addStackBinaryOp(OpCode::StackCheckGtFloat, lhsOffset, rhsOffset);
+}
+
+auto Assembler::addStackCheckLeFloat(uint8_t lhsOffset, uint8_t rhsOffset) -> void {
+  addStackBinaryOp(OpCode::StackCheckLeFloat, lhsOffset, rhsOffset);
+}
+
+auto Assembler::addAddInt() -> void {
+  switch (getPrevOp().value_or(OpCode::Fail)) {
+  case OpCode::LoadLitInt:
+  case OpCode::LoadLitIntSmall:
+  case OpCode::LoadLitInt0:
+  case OpCode::LoadLitInt1: {
+    // 'LoadLitInt' + 'AddInt' -> 'AddIntLit'.
+    const auto lit = getPrevOpLitInt();
+    replacePrevOp(OpCode::AddIntLit);
+    writeInt32(lit);
+  } break;
+  default:
+    writeOpCode(OpCode::AddInt);
+  }
+}
 
 auto Assembler::addAddLong() -> void { writeOpCode(OpCode::AddLong); }
 
@@ -83,7 +173,22 @@ auto Assembler::addCombineChar() -> void { writeOpCode(OpCode::CombineChar); }
 
 auto Assembler::addAppendChar() -> void { writeOpCode(OpCode::AppendChar); }
 
-auto Assembler::addSubInt() -> void { writeOpCode(OpCode::SubInt); }
+auto Assembler::addSubInt() -> void {
+  switch (getPrevOp().value_or(OpCode::Fail)) {
+  case OpCode::LoadLitInt:
+  case OpCode::LoadLitIntSmall:
+  case OpCode::LoadLitInt0:
+  case OpCode::LoadLitInt1: {
+    // 'LoadLitInt' + 'SubInt' -> 'AddIntLit' with the negated literal.
+    // Note: Negated as unsigned to get the same wrap-around behaviour as the 'SubInt' instruction.
+    const auto lit = static_cast<uint32_t>(getPrevOpLitInt());
+    replacePrevOp(OpCode::AddIntLit);
+    writeUInt32(0U - lit);
+  } break;
+  default:
+    writeOpCode(OpCode::SubInt);
+  }
+}
 
 auto Assembler::addSubLong() -> void { writeOpCode(OpCode::SubLong); }
 
@@ -151,6 +256,24 @@ auto Assembler::addIndexString() -> void { writeOpCode(OpCode::IndexString); }
 
 auto Assembler::addSliceString() -> void { writeOpCode(OpCode::SliceString); }
 
+auto Assembler::addIndexOfString() -> void { writeOpCode(OpCode::IndexOfString); }
+
+auto Assembler::addIndexOfLastString() -> void { writeOpCode(OpCode::IndexOfLastString); }
+
+auto Assembler::addIndexOfAnyString() -> void { writeOpCode(OpCode::IndexOfAnyString); }
+
+auto Assembler::addSpanString() -> void { writeOpCode(OpCode::SpanString); }
+
+auto Assembler::addStartsWithString() -> void { writeOpCode(OpCode::StartsWithString); }
+
+auto Assembler::addLengthArray() -> void { writeOpCode(OpCode::LengthArray); }
+
+auto Assembler::addIndexArray() -> void { writeOpCode(OpCode::IndexArray); }
+
+auto Assembler::addSliceArray() -> void { writeOpCode(OpCode::SliceArray); }
+
+auto Assembler::addAddArray() -> void { writeOpCode(OpCode::AddArray); }
+
 auto Assembler::addCheckEqInt() -> void { writeOpCode(OpCode::CheckEqInt); }
 
 auto Assembler::addCheckEqLong() -> void { writeOpCode(OpCode::CheckEqLong); }
@@ -224,7 +347,18 @@ auto Assembler::addMakeStruct(uint8_t fieldCount) -> void {
 auto Assembler::addMakeNullStruct() -> void { writeOpCode(OpCode::MakeNullStruct); }
 
 auto Assembler::addStructLoadField(uint8_t fieldIndex) -> void {
-  writeOpCode(OpCode::StructLoadField);
+  switch (getPrevOp().value_or(OpCode::Fail)) {
+  case OpCode::StackLoad:
+    // 'StackLoad' + 'StructLoadField' -> 'StackLoadStructField'.
+    fusePrevOp(OpCode::StackLoadStructField);
+    break;
+  case OpCode::Dup:
+    // 'Dup' + 'StructLoadField' -> 'StructPeekField'.
+    fusePrevOp(OpCode::StructPeekField);
+    break;
+  default:
+    writeOpCode(OpCode::StructLoadField);
+  }
   writeUInt8(fieldIndex);
 }
 
@@ -233,13 +367,32 @@ auto Assembler::addStructStoreField(uint8_t fieldIndex) -> void {
   writeUInt8(fieldIndex);
 }
 
+auto Assembler::addMakeArray() -> void { writeOpCode(OpCode::MakeArray); }
+
+auto Assembler::addMakeArrayList() -> void { writeOpCode(OpCode::MakeArrayList); }
+
+auto Assembler::addAllocArray() -> void { writeOpCode(OpCode::AllocArray); }
+
+auto Assembler::addArrayStore() -> void { writeOpCode(OpCode::ArrayStore); }
+
 auto Assembler::addJump(std::string label) -> void {
   writeOpCode(OpCode::Jump);
   writeIpOffset(std::move(label));
 }
 
 auto Assembler::addJumpIf(std::string label) -> void {
-  writeOpCode(OpCode::JumpIf);
+  switch (getPrevOp().value_or(OpCode::Fail)) {
+  case OpCode::CheckEqInt:
+    // 'CheckEqInt' + 'JumpIf' -> 'CheckEqIntJumpIf'.
+    fusePrevOp(OpCode::CheckEqIntJumpIf);
+    break;
+  case OpCode::StructPeekField:
+    // 'Dup' + 'StructLoadField' + 'JumpIf' -> 'StructPeekFieldJumpIf'.
+    fusePrevOp(OpCode::StructPeekFieldJumpIf);
+    break;
+  default:
+    writeOpCode(OpCode::JumpIf);
+  }
   writeIpOffset(std::move(label));
 }
 
@@ -299,8 +452,44 @@ auto Assembler::addFail() -> void { writeOpCode(OpCode::Fail); }
 
 auto Assembler::setEntrypoint(std::string label) -> void { m_entrypointLabel = std::move(label); }
 
+auto Assembler::addSourceFile(std::string path) -> uint32_t {
+  throwIfClosed();
+  return m_debugInfo.addFile(std::move(path));
+}
+
+auto Assembler::setSourceSpan(std::optional<SourceSpan> span) -> void {
+  if (span && span->file >= m_debugInfo.getFiles().size()) {
+    throw std::invalid_argument{"Source span refers to an unknown source file"};
+  }
+  m_sourceSpan = span;
+}
+
+auto Assembler::getSourceSpan() const noexcept -> const std::optional<SourceSpan>& {
+  return m_sourceSpan;
+}
+
+auto Assembler::beginFunction(std::string name) -> void {
+  throwIfClosed();
+  if (m_function) {
+    throw std::logic_error{"Function already in progress"};
+  }
+  m_function = std::make_pair(std::move(name), getCurrentIpOffset());
+}
+
+auto Assembler::endFunction() -> void {
+  throwIfClosed();
+  if (!m_function) {
+    throw std::logic_error{"No function in progress"};
+  }
+  m_debugInfo.addFunction(std::move(m_function->first), m_function->second, getCurrentIpOffset());
+  m_function = std::nullopt;
+}
+
 auto Assembler::close() -> Assembly {
   throwIfClosed();
+  if (m_function) {
+    throw std::logic_error{"Function in progress"};
+  }
 
   m_closed = true;
   patchLabels();
@@ -312,11 +501,15 @@ auto Assembler::close() -> Assembly {
     throw std::logic_error{oss.str()};
   }
 
+  const auto hasDebugInfo = !m_debugInfo.getFiles().empty() ||
+      !m_debugInfo.getSpans().empty() || !m_debugInfo.getFunctions().empty();
+
   auto version = std::string{PROJECT_VER};
   return Assembly{std::move(version),
                   entrypointItr->second,
                   std::move(m_litStrings),
-                  std::move(m_instructions)};
+                  std::move(m_instructions),
+                  hasDebugInfo ? std::optional{std::move(m_debugInfo)} : std::nullopt};
 }
 
 auto Assembler::getLabels() -> std::unordered_map<uint32_t, std::vector<std::string>> {
@@ -341,7 +534,74 @@ auto Assembler::addLitString(const std::string& string) -> uint32_t {
 
 auto Assembler::getCurrentIpOffset() -> uint32_t { return m_instructions.size(); }
 
-auto Assembler::writeOpCode(OpCode opCode) -> void { writeUInt8(static_cast<uint8_t>(opCode)); }
+auto Assembler::getPrevOp() -> std::optional<OpCode> {
+  if (!m_prevOpFusable) {
+    return std::nullopt;
+  }
+  return static_cast<OpCode>(m_instructions[m_prevOpOffset]);
+}
+
+auto Assembler::getPrevOpLitInt() -> int32_t {
+  const auto* operand = m_instructions.data() + m_prevOpOffset + 1;
+  switch (static_cast<OpCode>(m_instructions[m_prevOpOffset])) {
+  case OpCode::LoadLitInt0:
+    return 0;
+  case OpCode::LoadLitInt1:
+    return 1;
+  case OpCode::LoadLitIntSmall:
+    return operand[0];
+  case OpCode::LoadLitInt: {
+    auto raw = static_cast<uint32_t>(operand[0]);
+    raw |= static_cast<uint32_t>(operand[1]) << 8U;  // NOLINT: Magic number
+    raw |= static_cast<uint32_t>(operand[2]) << 16U; // NOLINT: Magic number
+    raw |= static_cast<uint32_t>(operand[3]) << 24U; // NOLINT: Magic number
+    return reinterpret_cast<int32_t&>(raw);          // NOLINT: Reinterpret cast
+  }
+  default:
+    throw std::logic_error{"Previous instruction is not an int literal"};
+  }
+}
+
+auto Assembler::fusePrevOp(OpCode opCode) -> void {
+  // Replace the op-code of the previous instruction (but keep its operands), operands of the fused
+  // instruction are written after it.
+  throwIfClosed();
+  m_instructions[m_prevOpOffset] = static_cast<uint8_t>(opCode);
+}
+
+auto Assembler::replacePrevOp(OpCode opCode) -> void {
+  // Remove the previous instruction (including its operands) and write the new op-code instead.
+  // Note: Only valid for instructions without instruction-pointer operands (those are patched).
+  throwIfClosed();
+  m_instructions.resize(m_prevOpOffset);
+  writeOpCode(opCode);
+}
+
+auto Assembler::addStackBinaryOp(OpCode opCode, uint8_t lhsOffset, uint8_t rhsOffset) -> void {
+  writeOpCode(opCode);
+  writeUInt8(lhsOffset);
+  writeUInt8(rhsOffset);
+}
+
+auto Assembler::writeOpCode(OpCode opCode) -> void {
+  m_prevOpOffset  = getCurrentIpOffset();
+  m_prevOpFusable = true;
+  writeSourceSpan();
+  writeUInt8(static_cast<uint8_t>(opCode));
+}
+
+auto Assembler::writeSourceSpan() -> void {
+  /* Only record a span entry when the span changes, an entry applies to all instructions up to the
+  next entry. Entries for instructions that have been removed (by 'replacePrevOp') are dropped. */
+  const auto ipOffset = getCurrentIpOffset();
+  m_debugInfo.removeSpans(ipOffset);
+
+  const auto& spans   = m_debugInfo.getSpans();
+  const auto prevSpan = spans.empty() ? std::nullopt : spans.back().span;
+  if (m_sourceSpan != prevSpan) {
+    m_debugInfo.addSpan(ipOffset, m_sourceSpan);
+  }
+}
 
 auto Assembler::writeUInt8(uint8_t val) -> void {
   throwIfClosed();
@@ -8,11 +8,13 @@ Assembly::Assembly(
     std::string compilerVersion,
     uint32_t entrypoint,
     std::vector<std::string> litStrings,
-    std::vector<uint8_t> instructions) noexcept :
+    std::vector<uint8_t> instructions,
+    std::optional<DebugInfo> debugInfo) noexcept :
     m_compilerVersion{std::move(compilerVersion)},
     m_entrypoint{entrypoint},
     m_litStrings{std::move(litStrings)},
-    m_instructions{std::move(instructions)} {}
+    m_instructions{std::move(instructions)},
+    m_debugInfo{std::move(debugInfo)} {}
 
 auto Assembly::operator==(const Assembly& rhs) const noexcept -> bool {
   return m_entrypoint == rhs.m_entrypoint && m_litStrings == rhs.m_litStrings &&
@@ -57,4 +59,8 @@ auto Assembly::isEnd(const uint8_t* ip) const noexcept -> bool {
   return ip == m_instructions.data() + m_instructions.size();
 }
 
+auto Assembly::getDebugInfo() const noexcept -> const DebugInfo* {
+  return m_debugInfo ? &*m_debugInfo : nullptr;
+}
+
 } // namespace novasm
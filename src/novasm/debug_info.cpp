@@ -0,0 +1,95 @@
+#include "novasm/debug_info.hpp"
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace novasm {
+
+auto SourceSpan::operator==(const SourceSpan& rhs) const noexcept -> bool {
+  return file == rhs.file && startLine == rhs.startLine && startCol == rhs.startCol &&
+      endLine == rhs.endLine && endCol == rhs.endCol;
+}
+
+auto SourceSpan::operator!=(const SourceSpan& rhs) const noexcept -> bool {
+  return !SourceSpan::operator==(rhs);
+}
+
+auto DebugInfo::SpanEntry::operator==(const SpanEntry& rhs) const noexcept -> bool {
+  return ipOffset == rhs.ipOffset && span == rhs.span;
+}
+
+auto DebugInfo::SpanEntry::operator!=(const SpanEntry& rhs) const noexcept -> bool {
+  return !SpanEntry::operator==(rhs);
+}
+
+auto DebugInfo::Function::operator==(const Function& rhs) const noexcept -> bool {
+  return name == rhs.name && ipBegin == rhs.ipBegin && ipEnd == rhs.ipEnd;
+}
+
+auto DebugInfo::Function::operator!=(const Function& rhs) const noexcept -> bool {
+  return !Function::operator==(rhs);
+}
+
+auto DebugInfo::operator==(const DebugInfo& rhs) const noexcept -> bool {
+  return m_files == rhs.m_files && m_spans == rhs.m_spans && m_functions == rhs.m_functions;
+}
+
+auto DebugInfo::operator!=(const DebugInfo& rhs) const noexcept -> bool {
+  return !DebugInfo::operator==(rhs);
+}
+
+auto DebugInfo::addFile(std::string path) -> uint32_t {
+  m_files.push_back(std::move(path));
+  return m_files.size() - 1U;
+}
+
+auto DebugInfo::addSpan(uint32_t ipOffset, std::optional<SourceSpan> span) -> void {
+  assert(m_spans.empty() || m_spans.back().ipOffset <= ipOffset);
+  assert(!span || span->file < m_files.size());
+  m_spans.push_back(SpanEntry{ipOffset, span});
+}
+
+auto DebugInfo::removeSpans(uint32_t ipOffset) -> void {
+  while (!m_spans.empty() && m_spans.back().ipOffset >= ipOffset) {
+    m_spans.pop_back();
+  }
+}
+
+auto DebugInfo::addFunction(std::string name, uint32_t ipBegin, uint32_t ipEnd) -> void {
+  assert(ipBegin <= ipEnd);
+  assert(m_functions.empty() || m_functions.back().ipEnd <= ipBegin);
+  m_functions.push_back(Function{std::move(name), ipBegin, ipEnd});
+}
+
+auto DebugInfo::getFiles() const noexcept -> const std::vector<std::string>& { return m_files; }
+
+auto DebugInfo::getSpans() const noexcept -> const std::vector<SpanEntry>& { return m_spans; }
+
+auto DebugInfo::getFunctions() const noexcept -> const std::vector<Function>& {
+  return m_functions;
+}
+
+auto DebugInfo::findSpan(uint32_t ipOffset) const noexcept -> std::optional<SourceSpan> {
+  // Find the last entry that starts at or before the offset.
+  const auto itr = std::upper_bound(
+      m_spans.begin(), m_spans.end(), ipOffset, [](uint32_t offset, const SpanEntry& entry) {
+        return offset < entry.ipOffset;
+      });
+  if (itr == m_spans.begin()) {
+    return std::nullopt;
+  }
+  return (itr - 1)->span;
+}
+
+auto DebugInfo::findFunction(uint32_t ipOffset) const noexcept -> const Function* {
+  const auto itr = std::upper_bound(
+      m_functions.begin(), m_functions.end(), ipOffset, [](uint32_t offset, const Function& func) {
+        return offset < func.ipBegin;
+      });
+  if (itr == m_functions.begin() || ipOffset >= (itr - 1)->ipEnd) {
+    return nullptr;
+  }
+  return &*(itr - 1);
+}
+
+} // namespace novasm
@@ -101,6 +101,7 @@ auto disassembleInstructions(const Assembly& assembly, const dasm::InstructionLa
 
     switch (opCode) {
     case OpCode::LoadLitInt:
+    case OpCode::AddIntLit:
       result.push_back(Instr{opCode, offset, {Arg{readAsm<int32_t>(&ip)}}, labels});
       continue;
     case OpCode::LoadLitLong:
@@ -116,6 +117,7 @@ auto disassembleInstructions(const Assembly& assembly, const dasm::InstructionLa
     case OpCode::MakeStruct:
     case OpCode::StructLoadField:
     case OpCode::StructStoreField:
+    case OpCode::StructPeekField:
     case OpCode::CallDyn:
     case OpCode::CallDynTail:
     case OpCode::CallDynForked:
@@ -163,6 +165,15 @@ auto disassembleInstructions(const Assembly& assembly, const dasm::InstructionLa
     case OpCode::LengthString:
     case OpCode::IndexString:
     case OpCode::SliceString:
+    case OpCode::IndexOfString:
+    case OpCode::IndexOfLastString:
+    case OpCode::IndexOfAnyString:
+    case OpCode::SpanString:
+    case OpCode::StartsWithString:
+    case OpCode::LengthArray:
+    case OpCode::IndexArray:
+    case OpCode::SliceArray:
+    case OpCode::AddArray:
     case OpCode::CheckEqInt:
     case OpCode::CheckEqLong:
     case OpCode::CheckEqFloat:
@@ -189,6 +200,10 @@ auto disassembleInstructions(const Assembly& assembly, const dasm::InstructionLa
     case OpCode::ConvFloatChar:
     case OpCode::ConvFloatLong:
     case OpCode::MakeNullStruct:
+    case OpCode::MakeArray:
+    case OpCode::MakeArrayList:
+    case OpCode::AllocArray:
+    case OpCode::ArrayStore:
     case OpCode::Ret:
     case OpCode::Fail:
     case OpCode::FutureWaitNano:
@@ -202,14 +217,47 @@ auto disassembleInstructions(const Assembly& assembly, const dasm::InstructionLa
     case OpCode::LoadLitString:
       result.push_back(Instr{opCode, offset, {Arg{readAsm<uint32_t>(&ip)}}, labels});
       continue;
+    case OpCode::StackLoadStructField:
+    case OpCode::StackAddInt:
+    case OpCode::StackSubInt:
+    case OpCode::StackMulInt:
+    case OpCode::StackAddFloat:
+    case OpCode::StackSubFloat:
+    case OpCode::StackMulFloat:
+    case OpCode::StackDivFloat:
+    case OpCode::StackCheckEqInt:
+    case OpCode::StackCheckGtInt:
+    case OpCode::StackCheckLeInt:
+    case OpCode::StackCheckGtFloat:
+    case OpCode::StackCheckLeFloat: {
+      const auto argA = readAsm<uint8_t>(&ip);
+      const auto argB = readAsm<uint8_t>(&ip);
+      result.push_back(Instr{opCode, offset, {Arg{argA}, Arg{argB}}, labels});
+      continue;
+    }
+    case OpCode::StackAddIntStore:
+    case OpCode::StackSubIntStore:
+    case OpCode::StackMulIntStore:
+    case OpCode::StackAddFloatStore:
+    case OpCode::StackSubFloatStore:
+    case OpCode::StackMulFloatStore:
+    case OpCode::StackDivFloatStore: {
+      const auto argA = readAsm<uint8_t>(&ip);
+      const auto argB = readAsm<uint8_t>(&ip);
+      const auto argC = readAsm<uint8_t>(&ip);
+      result.push_back(Instr{opCode, offset, {Arg{argA}, Arg{argB}, Arg{argC}}, labels});
+      continue;
+    }
     case OpCode::LoadLitIp:
     case OpCode::Jump:
-    case OpCode::JumpIf: {
+    case OpCode::JumpIf:
+    case OpCode::CheckEqIntJumpIf: {
       const auto tgtIpOffset = readAsm<uint32_t>(&ip);
       result.push_back(
           Instr{opCode, offset, {Arg{tgtIpOffset, getLabels(instrLabels, tgtIpOffset)}}, labels});
       continue;
     }
+    case OpCode::StructPeekFieldJumpIf:
     case OpCode::Call:
     case OpCode::CallTail:
     case OpCode::CallForked: {
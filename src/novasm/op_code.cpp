@@ -38,6 +38,9 @@ auto operator<<(std::ostream& out, const OpCode& rhs) noexcept -> std::ostream&
   case OpCode::StackLoad:
     out << "stack-load";
     break;
+  case OpCode::StackLoadStructField:
+    out << "stack-load-struct-field";
+    break;
 
   case OpCode::AddInt:
     out << "add-int";
@@ -159,6 +162,36 @@ auto operator<<(std::ostream& out, const OpCode& rhs) noexcept -> std::ostream&
   case OpCode::SliceString:
     out << "slice-string";
     break;
+  case OpCode::IndexOfString:
+    out << "index-of-string";
+    break;
+  case OpCode::IndexOfLastString:
+    out << "index-of-last-string";
+    break;
+  case OpCode::IndexOfAnyString:
+    out << "index-of-any-string";
+    break;
+  case OpCode::SpanString:
+    out << "span-string";
+    break;
+  case OpCode::StartsWithString:
+    out << "starts-with-string";
+    break;
+  case OpCode::AddIntLit:
+    out << "add-int-lit";
+    break;
+  case OpCode::LengthArray:
+    out << "length-array";
+    break;
+  case OpCode::IndexArray:
+    out << "index-array";
+    break;
+  case OpCode::SliceArray:
+    out << "slice-array";
+    break;
+  case OpCode::AddArray:
+    out << "add-array";
+    break;
 
   case OpCode::CheckEqInt:
     out << "check-eq-int";
@@ -237,6 +270,64 @@ auto operator<<(std::ostream& out, const OpCode& rhs) noexcept -> std::ostream&
     out << "conv-float-long";
     break;
 
+  case OpCode::StackAddInt:
+    out << "stack-add-int";
+    break;
+  case OpCode::StackSubInt:
+    out << "stack-sub-int";
+    break;
+  case OpCode::StackMulInt:
+    out << "stack-mul-int";
+    break;
+  case OpCode::StackAddFloat:
+    out << "stack-add-float";
+    break;
+  case OpCode::StackSubFloat:
+    out << "stack-sub-float";
+    break;
+  case OpCode::StackMulFloat:
+    out << "stack-mul-float";
+    break;
+  case OpCode::StackDivFloat:
+    out << "stack-div-float";
+    break;
+  case OpCode::StackCheckEqInt:
+    out << "stack-check-eq-int";
+    break;
+  case OpCode::StackCheckGtInt:
+    out << "stack-check-gt-int";
+    break;
+  case OpCode::StackCheckLeInt:
+    out << "stack-check-le-int";
+    break;
+  case OpCode::StackCheckGtFloat:
+    out << "stack-check-gt-float";
+    break;
+  case OpCode::StackCheckLeFloat:
+    out << "stack-check-le-float";
+    break;
+  case OpCode::StackAddIntStore:
+    out << "stack-add-int-store";
+    break;
+  case OpCode::StackSubIntStore:
+    out << "stack-sub-int-store";
+    break;
+  case OpCode::StackMulIntStore:
+    out << "stack-mul-int-store";
+    break;
+  case OpCode::StackAddFloatStore:
+    out << "stack-add-float-store";
+    break;
+  case OpCode::StackSubFloatStore:
+    out << "stack-sub-float-store";
+    break;
+  case OpCode::StackMulFloatStore:
+    out << "stack-mul-float-store";
+    break;
+  case OpCode::StackDivFloatStore:
+    out << "stack-div-float-store";
+    break;
+
   case OpCode::MakeStruct:
     out << "make-struct";
     break;
@@ -249,6 +340,22 @@ auto operator<<(std::ostream& out, const OpCode& rhs) noexcept -> std::ostream&
   case OpCode::StructStoreField:
     out << "struct-store-field";
     break;
+  case OpCode::StructPeekField:
+    out << "struct-peek-field";
+    break;
+
+  case OpCode::MakeArray:
+    out << "make-array";
+    break;
+  case OpCode::MakeArrayList:
+    out << "make-array-list";
+    break;
+  case OpCode::AllocArray:
+    out << "alloc-array";
+    break;
+  case OpCode::ArrayStore:
+    out << "array-store";
+    break;
 
   case OpCode::Jump:
     out << "jump";
@@ -256,6 +363,12 @@ auto operator<<(std::ostream& out, const OpCode& rhs) noexcept -> std::ostream&
   case OpCode::JumpIf:
     out << "jump-if";
     break;
+  case OpCode::CheckEqIntJumpIf:
+    out << "check-eq-int-jump-if";
+    break;
+  case OpCode::StructPeekFieldJumpIf:
+    out << "struct-peek-field-jump-if";
+    break;
 
   case OpCode::Call:
     out << "call";
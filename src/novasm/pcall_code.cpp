@@ -28,6 +28,12 @@ auto operator<<(std::ostream& out, const PCallCode& rhs) noexcept -> std::ostrea
   case PCallCode::StreamUnsetOptions:
     out << "stream-unset-options";
     break;
+  case PCallCode::StreamReadLine:
+    out << "stream-read-line";
+    break;
+  case PCallCode::StreamReadUntil:
+    out << "stream-read-until";
+    break;
 
   case PCallCode::FileOpenStream:
     out << "file-open-stream";
@@ -83,6 +89,10 @@ auto operator<<(std::ostream& out, const PCallCode& rhs) noexcept -> std::ostrea
     out << "clock-nano-steady";
     break;
 
+  case PCallCode::RuntimeMemStat:
+    out << "runtime-mem-stat";
+    break;
+
   case PCallCode::SleepNano:
     out << "sleep-nano";
     break;
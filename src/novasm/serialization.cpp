@@ -7,6 +7,11 @@
 
 namespace novasm {
 
+// Kinds of the optional sections that follow the instructions.
+enum class SectionKind : uint8_t {
+  DebugInfo = 1U,
+};
+
 template <typename ValueType, typename OutputItr>
 using Writer = void(const ValueType& val, OutputItr& outItr);
 
@@ -33,6 +38,22 @@ static auto writeUInt32(uint32_t val, OutputItr& outItr) -> void {
   writeUInt8(val >> 24U, outItr); // NOLINT: Magic number
 }
 
+template <typename OutputItr>
+static auto writeVarUInt(uint32_t val, OutputItr& outItr) -> void {
+  // Little-endian base 128: 7 bits per byte, the high bit indicates that more bytes follow.
+  while (val >= 0x80U) {                                   // NOLINT: Magic number
+    writeUInt8(static_cast<uint8_t>(val | 0x80U), outItr); // NOLINT: Magic number
+    val >>= 7U;                                            // NOLINT: Magic number
+  }
+  writeUInt8(static_cast<uint8_t>(val), outItr);
+}
+
+template <typename OutputItr>
+static auto writeVarInt(int64_t val, OutputItr& outItr) -> void {
+  // Zig-zag encoding to keep small negative numbers small.
+  writeVarUInt(static_cast<uint32_t>(val < 0 ? (-val * 2) - 1 : val * 2), outItr);
+}
+
 template <typename InputItrBegin, typename InputItrEnd, typename OutputItr>
 static auto writeRaw(InputItrBegin beginItr, InputItrEnd endItr, OutputItr& outItr) -> void {
   for (auto itr = beginItr; itr != endItr; ++itr) {
@@ -138,6 +159,31 @@ static auto readString(InputItr& itr, InputEndItr end) -> std::optional<std::str
   return result;
 }
 
+template <typename InputItr, typename InputEndItr>
+static auto readVarUInt(InputItr& itr, InputEndItr end) -> std::optional<uint32_t> {
+  auto result = 0U;
+  for (auto shift = 0U; shift < 32U; shift += 7U) { // NOLINT: Magic number
+    if (itr == end) {
+      return std::nullopt;
+    }
+    const auto byte = static_cast<uint8_t>(*itr++);
+    result |= static_cast<uint32_t>(byte & 0x7FU) << shift; // NOLINT: Magic number
+    if ((byte & 0x80U) == 0U) {                            // NOLINT: Magic number
+      return result;
+    }
+  }
+  return std::nullopt;
+}
+
+template <typename InputItr, typename InputEndItr>
+static auto readVarInt(InputItr& itr, InputEndItr end) -> std::optional<int64_t> {
+  const auto raw = readVarUInt(itr, end);
+  if (!raw) {
+    return std::nullopt;
+  }
+  return (*raw & 1U) ? -static_cast<int64_t>(*raw / 2U) - 1 : static_cast<int64_t>(*raw / 2U);
+}
+
 template <typename ElemType, typename InputItr, typename InputEndItr>
 static auto readSet(InputItr& itr, InputEndItr end, Reader<ElemType, InputItr, InputEndItr>* reader)
     -> std::optional<std::vector<ElemType>> {
@@ -159,6 +205,132 @@ static auto readSet(InputItr& itr, InputEndItr end, Reader<ElemType, InputItr, I
   return result;
 }
 
+template <typename OutputItr>
+static auto writeDebugInfo(const DebugInfo& debugInfo, OutputItr& outItr) -> void {
+  /* Compact encoding: offsets and lines are delta-encoded from the previous entry and all numbers
+  are written as variable length integers. */
+
+  const auto writeVarString = [&outItr](const std::string& str) {
+    writeVarUInt(str.length(), outItr);
+    writeRaw(str.begin(), str.end(), outItr);
+  };
+
+  writeVarUInt(debugInfo.getFiles().size(), outItr);
+  for (const auto& file : debugInfo.getFiles()) {
+    writeVarString(file);
+  }
+
+  writeVarUInt(debugInfo.getSpans().size(), outItr);
+  auto prevIpOffset  = 0U;
+  auto prevStartLine = 0U;
+  for (const auto& entry : debugInfo.getSpans()) {
+    writeVarUInt(entry.ipOffset - prevIpOffset, outItr);
+    prevIpOffset = entry.ipOffset;
+    if (!entry.span) {
+      writeVarUInt(0U, outItr);
+      continue;
+    }
+    const auto& span = *entry.span;
+    writeVarUInt(span.file + 1U, outItr); // Zero indicates that there is no span.
+    writeVarInt(static_cast<int64_t>(span.startLine) - prevStartLine, outItr);
+    writeVarUInt(span.startCol, outItr);
+    writeVarInt(static_cast<int64_t>(span.endLine) - span.startLine, outItr);
+    writeVarUInt(span.endCol, outItr);
+    prevStartLine = span.startLine;
+  }
+
+  writeVarUInt(debugInfo.getFunctions().size(), outItr);
+  auto prevIpEnd = 0U;
+  for (const auto& func : debugInfo.getFunctions()) {
+    writeVarUInt(func.ipBegin - prevIpEnd, outItr);
+    writeVarUInt(func.ipEnd - func.ipBegin, outItr);
+    writeVarString(func.name);
+    prevIpEnd = func.ipEnd;
+  }
+}
+
+template <typename InputItr, typename InputEndItr>
+static auto readDebugInfo(InputItr& itr, InputEndItr end) -> std::optional<DebugInfo> {
+  auto result = DebugInfo{};
+
+  const auto readVarString = [&itr, end]() -> std::optional<std::string> {
+    auto size = readVarUInt(itr, end);
+    if (!size) {
+      return std::nullopt;
+    }
+    auto str    = std::string{};
+    auto strItr = std::back_inserter(str);
+    if (!readRaw(*size, itr, end, strItr)) {
+      return std::nullopt;
+    }
+    return str;
+  };
+
+  auto fileCount = readVarUInt(itr, end);
+  if (!fileCount) {
+    return std::nullopt;
+  }
+  for (auto i = 0U; i != *fileCount; ++i) {
+    auto file = readVarString();
+    if (!file) {
+      return std::nullopt;
+    }
+    result.addFile(std::move(*file));
+  }
+
+  auto spanCount = readVarUInt(itr, end);
+  if (!spanCount) {
+    return std::nullopt;
+  }
+  auto ipOffset  = 0U;
+  auto startLine = 0L;
+  for (auto i = 0U; i != *spanCount; ++i) {
+    const auto ipDelta = readVarUInt(itr, end);
+    const auto file    = readVarUInt(itr, end);
+    if (!ipDelta || !file || *file > *fileCount) {
+      return std::nullopt;
+    }
+    ipOffset += *ipDelta;
+    if (*file == 0U) {
+      result.addSpan(ipOffset, std::nullopt);
+      continue;
+    }
+    const auto startLineDelta = readVarInt(itr, end);
+    const auto startCol       = readVarUInt(itr, end);
+    const auto lineCount      = readVarInt(itr, end);
+    const auto endCol         = readVarUInt(itr, end);
+    if (!startLineDelta || !startCol || !lineCount || !endCol) {
+      return std::nullopt;
+    }
+    startLine += *startLineDelta;
+    result.addSpan(
+        ipOffset,
+        SourceSpan{*file - 1U,
+                   static_cast<uint32_t>(startLine),
+                   *startCol,
+                   static_cast<uint32_t>(startLine + *lineCount),
+                   *endCol});
+  }
+
+  auto funcCount = readVarUInt(itr, end);
+  if (!funcCount) {
+    return std::nullopt;
+  }
+  auto ipEnd = 0U;
+  for (auto i = 0U; i != *funcCount; ++i) {
+    const auto ipGap  = readVarUInt(itr, end);
+    const auto ipSize = readVarUInt(itr, end);
+    auto name         = readVarString();
+    if (!ipGap || !ipSize || !name) {
+      return std::nullopt;
+    }
+    const auto ipBegin = ipEnd + *ipGap;
+    ipEnd              = ipBegin + *ipSize;
+    result.addFunction(std::move(*name), ipBegin, ipEnd);
+  }
+  return result;
+}
+
 template <typename OutputItr>
 auto serialize(const Assembly& assembly, OutputItr outItr) noexcept -> OutputItr {
 
@@ -179,11 +351,22 @@ auto serialize(const Assembly& assembly, OutputItr outItr) noexcept -> OutputItr
   writeUInt32(instructions.size(), outItr);
   writeRaw(instructions.begin(), instructions.end(), outItr);
 
+  // Optional sections, each starts with its kind and its size in bytes so readers can skip them.
+  if (const auto* debugInfo = assembly.getDebugInfo()) {
+    auto section    = std::vector<uint8_t>{};
+    auto sectionItr = std::back_inserter(section);
+    writeDebugInfo(*debugInfo, sectionItr);
+    writeUInt8(static_cast<uint8_t>(SectionKind::DebugInfo), outItr);
+    writeUInt32(section.size(), outItr);
+    writeRaw(section.begin(), section.end(), outItr);
+  }
+
   return outItr;
 }
 
 template <typename InputItrBegin, typename InputEndItr>
-auto deserialize(InputItrBegin itr, InputEndItr end) noexcept -> std::optional<Assembly> {
+auto deserialize(InputItrBegin itr, InputEndItr end, bool loadDebugInfo) noexcept
+    -> std::optional<Assembly> {
 
   // Format version number.
   auto formatVersionNum = readUInt16(itr, end);
@@ -226,10 +409,35 @@ auto deserialize(InputItrBegin itr, InputEndItr end) noexcept -> std::optional<A
     return std::nullopt;
   }
 
+  // Optional sections.
+  auto debugInfo = std::optional<DebugInfo>{};
+  while (loadDebugInfo && itr != end) {
+    const auto kind = readUInt8(itr, end);
+    const auto size = readUInt32(itr, end);
+    if (!kind || !size) {
+      return std::nullopt;
+    }
+    auto section    = std::vector<uint8_t>{};
+    auto sectionItr = std::back_inserter(section);
+    section.reserve(*size);
+    if (!readRaw(*size, itr, end, sectionItr)) {
+      return std::nullopt;
+    }
+    if (*kind == static_cast<uint8_t>(SectionKind::DebugInfo)) {
+      auto sectionReadItr = section.cbegin();
+      debugInfo           = readDebugInfo(sectionReadItr, section.cend());
+      if (!debugInfo) {
+        return std::nullopt;
+      }
+    }
+    // Note: Unknown sections are skipped.
+  }
+
   return Assembly{std::move(*compilerVersion),
                   *entryPoint,
                   std::move(*stringLiterals),
-                  std::move(instructions)};
+                  std::move(instructions),
+                  std::move(debugInfo)};
 }
 
 // Explicit instantiations.
@@ -242,13 +450,14 @@ template auto serialize(const Assembly&, std::ostream_iterator<char>) noexcept
 template auto serialize(const Assembly&, std::ostreambuf_iterator<char>) noexcept
     -> std::ostreambuf_iterator<char>;
 
-template auto deserialize(char*, char*) -> std::optional<Assembly>;
-template auto deserialize(std::string::iterator, std::string::iterator) -> std::optional<Assembly>;
-template auto deserialize(std::string::const_iterator, std::string::const_iterator)
+template auto deserialize(char*, char*, bool) -> std::optional<Assembly>;
+template auto deserialize(std::string::iterator, std::string::iterator, bool)
+    -> std::optional<Assembly>;
+template auto deserialize(std::string::const_iterator, std::string::const_iterator, bool)
     -> std::optional<Assembly>;
-template auto deserialize(std::istream_iterator<char>, std::istream_iterator<char>)
+template auto deserialize(std::istream_iterator<char>, std::istream_iterator<char>, bool)
     -> std::optional<Assembly>;
-template auto deserialize(std::istreambuf_iterator<char>, std::istreambuf_iterator<char>)
+template auto deserialize(std::istreambuf_iterator<char>, std::istreambuf_iterator<char>, bool)
     -> std::optional<Assembly>;
 
 } // namespace novasm
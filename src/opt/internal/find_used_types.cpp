@@ -50,6 +50,10 @@ auto FindUsedTypes::markType(prog::sym::TypeId type) -> void {
     const auto& lazyDef = std::get<prog::sym::LazyDef>(m_prog.getTypeDef(type));
     markType(lazyDef.getResult());
   } break;
+  case prog::sym::TypeKind::Array: {
+    const auto& arrayDef = std::get<prog::sym::ArrayDef>(m_prog.getTypeDef(type));
+    markType(arrayDef.getElement());
+  } break;
   case prog::sym::TypeKind::Enum:
   case prog::sym::TypeKind::Int:
   case prog::sym::TypeKind::Long:
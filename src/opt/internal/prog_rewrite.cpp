@@ -17,6 +17,7 @@ auto rewrite(
    * rewrite them before copying them over. */
 
   auto result = prog::Program{};
+  prog::copySourceFiles(prog, &result);
 
   // Copy all the types to the new program.
   for (auto typeItr = prog.beginTypeDecls(); typeItr != prog.endTypeDecls(); ++typeItr) {
@@ -134,6 +134,11 @@ namespace opt {
   case prog::sym::FuncKind::LengthString:
   case prog::sym::FuncKind::IndexString:
   case prog::sym::FuncKind::SliceString:
+  case prog::sym::FuncKind::IndexOfString:
+  case prog::sym::FuncKind::IndexOfLastString:
+  case prog::sym::FuncKind::IndexOfAnyString:
+  case prog::sym::FuncKind::SpanString:
+  case prog::sym::FuncKind::StartsWithString:
   case prog::sym::FuncKind::AppendChar:
   case prog::sym::FuncKind::CheckEqString:
   case prog::sym::FuncKind::CheckNEqString:
@@ -737,6 +742,62 @@ private:
       }
       return prog::expr::litStringNode(m_prog, str.substr(start, end - start));
     }
+    case prog::sym::FuncKind::IndexOfString: {
+      assert(args.size() == 3);
+      auto str   = getString(*args[0]);
+      auto sub   = getString(*args[1]);
+      auto start = getInt(*args[2]);
+      if (start < 0) {
+        start = 0;
+      }
+      auto res = sub.empty() ? std::string::npos : str.find(sub, start);
+      return prog::expr::litIntNode(
+          m_prog, res == std::string::npos ? -1 : static_cast<int32_t>(res));
+    }
+    case prog::sym::FuncKind::IndexOfLastString: {
+      assert(args.size() == 3);
+      auto str   = getString(*args[0]);
+      auto sub   = getString(*args[1]);
+      auto start = getInt(*args[2]);
+      auto res   = start < 0 || sub.empty() ? std::string::npos : str.rfind(sub, start);
+      return prog::expr::litIntNode(
+          m_prog, res == std::string::npos ? -1 : static_cast<int32_t>(res));
+    }
+    case prog::sym::FuncKind::IndexOfAnyString: {
+      assert(args.size() == 3);
+      auto str   = getString(*args[0]);
+      auto chars = getString(*args[1]);
+      auto start = getInt(*args[2]);
+      if (start < 0) {
+        start = 0;
+      }
+      auto res = str.find_first_of(chars, start);
+      return prog::expr::litIntNode(
+          m_prog, res == std::string::npos ? -1 : static_cast<int32_t>(res));
+    }
+    case prog::sym::FuncKind::SpanString: {
+      assert(args.size() == 3);
+      auto str   = getString(*args[0]);
+      auto chars = getString(*args[1]);
+      auto start = getInt(*args[2]);
+      if (start < 0) {
+        start = 0;
+      }
+      auto res = str.find_first_not_of(chars, start);
+      return prog::expr::litIntNode(
+          m_prog, static_cast<int32_t>(res == std::string::npos ? str.length() : res));
+    }
+    case prog::sym::FuncKind::StartsWithString: {
+      assert(args.size() == 3);
+      auto str    = getString(*args[0]);
+      auto sub    = getString(*args[1]);
+      auto offset = getInt(*args[2]);
+      if (offset < 0 || static_cast<unsigned>(offset) > str.length() ||
+          sub.length() > str.length() - offset) {
+        return prog::expr::litBoolNode(m_prog, false);
+      }
+      return prog::expr::litBoolNode(m_prog, str.compare(offset, sub.length(), sub) == 0);
+    }
     case prog::sym::FuncKind::AppendChar: {
       assert(args.size() == 2);
       auto result = getString(*args[0]);
@@ -45,6 +45,7 @@ auto treeshake(const prog::Program& prog) -> prog::Program {
 
   // Create a new program and copy the used functions, types and the exec statements.
   auto result = prog::Program{};
+  prog::copySourceFiles(prog, &result);
   for (const auto func : funcs) {
     prog::copyFunc(prog, &result, func);
   }
@@ -71,4 +71,10 @@ auto copyFunc(
   return true;
 }
 
+auto copySourceFiles(const Program& from, Program* to) -> void {
+  for (const auto& file : from.getSourceFiles()) {
+    to->addSourceFile(file);
+  }
+}
+
 } // namespace prog
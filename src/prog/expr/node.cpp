@@ -6,6 +6,17 @@ Node::Node(NodeKind kind) { m_kind = kind; }
 
 auto Node::getKind() const -> NodeKind { return m_kind; }
 
+auto Node::getSourceSpan() const noexcept -> const std::optional<SourceSpan>& {
+  return m_sourceSpan;
+}
+
+auto Node::setSourceSpan(SourceSpan span) noexcept -> void { m_sourceSpan = span; }
+
+auto Node::copySourceSpan(std::unique_ptr<Node> clone) const -> std::unique_ptr<Node> {
+  clone->m_sourceSpan = m_sourceSpan;
+  return clone;
+}
+
 auto operator<<(std::ostream& out, const Node& rhs) -> std::ostream& {
   return out << rhs.toString();
 }
@@ -36,8 +36,8 @@ auto AssignExprNode::toString() const -> std::string {
 }
 
 auto AssignExprNode::clone(Rewriter* rewriter) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<AssignExprNode>{new AssignExprNode{
-      m_constId, rewriter ? rewriter->rewrite(*m_expr) : m_expr->clone(nullptr)}};
+  return copySourceSpan(std::unique_ptr<AssignExprNode>{new AssignExprNode{
+      m_constId, rewriter ? rewriter->rewrite(*m_expr) : m_expr->clone(nullptr)}});
 }
 
 auto AssignExprNode::getConst() const noexcept -> sym::ConstId { return m_constId; }
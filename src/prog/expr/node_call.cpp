@@ -41,8 +41,8 @@ auto CallExprNode::toString() const -> std::string {
 }
 
 auto CallExprNode::clone(Rewriter* rewriter) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<CallExprNode>{
-      new CallExprNode{m_func, m_resultType, cloneNodes(m_args, rewriter), m_mode}};
+  return copySourceSpan(std::unique_ptr<CallExprNode>{
+      new CallExprNode{m_func, m_resultType, cloneNodes(m_args, rewriter), m_mode}});
 }
 
 auto CallExprNode::getFunc() const noexcept -> sym::FuncId { return m_func; }
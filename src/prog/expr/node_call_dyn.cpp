@@ -41,11 +41,11 @@ auto CallDynExprNode::getType() const noexcept -> sym::TypeId { return m_resultT
 auto CallDynExprNode::toString() const -> std::string { return "call-dyn"; }
 
 auto CallDynExprNode::clone(Rewriter* rewriter) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<CallDynExprNode>{
+  return copySourceSpan(std::unique_ptr<CallDynExprNode>{
       new CallDynExprNode{rewriter ? rewriter->rewrite(*m_lhs) : m_lhs->clone(nullptr),
                           m_resultType,
                           cloneNodes(m_args, rewriter),
-                          m_mode}};
+                          m_mode}});
 }
 
 auto CallDynExprNode::getArgs() const noexcept -> const std::vector<NodePtr>& { return m_args; }
@@ -32,8 +32,8 @@ auto CallSelfExprNode::getType() const noexcept -> sym::TypeId { return m_result
 auto CallSelfExprNode::toString() const -> std::string { return "self-call"; }
 
 auto CallSelfExprNode::clone(Rewriter* rewriter) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<CallSelfExprNode>{
-      new CallSelfExprNode{m_resultType, cloneNodes(m_args, rewriter)}};
+  return copySourceSpan(std::unique_ptr<CallSelfExprNode>{
+      new CallSelfExprNode{m_resultType, cloneNodes(m_args, rewriter)}});
 }
 
 auto CallSelfExprNode::accept(NodeVisitor* visitor) const -> void { visitor->visit(*this); }
@@ -36,8 +36,8 @@ auto ClosureNode::toString() const -> std::string {
 }
 
 auto ClosureNode::clone(Rewriter* rewriter) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<ClosureNode>{
-      new ClosureNode{m_type, m_func, cloneNodes(m_boundArgs, rewriter)}};
+  return copySourceSpan(std::unique_ptr<ClosureNode>{
+      new ClosureNode{m_type, m_func, cloneNodes(m_boundArgs, rewriter)}});
 }
 
 auto ClosureNode::getFunc() const noexcept -> sym::FuncId { return m_func; }
@@ -34,8 +34,8 @@ auto FieldExprNode::toString() const -> std::string {
 }
 
 auto FieldExprNode::clone(Rewriter* rewriter) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<FieldExprNode>{new FieldExprNode{
-      rewriter ? rewriter->rewrite(*m_lhs) : m_lhs->clone(nullptr), m_id, m_type}};
+  return copySourceSpan(std::unique_ptr<FieldExprNode>{new FieldExprNode{
+      rewriter ? rewriter->rewrite(*m_lhs) : m_lhs->clone(nullptr), m_id, m_type}});
 }
 
 auto FieldExprNode::getId() const noexcept -> sym::FieldId { return m_id; }
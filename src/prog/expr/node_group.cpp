@@ -30,7 +30,8 @@ auto GroupExprNode::getType() const noexcept -> sym::TypeId { return m_exprs.bac
 auto GroupExprNode::toString() const -> std::string { return "group"; }
 
 auto GroupExprNode::clone(Rewriter* rewriter) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<GroupExprNode>{new GroupExprNode{cloneNodes(m_exprs, rewriter)}};
+  return copySourceSpan(
+      std::unique_ptr<GroupExprNode>{new GroupExprNode{cloneNodes(m_exprs, rewriter)}});
 }
 
 auto GroupExprNode::accept(NodeVisitor* visitor) const -> void { visitor->visit(*this); }
@@ -26,7 +26,7 @@ auto LitBoolNode::getType() const noexcept -> sym::TypeId { return m_type; }
 auto LitBoolNode::toString() const -> std::string { return m_val ? "true" : "false"; }
 
 auto LitBoolNode::clone(Rewriter* /*rewriter*/) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<LitBoolNode>{new LitBoolNode{m_type, m_val}};
+  return copySourceSpan(std::unique_ptr<LitBoolNode>{new LitBoolNode{m_type, m_val}});
 }
 
 auto LitBoolNode::getVal() const noexcept -> bool { return m_val; }
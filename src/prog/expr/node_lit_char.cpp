@@ -31,7 +31,7 @@ auto LitCharNode::toString() const -> std::string {
 }
 
 auto LitCharNode::clone(Rewriter* /*rewriter*/) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<LitCharNode>{new LitCharNode{m_type, m_val}};
+  return copySourceSpan(std::unique_ptr<LitCharNode>{new LitCharNode{m_type, m_val}});
 }
 
 auto LitCharNode::getVal() const noexcept -> uint8_t { return m_val; }
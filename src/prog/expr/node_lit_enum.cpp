@@ -26,7 +26,7 @@ auto LitEnumNode::getType() const noexcept -> sym::TypeId { return m_type; }
 auto LitEnumNode::toString() const -> std::string { return m_name; }
 
 auto LitEnumNode::clone(Rewriter* /*rewriter*/) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<LitEnumNode>{new LitEnumNode{m_type, m_name, m_val}};
+  return copySourceSpan(std::unique_ptr<LitEnumNode>{new LitEnumNode{m_type, m_name, m_val}});
 }
 
 auto LitEnumNode::getName() const noexcept -> const std::string& { return m_name; }
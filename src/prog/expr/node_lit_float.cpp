@@ -42,7 +42,7 @@ auto LitFloatNode::toString() const -> std::string {
 }
 
 auto LitFloatNode::clone(Rewriter* /*rewriter*/) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<LitFloatNode>{new LitFloatNode{m_type, m_val}};
+  return copySourceSpan(std::unique_ptr<LitFloatNode>{new LitFloatNode{m_type, m_val}});
 }
 
 auto LitFloatNode::getVal() const noexcept -> float { return m_val; }
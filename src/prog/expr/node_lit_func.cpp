@@ -32,7 +32,7 @@ auto LitFuncNode::toString() const -> std::string {
 }
 
 auto LitFuncNode::clone(Rewriter* /*rewriter*/) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<LitFuncNode>{new LitFuncNode{m_type, m_func}};
+  return copySourceSpan(std::unique_ptr<LitFuncNode>{new LitFuncNode{m_type, m_func}});
 }
 
 auto LitFuncNode::getFunc() const noexcept -> sym::FuncId { return m_func; }
@@ -27,7 +27,7 @@ auto LitStringNode::getType() const noexcept -> sym::TypeId { return m_type; }
 auto LitStringNode::toString() const -> std::string { return m_val; }
 
 auto LitStringNode::clone(Rewriter* /*rewriter*/) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<LitStringNode>{new LitStringNode{m_type, m_val}};
+  return copySourceSpan(std::unique_ptr<LitStringNode>{new LitStringNode{m_type, m_val}});
 }
 
 auto LitStringNode::getVal() const noexcept -> const std::string& { return m_val; }
@@ -42,11 +42,11 @@ auto UnionGetExprNode::toString() const -> std::string {
 }
 
 auto UnionGetExprNode::clone(Rewriter* rewriter) const -> std::unique_ptr<Node> {
-  return std::unique_ptr<UnionGetExprNode>{
+  return copySourceSpan(std::unique_ptr<UnionGetExprNode>{
       new UnionGetExprNode{m_boolType,
                            rewriter ? rewriter->rewrite(*m_lhs) : m_lhs->clone(nullptr),
                            m_targetType,
-                           m_constId}};
+                           m_constId}});
 }
 
 auto UnionGetExprNode::getConst() const noexcept -> sym::ConstId { return m_constId; }
@@ -183,6 +183,32 @@ Program::Program() :
       getFuncName(Op::SquareSquare),
       sym::TypeSet{m_string, m_int, m_int},
       m_string);
+  m_funcDecls.registerFunc(
+      *this,
+      Fk::IndexOfString,
+      "stringIndexOf",
+      sym::TypeSet{m_string, m_string, m_int},
+      m_int);
+  m_funcDecls.registerFunc(
+      *this,
+      Fk::IndexOfLastString,
+      "stringIndexOfLast",
+      sym::TypeSet{m_string, m_string, m_int},
+      m_int);
+  m_funcDecls.registerFunc(
+      *this,
+      Fk::IndexOfAnyString,
+      "stringIndexOfAny",
+      sym::TypeSet{m_string, m_string, m_int},
+      m_int);
+  m_funcDecls.registerFunc(
+      *this, Fk::SpanString, "stringSpan", sym::TypeSet{m_string, m_string, m_int}, m_int);
+  m_funcDecls.registerFunc(
+      *this,
+      Fk::StartsWithString,
+      "stringStartsWith",
+      sym::TypeSet{m_string, m_string, m_int},
+      m_bool);
 
   // Register build-in unary char operators.
   m_funcDecls.registerFunc(
@@ -262,6 +288,14 @@ Program::Program() :
       "streamUnsetOptions",
       sym::TypeSet{m_stream, m_int},
       m_bool);
+  m_funcDecls.registerAction(
+      *this, Fk::ActionStreamReadLine, "streamReadLine", sym::TypeSet{m_stream}, m_string);
+  m_funcDecls.registerAction(
+      *this,
+      Fk::ActionStreamReadUntil,
+      "streamReadUntil",
+      sym::TypeSet{m_stream, m_char},
+      m_string);
 
   m_funcDecls.registerAction(
       *this, Fk::ActionFileOpenStream, "fileOpenStream", sym::TypeSet{m_string, m_int}, m_stream);
@@ -300,6 +334,9 @@ Program::Program() :
   m_funcDecls.registerAction(
       *this, Fk::ActionClockNanoSteady, "clockNanoSteady", sym::TypeSet{}, m_long);
 
+  m_funcDecls.registerAction(
+      *this, Fk::ActionRuntimeMemStat, "runtimeMemStat", sym::TypeSet{m_int}, m_long);
+
   m_funcDecls.registerAction(*this, Fk::ActionSleepNano, "sleepNano", sym::TypeSet{m_long}, m_long);
   m_funcDecls.registerAction(
       *this, Fk::ActionAssert, "assert", sym::TypeSet{m_bool, m_string}, m_bool);
@@ -462,6 +499,10 @@ auto Program::declareLazy(std::string name) -> sym::TypeId {
   return m_typeDecls.registerType(sym::TypeKind::Lazy, std::move(name));
 }
 
+auto Program::declareArray(std::string name) -> sym::TypeId {
+  return m_typeDecls.registerType(sym::TypeKind::Array, std::move(name));
+}
+
 auto Program::declarePureFunc(std::string name, sym::TypeSet input, sym::TypeId output)
     -> sym::FuncId {
   return m_funcDecls.registerFunc(
@@ -606,6 +647,45 @@ auto Program::defineLazy(sym::TypeId id, sym::TypeId result) -> void {
   m_typeDefs.registerLazy(m_typeDecls, id, result);
 }
 
+auto Program::defineArray(
+    sym::TypeId id,
+    sym::TypeId element,
+    sym::TypeId generator,
+    std::optional<sym::TypeId> list) -> void {
+
+  using Fk = prog::sym::FuncKind;
+  using Op = prog::Operator;
+
+  // Register constructor functions.
+  const auto& name = m_typeDecls[id].getName();
+  for (auto size = 0U; size <= arrayMaxCtorArgs; ++size) {
+    m_funcDecls.registerFunc(
+        *this, Fk::MakeArray, name, sym::TypeSet{std::vector<sym::TypeId>(size, element)}, id);
+  }
+  m_funcDecls.registerFunc(
+      *this, Fk::MakeArrayGenerate, name, sym::TypeSet{m_int, generator}, id);
+  if (list) {
+    m_funcDecls.registerFunc(*this, Fk::MakeArrayFromList, name, sym::TypeSet{*list}, id);
+  }
+
+  // Register utility functions.
+  m_funcDecls.registerFunc(*this, Fk::LengthArray, "length", sym::TypeSet{id}, m_int);
+  m_funcDecls.registerFunc(
+      *this, Fk::IndexArray, getFuncName(Op::SquareSquare), sym::TypeSet{id, m_int}, element);
+  m_funcDecls.registerFunc(
+      *this, Fk::SliceArray, getFuncName(Op::SquareSquare), sym::TypeSet{id, m_int, m_int}, id);
+  m_funcDecls.registerFunc(*this, Fk::AddArray, getFuncName(Op::Plus), sym::TypeSet{id, id}, id);
+
+  // Register (in)equality functions.
+  m_funcDecls.registerFunc(
+      *this, Fk::CheckEqUserType, getFuncName(Op::EqEq), sym::TypeSet{id, id}, m_bool);
+  m_funcDecls.registerFunc(
+      *this, Fk::CheckNEqUserType, getFuncName(Op::BangEq), sym::TypeSet{id, id}, m_bool);
+
+  // Register array definition.
+  m_typeDefs.registerArray(m_typeDecls, id, element);
+}
+
 auto Program::defineFunc(sym::FuncId id, sym::ConstDeclTable consts, expr::NodePtr expr) -> void {
   m_funcDefs.registerFunc(m_funcDecls, id, std::move(consts), std::move(expr));
 }
@@ -614,6 +694,11 @@ auto Program::addExecStmt(sym::ConstDeclTable consts, expr::NodePtr expr) -> voi
   return m_execStmts.push_back(sym::execStmt(std::move(consts), std::move(expr)));
 }
 
+auto Program::addSourceFile(std::string path) -> uint32_t {
+  m_sourceFiles.push_back(std::move(path));
+  return m_sourceFiles.size() - 1U;
+}
+
 auto Program::updateFuncOutput(sym::FuncId funcId, sym::TypeId newOutput) -> void {
   m_funcDecls.updateFuncOutput(funcId, newOutput);
 }
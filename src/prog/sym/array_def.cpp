@@ -0,0 +1,11 @@
+#include "prog/sym/array_def.hpp"
+
+namespace prog::sym {
+
+ArrayDef::ArrayDef(sym::TypeId id, TypeId element) : m_id{id}, m_element{element} {}
+
+auto ArrayDef::getId() const noexcept -> const TypeId& { return m_id; }
+
+auto ArrayDef::getElement() const -> const TypeId& { return m_element; }
+
+} // namespace prog::sym
@@ -82,6 +82,15 @@ auto TypeDefTable::registerLazy(const sym::TypeDeclTable& typeTable, sym::TypeId
   registerType(id, LazyDef{id, result});
 }
 
+auto TypeDefTable::registerArray(
+    const sym::TypeDeclTable& typeTable, sym::TypeId id, TypeId element) -> void {
+
+  if (typeTable[id].getKind() != sym::TypeKind::Array) {
+    throw std::invalid_argument{"Type has not been declared as being an array"};
+  }
+  registerType(id, ArrayDef{id, element});
+}
+
 auto TypeDefTable::registerType(sym::TypeId id, TypeDef def) -> void {
   auto itr = m_typeDefs.find(id);
   if (itr != m_typeDefs.end()) {
@@ -18,6 +18,7 @@ auto isPrimitive(const TypeKind& kind) -> bool {
   case TypeKind::Delegate:
   case TypeKind::Future:
   case TypeKind::Lazy:
+  case TypeKind::Array:
     return false;
   }
   throw std::invalid_argument{"Unknown type-kind"};
@@ -64,6 +65,9 @@ auto operator<<(std::ostream& out, const TypeKind& rhs) -> std::ostream& {
   case TypeKind::Lazy:
     out << "lazy";
     break;
+  case TypeKind::Array:
+    out << "array";
+    break;
   }
   return out;
 }
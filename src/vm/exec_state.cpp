@@ -34,6 +34,9 @@ auto operator<<(std::ostream& out, const ExecState& rhs) noexcept -> std::ostrea
   case ExecState::AssertFailed:
     out << "assert-failed";
     break;
+  case ExecState::IndexOutOfBounds:
+    out << "index-out-of-bounds";
+    break;
   }
   return out;
 }
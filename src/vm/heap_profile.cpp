@@ -0,0 +1,104 @@
+#include "vm/heap_profile.hpp"
+#include "vm/memory_stats.hpp"
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <string>
+
+namespace vm {
+
+HeapProfile::HeapProfile() noexcept : m_sampleCount{0U}, m_sampleRate{0U} {}
+
+auto HeapProfile::addAlloc(
+    uint32_t ipOffset, uint8_t refKind, uint64_t count, uint64_t bytes) noexcept -> void {
+  auto& site = m_sites[{ipOffset, refKind}];
+  site.allocCount += count;
+  site.allocBytes += bytes;
+  ++m_sampleCount;
+}
+
+auto HeapProfile::addFree(
+    uint32_t ipOffset, uint8_t refKind, uint64_t count, uint64_t bytes) noexcept -> void {
+  auto& site = m_sites[{ipOffset, refKind}];
+  site.freedCount += count;
+  site.freedBytes += bytes;
+}
+
+auto HeapProfile::addFunction(uint32_t entryIpOffset) noexcept -> void {
+  auto itr = std::lower_bound(m_functions.begin(), m_functions.end(), entryIpOffset);
+  if (itr == m_functions.end() || *itr != entryIpOffset) {
+    m_functions.insert(itr, entryIpOffset);
+  }
+}
+
+auto HeapProfile::getFunction(uint32_t ipOffset) const noexcept -> uint32_t {
+  if (ipOffset == unknownSite) {
+    return unknownSite;
+  }
+  auto itr = std::upper_bound(m_functions.begin(), m_functions.end(), ipOffset);
+  return itr == m_functions.begin() ? 0U : *(itr - 1);
+}
+
+auto HeapProfile::writeReport(std::ostream& out, const FunctionLabels& labels) const noexcept
+    -> void {
+
+  struct FunctionTotals final {
+    uint32_t func;
+    uint64_t allocBytes;
+    uint64_t retainedBytes;
+    uint64_t allocCount;
+    std::array<uint64_t, MemoryStats::refKindCount> kindBytes;
+  };
+
+  // Sites are recorded per instruction, merge the sites that are in the same functions.
+  auto functionTotals = std::map<uint32_t, FunctionTotals>{};
+  for (const auto& [key, site] : m_sites) {
+    const auto func = getFunction(key.first);
+    auto& total     = functionTotals[func];
+    total.func      = func;
+    total.allocBytes += site.allocBytes;
+    total.retainedBytes += site.getRetainedBytes();
+    total.allocCount += site.allocCount;
+    if (key.second < MemoryStats::refKindCount) {
+      total.kindBytes[key.second] += site.allocBytes;
+    }
+  }
+  auto totals = std::vector<FunctionTotals>{};
+  for (const auto& [func, total] : functionTotals) {
+    totals.push_back(total);
+  }
+  std::sort(totals.begin(), totals.end(), [](const FunctionTotals& a, const FunctionTotals& b) {
+    return a.allocBytes != b.allocBytes ? a.allocBytes > b.allocBytes : a.func < b.func;
+  });
+
+  out << "heap profile: " << m_sampleCount << " samples, 1 per " << m_sampleRate
+      << " bytes (estimated totals)\n";
+  out << std::setw(14) << "allocated" << std::setw(14) << "retained" << std::setw(12) << "allocs"
+      << "  function [bytes per kind]\n";
+  for (const auto& total : totals) {
+    out << std::setw(14) << total.allocBytes << std::setw(14) << total.retainedBytes
+        << std::setw(12) << total.allocCount << "  ";
+
+    const auto labelItr = labels.find(total.func);
+    if (total.func == unknownSite) {
+      out << "[runtime]";
+    } else if (labelItr != labels.end() && !labelItr->second.empty()) {
+      out << labelItr->second.front();
+    } else {
+      out << "func@" << total.func;
+    }
+
+    auto first = true;
+    for (auto kind = 0U; kind != MemoryStats::refKindCount; ++kind) {
+      if (total.kindBytes[kind] == 0U) {
+        continue;
+      }
+      out << (first ? " [" : ", ") << MemoryStats::getRefKindName(kind) << ": "
+          << total.kindBytes[kind];
+      first = false;
+    }
+    out << (first ? "\n" : "]\n");
+  }
+}
+
+} // namespace vm
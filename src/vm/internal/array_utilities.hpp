@@ -0,0 +1,82 @@
+#pragma once
+#include "internal/likely.hpp"
+#include "internal/ref_allocator.hpp"
+#include "internal/ref_array.hpp"
+#include "internal/ref_struct.hpp"
+#include <algorithm>
+
+namespace vm::internal {
+
+[[nodiscard]] auto inline sliceArray(
+    RefAllocator* refAlloc, ArrayRef* target, int32_t start, int32_t end) noexcept -> ArrayRef* {
+  const auto tgtSize = target->getSize();
+
+  // Check for negative indicies.
+  if (start < 0) {
+    start = 0;
+  }
+  if (end < 0) {
+    end = 0;
+  }
+
+  // Check that end does not go past the target array.
+  if (static_cast<unsigned>(end) >= tgtSize) {
+    end = tgtSize;
+    // 'Slice' of the entire array.
+    if (start == 0) {
+      return target;
+    }
+  }
+
+  // Check for inverted indices.
+  if (start > end) {
+    start = end;
+  }
+
+  // Copy the slice into a new array.
+  const auto size = static_cast<unsigned>(end - start);
+  auto* result    = refAlloc->allocArray(size);
+  if (unlikely(result == nullptr)) {
+    return nullptr;
+  }
+  std::copy_n(target->getValuesBegin() + start, size, result->getValuesBegin());
+  return result;
+}
+
+[[nodiscard]] auto inline concatArray(RefAllocator* refAlloc, ArrayRef* a, ArrayRef* b) noexcept
+    -> ArrayRef* {
+  // Arrays are immutable so when one of them is empty we can return the other.
+  if (a->getSize() == 0U) {
+    return b;
+  }
+  if (b->getSize() == 0U) {
+    return a;
+  }
+  auto* result = refAlloc->allocArray(a->getSize() + b->getSize());
+  if (unlikely(result == nullptr)) {
+    return nullptr;
+  }
+  auto* resultItr = std::copy(a->getValuesBegin(), a->getValuesEnd(), result->getValuesBegin());
+  std::copy(b->getValuesBegin(), b->getValuesEnd(), resultItr);
+  return result;
+}
+
+// Create an array from a list, the list is represented by a chain of structs where the first field
+// is the value and the second field the rest of the list, the end of the list is a null-struct.
+[[nodiscard]] auto inline listToArray(RefAllocator* refAlloc, Value list) noexcept -> ArrayRef* {
+  auto size = 0U;
+  for (auto node = list; !node.isNullRef(); node = getStructRef(node)->getField(1U)) {
+    ++size;
+  }
+  auto* result = refAlloc->allocArray(size);
+  if (unlikely(result == nullptr)) {
+    return nullptr;
+  }
+  auto* resultItr = result->getValuesBegin();
+  for (auto node = list; !node.isNullRef(); node = getStructRef(node)->getField(1U)) {
+    *resultItr++ = getStructRef(node)->getField(0U);
+  }
+  return result;
+}
+
+} // namespace vm::internal
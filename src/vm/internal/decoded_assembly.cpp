@@ -0,0 +1,294 @@
+#include "internal/decoded_assembly.hpp"
+#include <iterator>
+#include <limits>
+
+namespace vm::internal {
+
+using OpCode = novasm::OpCode;
+
+static const auto invalidIndex = std::numeric_limits<uint32_t>::max();
+
+// Read an operand from the packed assembly format and advance the offset.
+// Note: When reading past the end of the data 'valid' is set to false.
+template <typename Type>
+static auto readAsm(const std::vector<uint8_t>& data, uint32_t* offset, bool* valid) noexcept
+    -> Type {
+  if (*offset + sizeof(Type) > data.size()) {
+    *valid  = false;
+    *offset = static_cast<uint32_t>(data.size());
+    return Type{};
+  }
+  // TODO(bastian): Handle endianess differences.
+  const Type v = *reinterpret_cast<const Type*>(data.data() + *offset); // NOLINT: Reinterpret cast
+  *offset += sizeof(Type);
+  return v;
+}
+
+DecodedAssembly::DecodedAssembly(
+    const novasm::Assembly* assembly, RefAllocator* refAlloc) noexcept :
+    m_assembly{assembly}, m_instructions{}, m_offsetToIndex{}, m_entrypoint{nullptr} {
+  decode(refAlloc);
+  resolveTargets();
+  m_entrypoint = getInstruction(m_assembly->getEntrypoint());
+}
+
+auto DecodedAssembly::getInstruction(uint32_t ipOffset) const noexcept -> const Instruction* {
+  if (ipOffset >= m_offsetToIndex.size() || m_offsetToIndex[ipOffset] == invalidIndex) {
+    // Last instruction is always a 'Fail' sentinel.
+    return &m_instructions.back();
+  }
+  return &m_instructions[m_offsetToIndex[ipOffset]];
+}
+
+auto DecodedAssembly::decode(RefAllocator* refAlloc) noexcept -> void {
+  const auto& data = m_assembly->getInstructions();
+
+  // Create a single immortal string ref per literal.
+  // Note: When allocating fails the ref is nullptr, executing the load then fails the executor.
+  auto litStrings = std::vector<StringRef*>{};
+  for (auto itr = m_assembly->beginLitStrings(); itr != m_assembly->endLitStrings(); ++itr) {
+    litStrings.push_back(refAlloc->allocStrLitImmortal(*itr));
+  }
+  const auto litStringCount = static_cast<uint32_t>(litStrings.size());
+
+  m_offsetToIndex.assign(data.size(), invalidIndex);
+  m_instructions.reserve(data.size() / 2U + 1U);
+
+  auto offset = 0U;
+  auto valid  = true;
+  while (offset < data.size()) {
+    const auto ipOffset       = offset;
+    m_offsetToIndex[ipOffset] = static_cast<uint32_t>(m_instructions.size());
+
+    auto instr     = Instruction{};
+    instr.opCode   = readAsm<OpCode>(data, &offset, &valid);
+    instr.ipOffset = ipOffset;
+    instr.longArg  = 0;
+
+    auto knownOpCode = true;
+    switch (instr.opCode) {
+    // Widen all the int literal variants to a single instruction.
+    case OpCode::LoadLitInt:
+      instr.intArg = readAsm<int32_t>(data, &offset, &valid);
+      break;
+    case OpCode::LoadLitIntSmall:
+      instr.opCode = OpCode::LoadLitInt;
+      instr.intArg = readAsm<uint8_t>(data, &offset, &valid);
+      break;
+    case OpCode::LoadLitInt0:
+      instr.opCode = OpCode::LoadLitInt;
+      instr.intArg = 0;
+      break;
+    case OpCode::LoadLitInt1:
+      instr.opCode = OpCode::LoadLitInt;
+      instr.intArg = 1;
+      break;
+    case OpCode::AddIntLit:
+      instr.intArg = readAsm<int32_t>(data, &offset, &valid);
+      break;
+    case OpCode::LoadLitLong:
+      instr.longArg = readAsm<int64_t>(data, &offset, &valid);
+      break;
+    case OpCode::LoadLitFloat:
+      instr.floatArg = readAsm<float>(data, &offset, &valid);
+      break;
+    case OpCode::LoadLitString: {
+      const auto litStringId = readAsm<uint32_t>(data, &offset, &valid);
+      if (litStringId >= litStringCount) {
+        valid = false;
+        break;
+      }
+      instr.litString = litStrings[litStringId];
+    } break;
+
+    // Instruction pointer operands are resolved to instructions once all are decoded.
+    case OpCode::LoadLitIp:
+    case OpCode::Jump:
+    case OpCode::JumpIf:
+    case OpCode::CheckEqIntJumpIf:
+      instr.uintArg = readAsm<uint32_t>(data, &offset, &valid);
+      break;
+    case OpCode::StructPeekFieldJumpIf:
+    case OpCode::Call:
+    case OpCode::CallTail:
+    case OpCode::CallForked:
+      instr.argA    = readAsm<uint8_t>(data, &offset, &valid);
+      instr.uintArg = readAsm<uint32_t>(data, &offset, &valid);
+      break;
+
+    case OpCode::StackLoadStructField:
+    case OpCode::StackAddInt:
+    case OpCode::StackSubInt:
+    case OpCode::StackMulInt:
+    case OpCode::StackAddFloat:
+    case OpCode::StackSubFloat:
+    case OpCode::StackMulFloat:
+    case OpCode::StackDivFloat:
+    case OpCode::StackCheckEqInt:
+    case OpCode::StackCheckGtInt:
+    case OpCode::StackCheckLeInt:
+    case OpCode::StackCheckGtFloat:
+    case OpCode::StackCheckLeFloat:
+      instr.argA = readAsm<uint8_t>(data, &offset, &valid);
+      instr.argB = readAsm<uint8_t>(data, &offset, &valid);
+      break;
+    case OpCode::StackAddIntStore:
+    case OpCode::StackSubIntStore:
+    case OpCode::StackMulIntStore:
+    case OpCode::StackAddFloatStore:
+    case OpCode::StackSubFloatStore:
+    case OpCode::StackMulFloatStore:
+    case OpCode::StackDivFloatStore:
+      instr.argA = readAsm<uint8_t>(data, &offset, &valid);
+      instr.argB = readAsm<uint8_t>(data, &offset, &valid);
+      instr.argC = readAsm<uint8_t>(data, &offset, &valid);
+      break;
+
+    case OpCode::StackAlloc:
+    case OpCode::StackStore:
+    case OpCode::StackLoad:
+    case OpCode::MakeStruct:
+    case OpCode::StructLoadField:
+    case OpCode::StructStoreField:
+    case OpCode::StructPeekField:
+    case OpCode::CallDyn:
+    case OpCode::CallDynTail:
+    case OpCode::CallDynForked:
+    case OpCode::PCall:
+      instr.argA = readAsm<uint8_t>(data, &offset, &valid);
+      break;
+
+    case OpCode::AddInt:
+    case OpCode::AddLong:
+    case OpCode::AddFloat:
+    case OpCode::AddString:
+    case OpCode::CombineChar:
+    case OpCode::AppendChar:
+    case OpCode::SubInt:
+    case OpCode::SubLong:
+    case OpCode::SubFloat:
+    case OpCode::MulInt:
+    case OpCode::MulLong:
+    case OpCode::MulFloat:
+    case OpCode::DivInt:
+    case OpCode::DivLong:
+    case OpCode::DivFloat:
+    case OpCode::RemInt:
+    case OpCode::RemLong:
+    case OpCode::ModFloat:
+    case OpCode::PowFloat:
+    case OpCode::SqrtFloat:
+    case OpCode::SinFloat:
+    case OpCode::CosFloat:
+    case OpCode::TanFloat:
+    case OpCode::ASinFloat:
+    case OpCode::ACosFloat:
+    case OpCode::ATanFloat:
+    case OpCode::ATan2Float:
+    case OpCode::NegInt:
+    case OpCode::NegLong:
+    case OpCode::NegFloat:
+    case OpCode::LogicInvInt:
+    case OpCode::ShiftLeftInt:
+    case OpCode::ShiftRightInt:
+    case OpCode::AndInt:
+    case OpCode::OrInt:
+    case OpCode::XorInt:
+    case OpCode::InvInt:
+    case OpCode::LengthString:
+    case OpCode::IndexString:
+    case OpCode::SliceString:
+    case OpCode::IndexOfString:
+    case OpCode::IndexOfLastString:
+    case OpCode::IndexOfAnyString:
+    case OpCode::SpanString:
+    case OpCode::StartsWithString:
+    case OpCode::LengthArray:
+    case OpCode::IndexArray:
+    case OpCode::SliceArray:
+    case OpCode::AddArray:
+    case OpCode::CheckEqInt:
+    case OpCode::CheckEqLong:
+    case OpCode::CheckEqFloat:
+    case OpCode::CheckEqString:
+    case OpCode::CheckEqIp:
+    case OpCode::CheckEqCallDynTgt:
+    case OpCode::CheckGtInt:
+    case OpCode::CheckGtLong:
+    case OpCode::CheckGtFloat:
+    case OpCode::CheckLeInt:
+    case OpCode::CheckLeLong:
+    case OpCode::CheckLeFloat:
+    case OpCode::CheckStructNull:
+    case OpCode::ConvIntLong:
+    case OpCode::ConvIntFloat:
+    case OpCode::ConvLongInt:
+    case OpCode::ConvLongFloat:
+    case OpCode::ConvFloatInt:
+    case OpCode::ConvIntString:
+    case OpCode::ConvLongString:
+    case OpCode::ConvFloatString:
+    case OpCode::ConvCharString:
+    case OpCode::ConvIntChar:
+    case OpCode::ConvFloatChar:
+    case OpCode::ConvFloatLong:
+    case OpCode::MakeNullStruct:
+    case OpCode::MakeArray:
+    case OpCode::MakeArrayList:
+    case OpCode::AllocArray:
+    case OpCode::ArrayStore:
+    case OpCode::Ret:
+    case OpCode::FutureWaitNano:
+    case OpCode::FutureBlock:
+    case OpCode::Dup:
+    case OpCode::Pop:
+    case OpCode::Swap:
+    case OpCode::Fail:
+      break;
+
+    default:
+      knownOpCode = false;
+      break;
+    }
+
+    if (!knownOpCode || !valid) {
+      /* Unknown op-code or truncated operands, replace with a 'Fail' instruction. We cannot know
+      where the next instruction would start so we stop decoding, any jumps into the remaining
+      bytes end up at the 'Fail' sentinel. */
+      instr.opCode  = OpCode::Fail;
+      instr.longArg = 0;
+      m_instructions.push_back(instr);
+      break;
+    }
+    m_instructions.push_back(instr);
+  }
+
+  // Add a 'Fail' sentinel at the end, this is also where invalid instruction pointers resolve to.
+  auto sentinel     = Instruction{};
+  sentinel.opCode   = OpCode::Fail;
+  sentinel.ipOffset = static_cast<uint32_t>(data.size());
+  sentinel.longArg  = 0;
+  m_instructions.push_back(sentinel);
+}
+
+auto DecodedAssembly::resolveTargets() noexcept -> void {
+  // Note: Only valid after all instructions are decoded as before the vector could still grow.
+  for (auto& instr : m_instructions) {
+    switch (instr.opCode) {
+    case OpCode::LoadLitIp:
+    case OpCode::Jump:
+    case OpCode::JumpIf:
+    case OpCode::CheckEqIntJumpIf:
+    case OpCode::StructPeekFieldJumpIf:
+    case OpCode::Call:
+    case OpCode::CallTail:
+    case OpCode::CallForked:
+      instr.target = getInstruction(instr.uintArg);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+} // namespace vm::internal
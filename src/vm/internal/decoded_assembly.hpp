@@ -0,0 +1,72 @@
+#pragma once
+#include "internal/instruction.hpp"
+#include "internal/ref_allocator.hpp"
+#include "novasm/assembly.hpp"
+#include <vector>
+
+namespace vm::internal {
+
+// Assembly that is decoded into the (aligned) instruction format that the executor runs.
+// Decoding is done once at load time in a single linear pass over the assembly instructions.
+// String literals are turned into immortal string refs (owned by the given RefAllocator) so loading
+// a literal does not have to allocate.
+class DecodedAssembly final {
+  friend class JitCode;
+
+public:
+  DecodedAssembly(const novasm::Assembly* assembly, RefAllocator* refAlloc) noexcept;
+  DecodedAssembly(const DecodedAssembly& rhs) = delete;
+  DecodedAssembly(DecodedAssembly&& rhs)      = delete;
+  ~DecodedAssembly() noexcept                 = default;
+
+  auto operator=(const DecodedAssembly& rhs) -> DecodedAssembly& = delete;
+  auto operator=(DecodedAssembly&& rhs) -> DecodedAssembly& = delete;
+
+  [[nodiscard]] auto getAssembly() const noexcept -> const novasm::Assembly* { return m_assembly; }
+
+  [[nodiscard]] auto getEntrypoint() const noexcept -> const Instruction* { return m_entrypoint; }
+
+  [[nodiscard]] auto getInstructions() const noexcept -> const std::vector<Instruction>& {
+    return m_instructions;
+  }
+
+  // Lookup the decoded instruction that starts at the given offset in the source assembly.
+  // Note: Returns a 'Fail' instruction if no instruction starts at the given offset.
+  [[nodiscard]] auto getInstruction(uint32_t ipOffset) const noexcept -> const Instruction*;
+
+  // Lookup the offset in the source assembly of the given decoded instruction.
+  [[nodiscard]] auto getOffset(const Instruction* instr) const noexcept -> uint32_t {
+    return instr->ipOffset;
+  }
+
+  // Invoke the given function with the offsets of the function entries: the entrypoint and the
+  // targets of calls (and of closures).
+  // Note: Has to be done before jit compiling as that replaces instructions.
+  template <typename Func>
+  auto forEachFunctionEntry(Func func) const noexcept -> void {
+    func(getOffset(m_entrypoint));
+    for (const auto& instr : m_instructions) {
+      switch (instr.opCode) {
+      case novasm::OpCode::Call:
+      case novasm::OpCode::CallTail:
+      case novasm::OpCode::CallForked:
+      case novasm::OpCode::LoadLitIp:
+        func(getOffset(instr.target));
+        break;
+      default:
+        break;
+      }
+    }
+  }
+
+private:
+  const novasm::Assembly* m_assembly;
+  std::vector<Instruction> m_instructions;
+  std::vector<uint32_t> m_offsetToIndex;
+  const Instruction* m_entrypoint;
+
+  auto decode(RefAllocator* refAlloc) noexcept -> void;
+  auto resolveTargets() noexcept -> void;
+};
+
+} // namespace vm::internal
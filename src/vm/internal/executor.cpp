@@ -1,7 +1,13 @@
+#include "internal/array_utilities.hpp"
 #include "internal/executor.hpp"
+#include "internal/executor_pool.hpp"
+#include "internal/heap_profiler.hpp"
 #include "internal/likely.hpp"
 #include "internal/pcall.hpp"
+#include "internal/profiler.hpp"
+#include "internal/reactor.hpp"
 #include "internal/ref_allocator.hpp"
+#include "internal/ref_array.hpp"
 #include "internal/ref_future.hpp"
 #include "internal/ref_long.hpp"
 #include "internal/ref_string.hpp"
@@ -13,68 +19,84 @@
 #include "novasm/pcall_code.hpp"
 #include "vm/exec_state.hpp"
 #include "vm/platform_interface.hpp"
+#include <array>
 #include <cmath>
-#include <immintrin.h>
-#include <thread>
+#include <initializer_list>
+#include <utility>
+
+/* Use 'threaded' dispatch (jumping directly from the end of one instruction handler to the next
+through a table of label addresses) when the compiler supports 'labels as values'. Compared to a
+single switch this gives each handler its own indirect branch, which the cpu branch predictor can
+learn far better. Can be disabled (to use the portable switch dispatch) by defining
+'VM_SWITCH_DISPATCH'. */
+#if !defined(VM_SWITCH_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+#define VM_THREADED_DISPATCH
+#endif
 
 namespace vm::internal {
 
-// Read a single byte of assembly and increment the given instruction pointer.
-template <typename Type>
-inline auto readAsm(const uint8_t** ip) {
-  // TODO(bastian): Handle endianess differences.
-  const Type v = *reinterpret_cast<const Type*>(*ip); // NOLINT: Reinterpret cast
-  *ip += sizeof(Type);
-  return v;
+const auto stackFrameMetaSize = 2U; // Return ip and return stack-home.
+
+// Free stack space that is guaranteed to code that cannot grow the stack itself (platform calls
+// and jit compiled code). Note: Jit compiled 'StackAlloc' instructions allocate up to 255 values.
+const auto nativeStackSpace = 256U;
+
+// Continue on a new stack segment with space for at least 'amount' more values, the current
+// stack-frame is moved to the new segment. Returns false if the stack limit has been reached.
+inline auto growStack(Stack* stack, Value** sh, Value** rootSh, unsigned int amount) -> bool {
+
+  /* Stack-frames start with the return instruction pointer and stack-home, the root stack-frame
+  starts with the promise (or an empty value for the main executor). */
+
+  const auto isRoot = *sh == *rootSh;
+  auto* frame       = *sh - (isRoot ? 1U : stackFrameMetaSize);
+  auto* newFrame    = stack->grow(frame, amount);
+  if (unlikely(newFrame == nullptr)) {
+    return false;
+  }
+  *sh = newFrame + (*sh - frame);
+  if (isRoot) {
+    *rootSh = *sh;
+  }
+  return true;
 }
 
 // Make a call to a function at a given instruction pointer location. The current
 // instruction-pointer is saved on the stack for returning to when the called function returns.
-inline auto call(
-    const novasm::Assembly* assembly,
-    BasicStack* stack,
-    ExecutorHandle* execHandle,
-    const uint8_t** ip,
-    Value** sh,
-    uint8_t argCount,
-    uint32_t tgtIpOffset) -> bool {
+// Note: Caller has to make sure there is space for the stack-frame meta-data.
+inline auto
+call(Stack* stack, const Instruction** ip, Value** sh, uint8_t argCount, const Instruction* tgtIp)
+    -> void {
 
   /* Arguments are pushed on the stack before the call instruction, we shift over the arguments
   to make space for the return instruction, and the return stack home ptr. */
 
-  const int sfMetaSize = 2; // Return ip and return stack-home.
-
   auto* argStart = stack->getNext() - argCount;
-  auto* newSh    = argStart + sfMetaSize;
+  auto* newSh    = argStart + stackFrameMetaSize;
 
   // Allocate space on the stack for the stackframe meta-data.
-  if (unlikely(!stack->alloc(sfMetaSize))) {
-    execHandle->setState(ExecState::StackOverflow);
-    return false;
-  }
+  stack->alloc(stackFrameMetaSize);
 
   // Move the arguments to the beginning of the stack-home for the new stack frame.
   std::memmove(newSh, argStart, sizeof(Value) * argCount);
 
   // Save the return instruction pointer and stack-home.
-  *(newSh - 2) = uintValue(assembly->getOffset(*ip));
+  *(newSh - 2) = rawPtrValue(*ip);
   *(newSh - 1) = rawPtrValue(*sh);
 
   // Setup the ip and stack-home for the new stack frame.
-  *ip = assembly->getIp(tgtIpOffset);
+  *ip = tgtIp;
   *sh = newSh;
-  return true;
 }
 
 // Make a tail call to a function at a given instruction pointer location. Execution will NOT be
 // returned to the current function when the called function returns.
 inline auto callTail(
-    const novasm::Assembly* assembly,
-    BasicStack* stack,
-    const uint8_t** ip,
+    Stack* stack,
+    const Instruction** ip,
     Value* sh,
     uint8_t argCount,
-    uint32_t tgtIpOffset) -> void {
+    const Instruction* tgtIp) -> void {
 
   /* In case of a tail-call we discard our current stack-frame, we copy the arguments to the
   beginning of the current-stack frame and update the ip. */
@@ -85,17 +107,15 @@ inline auto callTail(
   std::memmove(sh, argStart, sizeof(Value) * argCount);
 
   stack->rewindToNext(sh + argCount); // Discard any extra values on the stack.
-  *ip = assembly->getIp(tgtIpOffset);
+  *ip = tgtIp;
 }
 
 // Push all the arguments of a closure on the stack (in preparation for calling the closure
 // function).
+// Note: Caller has to make sure there is space for the bound arguments.
 inline auto pushClosure(
-    BasicStack* stack,
-    ExecutorHandle* execHandle,
-    const Value& closureVal,
-    uint8_t* boundArgCount,
-    uint32_t* ipOffset) -> bool {
+    Stack* stack, const Value& closureVal, uint8_t* boundArgCount, const Instruction** tgtIp)
+    -> void {
 
   auto* closureStruct = getStructRef(closureVal);
   *boundArgCount      = closureStruct->getFieldCount() - 1U;
@@ -103,81 +123,73 @@ inline auto pushClosure(
 
   // Push all bound arguments on the stack.
   for (auto i = 0U; i != *boundArgCount; ++i) {
-    const auto& arg = closureStruct->getField(i);
-    if (unlikely(!stack->push(arg))) {
-      execHandle->setState(ExecState::StackOverflow);
-      return false;
-    }
+    stack->push(closureStruct->getField(i));
   }
 
-  *ipOffset = closureStruct->getField(*boundArgCount).getUInt();
-  return true;
+  *tgtIp = closureStruct->getField(*boundArgCount).getRawPtr<const Instruction>();
 }
 
-// Start executing a call to a function at a given instruction pointer location on a new thread. A
-// promise object for retreiving the results from will be pushed onto the stack.
+// Schedule a call to a function at a given instruction pointer location on the executor pool.
+// Returns a future for retreiving the results from (or nullptr if it failed to allocate it).
 inline auto fork(
     const Settings& settings,
-    const novasm::Assembly* assembly,
+    const DecodedAssembly* assembly,
     PlatformInterface* iface,
     ExecutorRegistry* execRegistry,
     RefAllocator* refAlloc,
-    BasicStack* stack,
+    Stack* stack,
     ExecutorHandle* execHandle,
     uint8_t argCount,
-    uint32_t entryIpOffset) -> bool {
+    const Instruction* entryIp) -> FutureRef* {
 
   // Create a future object to interact with the fork.
   auto* future = refAlloc->allocPlain<FutureRef>();
   if (unlikely(future == nullptr)) {
     execHandle->setState(ExecState::AllocFailed);
-    return false;
+    return nullptr;
   }
 
-  auto* argSource = stack->getNext() - argCount;
-  std::thread(
-      &execute,
-      settings,
-      assembly,
-      iface,
-      execRegistry,
-      refAlloc,
-      entryIpOffset,
-      argCount,
-      argSource,
-      future)
-      .detach();
-
-  // Wait until the fork executor has started.
-  std::this_thread::yield();
-  while (!future->getStarted().load(std::memory_order_acquire)) {
-    _mm_pause();
+  // Move the arguments into the future, the fork executor takes them from there when it starts.
+  if (argCount > 0U) {
+    auto* args = refAlloc->allocStruct(argCount);
+    if (unlikely(args == nullptr)) {
+      execHandle->setState(ExecState::AllocFailed);
+      return nullptr;
+    }
+    auto* argSource = stack->getNext() - argCount;
+    for (auto i = 0U; i != argCount; ++i) {
+      *args->getFieldPtr(i) = argSource[i];
+    }
+    future->setArgs(refValue(args));
+    stack->rewindToNext(argSource);
   }
 
-  /* Note its important to leave the arguments alone until the fork executor has started, as until
-  then the executor might still be reading them. */
-
-  // Remove the arguments from the stack.
-  stack->rewindToNext(stack->getNext() - argCount);
+  // Until the fork executor has started the registry keeps the future (and its arguments) alive.
+  execRegistry->registerFork(future);
+  ExecutorPool::get().push(
+      ForkTask{settings, assembly, iface, execRegistry, refAlloc, entryIp, future, 0U, nullptr});
+  return future;
+}
 
-  // Push the future on the stack.
-  if (unlikely(!stack->push(refValue(future)))) {
-    execHandle->setState(ExecState::StackOverflow);
-    return false;
+#if defined(VM_THREADED_DISPATCH)
+using DispatchTable = std::array<void*, 256U>;
+
+// Create a table of handler labels indexed by op-code, op-codes without a handler are dispatched
+// to the 'invalid' handler.
+static auto makeDispatchTable(
+    void* invalidHandler,
+    std::initializer_list<std::pair<novasm::OpCode, void*>> handlers) noexcept -> DispatchTable {
+  auto result = DispatchTable{};
+  result.fill(invalidHandler);
+  for (const auto& [opCode, handler] : handlers) {
+    result[static_cast<uint8_t>(opCode)] = handler;
   }
-  return true;
+  return result;
 }
+#endif
 
-auto execute(
-    const Settings& settings,
-    const novasm::Assembly* assembly,
-    PlatformInterface* iface,
-    ExecutorRegistry* execRegistry,
-    RefAllocator* refAlloc,
-    uint32_t entryIpOffset,
-    uint8_t entryArgCount,
-    Value* entryArgSource,
-    FutureRef* promise) noexcept -> ExecState {
+// Run the executor until it completes, returns 'Paused' when the executor was suspended instead.
+static auto run(Executor* executor) noexcept -> ExecState {
 
   using OpCode    = novasm::OpCode;
   using PCallCode = novasm::PCallCode;
@@ -189,28 +201,29 @@ auto execute(
       goto End;                                                                                    \
     }                                                                                              \
   }
-#define READ_BYTE() readAsm<uint8_t>(&ip)
-#define READ_INT() readAsm<int32_t>(&ip)
-#define READ_UINT() readAsm<uint32_t>(&ip)
-#define READ_LONG() readAsm<int64_t>(&ip)
-#define READ_FLOAT() readAsm<float>(&ip)
-#define SALLOC(COUNT)                                                                              \
-  if (unlikely(!stack.alloc(COUNT))) {                                                             \
-    execHandle.setState(ExecState::StackOverflow);                                                 \
-    goto End;                                                                                      \
+#define RESERVE(AMOUNT)                                                                            \
+  if (unlikely(!stack.hasSpace(AMOUNT))) {                                                         \
+    if (unlikely(!growStack(&stack, &sh, &rootSh, AMOUNT))) {                                      \
+      execHandle.setState(ExecState::StackOverflow);                                               \
+      goto End;                                                                                    \
+    }                                                                                              \
   }
+#define SALLOC(COUNT)                                                                              \
+  RESERVE(COUNT);                                                                                  \
+  stack.alloc(COUNT);
 #define PUSH(VAL)                                                                                  \
-  if (unlikely(!stack.push(VAL))) {                                                                \
-    execHandle.setState(ExecState::StackOverflow);                                                 \
-    goto End;                                                                                      \
+  {                                                                                                \
+    const auto pushVal = VAL;                                                                      \
+    RESERVE(1U);                                                                                   \
+    stack.push(pushVal);                                                                           \
   }
 #define PUSH_UINT(VAL) PUSH(uintValue(VAL))
 #define PUSH_INT(VAL) PUSH(intValue(VAL))
 #define PUSH_LONG(VAL)                                                                             \
   {                                                                                                \
     int64_t v = VAL;                                                                               \
-    if (v >= 0L) {                                                                                 \
-      PUSH(posLongValue(v));                                                                       \
+    if (likely(isInlineLong(v))) {                                                                 \
+      PUSH(inlineLongValue(v));                                                                    \
     } else {                                                                                       \
       PUSH_REF(refAlloc->allocPlain<LongRef>(v));                                                  \
     }                                                                                              \
@@ -223,92 +236,295 @@ auto execute(
     CHECK_ALLOC(refPtr);                                                                           \
     PUSH(refValue(refPtr));                                                                        \
   }
-#define PUSH_CLOSURE(VAL, RES_BOUND_ARG_COUNT, RES_TGT_IP_OFFSET)                                  \
-  if (unlikely(!pushClosure(&stack, &execHandle, VAL, RES_BOUND_ARG_COUNT, RES_TGT_IP_OFFSET))) {  \
-    goto End;                                                                                      \
-  }
+#define PUSH_CLOSURE(VAL, RES_BOUND_ARG_COUNT, RES_TGT_IP)                                         \
+  RESERVE(getStructRef(VAL)->getFieldCount() - 1U);                                                \
+  pushClosure(&stack, VAL, RES_BOUND_ARG_COUNT, RES_TGT_IP);
 #define PEEK() stack.peek()
+#define SLOT(OFFSET) (*(sh + (OFFSET)))
+#define SLOT_INT(OFFSET) SLOT(OFFSET).getInt()
+#define SLOT_FLOAT(OFFSET) SLOT(OFFSET).getFloat()
 #define POP() stack.pop()
 #define POP_UINT() POP().getUInt()
 #define POP_INT() POP().getInt()
 #define POP_FLOAT() POP().getFloat()
 #define CALL(ARG_COUNT, TGT_IP)                                                                    \
-  if (unlikely(!call(assembly, &stack, &execHandle, &ip, &sh, ARG_COUNT, TGT_IP))) {               \
-    goto End;                                                                                      \
+  RESERVE(stackFrameMetaSize);                                                                     \
+  call(&stack, &ip, &sh, ARG_COUNT, TGT_IP);
+#define CALL_TAIL(ARG_COUNT, TGT_IP) callTail(&stack, &ip, sh, ARG_COUNT, TGT_IP)
+// Backward jumps are safe-points, otherwise executors could not be paused while they loop.
+#define JUMP(TGT_IP)                                                                               \
+  {                                                                                                \
+    if (unlikely((TGT_IP) <= instr) && unlikely(execHandle.trap())) {                              \
+      goto End;                                                                                    \
+    }                                                                                              \
+    ip = TGT_IP;                                                                                   \
   }
-#define CALL_TAIL(ARG_COUNT, TGT_IP) callTail(assembly, &stack, &ip, sh, ARG_COUNT, TGT_IP)
 #define CALL_FORKED(ARG_COUNT, TGT_IP)                                                             \
-  if (unlikely(!fork(                                                                              \
-          settings,                                                                                \
-          assembly,                                                                                \
-          iface,                                                                                   \
-          execRegistry,                                                                            \
-          refAlloc,                                                                                \
-          &stack,                                                                                  \
-          &execHandle,                                                                             \
-          ARG_COUNT,                                                                               \
-          TGT_IP))) {                                                                              \
-    goto End;                                                                                      \
+  {                                                                                                \
+    auto* future = fork(                                                                           \
+        settings,                                                                                  \
+        assembly,                                                                                  \
+        iface,                                                                                     \
+        execRegistry,                                                                              \
+        refAlloc,                                                                                  \
+        &stack,                                                                                    \
+        &execHandle,                                                                               \
+        ARG_COUNT,                                                                                 \
+        TGT_IP);                                                                                   \
+    if (unlikely(future == nullptr)) {                                                             \
+      goto End;                                                                                    \
+    }                                                                                              \
+    PUSH(refValue(future));                                                                        \
   }
 
-  // Setup state.
-  auto stack      = BasicStack{};
-  auto execHandle = ExecutorHandle{&stack};
-  execRegistry->registerExecutor(&execHandle);
+#define ALLOC_SITE() heapAllocSite = instr
+#define SAMPLE()                                                                                   \
+  if (unlikely(execHandle.takeSampleRequest())) {                                                  \
+    settings.profiler->sample(instr, sh, rootSh);                                                  \
+  }
 
-  // If we are given a promise to fill then push it on the stack, its important to be on the stack
-  // so the garbage collector can 'see' it. We place the promise one position before the root
-  // stack-home to make it invisible to the running assembly.
-  if (promise) {
-    stack.push(refValue(promise));
+#if defined(VM_THREADED_DISPATCH)
+#define OP(NAME) Op##NAME:
+#define OP_INVALID() OpInvalid:
+#define OP_JIT_ENTER() OpJitEnter:
+#define NEXT()                                                                                     \
+  {                                                                                                \
+    instr = ip++;                                                                                  \
+    goto* dispatchTable[static_cast<uint8_t>(instr->opCode)];                                      \
   }
-  const uint8_t* ip = assembly->getIp(entryIpOffset); // Current instruction-pointer.
-  Value* sh     = stack.getNext(); // Current 'home' for this stack-frame, used to store variables.
-  Value* rootSh = sh;
-
-  // Push the entry args on the stack (if any), these are available at the root stack-home.
-  if (entryArgSource && entryArgCount > 0) {
-    SALLOC(entryArgCount);
-    std::memcpy(sh, entryArgSource, sizeof(Value) * entryArgCount);
+#else // !VM_THREADED_DISPATCH
+#define OP(NAME) case static_cast<uint8_t>(OpCode::NAME):
+#define OP_INVALID() default:
+#define OP_JIT_ENTER() case static_cast<uint8_t>(jitEnterOpCode):
+#define NEXT() break
+#endif
+
+  const auto& settings = executor->settings;
+  const auto* assembly = executor->assembly;
+  auto* iface          = executor->iface;
+  auto* execRegistry   = executor->execRegistry;
+  auto* refAlloc       = executor->refAlloc;
+  auto* promise        = executor->promise;
+  auto& stack          = executor->stack;
+  auto& execHandle     = executor->handle;
+
+  const Instruction* ip    = executor->ip; // Current instruction-pointer.
+  const Instruction* instr = nullptr;      // Instruction that is currently being executed.
+  Value* sh     = executor->sh; // Current 'home' for this stack-frame, used to store variables.
+  Value* rootSh = executor->rootSh;
+
+  // Wait if the executors are paused (or abort if the program is shutting down).
+  if (unlikely(execHandle.trap())) {
+    goto End;
   }
 
-  if (promise) {
-    // Signal that we've started running the promise, this also tells to outside that we are done
-    // with accessing the entry arguments and have properly placed the future on our stack.
-    promise->getStarted().store(true, std::memory_order_release);
+  // Setup the root stack-frame, unless the executor is resumed after being suspended.
+  if (sh == nullptr) {
+    if (unlikely(stack.grow(stack.getNext(), 1U) == nullptr)) {
+      execHandle.setState(ExecState::StackOverflow);
+      goto End;
+    }
+
+    // If we are given a promise to fill then push it on the stack, its important to be on the
+    // stack so the garbage collector can 'see' it. We place the promise one position before the
+    // root stack-home to make it invisible to the running assembly.
+    // Note: The root stack-frame always starts with this value, for the main executor its empty.
+    stack.push(promise ? refValue(promise) : nullRefValue());
+    sh     = stack.getNext();
+    rootSh = sh;
+
+    if (promise) {
+      // Take the entry args from the promise (if any), these are available at the root stack-home.
+      const auto args = promise->getArgs();
+      if (!args.isNullRef()) {
+        auto* argsStruct = getStructRef(args);
+        SALLOC(argsStruct->getFieldCount());
+        std::memcpy(
+            sh, argsStruct->getFieldsBegin(), sizeof(Value) * argsStruct->getFieldCount());
+        refAlloc->writeBarrier(promise, args, nullRefValue());
+        promise->setArgs(nullRefValue());
+      }
+
+      // Now that the promise is on our stack the registry does not need to keep it alive anymore.
+      execRegistry->unregisterFork(promise);
+    }
   }
 
+#if defined(VM_THREADED_DISPATCH)
+  /* Table of handler labels, indexed by op-code. Unknown op-codes are dispatched to the 'invalid'
+  handler which fails the executor (same as the 'default' case of the switch dispatch). The label
+  addresses are the same for every call, so the table is only created once. */
+#define REGISTER_OP(NAME) {OpCode::NAME, &&Op##NAME}
+  static const auto dispatchTable = makeDispatchTable(
+      &&OpInvalid,
+      {
+          REGISTER_OP(LoadLitInt),
+          REGISTER_OP(LoadLitLong),
+          REGISTER_OP(LoadLitFloat),
+          REGISTER_OP(LoadLitString),
+          REGISTER_OP(LoadLitIp),
+          REGISTER_OP(StackAlloc),
+          REGISTER_OP(StackStore),
+          REGISTER_OP(StackLoad),
+          REGISTER_OP(StackLoadStructField),
+          REGISTER_OP(AddInt),
+          REGISTER_OP(AddIntLit),
+          REGISTER_OP(StackAddInt),
+          REGISTER_OP(StackSubInt),
+          REGISTER_OP(StackMulInt),
+          REGISTER_OP(StackAddFloat),
+          REGISTER_OP(StackSubFloat),
+          REGISTER_OP(StackMulFloat),
+          REGISTER_OP(StackDivFloat),
+          REGISTER_OP(StackCheckEqInt),
+          REGISTER_OP(StackCheckGtInt),
+          REGISTER_OP(StackCheckLeInt),
+          REGISTER_OP(StackCheckGtFloat),
+          REGISTER_OP(StackCheckLeFloat),
+          REGISTER_OP(StackAddIntStore),
+          REGISTER_OP(StackSubIntStore),
+          REGISTER_OP(StackMulIntStore),
+          REGISTER_OP(StackAddFloatStore),
+          REGISTER_OP(StackSubFloatStore),
+          REGISTER_OP(StackMulFloatStore),
+          REGISTER_OP(StackDivFloatStore),
+          REGISTER_OP(AddLong),
+          REGISTER_OP(AddFloat),
+          REGISTER_OP(AddString),
+          REGISTER_OP(CombineChar),
+          REGISTER_OP(AppendChar),
+          REGISTER_OP(SubInt),
+          REGISTER_OP(SubLong),
+          REGISTER_OP(SubFloat),
+          REGISTER_OP(MulInt),
+          REGISTER_OP(MulLong),
+          REGISTER_OP(MulFloat),
+          REGISTER_OP(DivInt),
+          REGISTER_OP(DivLong),
+          REGISTER_OP(DivFloat),
+          REGISTER_OP(RemInt),
+          REGISTER_OP(RemLong),
+          REGISTER_OP(ModFloat),
+          REGISTER_OP(PowFloat),
+          REGISTER_OP(SqrtFloat),
+          REGISTER_OP(SinFloat),
+          REGISTER_OP(CosFloat),
+          REGISTER_OP(TanFloat),
+          REGISTER_OP(ASinFloat),
+          REGISTER_OP(ACosFloat),
+          REGISTER_OP(ATanFloat),
+          REGISTER_OP(ATan2Float),
+          REGISTER_OP(NegInt),
+          REGISTER_OP(NegLong),
+          REGISTER_OP(NegFloat),
+          REGISTER_OP(LogicInvInt),
+          REGISTER_OP(ShiftLeftInt),
+          REGISTER_OP(ShiftRightInt),
+          REGISTER_OP(AndInt),
+          REGISTER_OP(OrInt),
+          REGISTER_OP(XorInt),
+          REGISTER_OP(InvInt),
+          REGISTER_OP(LengthString),
+          REGISTER_OP(IndexString),
+          REGISTER_OP(SliceString),
+          REGISTER_OP(IndexOfString),
+          REGISTER_OP(IndexOfLastString),
+          REGISTER_OP(IndexOfAnyString),
+          REGISTER_OP(SpanString),
+          REGISTER_OP(StartsWithString),
+          REGISTER_OP(LengthArray),
+          REGISTER_OP(IndexArray),
+          REGISTER_OP(SliceArray),
+          REGISTER_OP(AddArray),
+          REGISTER_OP(CheckEqInt),
+          REGISTER_OP(CheckEqLong),
+          REGISTER_OP(CheckEqFloat),
+          REGISTER_OP(CheckEqString),
+          REGISTER_OP(CheckEqIp),
+          REGISTER_OP(CheckEqCallDynTgt),
+          REGISTER_OP(CheckGtInt),
+          REGISTER_OP(CheckGtLong),
+          REGISTER_OP(CheckGtFloat),
+          REGISTER_OP(CheckLeInt),
+          REGISTER_OP(CheckLeLong),
+          REGISTER_OP(CheckLeFloat),
+          REGISTER_OP(CheckStructNull),
+          REGISTER_OP(ConvIntLong),
+          REGISTER_OP(ConvIntFloat),
+          REGISTER_OP(ConvLongInt),
+          REGISTER_OP(ConvLongFloat),
+          REGISTER_OP(ConvFloatInt),
+          REGISTER_OP(ConvIntString),
+          REGISTER_OP(ConvLongString),
+          REGISTER_OP(ConvFloatString),
+          REGISTER_OP(ConvCharString),
+          REGISTER_OP(ConvIntChar),
+          REGISTER_OP(ConvFloatChar),
+          REGISTER_OP(ConvFloatLong),
+          REGISTER_OP(MakeStruct),
+          REGISTER_OP(MakeNullStruct),
+          REGISTER_OP(StructLoadField),
+          REGISTER_OP(StructStoreField),
+          REGISTER_OP(StructPeekField),
+          REGISTER_OP(MakeArray),
+          REGISTER_OP(MakeArrayList),
+          REGISTER_OP(AllocArray),
+          REGISTER_OP(ArrayStore),
+          REGISTER_OP(Jump),
+          REGISTER_OP(JumpIf),
+          REGISTER_OP(CheckEqIntJumpIf),
+          REGISTER_OP(StructPeekFieldJumpIf),
+          REGISTER_OP(Call),
+          REGISTER_OP(CallTail),
+          REGISTER_OP(CallForked),
+          REGISTER_OP(CallDyn),
+          REGISTER_OP(CallDynTail),
+          REGISTER_OP(CallDynForked),
+          REGISTER_OP(PCall),
+          REGISTER_OP(Ret),
+          REGISTER_OP(FutureWaitNano),
+          REGISTER_OP(FutureBlock),
+          REGISTER_OP(Dup),
+          REGISTER_OP(Pop),
+          REGISTER_OP(Swap),
+          REGISTER_OP(Fail),
+          {jitEnterOpCode, &&OpJitEnter},
+      });
+#undef REGISTER_OP
+
+  // Start executing instructions.
+  NEXT();
+#else // !VM_THREADED_DISPATCH
   // Start executing instructions.
   while (true) {
-    switch (readAsm<OpCode>(&ip)) {
-    case OpCode::LoadLitInt: {
-      PUSH_INT(READ_INT());
-    } break;
-    case OpCode::LoadLitIntSmall: {
-      PUSH_INT(READ_BYTE());
-    } break;
-    case OpCode::LoadLitInt0: {
-      PUSH_INT(0);
-    } break;
-    case OpCode::LoadLitInt1: {
-      PUSH_INT(1);
-    } break;
-    case OpCode::LoadLitLong: {
-      PUSH_LONG(READ_LONG());
-    } break;
-    case OpCode::LoadLitFloat: {
-      PUSH_FLOAT(READ_FLOAT());
-    } break;
-    case OpCode::LoadLitString: {
-      const auto& litStr = assembly->getLitString(READ_UINT());
-      PUSH_REF(refAlloc->allocStrLit(litStr));
-    } break;
-    case OpCode::LoadLitIp: {
-      PUSH_UINT(READ_UINT());
-    } break;
-
-    case OpCode::StackAlloc: {
-      const auto amount = READ_BYTE();
+    instr = ip++;
+    switch (static_cast<uint8_t>(instr->opCode)) {
+#endif
+    OP(LoadLitInt) {
+      // Note: The small int literal variants are all decoded to this instruction.
+      PUSH_INT(instr->intArg);
+    }
+    NEXT();
+    OP(LoadLitLong) {
+      ALLOC_SITE();
+      PUSH_LONG(instr->longArg);
+    }
+    NEXT();
+    OP(LoadLitFloat) {
+      PUSH_FLOAT(instr->floatArg);
+    }
+    NEXT();
+    OP(LoadLitString) {
+      PUSH_REF(instr->litString);
+    }
+    NEXT();
+    OP(LoadLitIp) {
+      PUSH(rawPtrValue(instr->target));
+    }
+    NEXT();
+
+    OP(StackAlloc) {
+      const auto amount = instr->argA;
       assert(amount > 0);
       SALLOC(amount);
 
@@ -316,25 +532,120 @@ auto execute(
       // require the program to actually write to this memory. So to avoid the garbage-collector
       // interpreting random memory (or mem from a previous call) as pointers we need to clear it.
       std::memset(stack.getNext() - amount, 0, sizeof(Value) * amount);
-    } break;
-    case OpCode::StackStore: {
-      *(sh + READ_BYTE()) = stack.pop();
-    } break;
-    case OpCode::StackLoad: {
-      PUSH(*(sh + READ_BYTE()));
-    } break;
-
-    case OpCode::AddInt: {
+    }
+    NEXT();
+    OP(StackStore) {
+      *(sh + instr->argA) = stack.pop();
+    }
+    NEXT();
+    OP(StackLoad) {
+      PUSH(*(sh + instr->argA));
+    }
+    NEXT();
+    OP(StackLoadStructField) {
+      auto* structure = getStructRef(*(sh + instr->argA));
+      PUSH(structure->getField(instr->argB));
+    }
+    NEXT();
+
+    OP(AddInt) {
       PUSH_INT(POP_INT() + POP_INT());
-    } break;
-    case OpCode::AddLong: {
+    }
+    NEXT();
+    OP(AddIntLit) {
+      // Modify the value on the top of the stack in-place, saves a pop and (bounds checked) push.
+      auto* top = stack.getTop();
+      *top      = intValue(top->getInt() + instr->intArg);
+    }
+    NEXT();
+    OP(StackAddInt) {
+      PUSH_INT(SLOT_INT(instr->argA) + SLOT_INT(instr->argB));
+    }
+    NEXT();
+    OP(StackSubInt) {
+      PUSH_INT(SLOT_INT(instr->argA) - SLOT_INT(instr->argB));
+    }
+    NEXT();
+    OP(StackMulInt) {
+      PUSH_INT(SLOT_INT(instr->argA) * SLOT_INT(instr->argB));
+    }
+    NEXT();
+    OP(StackAddFloat) {
+      PUSH_FLOAT(SLOT_FLOAT(instr->argA) + SLOT_FLOAT(instr->argB));
+    }
+    NEXT();
+    OP(StackSubFloat) {
+      PUSH_FLOAT(SLOT_FLOAT(instr->argA) - SLOT_FLOAT(instr->argB));
+    }
+    NEXT();
+    OP(StackMulFloat) {
+      PUSH_FLOAT(SLOT_FLOAT(instr->argA) * SLOT_FLOAT(instr->argB));
+    }
+    NEXT();
+    OP(StackDivFloat) {
+      PUSH_FLOAT(SLOT_FLOAT(instr->argA) / SLOT_FLOAT(instr->argB));
+    }
+    NEXT();
+    OP(StackCheckEqInt) {
+      PUSH_BOOL(SLOT_INT(instr->argA) == SLOT_INT(instr->argB));
+    }
+    NEXT();
+    OP(StackCheckGtInt) {
+      PUSH_BOOL(SLOT_INT(instr->argA) > SLOT_INT(instr->argB));
+    }
+    NEXT();
+    OP(StackCheckLeInt) {
+      PUSH_BOOL(SLOT_INT(instr->argA) < SLOT_INT(instr->argB));
+    }
+    NEXT();
+    OP(StackCheckGtFloat) {
+      PUSH_BOOL(SLOT_FLOAT(instr->argA) > SLOT_FLOAT(instr->argB));
+    }
+    NEXT();
+    OP(StackCheckLeFloat) {
+      PUSH_BOOL(SLOT_FLOAT(instr->argA) < SLOT_FLOAT(instr->argB));
+    }
+    NEXT();
+    OP(StackAddIntStore) {
+      SLOT(instr->argC) = intValue(SLOT_INT(instr->argA) + SLOT_INT(instr->argB));
+    }
+    NEXT();
+    OP(StackSubIntStore) {
+      SLOT(instr->argC) = intValue(SLOT_INT(instr->argA) - SLOT_INT(instr->argB));
+    }
+    NEXT();
+    OP(StackMulIntStore) {
+      SLOT(instr->argC) = intValue(SLOT_INT(instr->argA) * SLOT_INT(instr->argB));
+    }
+    NEXT();
+    OP(StackAddFloatStore) {
+      SLOT(instr->argC) = floatValue(SLOT_FLOAT(instr->argA) + SLOT_FLOAT(instr->argB));
+    }
+    NEXT();
+    OP(StackSubFloatStore) {
+      SLOT(instr->argC) = floatValue(SLOT_FLOAT(instr->argA) - SLOT_FLOAT(instr->argB));
+    }
+    NEXT();
+    OP(StackMulFloatStore) {
+      SLOT(instr->argC) = floatValue(SLOT_FLOAT(instr->argA) * SLOT_FLOAT(instr->argB));
+    }
+    NEXT();
+    OP(StackDivFloatStore) {
+      SLOT(instr->argC) = floatValue(SLOT_FLOAT(instr->argA) / SLOT_FLOAT(instr->argB));
+    }
+    NEXT();
+    OP(AddLong) {
+      ALLOC_SITE();
       const auto val = getLong(POP()) + getLong(POP());
       PUSH_LONG(val);
-    } break;
-    case OpCode::AddFloat: {
+    }
+    NEXT();
+    OP(AddFloat) {
       PUSH_FLOAT(POP_FLOAT() + POP_FLOAT());
-    } break;
-    case OpCode::AddString: {
+    }
+    NEXT();
+    OP(AddString) {
+      ALLOC_SITE();
       auto* b = getStringRef(refAlloc, POP());
       CHECK_ALLOC(b);
 
@@ -345,49 +656,62 @@ auto execute(
       // to the end). Support for building up strings backwards is possible but not implemented atm.
 
       auto* a = getStringOrLinkRef(POP());
-      PUSH_REF(refAlloc->allocStrLink(a, refValue(b)));
-    } break;
-    case OpCode::CombineChar: {
+      PUSH_REF(appendStringLink(refAlloc, a, b));
+    }
+    NEXT();
+    OP(CombineChar) {
+      ALLOC_SITE();
       auto b = static_cast<uint8_t>(POP_INT());
       auto a = static_cast<uint8_t>(POP_INT());
       PUSH_REF(charsToString(refAlloc, a, b));
-    } break;
-    case OpCode::AppendChar: {
-      auto b  = POP_INT();
+    }
+    NEXT();
+    OP(AppendChar) {
+      ALLOC_SITE();
+      auto b  = static_cast<uint8_t>(POP_INT());
       auto* a = getStringOrLinkRef(POP());
-      PUSH_REF(refAlloc->allocStrLink(a, intValue(b)));
-    } break;
-    case OpCode::SubInt: {
+      PUSH_REF(appendCharLink(refAlloc, a, b));
+    }
+    NEXT();
+    OP(SubInt) {
       auto b = POP_INT();
       auto a = POP_INT();
       PUSH_INT(a - b);
-    } break;
-    case OpCode::SubLong: {
+    }
+    NEXT();
+    OP(SubLong) {
+      ALLOC_SITE();
       auto b = getLong(POP());
       auto a = getLong(POP());
       PUSH_LONG(a - b);
-    } break;
-    case OpCode::SubFloat: {
+    }
+    NEXT();
+    OP(SubFloat) {
       auto b = POP_FLOAT();
       auto a = POP_FLOAT();
       PUSH_FLOAT(a - b);
-    } break;
-    case OpCode::MulInt: {
+    }
+    NEXT();
+    OP(MulInt) {
       auto b = POP_INT();
       auto a = POP_INT();
       PUSH_INT(a * b);
-    } break;
-    case OpCode::MulLong: {
+    }
+    NEXT();
+    OP(MulLong) {
+      ALLOC_SITE();
       auto b = getLong(POP());
       auto a = getLong(POP());
       PUSH_LONG(a * b);
-    } break;
-    case OpCode::MulFloat: {
+    }
+    NEXT();
+    OP(MulFloat) {
       auto b = POP_FLOAT();
       auto a = POP_FLOAT();
       PUSH_FLOAT(a * b);
-    } break;
-    case OpCode::DivInt: {
+    }
+    NEXT();
+    OP(DivInt) {
       auto b = POP_INT();
       auto a = POP_INT();
       if (unlikely(b == 0)) {
@@ -395,8 +719,10 @@ auto execute(
         goto End;
       }
       PUSH_INT(a / b);
-    } break;
-    case OpCode::DivLong: {
+    }
+    NEXT();
+    OP(DivLong) {
+      ALLOC_SITE();
       auto b = getLong(POP());
       auto a = getLong(POP());
       if (unlikely(b == 0)) {
@@ -404,13 +730,15 @@ auto execute(
         goto End;
       }
       PUSH_LONG(a / b);
-    } break;
-    case OpCode::DivFloat: {
+    }
+    NEXT();
+    OP(DivFloat) {
       auto b = POP_FLOAT();
       auto a = POP_FLOAT();
       PUSH_FLOAT(a / b);
-    } break;
-    case OpCode::RemInt: {
+    }
+    NEXT();
+    OP(RemInt) {
       auto b = POP_INT();
       auto a = POP_INT();
       if (unlikely(b == 0)) {
@@ -418,8 +746,10 @@ auto execute(
         goto End;
       }
       PUSH_INT(a % b);
-    } break;
-    case OpCode::RemLong: {
+    }
+    NEXT();
+    OP(RemLong) {
+      ALLOC_SITE();
       auto b = getLong(POP());
       auto a = getLong(POP());
       if (unlikely(b == 0)) {
@@ -427,118 +757,227 @@ auto execute(
         goto End;
       }
       PUSH_LONG(a % b);
-    } break;
-    case OpCode::ModFloat: {
+    }
+    NEXT();
+    OP(ModFloat) {
       auto b = POP_FLOAT();
       auto a = POP_FLOAT();
       PUSH_FLOAT(fmodf(a, b));
-    } break;
-    case OpCode::PowFloat: {
+    }
+    NEXT();
+    OP(PowFloat) {
       auto b = POP_FLOAT();
       auto a = POP_FLOAT();
       PUSH_FLOAT(powf(a, b));
-    } break;
-    case OpCode::SqrtFloat: {
+    }
+    NEXT();
+    OP(SqrtFloat) {
       PUSH_FLOAT(sqrtf(POP_FLOAT()));
-    } break;
-    case OpCode::SinFloat: {
+    }
+    NEXT();
+    OP(SinFloat) {
       PUSH_FLOAT(sinf(POP_FLOAT()));
-    } break;
-    case OpCode::CosFloat: {
+    }
+    NEXT();
+    OP(CosFloat) {
       PUSH_FLOAT(cosf(POP_FLOAT()));
-    } break;
-    case OpCode::TanFloat: {
+    }
+    NEXT();
+    OP(TanFloat) {
       PUSH_FLOAT(tanf(POP_FLOAT()));
-    } break;
-    case OpCode::ASinFloat: {
+    }
+    NEXT();
+    OP(ASinFloat) {
       PUSH_FLOAT(asinf(POP_FLOAT()));
-    } break;
-    case OpCode::ACosFloat: {
+    }
+    NEXT();
+    OP(ACosFloat) {
       PUSH_FLOAT(acosf(POP_FLOAT()));
-    } break;
-    case OpCode::ATanFloat: {
+    }
+    NEXT();
+    OP(ATanFloat) {
       PUSH_FLOAT(atanf(POP_FLOAT()));
-    } break;
-    case OpCode::ATan2Float: {
+    }
+    NEXT();
+    OP(ATan2Float) {
       auto b = POP_FLOAT();
       auto a = POP_FLOAT();
       PUSH_FLOAT(atan2f(a, b));
-    } break;
-    case OpCode::NegInt: {
+    }
+    NEXT();
+    OP(NegInt) {
       PUSH_INT(-POP_INT());
-    } break;
-    case OpCode::NegLong: {
+    }
+    NEXT();
+    OP(NegLong) {
+      ALLOC_SITE();
       PUSH_LONG(-getLong(POP()));
-    } break;
-    case OpCode::NegFloat: {
+    }
+    NEXT();
+    OP(NegFloat) {
       PUSH_FLOAT(-POP_FLOAT());
-    } break;
-    case OpCode::LogicInvInt: {
+    }
+    NEXT();
+    OP(LogicInvInt) {
       PUSH_BOOL(POP_INT() == 0);
-    } break;
-    case OpCode::ShiftLeftInt: {
+    }
+    NEXT();
+    OP(ShiftLeftInt) {
       auto b = POP_UINT();
       auto a = POP_UINT();
       PUSH_UINT(a << b);
-    } break;
-    case OpCode::ShiftRightInt: {
+    }
+    NEXT();
+    OP(ShiftRightInt) {
       auto b = POP_UINT();
       auto a = POP_UINT();
       PUSH_UINT(a >> b);
-    } break;
-    case OpCode::AndInt: {
+    }
+    NEXT();
+    OP(AndInt) {
       auto b = POP_UINT();
       auto a = POP_UINT();
       PUSH_UINT(a & b);
-    } break;
-    case OpCode::OrInt: {
+    }
+    NEXT();
+    OP(OrInt) {
       auto b = POP_UINT();
       auto a = POP_UINT();
       PUSH_UINT(a | b);
-    } break;
-    case OpCode::XorInt: {
+    }
+    NEXT();
+    OP(XorInt) {
       auto b = POP_UINT();
       auto a = POP_UINT();
       PUSH_UINT(a ^ b);
-    } break;
-    case OpCode::InvInt: {
+    }
+    NEXT();
+    OP(InvInt) {
       PUSH_UINT(~POP_UINT());
-    } break;
-    case OpCode::LengthString: {
-      auto* strRef = getStringRef(refAlloc, POP());
-      CHECK_ALLOC(strRef);
-      PUSH_INT(strRef->getSize());
-    } break;
-    case OpCode::IndexString: {
+    }
+    NEXT();
+    OP(LengthString) {
+      // String-links know the size of their chain, so no need to collapse them.
+      PUSH_INT(getStringOrLinkSize(getStringOrLinkRef(POP())));
+    }
+    NEXT();
+    OP(IndexString) {
+      ALLOC_SITE();
       auto index   = POP_INT();
       auto* strRef = getStringRef(refAlloc, POP());
       CHECK_ALLOC(strRef);
       PUSH_INT(indexString(strRef, index));
-    } break;
-    case OpCode::SliceString: {
+    }
+    NEXT();
+    OP(SliceString) {
+      ALLOC_SITE();
       auto end     = POP_INT();
       auto start   = POP_INT();
       auto* strRef = getStringRef(refAlloc, POP());
       CHECK_ALLOC(strRef);
       PUSH_REF(sliceString(refAlloc, strRef, start, end));
-    } break;
+    }
+    NEXT();
+    OP(IndexOfString) {
+      ALLOC_SITE();
+      auto start   = POP_INT();
+      auto* subRef = getStringRef(refAlloc, POP());
+      CHECK_ALLOC(subRef);
+      auto* strRef = getStringRef(refAlloc, POP());
+      CHECK_ALLOC(strRef);
+      PUSH_INT(indexOfString(strRef, subRef, start));
+    }
+    NEXT();
+    OP(IndexOfLastString) {
+      ALLOC_SITE();
+      auto start   = POP_INT();
+      auto* subRef = getStringRef(refAlloc, POP());
+      CHECK_ALLOC(subRef);
+      auto* strRef = getStringRef(refAlloc, POP());
+      CHECK_ALLOC(strRef);
+      PUSH_INT(indexOfLastString(strRef, subRef, start));
+    }
+    NEXT();
+    OP(IndexOfAnyString) {
+      ALLOC_SITE();
+      auto start   = POP_INT();
+      auto* subRef = getStringRef(refAlloc, POP());
+      CHECK_ALLOC(subRef);
+      auto* strRef = getStringRef(refAlloc, POP());
+      CHECK_ALLOC(strRef);
+      PUSH_INT(indexOfAnyString(strRef, subRef, start));
+    }
+    NEXT();
+    OP(SpanString) {
+      ALLOC_SITE();
+      auto start   = POP_INT();
+      auto* subRef = getStringRef(refAlloc, POP());
+      CHECK_ALLOC(subRef);
+      auto* strRef = getStringRef(refAlloc, POP());
+      CHECK_ALLOC(strRef);
+      PUSH_INT(spanString(strRef, subRef, start));
+    }
+    NEXT();
+    OP(StartsWithString) {
+      ALLOC_SITE();
+      auto start   = POP_INT();
+      auto* subRef = getStringRef(refAlloc, POP());
+      CHECK_ALLOC(subRef);
+      auto* strRef = getStringRef(refAlloc, POP());
+      CHECK_ALLOC(strRef);
+      PUSH_BOOL(startsWithString(strRef, subRef, start));
+    }
+    NEXT();
+    OP(LengthArray) {
+      PUSH_UINT(getArrayRef(POP())->getSize());
+    }
+    NEXT();
+    OP(IndexArray) {
+      auto index     = POP_INT();
+      auto* arrayRef = getArrayRef(POP());
+      if (unlikely(index < 0 || static_cast<unsigned>(index) >= arrayRef->getSize())) {
+        execHandle.setState(ExecState::IndexOutOfBounds);
+        goto End;
+      }
+      PUSH(arrayRef->getValue(static_cast<unsigned>(index)));
+    }
+    NEXT();
+    OP(SliceArray) {
+      ALLOC_SITE();
+      auto end       = POP_INT();
+      auto start     = POP_INT();
+      auto* arrayRef = getArrayRef(POP());
+      PUSH_REF(sliceArray(refAlloc, arrayRef, start, end));
+    }
+    NEXT();
+    OP(AddArray) {
+      ALLOC_SITE();
+      auto* b = getArrayRef(POP());
+      auto* a = getArrayRef(POP());
+      PUSH_REF(concatArray(refAlloc, a, b));
+    }
+    NEXT();
 
-    case OpCode::CheckEqInt: {
+    OP(CheckEqInt) {
       auto b = POP_INT();
       auto a = POP_INT();
       PUSH_BOOL(a == b);
-    } break;
-    case OpCode::CheckEqLong: {
+    }
+    NEXT();
+    OP(CheckEqLong) {
       auto b = getLong(POP());
       auto a = getLong(POP());
       PUSH_BOOL(a == b);
-    } break;
-    case OpCode::CheckEqFloat: {
+    }
+    NEXT();
+    OP(CheckEqFloat) {
       auto b = POP_FLOAT();
       auto a = POP_FLOAT();
       PUSH_BOOL(a == b);
-    } break;
-    case OpCode::CheckEqString: {
+    }
+    NEXT();
+    OP(CheckEqString) {
+      ALLOC_SITE();
       auto* bStrRef = getStringRef(refAlloc, POP());
       CHECK_ALLOC(bStrRef);
 
@@ -546,95 +985,124 @@ auto execute(
       CHECK_ALLOC(aStrRef);
 
       PUSH_BOOL(checkStringEq(aStrRef, bStrRef));
-    } break;
-    case OpCode::CheckEqIp: {
-      auto b = POP_UINT();
-      auto a = POP_UINT();
+    }
+    NEXT();
+    OP(CheckEqIp) {
+      auto* b = POP().getRawPtr<const Instruction>();
+      auto* a = POP().getRawPtr<const Instruction>();
       PUSH_BOOL(a == b);
-    } break;
-    case OpCode::CheckEqCallDynTgt: {
+    }
+    NEXT();
+    OP(CheckEqCallDynTgt) {
       // Compare the target instruction pointers (which for closure structs are stored in the last
       // field). Note: This does not compare bound arguments in a closure struct, main reason is
       // that we have no type information for those.
-      auto b   = POP();
-      auto bIp = (b.isRef() ? getStructRef(b)->getLastField() : b).getUInt();
-      auto a   = POP();
-      auto aIp = (a.isRef() ? getStructRef(a)->getLastField() : a).getUInt();
+      auto b    = POP();
+      auto* bIp = (b.isRef() ? getStructRef(b)->getLastField() : b).getRawPtr<const Instruction>();
+      auto a    = POP();
+      auto* aIp = (a.isRef() ? getStructRef(a)->getLastField() : a).getRawPtr<const Instruction>();
       PUSH_BOOL(aIp == bIp);
-    } break;
-    case OpCode::CheckGtInt: {
+    }
+    NEXT();
+    OP(CheckGtInt) {
       auto b = POP_INT();
       auto a = POP_INT();
       PUSH_BOOL(a > b);
-    } break;
-    case OpCode::CheckGtLong: {
+    }
+    NEXT();
+    OP(CheckGtLong) {
       auto b = getLong(POP());
       auto a = getLong(POP());
       PUSH_BOOL(a > b);
-    } break;
-    case OpCode::CheckGtFloat: {
+    }
+    NEXT();
+    OP(CheckGtFloat) {
       auto b = POP_FLOAT();
       auto a = POP_FLOAT();
       PUSH_BOOL(a > b);
-    } break;
-    case OpCode::CheckLeInt: {
+    }
+    NEXT();
+    OP(CheckLeInt) {
       auto b = POP_INT();
       auto a = POP_INT();
       PUSH_BOOL(a < b);
-    } break;
-    case OpCode::CheckLeLong: {
+    }
+    NEXT();
+    OP(CheckLeLong) {
       auto b = getLong(POP());
       auto a = getLong(POP());
       PUSH_BOOL(a < b);
-    } break;
-    case OpCode::CheckLeFloat: {
+    }
+    NEXT();
+    OP(CheckLeFloat) {
       auto b = POP_FLOAT();
       auto a = POP_FLOAT();
       PUSH_BOOL(a < b);
-    } break;
-    case OpCode::CheckStructNull: {
+    }
+    NEXT();
+    OP(CheckStructNull) {
       PUSH_BOOL(POP().isNullRef());
-    } break;
+    }
+    NEXT();
 
-    case OpCode::ConvIntLong: {
+    OP(ConvIntLong) {
+      ALLOC_SITE();
       PUSH_LONG(static_cast<int64_t>(POP_INT()));
-    } break;
-    case OpCode::ConvIntFloat: {
+    }
+    NEXT();
+    OP(ConvIntFloat) {
       PUSH_FLOAT(static_cast<float>(POP_INT()));
-    } break;
-    case OpCode::ConvLongInt: {
+    }
+    NEXT();
+    OP(ConvLongInt) {
       PUSH_INT(static_cast<int32_t>(getLong(POP())));
-    } break;
-    case OpCode::ConvLongFloat: {
+    }
+    NEXT();
+    OP(ConvLongFloat) {
       PUSH_FLOAT(static_cast<float>(getLong(POP())));
-    } break;
-    case OpCode::ConvFloatInt: {
+    }
+    NEXT();
+    OP(ConvFloatInt) {
       PUSH_INT(static_cast<int32_t>(POP_FLOAT()));
-    } break;
-    case OpCode::ConvIntString: {
+    }
+    NEXT();
+    OP(ConvIntString) {
+      ALLOC_SITE();
       PUSH_REF(intToString(refAlloc, POP_INT()));
-    } break;
-    case OpCode::ConvLongString: {
+    }
+    NEXT();
+    OP(ConvLongString) {
+      ALLOC_SITE();
       PUSH_REF(intToString(refAlloc, getLong(POP())));
-    } break;
-    case OpCode::ConvFloatString: {
+    }
+    NEXT();
+    OP(ConvFloatString) {
+      ALLOC_SITE();
       PUSH_REF(floatToString(refAlloc, POP_FLOAT()));
-    } break;
-    case OpCode::ConvCharString: {
+    }
+    NEXT();
+    OP(ConvCharString) {
+      ALLOC_SITE();
       PUSH_REF(charToString(refAlloc, static_cast<uint8_t>(POP_INT())));
-    } break;
-    case OpCode::ConvIntChar: {
+    }
+    NEXT();
+    OP(ConvIntChar) {
       PUSH_INT(static_cast<uint8_t>(POP_INT()));
-    } break;
-    case OpCode::ConvFloatChar: {
+    }
+    NEXT();
+    OP(ConvFloatChar) {
       PUSH_INT(static_cast<uint8_t>(POP_FLOAT()));
-    } break;
-    case OpCode::ConvFloatLong: {
+    }
+    NEXT();
+    OP(ConvFloatLong) {
+      ALLOC_SITE();
       PUSH_LONG(static_cast<int64_t>(POP_FLOAT()));
-    } break;
+    }
+    NEXT();
 
-    case OpCode::MakeStruct: {
-      const auto fieldCount = READ_BYTE();
+    OP(MakeStruct) {
+      ALLOC_SITE();
+      const auto fieldCount = instr->argA;
       assert(fieldCount > 0);
 
       auto structRef = refAlloc->allocStruct(fieldCount);
@@ -648,103 +1116,206 @@ auto execute(
         *structRef->getFieldPtr(fieldIndex) = POP();
       }
       PUSH_REF(structRef);
-    } break;
-    case OpCode::MakeNullStruct: {
+    }
+    NEXT();
+    OP(MakeNullStruct) {
       PUSH(nullRefValue());
-    } break;
-    case OpCode::StructLoadField: {
-      const auto fieldIndex = READ_BYTE();
+    }
+    NEXT();
+    OP(StructLoadField) {
+      const auto fieldIndex = instr->argA;
       auto* structure       = getStructRef(POP());
       PUSH(structure->getField(fieldIndex));
-    } break;
-    case OpCode::StructStoreField: {
-      const auto fieldIndex               = READ_BYTE();
-      auto val                            = POP();
-      auto* structure                     = getStructRef(POP());
-      *structure->getFieldPtr(fieldIndex) = val;
-    } break;
-
-    case OpCode::Jump: {
-      ip = assembly->getIp(READ_UINT());
-    } break;
-    case OpCode::JumpIf: {
-      auto ipOffset = READ_UINT();
+    }
+    NEXT();
+    OP(StructStoreField) {
+      const auto fieldIndex = instr->argA;
+      auto val              = POP();
+      auto* structure       = getStructRef(POP());
+      auto* fieldPtr        = structure->getFieldPtr(fieldIndex);
+      refAlloc->writeBarrier(structure, *fieldPtr, val);
+      *fieldPtr = val;
+    }
+    NEXT();
+    OP(StructPeekField) {
+      auto* structure = getStructRef(PEEK());
+      PUSH(structure->getField(instr->argA));
+    }
+    NEXT();
+
+    OP(MakeArray) {
+      ALLOC_SITE();
+      const auto count = POP_UINT();
+
+      auto* arrayRef = refAlloc->allocArray(count);
+      CHECK_ALLOC(arrayRef);
+
+      // Values are in order on the stack (the first value is the deepest).
+      auto* valuesBegin = stack.getNext() - count;
+      std::copy(valuesBegin, stack.getNext(), arrayRef->getValuesBegin());
+      stack.rewindToNext(valuesBegin);
+      PUSH_REF(arrayRef);
+    }
+    NEXT();
+    OP(MakeArrayList) {
+      ALLOC_SITE();
+      PUSH_REF(listToArray(refAlloc, POP()));
+    }
+    NEXT();
+    OP(AllocArray) {
+      ALLOC_SITE();
+      const auto count = POP_INT();
+
+      auto* arrayRef = refAlloc->allocArray(count > 0 ? static_cast<unsigned>(count) : 0U);
+      CHECK_ALLOC(arrayRef);
+      std::fill(arrayRef->getValuesBegin(), arrayRef->getValuesEnd(), intValue(0));
+      PUSH_REF(arrayRef);
+    }
+    NEXT();
+    OP(ArrayStore) {
+      auto val       = POP();
+      auto index     = POP_INT();
+      auto* arrayRef = getArrayRef(POP());
+      if (unlikely(index < 0 || static_cast<unsigned>(index) >= arrayRef->getSize())) {
+        execHandle.setState(ExecState::IndexOutOfBounds);
+        goto End;
+      }
+      auto* valPtr = arrayRef->getValuePtr(static_cast<unsigned>(index));
+      refAlloc->writeBarrier(arrayRef, *valPtr, val);
+      *valPtr = val;
+    }
+    NEXT();
+
+    OP(Jump) {
+      JUMP(instr->target);
+    }
+    NEXT();
+    OP(JumpIf) {
       if (POP_INT() != 0) {
-        ip = assembly->getIp(ipOffset);
+        JUMP(instr->target);
       }
-    } break;
-
-    case OpCode::Call: {
-      const auto argCount    = READ_BYTE();
-      const auto tgtIpOffset = READ_UINT();
-      CALL(argCount, tgtIpOffset);
-    } break;
-    case OpCode::CallTail: {
+    }
+    NEXT();
+    OP(CheckEqIntJumpIf) {
+      auto b = POP_INT();
+      auto a = POP_INT();
+      if (a == b) {
+        JUMP(instr->target);
+      }
+    }
+    NEXT();
+    OP(StructPeekFieldJumpIf) {
+      auto* structure = getStructRef(PEEK());
+      if (structure->getField(instr->argA).getInt() != 0) {
+        JUMP(instr->target);
+      }
+    }
+    NEXT();
+
+    OP(Call) {
+      CALL(instr->argA, instr->target);
+    }
+    NEXT();
+    OP(CallTail) {
       // Place a trap here as with tail-calls is possible to have code that runs for a long time
       // without ever hitting a 'ret' instruction.
+      SAMPLE();
       if (unlikely(execHandle.trap())) {
         goto End;
       }
 
-      const auto argCount    = READ_BYTE();
-      const auto tgtIpOffset = READ_UINT();
-      CALL_TAIL(argCount, tgtIpOffset);
-    } break;
-    case OpCode::CallForked: {
-      const auto argCount    = READ_BYTE();
-      const auto tgtIpOffset = READ_UINT();
-      CALL_FORKED(argCount, tgtIpOffset);
-    } break;
-    case OpCode::CallDyn: {
-      const auto argCount = READ_BYTE();
+      CALL_TAIL(instr->argA, instr->target);
+    }
+    NEXT();
+    OP(CallForked) {
+      ALLOC_SITE();
+      CALL_FORKED(instr->argA, instr->target);
+    }
+    NEXT();
+    OP(CallDyn) {
+      const auto argCount = instr->argA;
       auto tgt            = POP();
       if (tgt.isRef()) { // Target is a closure containing bound args and a instruction pointer.
         uint8_t boundArgCount;
-        uint32_t tgtIpOffset;
-        PUSH_CLOSURE(tgt, &boundArgCount, &tgtIpOffset);
-        CALL(argCount + boundArgCount, tgtIpOffset);
+        const Instruction* tgtIp;
+        PUSH_CLOSURE(tgt, &boundArgCount, &tgtIp);
+        CALL(argCount + boundArgCount, tgtIp);
       } else { // Target is a instruction pointer only.
-        CALL(argCount, tgt.getUInt());
+        CALL(argCount, tgt.getRawPtr<const Instruction>());
       }
-    } break;
-    case OpCode::CallDynTail: {
+    }
+    NEXT();
+    OP(CallDynTail) {
       // Place a trap here as with tail-calls is possible to have code that runs for a long time
       // without ever hitting a 'ret' instruction.
+      SAMPLE();
       if (unlikely(execHandle.trap())) {
         goto End;
       }
 
-      const auto argCount = READ_BYTE();
+      const auto argCount = instr->argA;
       auto tgt            = POP();
       if (tgt.isRef()) { // Target is a closure containing bound args and a instruction pointer.
         uint8_t boundArgCount;
-        uint32_t tgtIpOffset;
-        PUSH_CLOSURE(tgt, &boundArgCount, &tgtIpOffset);
-        CALL_TAIL(argCount + boundArgCount, tgtIpOffset);
+        const Instruction* tgtIp;
+        PUSH_CLOSURE(tgt, &boundArgCount, &tgtIp);
+        CALL_TAIL(argCount + boundArgCount, tgtIp);
       } else { // Target is a instruction pointer only.
-        CALL_TAIL(argCount, tgt.getUInt());
+        CALL_TAIL(argCount, tgt.getRawPtr<const Instruction>());
       }
-    } break;
-    case OpCode::CallDynForked: {
-      const auto argCount = READ_BYTE();
+    }
+    NEXT();
+    OP(CallDynForked) {
+      ALLOC_SITE();
+      const auto argCount = instr->argA;
       auto tgt            = POP();
       if (tgt.isRef()) { // Target is a closure containing bound args and a instruction pointer.
         uint8_t boundArgCount;
-        uint32_t tgtIpOffset;
-        PUSH_CLOSURE(tgt, &boundArgCount, &tgtIpOffset);
-        CALL_FORKED(argCount + boundArgCount, tgtIpOffset);
+        const Instruction* tgtIp;
+        PUSH_CLOSURE(tgt, &boundArgCount, &tgtIp);
+        CALL_FORKED(argCount + boundArgCount, tgtIp);
       } else { // Target is a instruction pointer only.
-        CALL_FORKED(argCount, tgt.getUInt());
+        CALL_FORKED(argCount, tgt.getRawPtr<const Instruction>());
       }
-    } break;
-    case OpCode::PCall: {
-      pcall(settings, iface, refAlloc, &stack, &execHandle, readAsm<PCallCode>(&ip));
+    }
+    NEXT();
+    OP(PCall) {
+      ALLOC_SITE();
+      RESERVE(nativeStackSpace);
+      pcall(settings, iface, refAlloc, &stack, &execHandle, static_cast<PCallCode>(instr->argA));
       if (unlikely(execHandle.getState(std::memory_order_relaxed) != ExecState::Running)) {
         assert(execHandle.getState(std::memory_order_relaxed) != ExecState::Success);
         goto End;
       }
-    } break;
-    case OpCode::Ret: {
+      auto ioFd    = 0;
+      auto ioEvent = IoEvent::Read;
+      if (unlikely(execHandle.takeIoWait(&ioFd, &ioEvent))) {
+        /* The platform call would block on a socket, wait for the socket and then execute the
+        platform call again. On a pool thread the executor is suspended until the reactor resumes
+        it, other executors block their thread. */
+        ip = instr;
+        if (ExecutorPool::isPoolThread()) {
+          executor->ip     = ip;
+          executor->sh     = sh;
+          executor->rootSh = rootSh;
+          if (Reactor::get().wait(ioFd, ioEvent, executor)) {
+            // Note: Can be resumed on another thread right away, do not touch the executor anymore.
+            execHandle.suspend();
+            heapAllocSite = nullptr;
+            return ExecState::Paused;
+          }
+        }
+        execHandle.beginBlocking();
+        Reactor::block(ioFd, ioEvent);
+        execHandle.endBlocking();
+        if (unlikely(execHandle.trap())) {
+          goto End;
+        }
+      }
+    }
+    NEXT();
+    OP(Ret) {
+      SAMPLE();
       if (unlikely(execHandle.trap())) {
         goto End;
       }
@@ -754,36 +1325,35 @@ auto execute(
         execHandle.setState(ExecState::Success);
         goto End;
       }
-      assert(stack.getSize() >= 3); // Should at least contain a return ip and sh and ret value.
-
       auto retVal = POP();
 
       // Rewind this entire stack-frame (+ 2 for the stack-frame meta-data).
-      stack.rewindToNext(sh - 2);
+      stack.rewindToFrame(sh - 2);
 
       // Note this assumes that the rewinding does not actually invalidate the memory (which it
       // doesn't).
-      ip = assembly->getIp((sh - 2)->getUInt());
+      ip = (sh - 2)->getRawPtr<const Instruction>();
       sh = (sh - 1)->getRawPtr<Value>();
 
       // Place the return-value on the stack.
       PUSH(retVal);
-    } break;
+    }
+    NEXT();
 
-    case OpCode::FutureWaitNano: {
+    OP(FutureWaitNano) {
       int64_t timeout = getLong(POP());
       if (timeout <= 0) {
         auto* future = getFutureRef(POP());
         PUSH_BOOL(future->poll() != ExecState::Running);
-        break;
+        NEXT();
       }
 
       // Get the future but leave it on the stack, reason is gc could run while we are blocked.
       auto* future = getFutureRef(PEEK());
 
-      execHandle.setState(ExecState::Paused);
+      execHandle.beginBlocking();
       auto success = future->waitNano(timeout);
-      execHandle.setState(ExecState::Running);
+      execHandle.endBlocking();
 
       if (unlikely(execHandle.trap())) {
         goto End;
@@ -791,17 +1361,54 @@ auto execute(
 
       POP(); // Pop the future itself from the stack.
       PUSH_BOOL(success);
-    } break;
-    case OpCode::FutureBlock: {
+    }
+    NEXT();
+    OP(FutureBlock) {
       // Get the future but leave it on the stack, reason is gc could run while we are blocked.
       auto* future = getFutureRef(PEEK());
 
-      execHandle.setState(ExecState::Paused);
-      auto futureState = future->block();
-      execHandle.setState(ExecState::Running);
-
-      if (unlikely(execHandle.trap())) {
-        goto End;
+      /* On a pool thread run the forks we made ourselves while the future is not done, when there
+      are none left suspend the executor until it is. Executors that do not run on a pool thread
+      (the main executor) block instead. */
+      auto futureState = future->poll();
+      while (futureState == ExecState::Running) {
+        execHandle.pause();
+        const auto ranTask = ExecutorPool::get().runOwnTask();
+        execHandle.unpause();
+        if (unlikely(execHandle.trap())) {
+          goto End;
+        }
+        if (ranTask) {
+          futureState = future->poll();
+          continue;
+        }
+        if (ExecutorPool::isPoolThread()) {
+          // Save our state and add ourselves to the waiters, we are resumed at this instruction.
+          executor->ip     = instr;
+          executor->sh     = sh;
+          executor->rootSh = rootSh;
+          {
+            auto lk     = std::lock_guard<std::mutex>{future->getMutex()};
+            futureState = future->getState();
+            if (futureState == ExecState::Running) {
+              executor->nextWaiter = future->getWaiters();
+              future->setWaiters(executor);
+            }
+          }
+          if (futureState == ExecState::Running) {
+            // Note: Can be resumed on another thread right away, do not touch the executor anymore.
+            execHandle.suspend();
+            heapAllocSite = nullptr;
+            return ExecState::Paused;
+          }
+          break;
+        }
+        execHandle.beginBlocking();
+        futureState = future->block();
+        execHandle.endBlocking();
+        if (unlikely(execHandle.trap())) {
+          goto End;
+        }
       }
 
       assert(futureState != ExecState::Running);
@@ -813,58 +1420,101 @@ auto execute(
         execHandle.setState(futureState);
         goto End;
       }
-    } break;
-    case OpCode::Dup:
+    }
+    NEXT();
+    OP(Dup) {
       PUSH(PEEK());
-      break;
-    case OpCode::Pop:
+    }
+    NEXT();
+    OP(Pop) {
       POP();
-      break;
-    case OpCode::Swap: {
+    }
+    NEXT();
+    OP(Swap) {
       auto* a  = stack.getTop();
       auto* b  = a - 1;
       auto tmp = *a; // Old a.
       *a       = *b;
       *b       = tmp;
-    } break;
+    }
+    NEXT();
+
+    OP_JIT_ENTER() {
+      /* Native code cannot grow the stack, it returns at the first instruction that needs more
+      space than is left in the current segment. Make sure there is enough space for any single
+      instruction so that it always makes progress. */
+      RESERVE(nativeStackSpace);
+
+      /* Native code returns at backward jumps when the executor has to trap, trap before entering
+      it again so it always makes progress. */
+      if (unlikely(execHandle.trap())) {
+        goto End;
+      }
+
+      // Execute jit compiled native code, it updates the stack and returns where to continue.
+      auto jitState = JitState{sh, stack.getNext(), stack.getMax(), execHandle.getRequestPtr()};
+      ip            = instr->native(&jitState);
+      stack.setNext(jitState.next);
+    }
+    NEXT();
 
-    case OpCode::Fail:
-    default:
+    OP(Fail)
+    OP_INVALID() {
       execHandle.setState(ExecState::Failed);
       goto End;
     }
+#if !defined(VM_THREADED_DISPATCH)
+    }
   }
+#endif
 
 End:
+  // Allocations made outside of instructions are not attributed to any allocation site.
+  heapAllocSite = nullptr;
+
   // If we are backing a promise then fill-in the results and notify all waiters.
   auto endState = execHandle.getState(std::memory_order_relaxed);
 
   // Note: During program shutdown thread can still be inside blocking system calls, when they
-  // return (and notice that they have been aborted) it is not safe to touch any memory outside
-  // their own stack.
+  // return (and notice that they have been abandoned) it is not safe to touch any memory outside
+  // their own executor.
   if (endState == ExecState::Aborted) {
+    if (!execHandle.isAbandoned()) {
+      execRegistry->unregisterExecutor(&execHandle);
+    }
     return ExecState::Aborted;
   }
 
   if (promise) {
     if (endState == ExecState::Success) {
-      promise->setResult(POP());
+      const auto result = POP();
+      promise->setResult(result);
+      refAlloc->writeBarrier(promise, result);
     }
+    Executor* waiters = nullptr;
     {
       auto lk = std::lock_guard<std::mutex>{promise->getMutex()};
       promise->setState(endState);
+      waiters = promise->getWaiters();
+      promise->setWaiters(nullptr);
     }
     promise->getCondVar().notify_all();
+
+    // Queue the executors that were suspended while waiting for the promise to be resumed.
+    while (waiters) {
+      auto* waiter      = waiters;
+      waiters           = waiter->nextWaiter;
+      auto task         = ForkTask{};
+      task.execRegistry = execRegistry;
+      task.executor     = waiter;
+      ExecutorPool::get().push(task);
+    }
   }
   execRegistry->unregisterExecutor(&execHandle);
   return endState;
 
 #undef CHECK_ALLOC
-#undef READ_BYTE
-#undef READ_INT
-#undef READ_UINT
-#undef READ_LONG
-#undef READ_FLOAT
+#undef RESERVE
 #undef SALLOC
 #undef PUSH
 #undef PUSH_UINT
@@ -875,13 +1525,56 @@ End:
 #undef PUSH_REF
 #undef PUSH_CLOSURE
 #undef PEEK
+#undef SLOT
+#undef SLOT_INT
+#undef SLOT_FLOAT
 #undef POP
 #undef POP_UINT
 #undef POP_INT
 #undef POP_FLOAT
 #undef CALL
 #undef CALL_TAIL
+#undef JUMP
 #undef CALL_FORKED
+#undef ALLOC_SITE
+#undef SAMPLE
+#undef OP
+#undef OP_INVALID
+#undef OP_JIT_ENTER
+#undef NEXT
+}
+
+auto execute(
+    const Settings& settings,
+    const DecodedAssembly* assembly,
+    PlatformInterface* iface,
+    ExecutorRegistry* execRegistry,
+    RefAllocator* refAlloc,
+    const Instruction* entryIp,
+    FutureRef* promise) noexcept -> ExecState {
+
+  auto* executor =
+      new Executor{settings, assembly, iface, execRegistry, refAlloc, entryIp, promise};
+  execRegistry->registerExecutor(&executor->handle);
+  if (promise) {
+    ExecutorPool::get().notifyStarted();
+  }
+
+  const auto state = run(executor);
+  if (state != ExecState::Paused) {
+    delete executor;
+  }
+  return state;
+}
+
+auto resume(Executor* executor) noexcept -> void {
+  const auto resumed = executor->handle.tryResume();
+  ExecutorPool::get().notifyStarted();
+
+  // Abandoned executors are owned by the registry.
+  if (resumed && run(executor) != ExecState::Paused) {
+    delete executor;
+  }
 }
 
 } // namespace vm::internal
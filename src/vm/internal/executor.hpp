@@ -1,26 +1,76 @@
 #pragma once
+#include "internal/decoded_assembly.hpp"
+#include "internal/executor_handle.hpp"
 #include "internal/executor_registry.hpp"
 #include "internal/ref_allocator.hpp"
 #include "internal/settings.hpp"
-#include "novasm/assembly.hpp"
+#include "internal/stack.hpp"
 #include "vm/exec_state.hpp"
 #include "vm/platform_interface.hpp"
 
 namespace vm::internal {
 
+// State of an executor, stored on the heap so that an executor that waits for a future (or for a
+// socket) can be suspended (freeing up its thread) and resumed later on any of the pool threads.
+struct Executor final {
+  Executor(
+      const Settings& settings,
+      const DecodedAssembly* assembly,
+      PlatformInterface* iface,
+      ExecutorRegistry* execRegistry,
+      RefAllocator* refAlloc,
+      const Instruction* entryIp,
+      FutureRef* promise) noexcept :
+      settings{settings},
+      assembly{assembly},
+      iface{iface},
+      execRegistry{execRegistry},
+      refAlloc{refAlloc},
+      promise{promise},
+      stack{settings.stackLimit},
+      handle{this, &stack},
+      ip{entryIp},
+      sh{nullptr},
+      rootSh{nullptr},
+      nextWaiter{nullptr} {}
+  Executor(const Executor& rhs) = delete;
+  Executor(Executor&& rhs)      = delete;
+  ~Executor() noexcept          = default;
+
+  auto operator=(const Executor& rhs) -> Executor& = delete;
+  auto operator=(Executor&& rhs) -> Executor& = delete;
+
+  Settings settings;
+  const DecodedAssembly* assembly;
+  PlatformInterface* iface;
+  ExecutorRegistry* execRegistry;
+  RefAllocator* refAlloc;
+  FutureRef* promise;
+  Stack stack;
+  ExecutorHandle handle;
+
+  // Saved while the executor is suspended.
+  const Instruction* ip;
+  Value* sh;
+  Value* rootSh;
+
+  Executor* nextWaiter; // Next executor that is waiting for the same future (or socket).
+};
+
 // Execute a specific entrypoint in the assembly until completion.
 //
-// 'entryArgCount', 'entryArgSource', 'promise' are used for sub-executers (forked calls) that take
-// arguments from a parent executor and place their result in the 'promise' object.
+// 'promise' is used for sub-executors (forked calls) that take their arguments from the 'promise'
+// object and place their result in it.
 auto execute(
     const Settings& settings,
-    const novasm::Assembly* assembly,
+    const DecodedAssembly* assembly,
     PlatformInterface* iface,
     ExecutorRegistry* execRegistry,
     RefAllocator* refAlloc,
-    uint32_t entryIpOffset,
-    uint8_t entryArgCount,
-    Value* entryArgSource,
+    const Instruction* entryIp,
     FutureRef* promise) noexcept -> ExecState;
 
+// Resume a suspended executor until it completes (or is suspended again).
+auto resume(Executor* executor) noexcept -> void;
+
 } // namespace vm::internal
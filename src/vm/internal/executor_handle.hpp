@@ -1,5 +1,7 @@
 #pragma once
+#include "internal/executor_pool.hpp"
 #include "internal/likely.hpp"
+#include "internal/reactor.hpp"
 #include "internal/stack.hpp"
 #include "vm/exec_state.hpp"
 #include <atomic>
@@ -9,10 +11,16 @@
 namespace vm::internal {
 
 class ExecutorRegistry;
+struct Executor;
 
-// Handle to an executor, an executor is a single thread that is executing novus assembly.
-// Each executor has its own virtual stack (that is stored on the hardware stack) and a simple
-// api to interact with the executor (to request it to pause for example).
+// Handle to an executor, an executor is a single thread of execution that is running novus assembly
+// (forked executors run on the threads of the executor pool). Each executor has its own virtual
+// stack (that is stored on the heap) and a simple api to interact with the executor (to request it
+// to pause for example).
+//
+// Executors that are paused (or suspended while they wait for a future) can be aborted by the
+// registry at any time, in that case the executor is 'abandoned': once it continues it aborts
+// without touching anything outside of its own state, as the program may have been shut down.
 //
 // Executors have a 'prev' and a 'next' to form a doubly linked list of executors.
 //
@@ -20,10 +28,16 @@ class ExecutorHandle final {
   friend ExecutorRegistry;
 
 public:
-  explicit ExecutorHandle(BasicStack* stack) noexcept :
+  ExecutorHandle(Executor* executor, Stack* stack) noexcept :
+      m_executor{executor},
       m_stack{stack},
       m_state{ExecState::Running},
       m_request{RequestType::None},
+      m_sampleRequest{false},
+      m_suspended{false},
+      m_abandoned{false},
+      m_ioWaitFd{-1},
+      m_ioWaitEvent{IoEvent::Read},
       m_prev{nullptr},
       m_next{nullptr} {}
   ExecutorHandle(const ExecutorHandle& rhs) = delete;
@@ -33,23 +47,108 @@ public:
   auto operator=(const ExecutorHandle& rhs) -> ExecutorHandle& = delete;
   auto operator=(ExecutorHandle&& rhs) -> ExecutorHandle& = delete;
 
-  [[nodiscard]] inline auto getStack() noexcept -> BasicStack* { return m_stack; }
+  [[nodiscard]] inline auto getExecutor() noexcept -> Executor* { return m_executor; }
+  [[nodiscard]] inline auto getStack() noexcept -> Stack* { return m_stack; }
   [[nodiscard]] inline auto getNext() noexcept -> ExecutorHandle* { return m_next; }
 
+  [[nodiscard]] inline auto isAbandoned() const noexcept -> bool { return m_abandoned; }
+
+  // Request as a plain integer (non-zero when the executor has to trap), read by native code.
+  [[nodiscard]] inline auto getRequestPtr() const noexcept -> const int32_t* {
+    return reinterpret_cast<const int32_t*>(&m_request); // NOLINT: Reinterpret cast
+  }
+
   [[nodiscard]] inline auto
   getState(std::memory_order memOrder = std::memory_order_acquire) noexcept -> ExecState {
     return m_state.load(memOrder);
   }
 
+  // Note: Use 'pause' and 'unpause' to switch between the 'Paused' and 'Running' states.
   inline auto setState(ExecState state) noexcept -> void {
     m_state.store(state, std::memory_order_release);
   }
 
+  // Mark the executor as paused while it is not executing novus assembly, this allows the garbage
+  // collector to run meanwhile.
+  // Note: After 'unpause' the executor should 'trap' to check if it has to pause or abort.
+  inline auto pause() noexcept -> void {
+    m_state.store(ExecState::Paused, std::memory_order_release);
+  }
+
+  inline auto unpause() noexcept -> void {
+    // Leave the state alone when the executor was aborted meanwhile, the next trap notices it.
+    auto expected = ExecState::Paused;
+    m_state.compare_exchange_strong(expected, ExecState::Running, std::memory_order_seq_cst);
+  }
+
+  // Mark the executor as paused while it makes a blocking call (for example a system call), this
+  // allows the garbage collector to run and the executor pool to use another thread meanwhile.
+  // Note: After 'endBlocking' the executor should 'trap' to check if it has to pause or abort.
+  inline auto beginBlocking() noexcept -> void {
+    pause();
+    ExecutorPool::get().beginBlocking();
+  }
+
+  inline auto endBlocking() noexcept -> void {
+    ExecutorPool::get().endBlocking();
+    unpause();
+  }
+
+  // Mark the executor as suspended, the executor is not running on any thread until it is resumed.
+  // Note: Last access to the executor by the thread that suspends it.
+  inline auto suspend() noexcept -> void {
+    m_suspended = true;
+    m_state.store(ExecState::Paused, std::memory_order_release);
+  }
+
+  // Request the executor to wait until the file descriptor is ready for the event, used by platform
+  // calls that would block. The executor executes the platform call again once its ready.
+  // Note: The platform call should leave the stack as it found it.
+  inline auto requestIoWait(int fd, IoEvent event) noexcept -> void {
+    m_ioWaitFd    = fd;
+    m_ioWaitEvent = event;
+  }
+
+  [[nodiscard]] inline auto hasIoWait() const noexcept -> bool { return m_ioWaitFd >= 0; }
+
+  // Take the io-wait request (if any) that was made by the last platform call.
+  [[nodiscard]] inline auto takeIoWait(int* fd, IoEvent* event) noexcept -> bool {
+    if (likely(m_ioWaitFd < 0)) {
+      return false;
+    }
+    *fd        = m_ioWaitFd;
+    *event     = m_ioWaitEvent;
+    m_ioWaitFd = -1;
+    return true;
+  }
+
+  // Take a suspended executor to resume it, returns false if it was abandoned meanwhile.
+  [[nodiscard]] inline auto tryResume() noexcept -> bool {
+    while (true) {
+      auto expected = m_state.load(std::memory_order_acquire);
+      switch (expected) {
+      case ExecState::Paused:
+        if (m_state.compare_exchange_weak(
+                expected, ExecState::Running, std::memory_order_seq_cst)) {
+          m_suspended = false;
+          return true;
+        }
+        break;
+      case ExecState::Aborted:
+        return false;
+      default:
+        // The thread that is suspending the executor did not finish yet.
+        _mm_pause();
+        break;
+      }
+    }
+  }
+
   // Called by the executor at safe-points in the execution, safe meaning that all data is written
   // back to the stack and the current state is safe to be observed.
   //
   // If no pause request has been placed than trap returns immediately, if pause was requested then
-  // trap blocks until its un-paused again.
+  // trap blocks until its un-paused again. Returns true if the executor has to abort.
   //
   [[nodiscard]] inline auto trap() noexcept -> bool {
   TrapBegin:
@@ -57,10 +156,16 @@ public:
     auto req = m_request.load(std::memory_order_acquire);
     switch (req) {
     case RequestType::Abort:
-    Abort:
-      m_state.store(ExecState::Aborted, std::memory_order_release);
+    Abort: {
+      // Switch to 'Aborted' unless the registry already did so, then we have been abandoned.
+      auto state = m_state.load(std::memory_order_acquire);
+      while (state != ExecState::Aborted &&
+             !m_state.compare_exchange_weak(state, ExecState::Aborted, std::memory_order_seq_cst)) {
+      }
+      m_abandoned = state == ExecState::Aborted;
       return true;
-    case RequestType::Pause:
+    }
+    case RequestType::Pause: {
       m_state.store(ExecState::Paused, std::memory_order_release);
 
       // TODO(bastian): Might be worth experimenting with different pausing mechanisms. Basically
@@ -78,10 +183,15 @@ public:
         goto Abort;
       }
 
-      // Store running with sequential-consistency order and restart the trap check. This is
-      // important because we could be re-paused in between us checking.
-      m_state.store(ExecState::Running, std::memory_order_seq_cst);
+      // Switch back to running with sequential-consistency order and restart the trap check. This
+      // is important because we could be re-paused in between us checking.
+      auto expected = ExecState::Paused;
+      if (unlikely(!m_state.compare_exchange_strong(
+              expected, ExecState::Running, std::memory_order_seq_cst))) {
+        goto Abort;
+      }
       goto TrapBegin;
+    }
     case RequestType::None:
       return false;
     }
@@ -91,11 +201,13 @@ public:
     return false;
   }
 
-  // Request the executor to abort. Returns immediately with a boolean indicating if the executor
-  // has aborted yet. Common pattern is to keep calling this function until true is returned.
-  inline auto requestAbort() noexcept -> bool {
-    m_request.store(RequestType::Abort, std::memory_order_release);
-    return m_state.load(std::memory_order_acquire) != ExecState::Running;
+  // Request the executor to abort. Returns true if the executor was paused (or suspended), in that
+  // case its aborted right away and abandoned: it will not touch the registry anymore. Running
+  // executors abort at their next safe-point.
+  [[nodiscard]] inline auto requestAbort() noexcept -> bool {
+    m_request.store(RequestType::Abort, std::memory_order_seq_cst);
+    auto expected = ExecState::Paused;
+    return m_state.compare_exchange_strong(expected, ExecState::Aborted, std::memory_order_seq_cst);
   }
 
   // Request the executor to pause. Returns immediately with a boolean indicating if the executor
@@ -111,6 +223,23 @@ public:
     return m_state.load(std::memory_order_acquire) != ExecState::Running;
   }
 
+  // Request the executor to record a sample of its call-stack (for the profiler) at its next
+  // safe-point, ignored when the executor is not running.
+  inline auto requestSample() noexcept -> void {
+    if (m_state.load(std::memory_order_relaxed) == ExecState::Running) {
+      m_sampleRequest.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  // Called by the executor at safe-points, returns true if it should record a sample.
+  [[nodiscard]] inline auto takeSampleRequest() noexcept -> bool {
+    if (likely(!m_sampleRequest.load(std::memory_order_relaxed))) {
+      return false;
+    }
+    m_sampleRequest.store(false, std::memory_order_relaxed);
+    return true;
+  }
+
   inline auto resume() noexcept -> void {
     auto currentReq = m_request.load(std::memory_order_relaxed);
     if (currentReq == RequestType::Pause) {
@@ -120,15 +249,23 @@ public:
   }
 
 private:
-  enum class RequestType : int {
+  enum class RequestType : int32_t {
     None  = 0,
     Abort = 1,
     Pause = 2,
   };
+  static_assert(
+      sizeof(std::atomic<RequestType>) == sizeof(int32_t), "Request is read by native code");
 
-  BasicStack* m_stack;
+  Executor* m_executor;
+  Stack* m_stack;
   std::atomic<ExecState> m_state;
   std::atomic<RequestType> m_request;
+  std::atomic<bool> m_sampleRequest;
+  bool m_suspended; // Only modified while the executor is paused.
+  bool m_abandoned; // Only accessed by the executor itself.
+  int m_ioWaitFd;    // Only accessed by the executor itself.
+  IoEvent m_ioWaitEvent;
 
   ExecutorHandle* m_prev;
   ExecutorHandle* m_next;
@@ -0,0 +1,237 @@
+#include "internal/executor_pool.hpp"
+#include "internal/executor.hpp"
+#include <algorithm>
+#include <thread>
+
+namespace vm::internal {
+
+thread_local ExecutorPool::Worker* ExecutorPool::currentWorker = nullptr;
+
+ExecutorPool::ExecutorPool() noexcept :
+    m_targetCount{std::max(std::thread::hardware_concurrency(), 1U)},
+    m_workers{std::make_unique<Worker[]>(executorPoolMaxThreads)},
+    m_workerCount{0U},
+    m_pendingCount{0U},
+    m_startingCount{0U},
+    m_idleCount{0U},
+    m_activeCount{0U},
+    m_threadCount{0U} {}
+
+auto ExecutorPool::get() noexcept -> ExecutorPool& {
+  // Intentionally never destroyed, see the note on the class.
+  static auto* pool = new ExecutorPool{};
+  return *pool;
+}
+
+auto ExecutorPool::setTargetCount(unsigned int count) noexcept -> void {
+  if (count == 0U) {
+    count = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  m_targetCount.store(std::min(count, executorPoolMaxThreads), std::memory_order_relaxed);
+}
+
+auto ExecutorPool::push(ForkTask task) noexcept -> void {
+  auto* worker = currentWorker;
+  if (worker) {
+    auto lk  = std::lock_guard<std::mutex>{worker->mutex};
+    task.seq = worker->nextSeq++;
+    worker->tasks.push_back(task);
+    m_pendingCount.fetch_add(1U, std::memory_order_seq_cst);
+  } else {
+    auto lk = std::lock_guard<std::mutex>{m_mutex};
+    m_sharedTasks.push_back(task);
+    m_pendingCount.fetch_add(1U, std::memory_order_seq_cst);
+  }
+  spawnIfNeeded();
+}
+
+auto ExecutorPool::runOwnTask() noexcept -> bool {
+  /* Only run tasks that were forked by the current executor. Other tasks could be waiting on the
+  future of an executor further down the stack of this thread, which cannot complete until they
+  return. */
+  auto* worker = currentWorker;
+  if (worker == nullptr || worker->depth == executorPoolMaxHelpDepth) {
+    return false;
+  }
+  auto task = ForkTask{};
+  if (!takeOwn(worker, worker->helpSeq, &task)) {
+    return false;
+  }
+  run(worker, task);
+  return true;
+}
+
+auto ExecutorPool::beginBlocking() noexcept -> void {
+  if (currentWorker) {
+    m_activeCount.fetch_sub(1U, std::memory_order_seq_cst);
+    spawnIfNeeded();
+  }
+}
+
+auto ExecutorPool::endBlocking() noexcept -> void {
+  if (currentWorker) {
+    m_activeCount.fetch_add(1U, std::memory_order_seq_cst);
+  }
+}
+
+auto ExecutorPool::notifyStarted() noexcept -> void {
+  m_startingCount.fetch_sub(1U, std::memory_order_release);
+}
+
+auto ExecutorPool::cancel(ExecutorRegistry* execRegistry) noexcept -> void {
+  auto removeTasks = [this, execRegistry](std::deque<ForkTask>* tasks) {
+    auto end = std::remove_if(tasks->begin(), tasks->end(), [execRegistry](const ForkTask& task) {
+      return task.execRegistry == execRegistry;
+    });
+    m_pendingCount.fetch_sub(static_cast<unsigned int>(tasks->end() - end));
+    tasks->erase(end, tasks->end());
+  };
+
+  {
+    auto lk = std::lock_guard<std::mutex>{m_mutex};
+    removeTasks(&m_sharedTasks);
+  }
+  const auto workerCount = m_workerCount.load(std::memory_order_acquire);
+  for (auto i = 0U; i != workerCount; ++i) {
+    auto lk = std::lock_guard<std::mutex>{m_workers[i].mutex};
+    removeTasks(&m_workers[i].tasks);
+  }
+
+  /* Wait for the tasks that were already taken to register their executor (which aborts them), or
+  to find out that the executor they would resume has been abandoned. */
+  while (m_startingCount.load(std::memory_order_acquire) != 0U) {
+    std::this_thread::yield();
+  }
+}
+
+auto ExecutorPool::workerLoop(unsigned int workerIdx) noexcept -> void {
+  auto* worker  = &m_workers[workerIdx];
+  currentWorker = worker;
+
+  auto task = ForkTask{};
+  while (true) {
+    if (take(worker, &task)) {
+      run(worker, task);
+      continue;
+    }
+
+    auto lk = std::unique_lock<std::mutex>{m_mutex};
+    if (m_activeCount.load(std::memory_order_seq_cst) >
+        m_targetCount.load(std::memory_order_relaxed)) {
+      // More threads are running than needed (blocked threads have resumed), exit this one.
+      m_activeCount.fetch_sub(1U, std::memory_order_seq_cst);
+      m_freeWorkers.push_back(workerIdx);
+      --m_threadCount;
+      return;
+    }
+    m_idleCount.fetch_add(1U, std::memory_order_seq_cst);
+    m_condVar.wait(lk, [this] { return m_pendingCount.load(std::memory_order_seq_cst) != 0U; });
+    m_idleCount.fetch_sub(1U, std::memory_order_seq_cst);
+  }
+}
+
+auto ExecutorPool::spawnIfNeeded() noexcept -> void {
+  if (m_pendingCount.load(std::memory_order_seq_cst) == 0U) {
+    return;
+  }
+  if (m_idleCount.load(std::memory_order_seq_cst) != 0U) {
+    auto lk = std::lock_guard<std::mutex>{m_mutex};
+    m_condVar.notify_one();
+    return;
+  }
+  const auto targetCount = m_targetCount.load(std::memory_order_relaxed);
+  if (m_activeCount.load(std::memory_order_seq_cst) >= targetCount) {
+    return;
+  }
+  auto lk = std::lock_guard<std::mutex>{m_mutex};
+  if (m_idleCount.load(std::memory_order_seq_cst) == 0U &&
+      m_activeCount.load(std::memory_order_seq_cst) < targetCount) {
+    spawn();
+  }
+}
+
+auto ExecutorPool::spawn() noexcept -> void {
+  if (m_threadCount == executorPoolMaxThreads) {
+    return;
+  }
+  auto workerIdx = 0U;
+  if (m_freeWorkers.empty()) {
+    workerIdx = m_workerCount.load(std::memory_order_relaxed);
+    m_workerCount.store(workerIdx + 1U, std::memory_order_release);
+  } else {
+    workerIdx = m_freeWorkers.back();
+    m_freeWorkers.pop_back();
+  }
+  ++m_threadCount;
+  m_activeCount.fetch_add(1U, std::memory_order_seq_cst);
+  std::thread(&ExecutorPool::workerLoop, this, workerIdx).detach();
+}
+
+auto ExecutorPool::take(Worker* worker, ForkTask* task) noexcept -> bool {
+  if (takeOwn(worker, 0U, task)) {
+    return true;
+  }
+  {
+    auto lk = std::lock_guard<std::mutex>{m_mutex};
+    if (!m_sharedTasks.empty()) {
+      *task = m_sharedTasks.front();
+      m_sharedTasks.pop_front();
+      m_pendingCount.fetch_sub(1U, std::memory_order_seq_cst);
+      m_startingCount.fetch_add(1U, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  // Steal the oldest task of another worker.
+  const auto workerCount = m_workerCount.load(std::memory_order_acquire);
+  const auto workerIdx   = static_cast<unsigned int>(worker - m_workers.get());
+  for (auto i = 1U; i < workerCount; ++i) {
+    auto* victim = &m_workers[(workerIdx + i) % workerCount];
+    auto lk      = std::lock_guard<std::mutex>{victim->mutex};
+    if (!victim->tasks.empty()) {
+      *task = victim->tasks.front();
+      victim->tasks.pop_front();
+      m_pendingCount.fetch_sub(1U, std::memory_order_seq_cst);
+      m_startingCount.fetch_add(1U, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+auto ExecutorPool::takeOwn(Worker* worker, uint64_t minSeq, ForkTask* task) noexcept -> bool {
+  auto lk = std::lock_guard<std::mutex>{worker->mutex};
+  if (worker->tasks.empty() || worker->tasks.back().seq < minSeq) {
+    return false;
+  }
+  *task = worker->tasks.back();
+  worker->tasks.pop_back();
+  m_pendingCount.fetch_sub(1U, std::memory_order_seq_cst);
+  m_startingCount.fetch_add(1U, std::memory_order_relaxed);
+  return true;
+}
+
+auto ExecutorPool::run(Worker* worker, const ForkTask& task) noexcept -> void {
+  // Tasks forked by the executor of this task are queued from the current sequence number onwards.
+  const auto prevHelpSeq = worker->helpSeq;
+  worker->helpSeq        = worker->nextSeq;
+  ++worker->depth;
+
+  if (task.executor) {
+    resume(task.executor);
+  } else {
+    execute(
+        task.settings,
+        task.assembly,
+        task.iface,
+        task.execRegistry,
+        task.refAlloc,
+        task.entryIp,
+        task.future);
+  }
+
+  --worker->depth;
+  worker->helpSeq = prevHelpSeq;
+}
+
+} // namespace vm::internal
@@ -0,0 +1,131 @@
+#pragma once
+#include "internal/settings.hpp"
+#include "vm/exec_state.hpp"
+#include "vm/platform_interface.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vm::internal {
+
+class DecodedAssembly;
+class ExecutorRegistry;
+struct Executor;
+class FutureRef;
+class RefAllocator;
+struct Instruction;
+
+const auto executorPoolMaxThreads   = 1024U; // Including threads that stand in for blocked ones.
+const auto executorPoolMaxHelpDepth = 16U;   // Max tasks nested on a thread while helping.
+
+// Forked call that is waiting to be executed, the arguments are stored in the future. Also used for
+// suspended executors that are waiting to be resumed, then only 'execRegistry' and 'executor' are
+// set.
+struct ForkTask final {
+  Settings settings;
+  const DecodedAssembly* assembly;
+  PlatformInterface* iface;
+  ExecutorRegistry* execRegistry;
+  RefAllocator* refAlloc;
+  const Instruction* entryIp;
+  FutureRef* future;
+  uint64_t seq; // Order in which the task was queued by its worker.
+  Executor* executor;
+};
+
+// Pool of threads that execute forked calls.
+//
+// The pool aims to keep one running thread per core. Each thread has its own queue of tasks: forks
+// made by the executor that is running on the thread are pushed to the back of its queue and the
+// thread takes its next task from the back as well. When a thread runs out of tasks it steals
+// from the front of the queue of another thread. Forks made outside of the pool (for example by
+// the main executor) are pushed to a shared queue.
+//
+// When an executor on a pool thread waits for a future it runs the tasks that it forked itself
+// (until the future is done) instead of blocking the thread. When there are none left the executor
+// is suspended: its state is kept on the heap and the thread continues with other tasks, when the
+// future is done the executor is queued to be resumed (on any of the threads), executors that wait
+// for a socket are suspended in the same way (see 'Reactor'). When an executor blocks for a
+// different reason (like a system call) an extra thread is started if there are queued tasks and
+// no thread to run them, those extra threads exit again once they are idle.
+//
+// Note: The pool is shared by all vm instances in the process and is never destroyed, reason is
+// that during shutdown pool threads can still be blocked in system calls of aborted executors.
+class ExecutorPool final {
+public:
+  ExecutorPool(const ExecutorPool& rhs) = delete;
+  ExecutorPool(ExecutorPool&& rhs)      = delete;
+  ~ExecutorPool() noexcept              = default;
+
+  auto operator=(const ExecutorPool& rhs) -> ExecutorPool& = delete;
+  auto operator=(ExecutorPool&& rhs) -> ExecutorPool& = delete;
+
+  [[nodiscard]] static auto get() noexcept -> ExecutorPool&;
+
+  // Check if the current thread is one of the pool threads, only those can suspend executors.
+  [[nodiscard]] static auto isPoolThread() noexcept -> bool { return currentWorker != nullptr; }
+
+  // Set the amount of running threads that the pool aims for, zero for one per core.
+  // Note: Affects all vm instances in the process, surplus threads exit once they are idle.
+  auto setTargetCount(unsigned int count) noexcept -> void;
+
+  // Queue a task to be executed by one of the pool threads.
+  auto push(ForkTask task) noexcept -> void;
+
+  // Run a task that was forked by the current executor (or by the tasks it ran meanwhile), used
+  // by pool threads to make progress while waiting for a future. Returns false if there is none.
+  [[nodiscard]] auto runOwnTask() noexcept -> bool;
+
+  // Called around blocking calls, allows the pool to run its tasks on another thread meanwhile.
+  auto beginBlocking() noexcept -> void;
+  auto endBlocking() noexcept -> void;
+
+  // Called by a forked executor once it is registered with its executor registry (or by a
+  // suspended executor once it is taken to be resumed).
+  auto notifyStarted() noexcept -> void;
+
+  // Remove all queued tasks of the given registry and wait for the tasks that are starting.
+  // Note: Should be called after aborting the executors of the registry.
+  auto cancel(ExecutorRegistry* execRegistry) noexcept -> void;
+
+private:
+  struct Worker final {
+    std::mutex mutex;
+    std::deque<ForkTask> tasks; // Protected by the mutex.
+    uint64_t nextSeq;           // Only accessed by the thread itself.
+    uint64_t helpSeq;   // Tasks from this sequence number onwards belong to the current task.
+    unsigned int depth; // Amount of tasks nested on the stack of the thread.
+  };
+
+  std::atomic<unsigned int> m_targetCount;
+  std::unique_ptr<Worker[]> m_workers;
+  std::atomic<unsigned int> m_workerCount; // Amount of workers that have ever been used.
+  std::atomic<unsigned int> m_pendingCount;
+  std::atomic<unsigned int> m_startingCount;
+  std::atomic<unsigned int> m_idleCount;
+  std::atomic<unsigned int> m_activeCount; // Threads that are not blocked.
+
+  std::mutex m_mutex;
+  std::condition_variable m_condVar;
+  std::deque<ForkTask> m_sharedTasks; // Protected by the mutex.
+  std::vector<unsigned int> m_freeWorkers;
+  unsigned int m_threadCount;
+
+  // Worker of the current thread, nullptr when the thread is not part of the pool.
+  static thread_local Worker* currentWorker;
+
+  ExecutorPool() noexcept;
+
+  auto workerLoop(unsigned int workerIdx) noexcept -> void;
+  auto spawnIfNeeded() noexcept -> void;
+  auto spawn() noexcept -> void;
+  auto take(Worker* worker, ForkTask* task) noexcept -> bool;
+  auto takeOwn(Worker* worker, uint64_t minSeq, ForkTask* task) noexcept -> bool;
+  auto run(Worker* worker, const ForkTask& task) noexcept -> void;
+};
+
+} // namespace vm::internal
@@ -1,9 +1,18 @@
 #include "internal/executor_registry.hpp"
+#include "internal/executor.hpp"
+#include "internal/ref_future.hpp"
 #include <thread>
 
 namespace vm::internal {
 
-ExecutorRegistry::ExecutorRegistry() noexcept : m_head{nullptr} {};
+ExecutorRegistry::ExecutorRegistry() noexcept :
+    m_head{nullptr}, m_pendingForks{}, m_abandoned{}, m_pausing{false}, m_aborting{false} {};
+
+ExecutorRegistry::~ExecutorRegistry() noexcept {
+  for (auto* handle : m_abandoned) {
+    delete handle->getExecutor();
+  }
+}
 
 auto ExecutorRegistry::registerExecutor(ExecutorHandle* handle) noexcept -> void {
   auto lk = std::lock_guard<std::mutex>{m_mutex};
@@ -15,11 +24,20 @@ auto ExecutorRegistry::registerExecutor(ExecutorHandle* handle) noexcept -> void
     handle->m_next = m_head;
   }
   m_head = handle;
+
+  if (m_aborting) {
+    handle->m_request.store(ExecutorHandle::RequestType::Abort, std::memory_order_release);
+  } else if (m_pausing) {
+    handle->m_request.store(ExecutorHandle::RequestType::Pause, std::memory_order_release);
+  }
 }
 
 auto ExecutorRegistry::unregisterExecutor(ExecutorHandle* handle) noexcept -> void {
   auto lk = std::lock_guard<std::mutex>{m_mutex};
+  unlink(handle);
+}
 
+auto ExecutorRegistry::unlink(ExecutorHandle* handle) noexcept -> void {
   assert(handle == m_head || handle->m_prev);
   if (handle == m_head) {
     m_head = handle->m_next;
@@ -31,20 +49,46 @@ auto ExecutorRegistry::unregisterExecutor(ExecutorHandle* handle) noexcept -> vo
   }
 }
 
+auto ExecutorRegistry::registerFork(FutureRef* future) noexcept -> void {
+  auto lk             = std::lock_guard<std::mutex>{m_mutex};
+  future->m_forkIndex = static_cast<unsigned int>(m_pendingForks.size());
+  m_pendingForks.push_back(future);
+}
+
+auto ExecutorRegistry::unregisterFork(FutureRef* future) noexcept -> void {
+  auto lk = std::lock_guard<std::mutex>{m_mutex};
+
+  // Swap-remove the future from the list.
+  assert(m_pendingForks[future->m_forkIndex] == future);
+  auto* last                          = m_pendingForks.back();
+  last->m_forkIndex                   = future->m_forkIndex;
+  m_pendingForks[future->m_forkIndex] = last;
+  m_pendingForks.pop_back();
+}
+
 auto ExecutorRegistry::abortExecutors() noexcept -> void {
-  /* Keep looping over all executors and requesting abort until all of them have aborted. */
+  /* Keep looping over all executors and requesting abort until none are left. Running executors
+  unregister themselves once they abort, paused executors are abandoned and unregistered here.
+  Suspended executors are not owned by any thread, so they are destroyed with the registry (after
+  the executor pool has dropped the tasks to resume them). */
   while (true) {
-    bool done = true;
     {
       auto lk    = std::lock_guard<std::mutex>{m_mutex};
+      m_aborting = true;
       auto* exec = m_head;
       while (exec) {
-        done &= exec->requestAbort();
-        exec = exec->m_next;
+        auto* next = exec->m_next;
+        if (exec->requestAbort()) {
+          unlink(exec);
+          if (exec->m_suspended) {
+            m_abandoned.push_back(exec);
+          }
+        }
+        exec = next;
+      }
+      if (m_head == nullptr) {
+        break;
       }
-    }
-    if (done) {
-      break;
     }
     std::this_thread::yield();
   }
@@ -56,6 +100,7 @@ auto ExecutorRegistry::pauseExecutors() noexcept -> void {
     bool done = true;
     {
       auto lk    = std::lock_guard<std::mutex>{m_mutex};
+      m_pausing  = true;
       auto* exec = m_head;
       while (exec) {
         done &= exec->requestPause();
@@ -72,6 +117,7 @@ auto ExecutorRegistry::pauseExecutors() noexcept -> void {
 auto ExecutorRegistry::resumeExecutors() noexcept -> void {
   /* Unset the pause flag on all executors. */
   auto lk    = std::lock_guard<std::mutex>{m_mutex};
+  m_pausing  = false;
   auto* exec = m_head;
   while (exec) {
     exec->resume();
@@ -79,4 +125,13 @@ auto ExecutorRegistry::resumeExecutors() noexcept -> void {
   }
 }
 
+auto ExecutorRegistry::requestSamples() noexcept -> void {
+  auto lk    = std::lock_guard<std::mutex>{m_mutex};
+  auto* exec = m_head;
+  while (exec) {
+    exec->requestSample();
+    exec = exec->m_next;
+  }
+}
+
 } // namespace vm::internal
@@ -2,32 +2,58 @@
 #include "internal/executor_handle.hpp"
 #include "internal/stack.hpp"
 #include <mutex>
+#include <vector>
 
 namespace vm::internal {
 
+class FutureRef;
+
 // Registry that keeps track of all executors.
+// Forks that are waiting to be started are tracked as well, their futures (holding the arguments
+// of the forked call) are roots for the garbage collector until the executor has started.
+//
+// Note: Suspended executors that are abandoned when aborting are destroyed by the registry.
 class ExecutorRegistry final {
 public:
   ExecutorRegistry() noexcept;
   ExecutorRegistry(const ExecutorRegistry& rhs) = delete;
   ExecutorRegistry(ExecutorRegistry&& rhs)      = delete;
-  ~ExecutorRegistry() noexcept                  = default;
+  ~ExecutorRegistry() noexcept;
 
   auto operator=(const ExecutorRegistry& rhs) -> ExecutorRegistry& = delete;
   auto operator=(ExecutorRegistry&& rhs) -> ExecutorRegistry& = delete;
 
   [[nodiscard]] inline auto getHeadExecutor() noexcept -> ExecutorHandle* { return m_head; }
 
+  // Note: Only safe to inspect while all executors are paused.
+  [[nodiscard]] inline auto getPendingForks() noexcept -> const std::vector<FutureRef*>& {
+    return m_pendingForks;
+  }
+
+  // Executors that register while a pause or abort is in progress are paused or aborted as well.
   auto registerExecutor(ExecutorHandle* handle) noexcept -> void;
   auto unregisterExecutor(ExecutorHandle* handle) noexcept -> void;
 
+  auto registerFork(FutureRef* future) noexcept -> void;
+  auto unregisterFork(FutureRef* future) noexcept -> void;
+
+  // Abort all executors, returns once all of them have either aborted or have been abandoned.
   auto abortExecutors() noexcept -> void;
   auto pauseExecutors() noexcept -> void;
   auto resumeExecutors() noexcept -> void;
 
+  // Request all running executors to record a sample of their call-stack for the profiler.
+  auto requestSamples() noexcept -> void;
+
 private:
   std::mutex m_mutex;
   ExecutorHandle* m_head;
+  std::vector<FutureRef*> m_pendingForks;
+  std::vector<ExecutorHandle*> m_abandoned;
+  bool m_pausing;
+  bool m_aborting;
+
+  auto unlink(ExecutorHandle* handle) noexcept -> void;
 };
 
 } // namespace vm::internal
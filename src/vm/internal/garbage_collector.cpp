@@ -1,10 +1,13 @@
 #include "internal/garbage_collector.hpp"
 #include "internal/ref_allocator.hpp"
+#include "internal/ref_array.hpp"
 #include "internal/ref_future.hpp"
 #include "internal/ref_string_link.hpp"
 #include "internal/ref_struct.hpp"
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
+#include <limits>
 #include <mutex>
 
 namespace vm::internal {
@@ -15,13 +18,48 @@ const static auto bytesAllocThreadAccumMax = 1024U * 1024U; // 1 MiB
 thread_local static unsigned int bytesAllocThreadAccum;
 
 GarbageCollector::GarbageCollector(
-    RefAllocator* refAlloc, ExecutorRegistry* execRegistry) noexcept :
-    m_refAlloc{refAlloc}, m_execRegistry{execRegistry}, m_requestType{RequestType::None} {
+    RefAllocator* refAlloc, ExecutorRegistry* execRegistry, const GcSettings& settings) noexcept :
+    m_refAlloc{refAlloc},
+    m_execRegistry{execRegistry},
+    m_settings{settings},
+    m_bytesUntilNextCollection{
+        static_cast<int64_t>(std::max<uint64_t>(settings.minHeap, gcMinTriggerBytes))},
+    m_collectionCount{0U},
+    m_majorCollection{false},
+    m_nextMajorCollection{false},
+    m_statCollections{0U},
+    m_statMajorCollections{0U},
+    m_statPauseCount{0U},
+    m_statPauseTotalNs{0U},
+    m_statPauseMaxNs{0U},
+    m_statHeapLiveBytes{0U},
+    m_statHeapTriggerBytes{std::max<uint64_t>(settings.minHeap, gcMinTriggerBytes)},
+    m_requestType{RequestType::None},
+    m_workerCount{std::clamp(
+        settings.workers != 0U ? settings.workers : std::thread::hardware_concurrency(),
+        1U,
+        gcMaxWorkers)},
+    m_workers{std::make_unique<Worker[]>(m_workerCount)},
+    m_activeMarkWorkers{0U},
+    m_sweepUnitCount{0U},
+    m_nextSweepUnit{0U},
+    m_jobType{JobType::Mark},
+    m_jobId{0U},
+    m_jobsPending{0U} {
 
   // Subscribe to allocation notifications, we can use these to decide when to run a collection.
   refAlloc->subscribe(this);
 
   m_markQueue.reserve(initialGcMarkQueueSize);
+  for (auto i = 0U; i != m_workerCount; ++i) {
+    m_workers[i].markQueue.reserve(initialGcMarkQueueSize);
+    m_workers[i].sharedCount.store(0U, std::memory_order_relaxed);
+  }
+
+  // Start the helper threads, the collector thread itself acts as worker 0.
+  for (auto i = 1U; i < m_workerCount; ++i) {
+    m_workerThreads.emplace_back(&GarbageCollector::workerLoop, this, i);
+  }
 
   // Start the garbage-collector thread.
   m_collectorThread = std::thread(&GarbageCollector::collectorLoop, this);
@@ -50,6 +88,31 @@ auto GarbageCollector::terminateCollector() noexcept -> void {
   }
   m_requestCondVar.notify_one();
   m_collectorThread.join();
+
+  // Terminate the helper threads.
+  {
+    std::lock_guard<std::mutex> lk(m_jobMutex);
+    m_jobType = JobType::Terminate;
+    ++m_jobId;
+  }
+  m_jobCondVar.notify_all();
+  for (auto& thread : m_workerThreads) {
+    thread.join();
+  }
+}
+
+auto GarbageCollector::getStats(MemoryStats* out) const noexcept -> void {
+  using Counter = MemoryStats::Counter;
+
+  m_refAlloc->getStats(out);
+
+  out->set(Counter::Collections, m_statCollections.load(std::memory_order_relaxed));
+  out->set(Counter::MajorCollections, m_statMajorCollections.load(std::memory_order_relaxed));
+  out->set(Counter::PauseCount, m_statPauseCount.load(std::memory_order_relaxed));
+  out->set(Counter::PauseTotalNs, m_statPauseTotalNs.load(std::memory_order_relaxed));
+  out->set(Counter::PauseMaxNs, m_statPauseMaxNs.load(std::memory_order_relaxed));
+  out->set(Counter::HeapLiveBytes, m_statHeapLiveBytes.load(std::memory_order_relaxed));
+  out->set(Counter::HeapTriggerBytes, m_statHeapTriggerBytes.load(std::memory_order_relaxed));
 }
 
 auto GarbageCollector::notifyAlloc(unsigned int size) noexcept -> void {
@@ -57,10 +120,9 @@ auto GarbageCollector::notifyAlloc(unsigned int size) noexcept -> void {
   bytesAllocThreadAccum += size;
   if (bytesAllocThreadAccum > bytesAllocThreadAccumMax) {
 
-    // Decrease the bytesUntilNextCollection atomic.
+    // Decrease the bytesUntilNextCollection atomic, it is reset when the collection completes.
     if (m_bytesUntilNextCollection.fetch_sub(bytesAllocThreadAccum, std::memory_order_acq_rel) <
         0) {
-      m_bytesUntilNextCollection.store(gcByteInterval, std::memory_order_release);
       requestCollection();
     }
 
@@ -70,46 +132,217 @@ auto GarbageCollector::notifyAlloc(unsigned int size) noexcept -> void {
 
 auto GarbageCollector::collectorLoop() noexcept -> void {
   while (true) {
-    // Wait for a request (or timout for a minimum gc interval).
+    // Wait for a request (or until the program has been idle for the idle interval).
+    auto idle = false;
     {
       std::unique_lock<std::mutex> lk(m_requestMutex);
-      m_requestCondVar.wait_for(lk, std::chrono::seconds(gcMinIntervalSeconds), [this]() {
-        return m_requestType != RequestType::None;
-      });
+      const auto hasRequest = [this]() { return m_requestType != RequestType::None; };
+      if (m_settings.idleInterval.count() != 0) {
+        idle = !m_requestCondVar.wait_for(lk, m_settings.idleInterval, hasRequest);
+      } else {
+        m_requestCondVar.wait(lk, hasRequest);
+      }
       if (unlikely(m_requestType == RequestType::Terminate)) {
         return;
       }
-
-      // Reset the bytes counter.
-      m_bytesUntilNextCollection.store(gcByteInterval, std::memory_order_release);
-
       m_requestType = RequestType::None;
     }
 
+    // When idle only collect if the program allocated since the last collection, idle collections
+    // collect the full heap as there is no hurry.
+    const auto trigger =
+        static_cast<int64_t>(m_statHeapTriggerBytes.load(std::memory_order_relaxed));
+    if (idle) {
+      if (m_bytesUntilNextCollection.load(std::memory_order_acquire) >= trigger) {
+        continue;
+      }
+      m_nextMajorCollection = true;
+    }
+
+    // Reset the counter while collecting, this avoids requesting collections during the collection
+    // (the next trigger is computed once it is complete).
+    m_bytesUntilNextCollection.store(trigger, std::memory_order_release);
+
     // Collect garbage.
     collect();
+    scheduleNextCollection();
+  }
+}
+
+auto GarbageCollector::workerLoop(unsigned int workerIdx) noexcept -> void {
+  auto lastJobId = 0U;
+  while (true) {
+    // Wait for a new job.
+    auto type = JobType{};
+    {
+      std::unique_lock<std::mutex> lk(m_jobMutex);
+      m_jobCondVar.wait(lk, [this, lastJobId]() { return m_jobId != lastJobId; });
+      lastJobId = m_jobId;
+      type      = m_jobType;
+    }
+    if (unlikely(type == JobType::Terminate)) {
+      return;
+    }
+
+    runJob(type, workerIdx);
+
+    {
+      std::lock_guard<std::mutex> lk(m_jobMutex);
+      --m_jobsPending;
+    }
+    m_jobDoneCondVar.notify_one();
+  }
+}
+
+auto GarbageCollector::runJob(JobType type) noexcept -> void {
+  // Start the job on the helper threads.
+  {
+    std::lock_guard<std::mutex> lk(m_jobMutex);
+    m_jobType     = type;
+    m_jobsPending = m_workerCount - 1U;
+    ++m_jobId;
+  }
+  m_jobCondVar.notify_all();
+
+  // Participate as worker 0 and wait for the helpers to finish.
+  runJob(type, 0U);
+
+  std::unique_lock<std::mutex> lk(m_jobMutex);
+  m_jobDoneCondVar.wait(lk, [this]() { return m_jobsPending == 0U; });
+}
+
+auto GarbageCollector::runJob(JobType type, unsigned int workerIdx) noexcept -> void {
+  switch (type) {
+  case JobType::Mark:
+    mark(workerIdx);
+    break;
+  case JobType::Sweep:
+    sweep();
+    break;
+  case JobType::Terminate:
+    break;
   }
 }
 
 auto GarbageCollector::collect() noexcept -> void {
-  // Pause all executors. This makes sure that we are free to inspect the stacks of the allocators
-  // and no new allocations are being made.
-  m_execRegistry->pauseExecutors(); // Will block until all executors have paused.
+  m_majorCollection     = ++m_collectionCount % gcMajorInterval == 0U || m_nextMajorCollection;
+  m_nextMajorCollection = false;
+
+  // Pause all executors. This makes sure that we are free to inspect the stacks of the executors.
+  pause(); // Will block until all executors have paused.
 
   // Populate mark-queue with the references from the stacks of the executors.
   populateMarkQueue();
 
-  // Mark all references in the mark-queue.
-  mark();
+  // For minor collections the remembered old refs are roots.
+  m_refAlloc->takeRemembered(&m_remembered);
+
+  // Begin the sweep, refs allocated from now on are not part of it (and form the new nursery).
+  m_sweepUnitCount = m_refAlloc->beginSweep();
+  m_refAlloc->setMarking(true);
 
-  // Get the head ref to start the sweep from.
-  Ref* sweepHead = m_refAlloc->getHeadAlloc();
+  // Resume the executors as the marking can run concurrently with the program.
+  resume();
+
+  if (!m_majorCollection) {
+    populateMarkQueueRemembered();
+  }
+  m_remembered.clear();
+  markQueue();
+
+  // Mark the refs that the program has overwritten in the meantime.
+  for (auto round = 0U; round != gcConcurrentMarkRounds; ++round) {
+    m_refAlloc->takeMarkLog(&m_markQueue);
+    if (m_markQueue.empty()) {
+      break;
+    }
+    markQueue();
+  }
+
+  // Pause to finish marking, while paused no new refs can be added to the mark-logs.
+  pause();
+  m_refAlloc->flushMarkLogs();
+  m_refAlloc->takeMarkLog(&m_markQueue);
+  markQueue();
+  m_refAlloc->setMarking(false);
+
+  // Clear the links of collapsed string-links, while paused no executor can be accessing them.
+  for (auto i = 0U; i != m_workerCount; ++i) {
+    for (auto* link : m_workers[i].collapsedLinks) {
+      link->clearLink();
+    }
+    m_workers[i].collapsedLinks.clear();
+  }
 
   // Resume the executors as the sweeping can run concurrently with the program.
+  resume();
+
+  // Surviving refs are promoted to the old generation, but refs that were recorded while marking
+  // can be young refs that are about to be freed.
+  m_refAlloc->filterRemembered([this](Ref* ref) {
+    return m_refAlloc->isMarked(ref) || (!m_majorCollection && ref->isOld());
+  });
+
+  // Remove all non-marked allocations, minor collections only have to sweep the nursery.
+  m_nextSweepUnit.store(0U, std::memory_order_release);
+  runJob(JobType::Sweep);
+
+  m_statCollections.fetch_add(1U, std::memory_order_relaxed);
+  if (m_majorCollection) {
+    m_statMajorCollections.fetch_add(1U, std::memory_order_relaxed);
+  }
+}
+
+auto GarbageCollector::scheduleNextCollection() noexcept -> void {
+  /* Allow the program to allocate 'heapGrowth' percent of the live heap before collecting again.
+  After a minor collection the live heap also contains the unreachable refs of the old generation,
+  they are only reclaimed by the next major collection. */
+
+  const auto liveBytes = m_refAlloc->getSweepLiveBytes();
+  auto trigger          = std::max(liveBytes / 100U * m_settings.heapGrowth, m_settings.minHeap);
+
+  // Stay below the soft heap limit by collecting (the full heap) more often when close to it.
+  if (m_settings.heapLimit != 0U) {
+    const auto headroom = m_settings.heapLimit > liveBytes ? m_settings.heapLimit - liveBytes : 0U;
+    if (trigger > headroom) {
+      trigger               = headroom;
+      m_nextMajorCollection = true;
+    }
+  }
+  trigger = std::clamp<uint64_t>(
+      trigger, gcMinTriggerBytes, std::numeric_limits<int64_t>::max());
+
+  m_statHeapLiveBytes.store(liveBytes, std::memory_order_relaxed);
+  m_statHeapTriggerBytes.store(trigger, std::memory_order_relaxed);
+  m_bytesUntilNextCollection.store(static_cast<int64_t>(trigger), std::memory_order_release);
+}
+
+auto GarbageCollector::pause() noexcept -> void {
+  m_pauseStart = std::chrono::steady_clock::now();
+  m_execRegistry->pauseExecutors();
+}
+
+auto GarbageCollector::resume() noexcept -> void {
   m_execRegistry->resumeExecutors();
 
-  // Remove all non-marked allocations.
-  sweep(sweepHead);
+  const auto duration = std::chrono::steady_clock::now() - m_pauseStart;
+  m_pauses.add(static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+
+  // Publish the totals, only the collector thread writes to them.
+  m_statPauseCount.store(m_pauses.getCount(), std::memory_order_relaxed);
+  m_statPauseTotalNs.store(m_pauses.getTotalNs(), std::memory_order_relaxed);
+  m_statPauseMaxNs.store(m_pauses.getMaxNs(), std::memory_order_relaxed);
+}
+
+auto GarbageCollector::markQueue() noexcept -> void {
+  // Distribute the mark-queue over the workers and mark all references in parallel.
+  for (auto i = 0U; i != m_markQueue.size(); ++i) {
+    m_workers[i % m_workerCount].markQueue.push_back(m_markQueue[i]);
+  }
+  m_markQueue.clear();
+  m_activeMarkWorkers.store(m_workerCount, std::memory_order_release);
+  runJob(JobType::Mark);
 }
 
 auto GarbageCollector::populateMarkQueue() noexcept -> void {
@@ -119,108 +352,200 @@ auto GarbageCollector::populateMarkQueue() noexcept -> void {
     populateMarkQueue(execHandle->getStack());
     execHandle = execHandle->getNext();
   }
+
+  // Forks that have not started yet are kept alive by the registry.
+  for (auto* future : m_execRegistry->getPendingForks()) {
+    m_markQueue.push_back(future);
+  }
 }
 
-auto GarbageCollector::populateMarkQueue(BasicStack* stack) noexcept -> void {
-  // Add all references on the stack to the mark-queue.
-  for (auto* sp = stack->getBottom(); sp != stack->getNext(); ++sp) {
-    assert(sp < stack->getNext());
-    if (sp->isRef()) {
-      auto* ref = sp->getRef();
+auto GarbageCollector::populateMarkQueue(const Stack* stack) noexcept -> void {
+  // Add all references on the stack (from all of its segments) to the mark-queue.
+  stack->forEach([this](const Value& val) {
+    if (val.isRef()) {
+      auto* ref = val.getRef();
       if (ref != nullptr) {
         m_markQueue.push_back(ref);
       }
     }
-  }
+  });
 }
 
-auto GarbageCollector::mark() noexcept -> void {
-  while (!m_markQueue.empty()) {
-    // Take a reference from the queue.
-    Ref* cur = m_markQueue.back();
-    m_markQueue.pop_back();
-
-    // If its allready marked then we ignore it.
-    if (cur->hasFlag<RefFlags::GcMarked>()) {
-      continue;
-    }
-
-    // Mark it.
-    cur->setFlag<RefFlags::GcMarked>();
-
-    // Push any child references it has to the queue.
-    switch (cur->getKind()) {
-    case RefKind::Struct: {
-      auto* s = downcastRef<StructRef>(cur);
-      for (auto* fP = s->getFieldsBegin(); fP != s->getFieldsEnd(); ++fP) {
-        if (fP->isRef()) {
-          auto* ref = fP->getRef();
-          if (ref != nullptr) {
-            m_markQueue.push_back(ref);
-          }
+// Push the children of the ref to the queue, collapsed string-links are added to 'collapsedLinks'.
+static auto pushChildren(
+    Ref* ref, std::vector<Ref*>* queue, std::vector<StringLinkRef*>* collapsedLinks) noexcept
+    -> void {
+  switch (ref->getKind()) {
+  case RefKind::Struct: {
+    auto* s = downcastRef<StructRef>(ref);
+    for (auto* fP = s->getFieldsBegin(); fP != s->getFieldsEnd(); ++fP) {
+      if (fP->isRef()) {
+        auto* fieldRef = fP->getRef();
+        if (fieldRef != nullptr) {
+          queue->push_back(fieldRef);
         }
       }
-    } break;
-    case RefKind::Future: {
-      auto* f  = downcastRef<FutureRef>(cur);
-      auto res = f->getResult();
-      if (res.isRef()) {
-        auto* ref = res.getRef();
-        if (ref != nullptr) {
-          m_markQueue.push_back(ref);
+    }
+  } break;
+  case RefKind::Array: {
+    auto* a = downcastRef<ArrayRef>(ref);
+    for (auto* vP = a->getValuesBegin(); vP != a->getValuesEnd(); ++vP) {
+      if (vP->isRef()) {
+        auto* valRef = vP->getRef();
+        if (valRef != nullptr) {
+          queue->push_back(valRef);
         }
       }
-    } break;
-    case RefKind::StringLink: {
-      auto* l = downcastRef<StringLinkRef>(cur);
-      if (l->isCollapsed()) {
-        m_markQueue.push_back(l->getCollapsed());
-        // If a collapsed representation has been computed we can safely discard the 'link' to the
-        // rest of the chain.
-        l->clearLink();
-      } else {
-        assert(l->getPrev() != nullptr);
-        m_markQueue.push_back(l->getPrev());
-        if (l->getVal().isRef()) {
-          auto* valRef = l->getVal().getRef();
-          assert(valRef != nullptr);
-          m_markQueue.push_back(valRef);
+    }
+  } break;
+  case RefKind::Future: {
+    auto* f = downcastRef<FutureRef>(ref);
+    for (auto val : {f->getArgs(), f->getResult()}) {
+      if (val.isRef()) {
+        auto* valRef = val.getRef();
+        if (valRef != nullptr) {
+          queue->push_back(valRef);
         }
       }
-    } break;
-    case RefKind::String:
-    case RefKind::StreamFile:
-    case RefKind::StreamConsole:
-    case RefKind::StreamTcp:
-    case RefKind::Long:
-      break;
     }
+  } break;
+  case RefKind::StringLink: {
+    auto* l    = downcastRef<StringLinkRef>(ref);
+    auto* prev = l->getPrev();
+    queue->push_back(prev);
+    if (l->isCollapsedPrev(prev)) {
+      // If a collapsed representation has been computed we can discard the 'val' of the link, but
+      // only once marking has finished as executors might still be walking the old chain.
+      if (collapsedLinks) {
+        collapsedLinks->push_back(l);
+      }
+    } else if (l->getVal().isRef()) {
+      auto* valRef = l->getVal().getRef();
+      assert(valRef != nullptr);
+      queue->push_back(valRef);
+    }
+  } break;
+  case RefKind::StringSlice:
+    queue->push_back(downcastRef<StringSliceRef>(ref)->getParent());
+    break;
+  case RefKind::String:
+  case RefKind::CharBuffer:
+  case RefKind::StreamFile:
+  case RefKind::StreamConsole:
+  case RefKind::StreamTcp:
+  case RefKind::Long:
+    break;
   }
 }
 
-auto GarbageCollector::sweep(Ref* head) noexcept -> void {
-  if (unlikely(head == nullptr)) {
-    return;
+auto GarbageCollector::populateMarkQueueRemembered() noexcept -> void {
+  // Old refs are not marked in a minor collection, but the young refs they point to are.
+  for (auto* ref : m_remembered) {
+    pushChildren(ref, &m_markQueue, nullptr);
+  }
+}
+
+auto GarbageCollector::mark(unsigned int workerIdx) noexcept -> void {
+  auto& worker = m_workers[workerIdx];
+  auto& queue  = worker.markQueue;
+  while (true) {
+    while (!queue.empty()) {
+      // Take a reference from the queue.
+      Ref* cur = queue.back();
+      queue.pop_back();
+
+      // Immortal refs are not part of the heap, there is nothing to mark (or free).
+      if (cur->hasFlag<RefFlags::Immortal>()) {
+        continue;
+      }
+
+      // Minor collections do not mark (or traverse) the old generation.
+      if (!m_majorCollection && cur->isOld()) {
+        continue;
+      }
+
+      // Mark it, if its allready marked (possibly by another worker) then we ignore it.
+      if (!m_refAlloc->tryMark(cur)) {
+        continue;
+      }
+
+      // Promote it to the old generation.
+      // Note: Only the worker that marked the ref modifies it.
+      cur->promote();
+
+      // Push any child references it has to the queue.
+      pushChildren(cur, &queue, &worker.collapsedLinks);
+
+      // Share work when we have plenty and other workers might be starving.
+      if (queue.size() > gcMarkShareSize &&
+          worker.sharedCount.load(std::memory_order_relaxed) == 0U) {
+        shareWork(&worker);
+      }
+    }
+    if (!takeWork(workerIdx) && !waitForWork(workerIdx)) {
+      return; // All workers are out of work.
+    }
   }
+}
 
-  // Walks the list of allocations, if its marked then its unmarked and if its not marked it is
-  // deleted. This won't ever delete the head node, reason is that would require syncronization as
-  // the running program might change the head.
+auto GarbageCollector::shareWork(Worker* worker) noexcept -> void {
+  const auto shareCount = worker->markQueue.size() / 2U;
+  const auto shareBegin = worker->markQueue.end() - shareCount;
 
-  head->unsetFlag<RefFlags::GcMarked>();
+  std::lock_guard<std::mutex> lk(worker->sharedMutex);
+  worker->sharedQueue.insert(worker->sharedQueue.end(), shareBegin, worker->markQueue.end());
+  worker->sharedCount.store(
+      static_cast<unsigned int>(worker->sharedQueue.size()), std::memory_order_release);
+  worker->markQueue.erase(shareBegin, worker->markQueue.end());
+}
 
-  Ref* prev = head;
-  Ref* cur  = m_refAlloc->getNextAlloc(head);
-  while (cur) {
-    if (cur->hasFlag<RefFlags::GcMarked>()) {
-      // Still reachable.
-      cur->unsetFlag<RefFlags::GcMarked>();
-      prev = cur;
-      cur  = m_refAlloc->getNextAlloc(cur);
-    } else {
-      // No longer reachable.
-      cur = m_refAlloc->freeNext(prev);
+auto GarbageCollector::takeWork(unsigned int workerIdx) noexcept -> bool {
+  // Take work from our own shared queue first, then try to steal from the other workers.
+  auto& queue = m_workers[workerIdx].markQueue;
+  for (auto i = 0U; i != m_workerCount; ++i) {
+    auto& victim = m_workers[(workerIdx + i) % m_workerCount];
+    if (victim.sharedCount.load(std::memory_order_acquire) == 0U) {
+      continue;
+    }
+    std::lock_guard<std::mutex> lk(victim.sharedMutex);
+    if (!victim.sharedQueue.empty()) {
+      queue.swap(victim.sharedQueue);
+      victim.sharedCount.store(0U, std::memory_order_release);
+      return true;
+    }
+  }
+  return false;
+}
+
+auto GarbageCollector::waitForWork(unsigned int workerIdx) noexcept -> bool {
+  /* Mark this worker as idle and wait until either work is shared or all workers are idle. Only
+  active workers can produce work, so once no workers are active marking is complete. */
+  m_activeMarkWorkers.fetch_sub(1U, std::memory_order_acq_rel);
+  while (true) {
+    for (auto i = 0U; i != m_workerCount; ++i) {
+      if (m_workers[i].sharedCount.load(std::memory_order_acquire) != 0U) {
+        m_activeMarkWorkers.fetch_add(1U, std::memory_order_acq_rel);
+        if (takeWork(workerIdx)) {
+          return true;
+        }
+        m_activeMarkWorkers.fetch_sub(1U, std::memory_order_acq_rel);
+      }
+    }
+    if (m_activeMarkWorkers.load(std::memory_order_acquire) == 0U) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+}
+
+auto GarbageCollector::sweep() noexcept -> void {
+  // Workers take units (pages) to sweep until all are swept.
+  while (true) {
+    const auto unit = m_nextSweepUnit.fetch_add(1U, std::memory_order_acq_rel);
+    if (unit >= m_sweepUnitCount) {
+      return;
     }
+    m_refAlloc->sweep(unit, !m_majorCollection);
   }
 }
 
@@ -1,32 +1,80 @@
 #pragma once
 #include "internal/executor_registry.hpp"
 #include "internal/ref_alloc_observer.hpp"
+#include "vm/memory_stats.hpp"
+#include "vm/pause_histogram.hpp"
+#include <chrono>
 #include <condition_variable>
+#include <memory>
 #include <thread>
 #include <vector>
 
 namespace vm::internal {
 
 class RefAllocator;
+class StringLinkRef;
 
-const auto gcByteInterval         = 100U * 1024U * 1024U; // 100 MiB
-const auto gcMinIntervalSeconds   = 10U;
+const auto gcMinTriggerBytes      = 1024U * 1024U; // Allocated between collections at the limit.
+const auto gcMajorInterval        = 4U; // Every n-th collection collects the full heap.
+const auto gcMaxWorkers           = 8U; // Maximum threads that mark and sweep in parallel.
+const auto gcMarkShareSize        = 64U; // Mark queue size before sharing work with other workers.
+const auto gcConcurrentMarkRounds = 4U; // Rounds of marking the mark-log before pausing to finish.
 const auto initialGcMarkQueueSize = 1024U;
 
-// Garbage collector is responsible for freeing unused references. It uses allocated bytes and
-// elapsed time as heuristics to decide when to run a collection pass.
+// Tunables of the garbage collector, see 'vm::Settings' for their defaults.
+struct GcSettings final {
+  unsigned int heapGrowth; // Percent of the live heap to allocate before collecting again.
+  uint64_t minHeap;        // Bytes to allocate before collecting, regardless of the live heap.
+  uint64_t heapLimit;      // Soft limit on the size of the heap, zero for no limit.
+  std::chrono::milliseconds idleInterval; // Collect when idle for this long, zero to disable.
+  unsigned int workers; // Threads that mark and sweep in parallel, zero for one per core.
+};
+
+// Garbage collector is responsible for freeing unused references. It uses the growth of the heap
+// and idle time as heuristics to decide when to run a collection pass.
+//
+// After every collection the next one is scheduled once the program has allocated 'heapGrowth'
+// percent of the live heap (the bytes that survived the sweep), but at least 'minHeap' bytes. This
+// keeps the cost of collecting proportional to the allocations of the program: small heaps are
+// collected often and large heaps rarely. When the live heap approaches the soft 'heapLimit' the
+// allocations between collections are capped so the heap stays below it (and the full heap is
+// collected), allocations never fail because of the limit. A program that has allocated since the
+// last collection but did not trigger a new one within the 'idleInterval' is collected as well,
+// this releases the garbage of programs that are mostly waiting.
 //
 // When collecting garbage it performs these steps:
 // * Wake up the collector thread.
 // * Pause all executors ('Stop the world').
-// * Mark all used objects on the stacks of all executors.
+// * Gather the references on the stacks of all executors (the roots).
 // * Resume all executors ('Resume the world').
+// * Mark all references reachable from the roots, concurrently with the program.
+// * Pause all executors again to mark the remaining references in the mark-log.
+// * Resume all executors.
 // * Remove all unused references ('Sweep').
 // * Put the collector thread to sleep.
 //
+// Marking is 'snapshot at the beginning': all refs that are reachable when marking begins are
+// marked. While marking the write-barrier of the RefAllocator records overwritten references in the
+// mark-log, refs that are allocated while marking are not part of the sweep. The pause times are
+// recorded in a histogram, the collection and pause counts are also published through relaxed
+// atomics so they can be read while the program is running (see 'getStats').
+//
+// Marking and sweeping are performed in parallel by a set of workers (the collector thread and
+// helper threads, up to 'gcMaxWorkers' in total). Each marking worker has its own mark queue, when
+// it grows large it shares half of it with the other workers who can steal from it once they run
+// out of work. Marks are stored in the bitmaps of the heap pages, sweeping is partitioned over the
+// pages (workers take pages until all are swept).
+//
+// The heap is split in two generations: refs that survived a collection are 'old', all refs
+// allocated since the last collection are 'young' (the nursery). Most collections are 'minor'
+// collections that only mark and sweep the nursery, old refs that point to young refs are found
+// through the remembered-set of the RefAllocator (filled by its write-barrier). Every
+// 'gcMajorInterval' collections a 'major' collection marks and sweeps the full heap.
+//
 class GarbageCollector final : public RefAllocObserver {
 public:
-  GarbageCollector(RefAllocator* refAlloc, ExecutorRegistry* execRegistry) noexcept;
+  GarbageCollector(
+      RefAllocator* refAlloc, ExecutorRegistry* execRegistry, const GcSettings& settings) noexcept;
   GarbageCollector(const GarbageCollector& rhs) = delete;
   GarbageCollector(GarbageCollector&& rhs)      = delete;
   ~GarbageCollector() noexcept;
@@ -37,6 +85,14 @@ public:
   auto requestCollection() noexcept -> void;
   auto terminateCollector() noexcept -> void;
 
+  // Histogram of the pause times.
+  // Note: Only safe to read after the collector has been terminated.
+  [[nodiscard]] auto getPauses() const noexcept -> const PauseHistogram& { return m_pauses; }
+
+  // Write the statistics of the collector and the allocators to the given stats.
+  // Note: Can be called while the program is running, the pause histogram is not included.
+  auto getStats(MemoryStats* out) const noexcept -> void;
+
 private:
   enum class RequestType : int {
     None      = 0,
@@ -44,26 +100,80 @@ private:
     Terminate = 2,
   };
 
+  enum class JobType : int {
+    Mark      = 0,
+    Sweep     = 1,
+    Terminate = 2,
+  };
+
+  struct Worker final {
+    std::vector<Ref*> markQueue;   // Only accessed by the worker itself.
+    std::vector<Ref*> sharedQueue; // Work that other workers can steal, protected by the mutex.
+    std::vector<StringLinkRef*> collapsedLinks; // Links to clear at the end of marking.
+    std::atomic<unsigned int> sharedCount;
+    std::mutex sharedMutex;
+  };
+
   RefAllocator* m_refAlloc;
   ExecutorRegistry* m_execRegistry;
+  GcSettings m_settings;
   std::vector<Ref*> m_markQueue;
-  std::atomic<int> m_bytesUntilNextCollection;
+  std::vector<Ref*> m_remembered;
+  std::atomic<int64_t> m_bytesUntilNextCollection;
+  unsigned int m_collectionCount;
+  bool m_majorCollection;
+  bool m_nextMajorCollection; // Set when approaching the heap limit.
+  PauseHistogram m_pauses;
+  std::chrono::steady_clock::time_point m_pauseStart;
+
+  std::atomic<uint64_t> m_statCollections;
+  std::atomic<uint64_t> m_statMajorCollections;
+  std::atomic<uint64_t> m_statPauseCount;
+  std::atomic<uint64_t> m_statPauseTotalNs;
+  std::atomic<uint64_t> m_statPauseMaxNs;
+  std::atomic<uint64_t> m_statHeapLiveBytes;
+  std::atomic<uint64_t> m_statHeapTriggerBytes;
 
   std::thread m_collectorThread;
   RequestType m_requestType;
   std::mutex m_requestMutex;
   std::condition_variable m_requestCondVar;
 
+  unsigned int m_workerCount;
+  std::unique_ptr<Worker[]> m_workers;
+  std::vector<std::thread> m_workerThreads;
+  std::atomic<unsigned int> m_activeMarkWorkers;
+  unsigned int m_sweepUnitCount;
+  std::atomic<unsigned int> m_nextSweepUnit;
+  JobType m_jobType;
+  unsigned int m_jobId;
+  unsigned int m_jobsPending;
+  std::mutex m_jobMutex;
+  std::condition_variable m_jobCondVar;
+  std::condition_variable m_jobDoneCondVar;
+
   auto notifyAlloc(unsigned int size) noexcept -> void override;
 
   auto request(RequestType type) noexcept -> void;
   auto collectorLoop() noexcept -> void;
 
+  auto workerLoop(unsigned int workerIdx) noexcept -> void;
+  auto runJob(JobType type) noexcept -> void;
+  auto runJob(JobType type, unsigned int workerIdx) noexcept -> void;
+
   auto collect() noexcept -> void;
+  auto scheduleNextCollection() noexcept -> void;
+  auto pause() noexcept -> void;
+  auto resume() noexcept -> void;
+  auto markQueue() noexcept -> void;
   auto populateMarkQueue() noexcept -> void;
-  auto populateMarkQueue(BasicStack* stack) noexcept -> void;
-  auto mark() noexcept -> void;
-  auto sweep(Ref* head) noexcept -> void;
+  auto populateMarkQueue(const Stack* stack) noexcept -> void;
+  auto populateMarkQueueRemembered() noexcept -> void;
+  auto mark(unsigned int workerIdx) noexcept -> void;
+  auto shareWork(Worker* worker) noexcept -> void;
+  auto takeWork(unsigned int workerIdx) noexcept -> bool;
+  auto waitForWork(unsigned int workerIdx) noexcept -> bool;
+  auto sweep() noexcept -> void;
 };
 
 } // namespace vm::internal
@@ -0,0 +1,145 @@
+#include "internal/heap_profiler.hpp"
+#include "internal/decoded_assembly.hpp"
+#include "internal/instruction.hpp"
+#include "internal/likely.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <csignal>
+
+namespace vm::internal {
+
+// Per thread state of the sampling, the countdown is shared between all profilers (in practice
+// only a single profiler is active at a time).
+static thread_local int64_t bytesUntilSample = 0;
+static thread_local uint64_t rngState        = 0U;
+
+static std::atomic_bool snapshotRequested{false};
+
+static auto onSnapshotSignal(int /*unused*/) noexcept -> void {
+  snapshotRequested.store(true, std::memory_order_relaxed);
+}
+
+// Xorshift64* generator, the samples do not need good randomness but drawing them has to be cheap.
+static auto nextRandom() noexcept -> uint64_t {
+  rngState ^= rngState >> 12U;
+  rngState ^= rngState << 25U;
+  rngState ^= rngState >> 27U;
+  return rngState * 0x2545F4914F6CDD1DULL;
+}
+
+// Draw the bytes until the next sample from an exponential distribution with the given mean.
+static auto nextSampleDistance(double mean) noexcept -> int64_t {
+  const auto uniform = static_cast<double>(nextRandom() >> 11U) * 0x1.0p-53; // [0, 1)
+  return static_cast<int64_t>(-std::log(1.0 - uniform) * mean) + 1;
+}
+
+HeapProfiler::HeapProfiler(
+    const DecodedAssembly* assembly, uint32_t sampleRate, SnapshotFunc snapshotFunc) noexcept :
+    m_sampleRate{static_cast<double>(std::max(sampleRate, 1U))},
+    m_snapshotFunc{std::move(snapshotFunc)},
+    m_stopRequested{false} {
+
+  m_profile.setSampleRate(sampleRate);
+  assembly->forEachFunctionEntry([this](uint32_t ipOffset) { m_profile.addFunction(ipOffset); });
+}
+
+HeapProfiler::~HeapProfiler() noexcept { stop(); }
+
+auto HeapProfiler::start() noexcept -> void {
+#if !defined(_WIN32)
+  if (!m_snapshotFunc) {
+    return;
+  }
+  assert(!m_snapshotThread.joinable());
+  m_stopRequested = false;
+  snapshotRequested.store(false, std::memory_order_relaxed);
+  signal(SIGUSR1, onSnapshotSignal);
+  m_snapshotThread = std::thread(&HeapProfiler::snapshotLoop, this);
+#endif // !_WIN32
+}
+
+auto HeapProfiler::stop() noexcept -> void {
+  if (!m_snapshotThread.joinable()) {
+    return;
+  }
+#if !defined(_WIN32)
+  signal(SIGUSR1, SIG_DFL);
+#endif // !_WIN32
+  {
+    auto lk         = std::lock_guard<std::mutex>{m_stopMutex};
+    m_stopRequested = true;
+  }
+  m_stopCondVar.notify_one();
+  m_snapshotThread.join();
+}
+
+auto HeapProfiler::notifyAlloc(Ref* ref, size_t size) noexcept -> void {
+  bytesUntilSample -= static_cast<int64_t>(size);
+  if (likely(bytesUntilSample > 0)) {
+    return;
+  }
+  if (unlikely(rngState == 0U)) {
+    // First allocation on this thread: seed the generator and start the countdown.
+    const auto seed  = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    rngState         = static_cast<uint64_t>(seed) | 1U;
+    bytesUntilSample = nextSampleDistance(m_sampleRate);
+    return;
+  }
+  bytesUntilSample = nextSampleDistance(m_sampleRate);
+  sample(ref, size);
+}
+
+auto HeapProfiler::notifyFree(Ref* ref) noexcept -> void {
+  auto lk  = std::lock_guard<std::mutex>{m_profileMutex};
+  auto itr = m_samples.find(ref);
+  if (itr == m_samples.end()) {
+    return;
+  }
+  const auto kind = static_cast<uint8_t>(ref->getKind());
+  m_profile.addFree(itr->second.ipOffset, kind, itr->second.count, itr->second.bytes);
+  m_samples.erase(itr);
+}
+
+auto HeapProfiler::takeProfile() noexcept -> HeapProfile {
+  auto lk = std::lock_guard<std::mutex>{m_profileMutex};
+  return std::move(m_profile);
+}
+
+auto HeapProfiler::sample(Ref* ref, size_t size) noexcept -> void {
+  /* Weigh the sample by the inverse of the chance that an allocation of this size is sampled,
+  this makes the totals unbiased estimates of all allocations (instead of only the big ones). */
+
+  const auto chance = 1.0 - std::exp(-static_cast<double>(size) / m_sampleRate);
+  const auto smp    = Sample{
+      heapAllocSite ? heapAllocSite->ipOffset : HeapProfile::unknownSite,
+      static_cast<uint64_t>(std::llround(1.0 / chance)),
+      static_cast<uint64_t>(std::llround(size / chance)),
+  };
+
+  ref->setFlag<RefFlags::HeapSampled>();
+
+  auto lk = std::lock_guard<std::mutex>{m_profileMutex};
+  m_profile.addAlloc(smp.ipOffset, static_cast<uint8_t>(ref->getKind()), smp.count, smp.bytes);
+  m_samples.emplace(ref, smp);
+}
+
+auto HeapProfiler::snapshotLoop() noexcept -> void {
+  auto lk = std::unique_lock<std::mutex>{m_stopMutex};
+  while (!m_stopCondVar.wait_for(
+      lk, heapSnapshotPollInterval, [this]() { return m_stopRequested; })) {
+
+    if (!snapshotRequested.exchange(false, std::memory_order_relaxed)) {
+      continue;
+    }
+    auto snapshot = HeapProfile{};
+    {
+      auto profileLk = std::lock_guard<std::mutex>{m_profileMutex};
+      snapshot       = m_profile;
+    }
+    m_snapshotFunc(snapshot);
+  }
+}
+
+} // namespace vm::internal
@@ -0,0 +1,82 @@
+#pragma once
+#include "internal/ref.hpp"
+#include "vm/heap_profile.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace vm::internal {
+
+class DecodedAssembly;
+struct Instruction;
+
+const auto heapSnapshotPollInterval = std::chrono::milliseconds{100};
+
+// Instruction that the executor on this thread is executing, executors publish it before executing
+// instructions that can allocate so the heap profiler can attribute the allocations to it.
+inline thread_local const Instruction* heapAllocSite = nullptr;
+
+// Heap profiler, samples allocations by bytes and records the instructions that made them.
+//
+// Every thread counts down the bytes until its next sample, the distances between samples are
+// drawn from an exponential distribution with the sample rate as the mean. This gives every
+// allocated byte the same chance to be sampled (so periodic allocation patterns do not bias the
+// result) and keeps the cost for allocations that are not sampled to a subtraction.
+//
+// Sampled refs are flagged, when the garbage collector frees a flagged ref it reports it to the
+// profiler. Optionally a snapshot of the profile can be requested while the program is running by
+// sending a 'SIGUSR1' signal to the process (not supported on windows).
+class HeapProfiler final {
+public:
+  using SnapshotFunc = std::function<void(const HeapProfile&)>;
+
+  HeapProfiler(
+      const DecodedAssembly* assembly, uint32_t sampleRate, SnapshotFunc snapshotFunc) noexcept;
+  HeapProfiler(const HeapProfiler& rhs) = delete;
+  HeapProfiler(HeapProfiler&& rhs)      = delete;
+  ~HeapProfiler() noexcept;
+
+  auto operator=(const HeapProfiler& rhs) -> HeapProfiler& = delete;
+  auto operator=(HeapProfiler&& rhs) -> HeapProfiler& = delete;
+
+  // Start (and stop) handling snapshot requests, does nothing when there is no snapshot function.
+  auto start() noexcept -> void;
+  auto stop() noexcept -> void;
+
+  // Called by the RefAllocator for every allocation.
+  // Note: Can be called from multiple threads concurrently.
+  auto notifyAlloc(Ref* ref, size_t size) noexcept -> void;
+
+  // Called by the garbage collector for every sampled ref that it frees (before destroying it).
+  // Note: Can be called from multiple threads concurrently.
+  auto notifyFree(Ref* ref) noexcept -> void;
+
+  // Take the profile that has been recorded so far.
+  [[nodiscard]] auto takeProfile() noexcept -> HeapProfile;
+
+private:
+  struct Sample final {
+    uint32_t ipOffset;
+    uint64_t count; // Estimated allocations that the sample represents.
+    uint64_t bytes; // Estimated bytes that the sample represents.
+  };
+
+  double m_sampleRate;
+  SnapshotFunc m_snapshotFunc;
+  HeapProfile m_profile;
+  std::unordered_map<const Ref*, Sample> m_samples; // Sampled refs that are not freed (yet).
+  std::mutex m_profileMutex;
+
+  std::thread m_snapshotThread;
+  bool m_stopRequested;
+  std::mutex m_stopMutex;
+  std::condition_variable m_stopCondVar;
+
+  auto sample(Ref* ref, size_t size) noexcept -> void;
+  auto snapshotLoop() noexcept -> void;
+};
+
+} // namespace vm::internal
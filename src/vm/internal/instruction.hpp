@@ -0,0 +1,51 @@
+#pragma once
+#include "internal/value.hpp"
+#include "novasm/op_code.hpp"
+#include <cstdint>
+
+namespace vm::internal {
+
+class StringRef;
+struct Instruction;
+
+// State that is passed to (and updated by) jit compiled native code.
+struct JitState final {
+  Value* sh;   // Stack-home of the current stack-frame.
+  Value* next; // Next free position on the stack, updated when the native code returns.
+  Value* max;  // End of the stack segment, the native code exits to the interpreter to grow it.
+  const int32_t* request; // Non-zero when the executor has to trap, checked at backward jumps.
+};
+
+// Entry into jit compiled native code, returns the next instruction to execute.
+using JitFunc = auto (*)(JitState* state) -> const Instruction*;
+
+// Op-code of the instruction that enters jit compiled native code. Only exists in the decoded
+// format, op-code 0 is never valid in novus assembly.
+constexpr auto jitEnterOpCode = static_cast<novasm::OpCode>(0U);
+
+/* Decoded representation of a single assembly instruction.
+ * Unlike the packed 'nova' assembly format all instructions have the same (aligned) size, operands
+ * are widened to their runtime representation and instruction-pointer operands are resolved to
+ * direct pointers to the target instruction. Only used by the executor, the serialized format is
+ * unaffected.
+ */
+struct alignas(16) Instruction final {
+  novasm::OpCode opCode;
+  uint8_t argA;      // Small operand: argument count, stack offset, field index, pcall code.
+  uint8_t argB;      // Second small operand (only used by some instructions).
+  uint8_t argC;      // Third small operand (only used by some instructions).
+  uint32_t ipOffset; // Offset of this instruction in the source assembly.
+  union {
+    int32_t intArg;
+    uint32_t uintArg;
+    float floatArg;
+    int64_t longArg;
+    const Instruction* target;
+    StringRef* litString; // Immortal string ref for the literal, created when decoding.
+    JitFunc native;
+  };
+};
+
+static_assert(sizeof(Instruction) == 16, "Unexpected decoded instruction size");
+
+} // namespace vm::internal
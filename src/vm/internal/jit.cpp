@@ -0,0 +1,951 @@
+#include "internal/jit.hpp"
+#include "internal/os_include.hpp"
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define VM_JIT_SUPPORTED
+#endif
+
+namespace vm::internal {
+
+#if defined(VM_JIT_SUPPORTED)
+
+using OpCode = novasm::OpCode;
+
+// Minimum amount of instructions in a run to be worth the overhead of entering native code.
+static const auto minRunLength = 3U;
+
+/* Register usage in the native code (System V calling convention):
+- rdi: Pointer to the 'JitState'.
+- r9:  Stack-home of the current stack-frame.
+- rcx: Next free position on the stack.
+- rdx: Stack limit.
+- rax, r8, xmm0, xmm1: Scratch registers.
+All registers used are caller-saved so no registers have to be preserved. */
+enum class Reg : uint8_t {
+  Rax = 0,
+  Rcx = 1,
+  Rdx = 2,
+  Rdi = 7,
+  R8  = 8,
+  R9  = 9,
+};
+
+enum class Xmm : uint8_t {
+  Xmm0 = 0,
+  Xmm1 = 1,
+};
+
+enum class Cond : uint8_t {
+  AboveEq = 0x3,
+  Eq      = 0x4,
+  NotEq   = 0x5,
+  Above   = 0x7,
+  Less    = 0xC,
+  Greater = 0xF,
+};
+
+// Arithmetic op-codes ('reg, r/m' form) and the matching '/digit' extension for the imm form.
+enum class Alu : uint8_t {
+  Add = 0x03,
+  Or  = 0x0B,
+  And = 0x23,
+  Sub = 0x2B,
+  Xor = 0x33,
+  Cmp = 0x3B,
+};
+
+static auto getAluExt(Alu alu) noexcept -> uint8_t { return static_cast<uint8_t>(alu) >> 3U; }
+
+static auto getRaw(Value val) noexcept -> uint64_t {
+  auto raw = uint64_t{};
+  std::memcpy(&raw, &val, sizeof(raw));
+  return raw;
+}
+
+// Minimal x86-64 instruction writer, only supports the forms that the templates use.
+class Writer final {
+public:
+  Writer() = default;
+
+  [[nodiscard]] auto getPos() const noexcept -> uint32_t {
+    return static_cast<uint32_t>(m_code.size());
+  }
+
+  [[nodiscard]] auto getCode() const noexcept -> const std::vector<uint8_t>& { return m_code; }
+
+  // mov dst, [base + disp]
+  auto movLoad(Reg dst, Reg base, int32_t disp) -> void {
+    rex(dst, base);
+    byte(0x8B);
+    memOperand(dst, base, disp);
+  }
+
+  // mov [base + disp], src
+  auto movStore(Reg base, int32_t disp, Reg src) -> void {
+    rex(src, base);
+    byte(0x89);
+    memOperand(src, base, disp);
+  }
+
+  // mov dst, src
+  auto movReg(Reg dst, Reg src) -> void {
+    rex(src, dst);
+    byte(0x89);
+    regOperand(src, dst);
+  }
+
+  // mov dst, imm64
+  auto movImm(Reg dst, uint64_t imm) -> void {
+    rex(Reg::Rax, dst);
+    byte(0xB8 + (static_cast<uint8_t>(dst) & 7U));
+    for (auto i = 0U; i != sizeof(uint64_t); ++i) {
+      byte(static_cast<uint8_t>(imm >> (i * 8U)));
+    }
+  }
+
+  // lea dst, [base + disp]
+  auto lea(Reg dst, Reg base, int32_t disp) -> void {
+    rex(dst, base);
+    byte(0x8D);
+    memOperand(dst, base, disp);
+  }
+
+  // <alu> dst, [base + disp]
+  auto aluLoad(Alu alu, Reg dst, Reg base, int32_t disp) -> void {
+    rex(dst, base);
+    byte(static_cast<uint8_t>(alu));
+    memOperand(dst, base, disp);
+  }
+
+  // <alu> dst, src
+  auto aluReg(Alu alu, Reg dst, Reg src) -> void {
+    rex(dst, src);
+    byte(static_cast<uint8_t>(alu));
+    regOperand(dst, src);
+  }
+
+  // <alu> dst, imm32 (sign extended)
+  auto aluImm(Alu alu, Reg dst, int32_t imm) -> void {
+    rex(Reg::Rax, dst);
+    byte(0x81);
+    regOperand(getAluExt(alu), dst);
+    imm32(static_cast<uint32_t>(imm));
+  }
+
+  // cmp dword [base + disp], imm8 (sign extended)
+  auto cmpLoad32Imm(Reg base, int32_t disp, int8_t imm) -> void {
+    if (static_cast<uint8_t>(base) >> 3U) {
+      byte(0x41); // Rex prefix (without 'w') for the extended base register.
+    }
+    byte(0x83);
+    memOperand(getAluExt(Alu::Cmp), base, disp);
+    byte(static_cast<uint8_t>(imm));
+  }
+
+  // imul dst, [base + disp]
+  auto imulLoad(Reg dst, Reg base, int32_t disp) -> void {
+    rex(dst, base);
+    byte(0x0F);
+    byte(0xAF);
+    memOperand(dst, base, disp);
+  }
+
+  auto shl(Reg dst, uint8_t amount) -> void { shift(4U, dst, amount); }
+  auto shr(Reg dst, uint8_t amount) -> void { shift(5U, dst, amount); }
+  auto sar(Reg dst, uint8_t amount) -> void { shift(7U, dst, amount); }
+
+  auto neg(Reg dst) -> void {
+    rex(Reg::Rax, dst);
+    byte(0xF7);
+    regOperand(3U, dst);
+  }
+
+  auto test(Reg a, Reg b) -> void {
+    rex(b, a);
+    byte(0x85);
+    regOperand(b, a);
+  }
+
+  // Set rax to 1 if the condition holds and to 0 otherwise.
+  auto setCondRax(Cond cond) -> void {
+    byte(0x0F);
+    byte(0x90 + static_cast<uint8_t>(cond)); // setcc al
+    byte(0xC0);
+    byte(0x0F);
+    byte(0xB6); // movzx eax, al
+    byte(0xC0);
+  }
+
+  // xor eax, eax
+  auto clearRax() -> void {
+    byte(0x31);
+    byte(0xC0);
+  }
+
+  // Returns the position of the (relative) target to patch.
+  [[nodiscard]] auto jmp() -> uint32_t {
+    byte(0xE9);
+    imm32(0U);
+    return getPos() - 4U;
+  }
+
+  // Returns the position of the (relative) target to patch.
+  [[nodiscard]] auto jcc(Cond cond) -> uint32_t {
+    byte(0x0F);
+    byte(0x80 + static_cast<uint8_t>(cond));
+    imm32(0U);
+    return getPos() - 4U;
+  }
+
+  auto patchJump(uint32_t patchPos, uint32_t targetPos) -> void {
+    const auto rel = static_cast<int32_t>(targetPos) - static_cast<int32_t>(patchPos + 4U);
+    std::memcpy(m_code.data() + patchPos, &rel, sizeof(rel));
+  }
+
+  auto ret() -> void { byte(0xC3); }
+
+  // movd xmm, eax
+  auto movdToXmm(Xmm dst) -> void {
+    byte(0x66);
+    byte(0x0F);
+    byte(0x6E);
+    regOperand(static_cast<uint8_t>(dst), Reg::Rax);
+  }
+
+  // movd eax, xmm
+  auto movdFromXmm(Xmm src) -> void {
+    byte(0x66);
+    byte(0x0F);
+    byte(0x7E);
+    regOperand(static_cast<uint8_t>(src), Reg::Rax);
+  }
+
+  auto addss(Xmm dst, Xmm src) -> void { scalarSingle(0x58, dst, src); }
+  auto mulss(Xmm dst, Xmm src) -> void { scalarSingle(0x59, dst, src); }
+  auto subss(Xmm dst, Xmm src) -> void { scalarSingle(0x5C, dst, src); }
+  auto divss(Xmm dst, Xmm src) -> void { scalarSingle(0x5E, dst, src); }
+
+  // ucomiss a, b
+  auto ucomiss(Xmm a, Xmm b) -> void {
+    byte(0x0F);
+    byte(0x2E);
+    byte(0xC0 | (static_cast<uint8_t>(a) << 3U) | static_cast<uint8_t>(b));
+  }
+
+  // cvtsi2ss xmm, eax
+  auto cvtIntToFloat(Xmm dst) -> void {
+    byte(0xF3);
+    byte(0x0F);
+    byte(0x2A);
+    regOperand(static_cast<uint8_t>(dst), Reg::Rax);
+  }
+
+  // cvttss2si eax, xmm
+  auto cvtFloatToInt(Xmm src) -> void {
+    byte(0xF3);
+    byte(0x0F);
+    byte(0x2C);
+    byte(0xC0 | static_cast<uint8_t>(src));
+  }
+
+private:
+  std::vector<uint8_t> m_code;
+
+  auto byte(uint8_t val) -> void { m_code.push_back(val); }
+
+  auto imm32(uint32_t val) -> void {
+    for (auto i = 0U; i != sizeof(uint32_t); ++i) {
+      byte(static_cast<uint8_t>(val >> (i * 8U)));
+    }
+  }
+
+  // Rex prefix for a 64 bit operation.
+  auto rex(Reg reg, Reg rm) -> void {
+    const auto r = static_cast<uint8_t>(reg) >> 3U;
+    const auto b = static_cast<uint8_t>(rm) >> 3U;
+    byte(0x48 | (r << 2U) | b);
+  }
+
+  auto regOperand(Reg reg, Reg rm) -> void { regOperand(static_cast<uint8_t>(reg), rm); }
+
+  auto regOperand(uint8_t reg, Reg rm) -> void {
+    byte(0xC0 | ((reg & 7U) << 3U) | (static_cast<uint8_t>(rm) & 7U));
+  }
+
+  auto memOperand(Reg reg, Reg base, int32_t disp) -> void {
+    memOperand(static_cast<uint8_t>(reg), base, disp);
+  }
+
+  auto memOperand(uint8_t reg, Reg base, int32_t disp) -> void {
+    // Note: 'rsp' and 'r12' (that would need a sib byte) are never used as a base.
+    const auto regBits  = static_cast<uint8_t>((reg & 7U) << 3U);
+    const auto baseBits = static_cast<uint8_t>(static_cast<uint8_t>(base) & 7U);
+    if (disp >= -128 && disp <= 127) {
+      byte(0x40 | regBits | baseBits);
+      byte(static_cast<uint8_t>(disp));
+    } else {
+      byte(0x80 | regBits | baseBits);
+      imm32(static_cast<uint32_t>(disp));
+    }
+  }
+
+  auto shift(uint8_t ext, Reg dst, uint8_t amount) -> void {
+    rex(Reg::Rax, dst);
+    byte(0xC1);
+    regOperand(ext, dst);
+    byte(amount);
+  }
+
+  auto scalarSingle(uint8_t opCode, Xmm dst, Xmm src) -> void {
+    byte(0xF3);
+    byte(0x0F);
+    byte(opCode);
+    byte(0xC0 | (static_cast<uint8_t>(dst) << 3U) | static_cast<uint8_t>(src));
+  }
+};
+
+static auto isJitSupported(const Instruction& instr) noexcept -> bool {
+  switch (instr.opCode) {
+  case OpCode::LoadLitLong:
+    // Longs that cannot be stored inline are allocated on the heap.
+    return isInlineLong(instr.longArg);
+  case OpCode::LoadLitInt:
+  case OpCode::LoadLitFloat:
+  case OpCode::LoadLitIp:
+  case OpCode::StackAlloc:
+  case OpCode::StackStore:
+  case OpCode::StackLoad:
+  case OpCode::AddInt:
+  case OpCode::AddIntLit:
+  case OpCode::SubInt:
+  case OpCode::MulInt:
+  case OpCode::NegInt:
+  case OpCode::LogicInvInt:
+  case OpCode::AndInt:
+  case OpCode::OrInt:
+  case OpCode::XorInt:
+  case OpCode::InvInt:
+  case OpCode::AddFloat:
+  case OpCode::SubFloat:
+  case OpCode::MulFloat:
+  case OpCode::DivFloat:
+  case OpCode::NegFloat:
+  case OpCode::StackAddInt:
+  case OpCode::StackSubInt:
+  case OpCode::StackMulInt:
+  case OpCode::StackAddFloat:
+  case OpCode::StackSubFloat:
+  case OpCode::StackMulFloat:
+  case OpCode::StackDivFloat:
+  case OpCode::StackCheckEqInt:
+  case OpCode::StackCheckGtInt:
+  case OpCode::StackCheckLeInt:
+  case OpCode::StackCheckGtFloat:
+  case OpCode::StackCheckLeFloat:
+  case OpCode::StackAddIntStore:
+  case OpCode::StackSubIntStore:
+  case OpCode::StackMulIntStore:
+  case OpCode::StackAddFloatStore:
+  case OpCode::StackSubFloatStore:
+  case OpCode::StackMulFloatStore:
+  case OpCode::StackDivFloatStore:
+  case OpCode::CheckEqInt:
+  case OpCode::CheckEqIp:
+  case OpCode::CheckGtInt:
+  case OpCode::CheckLeInt:
+  case OpCode::CheckGtFloat:
+  case OpCode::CheckLeFloat:
+  case OpCode::ConvIntFloat:
+  case OpCode::ConvFloatInt:
+  case OpCode::ConvIntChar:
+  case OpCode::Jump:
+  case OpCode::JumpIf:
+  case OpCode::CheckEqIntJumpIf:
+  case OpCode::Dup:
+  case OpCode::Pop:
+  case OpCode::Swap:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static auto slotDisp(uint8_t offset) noexcept -> int32_t {
+  return static_cast<int32_t>(offset) * static_cast<int32_t>(sizeof(Value));
+}
+
+static const auto valSize = static_cast<int32_t>(sizeof(Value));
+
+// Compiles a single run of supported instructions.
+class RunCompiler final {
+public:
+  RunCompiler(Writer* writer, const Instruction* instructions, uint32_t begin, uint32_t end) :
+      m_writer{writer},
+      m_instructions{instructions},
+      m_begin{begin},
+      m_end{end},
+      m_labels(end - begin, 0U),
+      m_instr{nullptr} {}
+
+  // Compile the run with the given entry points, returns the position of each entry.
+  auto compile(const std::vector<uint32_t>& entries) -> std::vector<uint32_t> {
+    auto& w = *m_writer;
+
+    // Entry stubs, load the state into registers and jump to the instruction.
+    auto entryPositions = std::vector<uint32_t>{};
+    auto entryPatches   = std::vector<std::pair<uint32_t, uint32_t>>{};
+    for (const auto entry : entries) {
+      entryPositions.push_back(w.getPos());
+      w.movLoad(Reg::R9, Reg::Rdi, offsetof(JitState, sh));
+      w.movLoad(Reg::Rcx, Reg::Rdi, offsetof(JitState, next));
+      w.movLoad(Reg::Rdx, Reg::Rdi, offsetof(JitState, max));
+      if (entry != m_begin) {
+        entryPatches.emplace_back(w.jmp(), entry);
+      }
+    }
+    // Note: The last entry stub is always for the start of the run so it can fall through.
+
+    for (auto i = m_begin; i != m_end; ++i) {
+      m_labels[i - m_begin] = w.getPos();
+      m_instr               = &m_instructions[i];
+      compileInstr(m_instructions[i]);
+    }
+    exitTo(&m_instructions[m_end]);
+
+    // Exit stubs, write back the stack position and return the next instruction to execute.
+    for (const auto& [patchPos, target] : m_exitPatches) {
+      auto existing = m_exitStubs.find(target);
+      if (existing != m_exitStubs.end()) {
+        w.patchJump(patchPos, existing->second);
+        continue;
+      }
+      m_exitStubs.insert({target, w.getPos()});
+      w.patchJump(patchPos, w.getPos());
+      w.movStore(Reg::Rdi, offsetof(JitState, next), Reg::Rcx);
+      w.movImm(Reg::Rax, reinterpret_cast<uint64_t>(target)); // NOLINT: Reinterpret cast
+      w.ret();
+    }
+
+    for (const auto& [patchPos, target] : m_branchPatches) {
+      w.patchJump(patchPos, m_labels[target - m_begin]);
+    }
+    for (const auto& [patchPos, target] : entryPatches) {
+      w.patchJump(patchPos, m_labels[target - m_begin]);
+    }
+    return entryPositions;
+  }
+
+private:
+  Writer* m_writer;
+  const Instruction* m_instructions;
+  uint32_t m_begin;
+  uint32_t m_end;
+  std::vector<uint32_t> m_labels;
+  const Instruction* m_instr; // Instruction that is being compiled.
+  std::vector<std::pair<uint32_t, uint32_t>> m_branchPatches;
+  std::vector<std::pair<uint32_t, const Instruction*>> m_exitPatches;
+  std::unordered_map<const Instruction*, uint32_t> m_exitStubs;
+
+  auto exitTo(const Instruction* target) -> void {
+    m_exitPatches.emplace_back(m_writer->jmp(), target);
+  }
+
+  // Jump to the target instruction when the condition holds, either directly to the native code of
+  // the target (when its part of this run) or by returning it to the interpreter.
+  auto branch(const Instruction* target, std::optional<Cond> cond) -> void {
+    const auto patchPos = cond ? m_writer->jcc(*cond) : m_writer->jmp();
+    const auto index    = static_cast<uint32_t>(target - m_instructions);
+    if (index >= m_begin && index < m_end) {
+      m_branchPatches.emplace_back(patchPos, index);
+    } else {
+      m_exitPatches.emplace_back(patchPos, target);
+    }
+  }
+
+  // Return to the interpreter at the current (jump) instruction when the executor has to trap and
+  // the jump goes backwards inside this run, otherwise loops would never reach a safe-point.
+  auto exitIfTrapBeforeLoop(const Instruction* target) -> void {
+    const auto index = static_cast<uint32_t>(target - m_instructions);
+    if (index < m_begin || target > m_instr) {
+      return;
+    }
+    m_writer->movLoad(Reg::Rax, Reg::Rdi, offsetof(JitState, request));
+    m_writer->cmpLoad32Imm(Reg::Rax, 0, 0);
+    m_exitPatches.emplace_back(m_writer->jcc(Cond::NotEq), m_instr);
+  }
+
+  // Return to the interpreter at the current instruction when there is not enough space left on
+  // the stack, it grows the stack. The check is done before the instruction modifies the stack.
+  auto exitIfFull(Reg newNext) -> void {
+    m_writer->aluReg(Alu::Cmp, newNext, Reg::Rdx);
+    m_exitPatches.emplace_back(m_writer->jcc(Cond::Above), m_instr);
+  }
+
+  auto push(Reg reg) -> void {
+    auto& w = *m_writer;
+    w.lea(Reg::R8, Reg::Rcx, valSize);
+    exitIfFull(Reg::R8);
+    w.movStore(Reg::Rcx, 0, reg);
+    w.movReg(Reg::Rcx, Reg::R8);
+  }
+
+  auto pushImm(Value val) -> void {
+    m_writer->movImm(Reg::Rax, getRaw(val));
+    push(Reg::Rax);
+  }
+
+  // Replace the top two values on the stack with the value in rax.
+  auto replaceTwo() -> void {
+    m_writer->movStore(Reg::Rcx, -2 * valSize, Reg::Rax);
+    m_writer->aluImm(Alu::Sub, Reg::Rcx, valSize);
+  }
+
+  // Convert the result of a condition to a bool value in rax.
+  auto condToBool(Cond cond) -> void {
+    m_writer->setCondRax(cond);
+    m_writer->shl(Reg::Rax, 32U);
+  }
+
+  // Load the float in the value at [base + disp] into the xmm register.
+  auto loadFloat(Xmm dst, Reg base, int32_t disp) -> void {
+    m_writer->movLoad(Reg::Rax, base, disp);
+    m_writer->shr(Reg::Rax, 32U);
+    m_writer->movdToXmm(dst);
+  }
+
+  // Convert the float in the xmm register to a value in rax.
+  auto storeFloat(Xmm src) -> void {
+    m_writer->movdFromXmm(src);
+    m_writer->shl(Reg::Rax, 32U);
+  }
+
+  // Int operation on the values at [base + dispA] and [base + dispB], result is stored in rax.
+  // Note: Ints are stored in the upper 32 bits (lower bits are zero) so add, substract and bitwise
+  // operations on the raw values give the correct (wrapped around) result.
+  auto intOp(OpCode op, Reg base, int32_t dispA, int32_t dispB) -> void {
+    auto& w = *m_writer;
+    w.movLoad(Reg::Rax, base, dispA);
+    switch (op) {
+    case OpCode::AddInt:
+      w.aluLoad(Alu::Add, Reg::Rax, base, dispB);
+      break;
+    case OpCode::SubInt:
+      w.aluLoad(Alu::Sub, Reg::Rax, base, dispB);
+      break;
+    case OpCode::MulInt:
+      w.sar(Reg::Rax, 32U);
+      w.imulLoad(Reg::Rax, base, dispB);
+      break;
+    case OpCode::AndInt:
+      w.aluLoad(Alu::And, Reg::Rax, base, dispB);
+      break;
+    case OpCode::OrInt:
+      w.aluLoad(Alu::Or, Reg::Rax, base, dispB);
+      break;
+    case OpCode::XorInt:
+      w.aluLoad(Alu::Xor, Reg::Rax, base, dispB);
+      break;
+    default:
+      assert(false);
+      break;
+    }
+  }
+
+  // Float operation on the values at [base + dispA] and [base + dispB], result is stored in rax.
+  auto floatOp(OpCode op, Reg base, int32_t dispA, int32_t dispB) -> void {
+    auto& w = *m_writer;
+    loadFloat(Xmm::Xmm0, base, dispA);
+    loadFloat(Xmm::Xmm1, base, dispB);
+    switch (op) {
+    case OpCode::AddFloat:
+      w.addss(Xmm::Xmm0, Xmm::Xmm1);
+      break;
+    case OpCode::SubFloat:
+      w.subss(Xmm::Xmm0, Xmm::Xmm1);
+      break;
+    case OpCode::MulFloat:
+      w.mulss(Xmm::Xmm0, Xmm::Xmm1);
+      break;
+    case OpCode::DivFloat:
+      w.divss(Xmm::Xmm0, Xmm::Xmm1);
+      break;
+    default:
+      assert(false);
+      break;
+    }
+    storeFloat(Xmm::Xmm0);
+  }
+
+  // Compare the values at [base + dispA] and [base + dispB], result is stored in rax.
+  auto checkOp(OpCode op, Reg base, int32_t dispA, int32_t dispB) -> void {
+    auto& w = *m_writer;
+    switch (op) {
+    case OpCode::CheckEqInt:
+    case OpCode::CheckEqIp:
+    case OpCode::CheckGtInt:
+    case OpCode::CheckLeInt:
+      // Note: Comparing the raw values gives the same result as comparing the ints.
+      w.movLoad(Reg::Rax, base, dispA);
+      w.aluLoad(Alu::Cmp, Reg::Rax, base, dispB);
+      condToBool(
+          op == OpCode::CheckGtInt ? Cond::Greater
+                                   : (op == OpCode::CheckLeInt ? Cond::Less : Cond::Eq));
+      break;
+    case OpCode::CheckGtFloat:
+      // Note: Unordered (NaN) comparisons set the carry flag, so 'above' is false for them.
+      loadFloat(Xmm::Xmm0, base, dispA);
+      loadFloat(Xmm::Xmm1, base, dispB);
+      w.ucomiss(Xmm::Xmm0, Xmm::Xmm1);
+      condToBool(Cond::Above);
+      break;
+    case OpCode::CheckLeFloat:
+      loadFloat(Xmm::Xmm0, base, dispA);
+      loadFloat(Xmm::Xmm1, base, dispB);
+      w.ucomiss(Xmm::Xmm1, Xmm::Xmm0);
+      condToBool(Cond::Above);
+      break;
+    default:
+      assert(false);
+      break;
+    }
+  }
+
+  // Map the three-address stack instructions to their stack based counterpart.
+  static auto getStackOpBase(OpCode op) -> OpCode {
+    switch (op) {
+    case OpCode::StackAddInt:
+    case OpCode::StackAddIntStore:
+      return OpCode::AddInt;
+    case OpCode::StackSubInt:
+    case OpCode::StackSubIntStore:
+      return OpCode::SubInt;
+    case OpCode::StackMulInt:
+    case OpCode::StackMulIntStore:
+      return OpCode::MulInt;
+    case OpCode::StackAddFloat:
+    case OpCode::StackAddFloatStore:
+      return OpCode::AddFloat;
+    case OpCode::StackSubFloat:
+    case OpCode::StackSubFloatStore:
+      return OpCode::SubFloat;
+    case OpCode::StackMulFloat:
+    case OpCode::StackMulFloatStore:
+      return OpCode::MulFloat;
+    case OpCode::StackDivFloat:
+    case OpCode::StackDivFloatStore:
+      return OpCode::DivFloat;
+    case OpCode::StackCheckEqInt:
+      return OpCode::CheckEqInt;
+    case OpCode::StackCheckGtInt:
+      return OpCode::CheckGtInt;
+    case OpCode::StackCheckLeInt:
+      return OpCode::CheckLeInt;
+    case OpCode::StackCheckGtFloat:
+      return OpCode::CheckGtFloat;
+    case OpCode::StackCheckLeFloat:
+      return OpCode::CheckLeFloat;
+    default:
+      assert(false);
+      return OpCode::Fail;
+    }
+  }
+
+  // Emit code for a stack-based or three-address variant of an int, float or compare operation.
+  auto binaryOp(OpCode op, Reg base, int32_t dispA, int32_t dispB) -> void {
+    switch (op) {
+    case OpCode::AddFloat:
+    case OpCode::SubFloat:
+    case OpCode::MulFloat:
+    case OpCode::DivFloat:
+      floatOp(op, base, dispA, dispB);
+      break;
+    case OpCode::CheckEqInt:
+    case OpCode::CheckEqIp:
+    case OpCode::CheckGtInt:
+    case OpCode::CheckLeInt:
+    case OpCode::CheckGtFloat:
+    case OpCode::CheckLeFloat:
+      checkOp(op, base, dispA, dispB);
+      break;
+    default:
+      intOp(op, base, dispA, dispB);
+      break;
+    }
+  }
+
+  auto compileInstr(const Instruction& instr) -> void {
+    auto& w = *m_writer;
+    switch (instr.opCode) {
+    case OpCode::LoadLitInt:
+      pushImm(intValue(instr.intArg));
+      break;
+    case OpCode::LoadLitLong:
+      pushImm(inlineLongValue(instr.longArg));
+      break;
+    case OpCode::LoadLitFloat:
+      pushImm(floatValue(instr.floatArg));
+      break;
+    case OpCode::LoadLitIp:
+      pushImm(rawPtrValue(instr.target));
+      break;
+
+    case OpCode::StackAlloc: {
+      const auto size = static_cast<int32_t>(instr.argA) * valSize;
+      w.lea(Reg::R8, Reg::Rcx, size);
+      exitIfFull(Reg::R8);
+      w.clearRax();
+      for (auto disp = 0; disp != size; disp += valSize) {
+        w.movStore(Reg::Rcx, disp, Reg::Rax);
+      }
+      w.movReg(Reg::Rcx, Reg::R8);
+    } break;
+    case OpCode::StackStore:
+      w.movLoad(Reg::Rax, Reg::Rcx, -valSize);
+      w.aluImm(Alu::Sub, Reg::Rcx, valSize);
+      w.movStore(Reg::R9, slotDisp(instr.argA), Reg::Rax);
+      break;
+    case OpCode::StackLoad:
+      w.movLoad(Reg::Rax, Reg::R9, slotDisp(instr.argA));
+      push(Reg::Rax);
+      break;
+
+    case OpCode::AddInt:
+    case OpCode::SubInt:
+    case OpCode::MulInt:
+    case OpCode::AndInt:
+    case OpCode::OrInt:
+    case OpCode::XorInt:
+    case OpCode::AddFloat:
+    case OpCode::SubFloat:
+    case OpCode::MulFloat:
+    case OpCode::DivFloat:
+    case OpCode::CheckEqInt:
+    case OpCode::CheckEqIp:
+    case OpCode::CheckGtInt:
+    case OpCode::CheckLeInt:
+    case OpCode::CheckGtFloat:
+    case OpCode::CheckLeFloat:
+      binaryOp(instr.opCode, Reg::Rcx, -2 * valSize, -valSize);
+      replaceTwo();
+      break;
+    case OpCode::AddIntLit:
+      w.movImm(Reg::R8, getRaw(intValue(instr.intArg)));
+      w.movLoad(Reg::Rax, Reg::Rcx, -valSize);
+      w.aluReg(Alu::Add, Reg::Rax, Reg::R8);
+      w.movStore(Reg::Rcx, -valSize, Reg::Rax);
+      break;
+    case OpCode::NegInt:
+      w.movLoad(Reg::Rax, Reg::Rcx, -valSize);
+      w.neg(Reg::Rax);
+      w.movStore(Reg::Rcx, -valSize, Reg::Rax);
+      break;
+    case OpCode::InvInt:
+    case OpCode::NegFloat:
+      // Flip all the bits of the int or the sign bit of the float.
+      w.movImm(Reg::R8, instr.opCode == OpCode::InvInt ? 0xFFFFFFFF00000000UL : 1UL << 63U);
+      w.movLoad(Reg::Rax, Reg::Rcx, -valSize);
+      w.aluReg(Alu::Xor, Reg::Rax, Reg::R8);
+      w.movStore(Reg::Rcx, -valSize, Reg::Rax);
+      break;
+    case OpCode::LogicInvInt:
+      w.movLoad(Reg::Rax, Reg::Rcx, -valSize);
+      w.test(Reg::Rax, Reg::Rax);
+      condToBool(Cond::Eq);
+      w.movStore(Reg::Rcx, -valSize, Reg::Rax);
+      break;
+
+    case OpCode::StackAddInt:
+    case OpCode::StackSubInt:
+    case OpCode::StackMulInt:
+    case OpCode::StackAddFloat:
+    case OpCode::StackSubFloat:
+    case OpCode::StackMulFloat:
+    case OpCode::StackDivFloat:
+    case OpCode::StackCheckEqInt:
+    case OpCode::StackCheckGtInt:
+    case OpCode::StackCheckLeInt:
+    case OpCode::StackCheckGtFloat:
+    case OpCode::StackCheckLeFloat:
+      binaryOp(getStackOpBase(instr.opCode), Reg::R9, slotDisp(instr.argA), slotDisp(instr.argB));
+      push(Reg::Rax);
+      break;
+    case OpCode::StackAddIntStore:
+    case OpCode::StackSubIntStore:
+    case OpCode::StackMulIntStore:
+    case OpCode::StackAddFloatStore:
+    case OpCode::StackSubFloatStore:
+    case OpCode::StackMulFloatStore:
+    case OpCode::StackDivFloatStore:
+      binaryOp(getStackOpBase(instr.opCode), Reg::R9, slotDisp(instr.argA), slotDisp(instr.argB));
+      w.movStore(Reg::R9, slotDisp(instr.argC), Reg::Rax);
+      break;
+
+    case OpCode::ConvIntFloat:
+      w.movLoad(Reg::Rax, Reg::Rcx, -valSize);
+      w.sar(Reg::Rax, 32U);
+      w.cvtIntToFloat(Xmm::Xmm0);
+      storeFloat(Xmm::Xmm0);
+      w.movStore(Reg::Rcx, -valSize, Reg::Rax);
+      break;
+    case OpCode::ConvFloatInt:
+      loadFloat(Xmm::Xmm0, Reg::Rcx, -valSize);
+      w.cvtFloatToInt(Xmm::Xmm0);
+      w.shl(Reg::Rax, 32U);
+      w.movStore(Reg::Rcx, -valSize, Reg::Rax);
+      break;
+    case OpCode::ConvIntChar:
+      w.movImm(Reg::R8, 0xFF00000000UL);
+      w.movLoad(Reg::Rax, Reg::Rcx, -valSize);
+      w.aluReg(Alu::And, Reg::Rax, Reg::R8);
+      w.movStore(Reg::Rcx, -valSize, Reg::Rax);
+      break;
+
+    case OpCode::Jump:
+      exitIfTrapBeforeLoop(instr.target);
+      branch(instr.target, std::nullopt);
+      break;
+    case OpCode::JumpIf:
+      exitIfTrapBeforeLoop(instr.target);
+      // Note: 'lea' is used to pop as it does not modify the flags.
+      w.movLoad(Reg::Rax, Reg::Rcx, -valSize);
+      w.lea(Reg::Rcx, Reg::Rcx, -valSize);
+      w.test(Reg::Rax, Reg::Rax);
+      branch(instr.target, Cond::NotEq);
+      break;
+    case OpCode::CheckEqIntJumpIf:
+      exitIfTrapBeforeLoop(instr.target);
+      w.movLoad(Reg::Rax, Reg::Rcx, -2 * valSize);
+      w.lea(Reg::Rcx, Reg::Rcx, -2 * valSize);
+      w.aluLoad(Alu::Cmp, Reg::Rax, Reg::Rcx, valSize);
+      branch(instr.target, Cond::Eq);
+      break;
+
+    case OpCode::Dup:
+      w.movLoad(Reg::Rax, Reg::Rcx, -valSize);
+      push(Reg::Rax);
+      break;
+    case OpCode::Pop:
+      w.aluImm(Alu::Sub, Reg::Rcx, valSize);
+      break;
+    case OpCode::Swap:
+      w.movLoad(Reg::Rax, Reg::Rcx, -valSize);
+      w.movLoad(Reg::R8, Reg::Rcx, -2 * valSize);
+      w.movStore(Reg::Rcx, -2 * valSize, Reg::Rax);
+      w.movStore(Reg::Rcx, -valSize, Reg::R8);
+      break;
+
+    default:
+      assert(false);
+      break;
+    }
+  }
+};
+
+JitCode::JitCode() noexcept : m_code{nullptr}, m_size{0U} {}
+
+JitCode::~JitCode() noexcept {
+  if (m_code) {
+    munmap(m_code, m_size);
+  }
+}
+
+auto JitCode::isSupported() noexcept -> bool { return true; }
+
+auto JitCode::compile(DecodedAssembly* assembly) noexcept -> bool {
+  auto& instructions = assembly->m_instructions;
+  const auto count   = static_cast<uint32_t>(instructions.size());
+
+  // Find all instructions that execution can jump to (jump / call targets and the entrypoint).
+  auto isLeader = std::vector<bool>(count, false);
+  isLeader[static_cast<uint32_t>(assembly->m_entrypoint - instructions.data())] = true;
+  for (const auto& instr : instructions) {
+    switch (instr.opCode) {
+    case OpCode::LoadLitIp:
+    case OpCode::Jump:
+    case OpCode::JumpIf:
+    case OpCode::CheckEqIntJumpIf:
+    case OpCode::StructPeekFieldJumpIf:
+    case OpCode::Call:
+    case OpCode::CallTail:
+    case OpCode::CallForked:
+      isLeader[static_cast<uint32_t>(instr.target - instructions.data())] = true;
+      break;
+    default:
+      break;
+    }
+  }
+
+  /* Compile all runs of supported instructions, every run can be entered at its start and at any
+  leader inside it (as long as enough instructions are left). */
+  auto writer  = Writer{};
+  auto patches = std::vector<std::pair<uint32_t, uint32_t>>{}; // Instruction index, code position.
+  for (auto begin = 0U; begin != count;) {
+    auto end = begin;
+    while (end != count && isJitSupported(instructions[end])) {
+      ++end;
+    }
+    if (end - begin >= minRunLength) {
+      auto entries = std::vector<uint32_t>{};
+      for (auto i = begin + 1U; i + minRunLength <= end; ++i) {
+        if (isLeader[i]) {
+          entries.push_back(i);
+        }
+      }
+      entries.push_back(begin); // Start of the run last, its entry stub falls through.
+
+      auto runCompiler     = RunCompiler{&writer, instructions.data(), begin, end};
+      const auto positions = runCompiler.compile(entries);
+      for (auto i = 0U; i != entries.size(); ++i) {
+        patches.emplace_back(entries[i], positions[i]);
+      }
+    }
+    begin = end == begin ? begin + 1U : end;
+  }
+  if (patches.empty()) {
+    return false;
+  }
+
+  // Copy the code to executable memory.
+  const auto& code = writer.getCode();
+  auto* mem =
+      mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) {
+    return false;
+  }
+  std::memcpy(mem, code.data(), code.size());
+  if (mprotect(mem, code.size(), PROT_READ | PROT_EXEC) != 0) {
+    munmap(mem, code.size());
+    return false;
+  }
+  m_code = mem;
+  m_size = code.size();
+
+  // Patch the entry instructions to enter the native code.
+  for (const auto& [index, codePos] : patches) {
+    auto& instr  = instructions[index];
+    instr.opCode = jitEnterOpCode;
+    instr.native = reinterpret_cast<JitFunc>(static_cast<uint8_t*>(mem) + codePos); // NOLINT
+  }
+  return true;
+}
+
+#else // !VM_JIT_SUPPORTED
+
+JitCode::JitCode() noexcept : m_code{nullptr}, m_size{0U} {}
+
+JitCode::~JitCode() noexcept = default;
+
+auto JitCode::isSupported() noexcept -> bool { return false; }
+
+auto JitCode::compile(DecodedAssembly* /*unused*/) noexcept -> bool { return false; }
+
+#endif // !VM_JIT_SUPPORTED
+
+} // namespace vm::internal
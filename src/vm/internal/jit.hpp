@@ -0,0 +1,49 @@
+#pragma once
+#include "internal/decoded_assembly.hpp"
+#include <cstddef>
+
+namespace vm::internal {
+
+// Native code produced by the baseline (template) jit compiler.
+//
+// Runs of simple instructions (literals, stack, arithmetic, compare and jump instructions) are
+// translated to x86-64 code, each instruction to a fixed template. The first instruction of a run
+// (and any jump target inside it) is replaced by a 'jit-enter' instruction that executes the native
+// code. Native code operates directly on the executor stack (using the same value encoding) and
+// returns to the interpreter at the first instruction that it does not support, or at the first
+// instruction that needs more stack space than is left in the current stack segment.
+//
+// Runs are compiled eagerly for the whole assembly instead of per called function, the runs never
+// contain calls or returns so they do not need to know where functions begin or end.
+//
+// Native code never allocates, never blocks and never calls out. The only safe-points in native code
+// are backward jumps inside a run (loops): when the executor has to trap the native code returns to
+// the interpreter at the jump instead, which traps before executing it (or before entering native
+// code again). All values are written back to the stack before returning to the interpreter.
+//
+// Note: Only supported on x86-64 (non-windows) platforms, on other platforms nothing is compiled.
+class JitCode final {
+public:
+  JitCode() noexcept;
+  JitCode(const JitCode& rhs) = delete;
+  JitCode(JitCode&& rhs)      = delete;
+  ~JitCode() noexcept;
+
+  auto operator=(const JitCode& rhs) -> JitCode& = delete;
+  auto operator=(JitCode&& rhs) -> JitCode& = delete;
+
+  [[nodiscard]] static auto isSupported() noexcept -> bool;
+
+  // Size (in bytes) of the native code.
+  [[nodiscard]] auto getSize() const noexcept -> size_t { return m_size; }
+
+  // Compile the assembly and patch its instructions to enter the native code.
+  // Note: The native code has to outlive any execution of the assembly.
+  auto compile(DecodedAssembly* assembly) noexcept -> bool;
+
+private:
+  void* m_code;
+  size_t m_size;
+};
+
+} // namespace vm::internal
@@ -1,225 +1,297 @@
 #include "internal/memory_allocator.hpp"
 #include "internal/os_include.hpp"
 #include "likely.hpp"
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <mutex>
+#include <new>
 #include <vector>
 
 namespace vm::internal {
 
 /*
-Naive allocator, allocations for 'chunkSize' or less are allocated from a 'pool' of
-chunks. Bigger allocations are handled through the systems 'malloc' and 'free'.
+Page based allocator, allocations for 'heapMaxSlotSize' or less are allocated from a page of the
+smallest size class that fits the allocation. Bigger allocations are handled through the systems
+'malloc' and 'free'.
+
+Each thread caches a page per size class, allocating from it takes a slot from the free-list of the
+page and sets its bit in the allocation bitmap. When the page is full the thread acquires a page
+with free slots from the global set of free pages, if there are none it will allocate a new page
+from the system.
+
+A page is only ever used by a single thread at a time: either by the thread that allocates from it
+or by the sweeper. When a sweep begins all pages are taken away from the threads (by changing the
+'epoch') and the set of free pages is cleared, after sweeping a page it is made available again.
+
+Pages that are completely empty after sweeping are not bound to their size class anymore, up to
+'maxEmptyPages' of them are kept to be re-initialized for any size class and the rest are
+returned to the system.
+
+Note: Current implementation of the garbage collector begins a sweep while all executors are paused,
+but allocations can happen concurrently with marking and sweeping the pages. Pages (and large
+allocations) remember the epoch in which they were acquired, allocations made after the sweep
+began are not part of it and are considered marked.
+*/
 
-When an allocation for a chunk comes in it tries to satisfy it from a thread-cache, if the
-thread-cache is empty it refills the thread-cache from a global cache. If the global cache is empty
-it will allocate new memory from the system.
+static std::atomic<uint64_t> nextEpoch{1U};
 
-When free-ing a chunk it is placed on the thread-cache, if the thread-cache reaches capacity
-'maxChunksPerThread' it will move the set to the global cache.
+struct ThreadPages {
+  uint64_t epoch;
+  std::array<HeapPage*, heapSizeClassCount> pages;
+};
 
-Note: Current implementation of the garbage collector free's only on the gc-thread and no
-allocations happen on the gc-thread. Implementation of the MemoryAllocator should NOT rely on that
-being true but it can be taken into account when tuning performance.
+// Note: Trivially destructible on purpose, pages of threads that exit are reclaimed by the next
+// sweep.
+thread_local static ThreadPages threadPages;
 
-Note: All allocations are aligned to multiples of 64 bytes from the systems virtual page start.
+#if defined(_WIN32)
 
-Note: Pooled memory is never returned back to the system at the moment.
-*/
+// Note: 'VirtualAlloc' allocations are aligned to the allocation granularity (64 KiB).
+inline auto mapPage() noexcept -> void* {
+  return VirtualAlloc(nullptr, heapPageSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
 
-// On MinGW there is a bug in thread_local objects with destructors.
-// More info: https://sourceforge.net/p/mingw-w64/bugs/527/
-// as a workaround we disable our custom allocator and fall back to the systems 'malloc' / 'free'.
-// TODO(bastian): Investigate which MinGw versions are affected.
-#if defined(__MINGW32__)
-#define CUSTOM_ALLOCATOR_ENABLED false
-#else // !__MINGW32__
-#define CUSTOM_ALLOCATOR_ENABLED true
-#endif
+inline auto unmapPage(void* page) noexcept -> void { VirtualFree(page, 0, MEM_RELEASE); }
 
-#if CUSTOM_ALLOCATOR_ENABLED
+#else // !_WIN32
 
-#if defined(_WIN32)
-static auto getpagesize() -> unsigned int {
-  SYSTEM_INFO si;
-  GetSystemInfo(&si);
-  return si.dwPageSize;
+inline auto mapPage() noexcept -> void* {
+  // Map twice the page size and trim the parts before and after the aligned page.
+  const auto mapSize = heapPageSize * 2U;
+  auto* res = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (unlikely(res == MAP_FAILED)) {
+    return nullptr;
+  }
+  const auto addr    = reinterpret_cast<uintptr_t>(res); // NOLINT: Reinterpret cast
+  const auto aligned = (addr + heapPageSize - 1U) & ~uintptr_t{heapPageSize - 1U};
+  if (aligned != addr) {
+    munmap(res, aligned - addr);
+  }
+  munmap(reinterpret_cast<void*>(aligned + heapPageSize), addr + mapSize - aligned - heapPageSize);
+  return reinterpret_cast<void*>(aligned); // NOLINT: Reinterpret cast
 }
-#endif
-
-const unsigned int pageSize                 = getpagesize(); // Systems virtual page-size.
-const unsigned int pagesPerArea             = 50U;
-const unsigned int areaSize                 = pageSize * pagesPerArea;
-const unsigned int chunkSize                = 64U;
-const unsigned int chunksPerArea            = areaSize / chunkSize;
-const unsigned int maxChunksPerThread       = chunksPerArea;
-const unsigned int preAllocateChunkSetCount = 10U;
-
-enum class MemTag : uint8_t {
-  MAlloc = 0,
-  Chunk  = 1,
-};
-
-struct Chunk {
-  Chunk* next;
-};
-
-struct ChunkSet {
-  Chunk* head;
-  unsigned int count;
-};
 
-static auto getChunkSet() noexcept -> ChunkSet;
-static auto freeChunkSet(ChunkSet s) noexcept -> void;
+inline auto unmapPage(void* page) noexcept -> void { munmap(page, heapPageSize); }
 
-struct ThreadCache {
-  ChunkSet chunks;
+#endif // !_WIN32
 
-  ~ThreadCache() noexcept {
-    if (chunks.count > 0) {
-      freeChunkSet(chunks);
-    }
+static auto getSizeClass(unsigned int size) noexcept -> unsigned int {
+  auto sizeClass = 0U;
+  while (heapSizeClasses[sizeClass] < size) {
+    ++sizeClass;
   }
-};
-
-thread_local static ThreadCache threadCache;
+  return sizeClass;
+}
 
-static std::mutex globalChunksMutex;
-static std::vector<ChunkSet> globalChunkSets;
-static bool chunkSetsPreAllocated;
+// Initialize a page for the given size class and fill its free-list with all slots.
+static auto initPage(void* mem, unsigned int sizeClass) noexcept -> HeapPage* {
+  const auto slotSize   = heapSizeClasses[sizeClass];
+  const auto headerSize = (sizeof(HeapPage) + alignof(std::max_align_t) - 1U) &
+      ~(alignof(std::max_align_t) - 1U);
 
-#if defined(_WIN32)
-inline auto mapArea() noexcept -> void* {
-  return VirtualAlloc(nullptr, areaSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
-}
-#else // !_WIN32
-inline auto mapArea() noexcept -> void* {
-  auto* res = mmap(nullptr, areaSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-  return unlikely(res == MAP_FAILED) ? nullptr : res;
+  auto* page      = new (mem) HeapPage{};
+  page->sizeClass = static_cast<uint8_t>(sizeClass);
+  while ((1U << page->slotShift) != slotSize) {
+    ++page->slotShift;
+  }
+  page->slotCount = static_cast<unsigned int>((heapPageSize - headerSize) / slotSize);
+  page->slots     = static_cast<uint8_t*>(mem) + headerSize;
+  for (auto i = page->slotCount; i-- != 0U;) {
+    auto* slot     = static_cast<HeapPage::Slot*>(page->getSlot(i));
+    slot->next     = page->freeList;
+    page->freeList = slot;
+  }
+  page->freeCount = page->slotCount;
+  return page;
 }
-#endif
 
-// Allocate an area and fill it with chunks.
-inline auto allocChunkSet() noexcept -> ChunkSet {
-  auto* area = mapArea();
-  if (unlikely(area == nullptr)) {
-    return ChunkSet{nullptr, 0};
+MemoryAllocator::MemoryAllocator(unsigned int maxEmptyPages) noexcept :
+    m_maxEmptyPages{maxEmptyPages},
+    m_epoch{nextEpoch.fetch_add(1U, std::memory_order_relaxed)},
+    m_largeHead{nullptr},
+    m_sweepLargeHead{nullptr},
+    m_sweepLiveBytes{0U},
+    m_statPageAcquires{0U},
+    m_statPagesMapped{0U},
+    m_statPagesUnmapped{0U},
+    m_statLargeAllocs{0U},
+    m_statLargeBytes{0U} {}
+
+MemoryAllocator::~MemoryAllocator() noexcept {
+  for (auto* page : m_pages) {
+    page->~HeapPage();
+    unmapPage(page);
   }
+  for (auto* page : m_emptyPages) {
+    page->~HeapPage();
+    unmapPage(page);
+  }
+  auto* large = m_largeHead.load(std::memory_order_acquire);
+  while (large) {
+    auto* next = large->next;
+    std::free(large);
+    large = next;
+  }
+}
 
-  auto* begin = static_cast<Chunk*>(area);
-  auto* cur   = begin;
-  for (auto i = 0U; i != chunksPerArea - 1; ++i) {
-    void* curMem  = static_cast<void*>(cur);
-    void* nextMem = static_cast<void*>(static_cast<uint8_t*>(curMem) + chunkSize);
-
-    cur->next = static_cast<Chunk*>(nextMem);
-    cur       = cur->next;
+auto MemoryAllocator::alloc(unsigned int size) noexcept -> std::pair<void*, uint8_t> {
+  if (unlikely(size > heapMaxSlotSize)) {
+    return {allocLarge(size), memTagLargeAlloc};
   }
 
-  cur->next = nullptr;
-  return ChunkSet{begin, chunksPerArea};
-}
+  // Pages cached for a different allocator or before the last sweep cannot be used anymore.
+  const auto epoch = m_epoch.load(std::memory_order_relaxed);
+  if (unlikely(threadPages.epoch != epoch)) {
+    threadPages.epoch = epoch;
+    threadPages.pages.fill(nullptr);
+  }
 
-inline auto getChunkSet() noexcept -> ChunkSet {
-  {
-    auto lk = std::lock_guard<std::mutex>{globalChunksMutex};
-    if (!globalChunkSets.empty()) {
-      auto set = globalChunkSets.back();
-      globalChunkSets.pop_back();
-      assert(set.head != nullptr && set.count > 0);
-      return set;
+  const auto sizeClass = getSizeClass(size);
+  auto* page           = threadPages.pages[sizeClass];
+  if (unlikely(page == nullptr || page->freeList == nullptr)) {
+    page = threadPages.pages[sizeClass] = acquirePage(sizeClass);
+    if (unlikely(page == nullptr)) {
+      return {nullptr, 0U};
     }
   }
-  return allocChunkSet();
-}
 
-inline auto freeChunkSet(ChunkSet chunkSet) noexcept -> void {
-  assert(chunkSet.head != nullptr && chunkSet.count > 0);
+  auto* slot     = page->freeList;
+  page->freeList = slot->next;
+  --page->freeCount;
 
-  auto lk = std::lock_guard<std::mutex>{globalChunksMutex};
-  globalChunkSets.push_back(chunkSet);
+  const auto idx  = page->getSlotIndex(slot);
+  const auto mask = uint64_t{1U} << (idx % 64U);
+  page->allocBits[idx / 64U] |= mask;
+  page->newBits[idx / 64U] |= mask;
+  return {static_cast<void*>(slot), static_cast<uint8_t>(sizeClass)};
 }
 
-inline auto preAllocateChunkSets() noexcept {
-  globalChunkSets.reserve(preAllocateChunkSetCount);
-  for (auto i = 0U; i != preAllocateChunkSetCount; ++i) {
-    auto chunkSet = allocChunkSet();
-    if (unlikely(chunkSet.head == nullptr)) {
-      return;
-    }
-    freeChunkSet(chunkSet);
-  }
+auto MemoryAllocator::isEmpty() noexcept -> bool {
+  auto lk = std::lock_guard<std::mutex>{m_pagesMutex};
+  return m_pages.empty() && m_largeHead.load(std::memory_order_acquire) == nullptr;
 }
 
-inline auto getThreadChunk() noexcept -> Chunk* {
-  if (threadCache.chunks.count == 0) {
-    threadCache.chunks = getChunkSet();
-    if (unlikely(threadCache.chunks.head == nullptr)) {
-      return nullptr;
-    }
-  }
+auto MemoryAllocator::getStats(MemoryStats* out) noexcept -> void {
+  using Counter = MemoryStats::Counter;
 
-  auto* chunk             = threadCache.chunks.head;
-  threadCache.chunks.head = chunk->next;
-  --threadCache.chunks.count;
-  return chunk;
+  out->set(Counter::PageCacheMisses, m_statPageAcquires.load(std::memory_order_relaxed));
+  out->set(Counter::PagesMapped, m_statPagesMapped.load(std::memory_order_relaxed));
+  out->set(Counter::PagesUnmapped, m_statPagesUnmapped.load(std::memory_order_relaxed));
+  out->set(Counter::LargeAllocations, m_statLargeAllocs.load(std::memory_order_relaxed));
+  out->set(Counter::LargeAllocatedBytes, m_statLargeBytes.load(std::memory_order_relaxed));
+
+  auto lk = std::lock_guard<std::mutex>{m_pagesMutex};
+  out->set(Counter::HeapPages, m_pages.size() + m_emptyPages.size());
 }
 
-inline auto freeChunk(Chunk* chunk) noexcept -> void {
-  chunk->next             = threadCache.chunks.head;
-  threadCache.chunks.head = chunk;
-  ++threadCache.chunks.count;
+auto MemoryAllocator::beginSweep() noexcept -> unsigned int {
+  // Take the pages away from the threads that are allocating from them.
+  m_epoch.store(nextEpoch.fetch_add(1U, std::memory_order_relaxed), std::memory_order_relaxed);
 
-  if (threadCache.chunks.count > maxChunksPerThread) {
-    freeChunkSet(threadCache.chunks);
-    threadCache.chunks = ChunkSet{};
+  auto lk = std::lock_guard<std::mutex>{m_pagesMutex};
+  for (auto& freePages : m_freePages) {
+    freePages.clear();
   }
-}
+  m_sweepPages     = m_pages;
+  m_sweepLargeHead = m_largeHead.load(std::memory_order_acquire);
+  m_sweepLiveBytes.store(0U, std::memory_order_relaxed);
 
-MemoryAllocator::MemoryAllocator() noexcept {
-  if (!chunkSetsPreAllocated) {
-    preAllocateChunkSets();
-    chunkSetsPreAllocated = true;
-  }
+  // One unit per page plus one for the large allocations.
+  return static_cast<unsigned int>(m_sweepPages.size()) + 1U;
 }
 
-auto MemoryAllocator::alloc(unsigned int size) noexcept -> std::pair<void*, uint8_t> {
-  if (size > chunkSize) {
-    return {std::malloc(size), static_cast<uint8_t>(MemTag::MAlloc)};
+auto MemoryAllocator::allocLarge(unsigned int size) noexcept -> void* {
+  auto* mem = std::malloc(sizeof(LargeAlloc) + size);
+  if (unlikely(mem == nullptr)) {
+    return nullptr;
+  }
+  const auto epoch = m_epoch.load(std::memory_order_relaxed);
+  auto* large      = new (mem) LargeAlloc{nullptr, epoch, size, {false}, true};
+  m_statLargeAllocs.fetch_add(1U, std::memory_order_relaxed);
+  m_statLargeBytes.fetch_add(size, std::memory_order_relaxed);
+
+  // Keep track of all large allocations by linking them as a singly linked list.
+  large->next = m_largeHead.load(std::memory_order_relaxed);
+  while (!m_largeHead.compare_exchange_weak(
+      large->next, large, std::memory_order_release, std::memory_order_relaxed)) {
   }
-  auto* chunk = getThreadChunk();
-  return {static_cast<void*>(chunk), static_cast<uint8_t>(MemTag::Chunk)};
+  return getLargePayload(large);
 }
 
-auto MemoryAllocator::free(void* memoryPtr, uint8_t memTag) noexcept -> void {
-  assert(memoryPtr != nullptr);
+auto MemoryAllocator::acquirePage(unsigned int sizeClass) noexcept -> HeapPage* {
+  m_statPageAcquires.fetch_add(1U, std::memory_order_relaxed);
 
-  switch (static_cast<MemTag>(memTag)) {
-  case MemTag::MAlloc:
-    std::free(memoryPtr);
-    break;
-  case MemTag::Chunk:
-    freeChunk(static_cast<Chunk*>(memoryPtr));
-    break;
-  default:
-    assert(false);
-    break;
+  void* mem = nullptr;
+  {
+    auto lk         = std::lock_guard<std::mutex>{m_pagesMutex};
+    auto& freePages = m_freePages[sizeClass];
+    if (!freePages.empty()) {
+      auto* page = freePages.back();
+      freePages.pop_back();
+      assert(page->freeList != nullptr);
+      page->epoch = m_epoch.load(std::memory_order_relaxed);
+      return page;
+    }
+
+    // Reuse an empty page, possibly of a different size class.
+    if (!m_emptyPages.empty()) {
+      mem = m_emptyPages.back();
+      m_emptyPages.pop_back();
+      static_cast<HeapPage*>(mem)->~HeapPage();
+    }
+  }
+
+  if (mem == nullptr) {
+    mem = mapPage();
+    if (unlikely(mem == nullptr)) {
+      return nullptr;
+    }
+    m_statPagesMapped.fetch_add(1U, std::memory_order_relaxed);
   }
+
+  auto* page  = initPage(mem, sizeClass);
+  page->epoch = m_epoch.load(std::memory_order_relaxed);
+  auto lk     = std::lock_guard<std::mutex>{m_pagesMutex};
+  addPage(page);
+  return page;
 }
 
-#else // !CUSTOM_ALLOCATOR_ENABLED
+auto MemoryAllocator::releasePage(HeapPage* page) noexcept -> void {
+  if (page->freeCount == 0U) {
+    return; // Page is full, it is considered again by the next sweep.
+  }
 
-MemoryAllocator::MemoryAllocator() noexcept {}
+  auto lk = std::lock_guard<std::mutex>{m_pagesMutex};
+  if (page->freeCount != page->slotCount) {
+    // Make the page available for allocating again.
+    m_freePages[page->sizeClass].push_back(page);
+    return;
+  }
 
-auto MemoryAllocator::alloc(unsigned int size) noexcept -> std::pair<void*, uint8_t> {
-  return {std::malloc(size), 0};
+  // Page is empty, keep it for reuse or return it to the system.
+  removePage(page);
+  if (m_emptyPages.size() < m_maxEmptyPages) {
+    m_emptyPages.push_back(page);
+  } else {
+    page->~HeapPage();
+    unmapPage(page);
+    m_statPagesUnmapped.fetch_add(1U, std::memory_order_relaxed);
+  }
 }
 
-auto MemoryAllocator::free(void* memoryPtr, uint8_t /*unused*/) noexcept -> void {
-  assert(memoryPtr != nullptr);
-  std::free(memoryPtr);
+auto MemoryAllocator::addPage(HeapPage* page) noexcept -> void {
+  page->index = static_cast<unsigned int>(m_pages.size());
+  m_pages.push_back(page);
 }
 
-#endif
+auto MemoryAllocator::removePage(HeapPage* page) noexcept -> void {
+  // Swap-remove the page from the list.
+  assert(m_pages[page->index] == page);
+  auto* last           = m_pages.back();
+  last->index          = page->index;
+  m_pages[last->index] = last;
+  m_pages.pop_back();
+}
 
 } // namespace vm::internal
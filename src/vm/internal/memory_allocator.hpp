@@ -1,23 +1,284 @@
 #pragma once
+#include "internal/likely.hpp"
+#include "vm/memory_stats.hpp"
+#include <array>
+#include <atomic>
+#include <cassert>
 #include <cstdint>
+#include <cstdlib>
+#include <mutex>
 #include <utility>
+#include <vector>
 
 namespace vm::internal {
 
+const auto heapPageSize       = 64U * 1024U; // 64 KiB, pages are aligned to their size.
+const auto heapSizeClasses    = std::array<unsigned int, 7U>{16, 32, 64, 128, 256, 512, 1024};
+const auto heapSizeClassCount = static_cast<unsigned int>(heapSizeClasses.size());
+const auto heapMinSlotSize    = heapSizeClasses.front();
+const auto heapMaxSlotSize    = heapSizeClasses.back();
+const auto heapBitmapWords    = heapPageSize / heapMinSlotSize / 64U;
+const auto memTagLargeAlloc   = static_cast<uint8_t>(0xFFU);
+
+// Page of equally sized slots, all slots in a page belong to the same size class.
+// The page header is stored at the start of the (aligned) page, so the page of any slot can be
+// found by masking its address.
+struct HeapPage final {
+  struct Slot final {
+    Slot* next;
+  };
+
+  uint8_t sizeClass;
+  uint8_t slotShift;  // Slot sizes are powers of two.
+  unsigned int index; // Index in the list of pages of the allocator.
+  uint64_t epoch;     // Sweep epoch in which a thread acquired the page for allocating.
+  unsigned int slotCount;
+  unsigned int freeCount;
+  Slot* freeList;
+  uint8_t* slots;
+  std::array<uint64_t, heapBitmapWords> allocBits; // Slots that hold an allocation.
+  std::array<uint64_t, heapBitmapWords> newBits;   // Slots allocated since the last sweep.
+  std::array<std::atomic<uint64_t>, heapBitmapWords> markBits;
+
+  [[nodiscard]] inline auto getSlotIndex(const void* ptr) const noexcept -> unsigned int {
+    return static_cast<unsigned int>((static_cast<const uint8_t*>(ptr) - slots) >> slotShift);
+  }
+
+  [[nodiscard]] inline auto getSlot(unsigned int index) const noexcept -> void* {
+    return slots + (static_cast<size_t>(index) << slotShift);
+  }
+};
+
+// Allocation that is too big for any of the size classes, allocated directly from the system.
+// Note: The header is stored in front of the allocation.
+struct alignas(16) LargeAlloc final {
+  LargeAlloc* next;
+  uint64_t epoch; // Sweep epoch in which the allocation was made.
+  unsigned int size;
+  std::atomic_bool marked;
+  bool isNew;
+};
+
 // Responsible for allocating and deallocating raw memory from the system.
+//
+// Allocations are served from pages per size class, each thread allocates from its own page per
+// size class so the allocation path does not need any synchronization. Bigger allocations are
+// made directly from the system (and tracked in a list). Pages that become empty are reused for
+// any size class, or returned to the system when there are more than 'maxEmptyPages'.
+//
+// Sweeping measures the bytes of the allocations that survive it (including the unused part of
+// their slots), the garbage collector uses this to decide when to collect again.
+//
+// The allocator does not support freeing individual allocations, instead memory is reclaimed by
+// sweeping: allocations that are not marked (in the mark bitmap of the page) are freed. Sweeping
+// walks the pages linearly and does not need to touch the memory of marked allocations.
+//
+// Statistics are only recorded on the slow paths (acquiring pages and large allocations), the
+// allocations served from the page cached by a thread are counted by the RefAllocator.
 class MemoryAllocator final {
 public:
-  MemoryAllocator() noexcept;
+  explicit MemoryAllocator(unsigned int maxEmptyPages) noexcept;
   MemoryAllocator(const MemoryAllocator& rhs) = delete;
   MemoryAllocator(MemoryAllocator&& rhs)      = delete;
-  ~MemoryAllocator() noexcept                 = default;
+  ~MemoryAllocator() noexcept;
 
   auto operator=(const MemoryAllocator& rhs) -> MemoryAllocator& = delete;
   auto operator=(MemoryAllocator&& rhs) -> MemoryAllocator& = delete;
 
+  // Allocate memory of the given size, returns the memory and a tag that identifies where the
+  // allocation was made from. Upon failure returns nullptr.
   [[nodiscard]] auto alloc(unsigned int size) noexcept -> std::pair<void*, uint8_t>;
 
-  auto free(void* memoryPtr, uint8_t tag) noexcept -> void;
+  // Are there any allocations made from this allocator.
+  [[nodiscard]] auto isEmpty() noexcept -> bool;
+
+  // Write the page and large allocation statistics to the given stats.
+  // Note: Can be called concurrently with allocations.
+  auto getStats(MemoryStats* out) noexcept -> void;
+
+  // Was the allocation made after the current sweep began, such allocations are not part of the
+  // sweep and are treated as marked.
+  [[nodiscard]] inline auto isAllocatedDuringSweep(void* memoryPtr, uint8_t tag) const noexcept
+      -> bool {
+    const auto epoch = m_epoch.load(std::memory_order_relaxed);
+    if (unlikely(tag == memTagLargeAlloc)) {
+      return getLargeAlloc(memoryPtr)->epoch == epoch;
+    }
+    return getPage(memoryPtr)->epoch == epoch;
+  }
+
+  [[nodiscard]] inline auto isMarked(void* memoryPtr, uint8_t tag) const noexcept -> bool {
+    if (isAllocatedDuringSweep(memoryPtr, tag)) {
+      return true;
+    }
+    if (unlikely(tag == memTagLargeAlloc)) {
+      return getLargeAlloc(memoryPtr)->marked.load(std::memory_order_relaxed);
+    }
+    auto* page      = getPage(memoryPtr);
+    const auto idx  = page->getSlotIndex(memoryPtr);
+    const auto mask = uint64_t{1U} << (idx % 64U);
+    return (page->markBits[idx / 64U].load(std::memory_order_relaxed) & mask) != 0U;
+  }
+
+  // Mark the allocation, returns true if this call marked it and false if it was already marked.
+  // Note: Can be called from multiple threads concurrently.
+  inline auto tryMark(void* memoryPtr, uint8_t tag) noexcept -> bool {
+    if (isAllocatedDuringSweep(memoryPtr, tag)) {
+      return false;
+    }
+    if (unlikely(tag == memTagLargeAlloc)) {
+      return !getLargeAlloc(memoryPtr)->marked.exchange(true, std::memory_order_relaxed);
+    }
+    auto* page      = getPage(memoryPtr);
+    const auto idx  = page->getSlotIndex(memoryPtr);
+    const auto mask = uint64_t{1U} << (idx % 64U);
+    return (page->markBits[idx / 64U].fetch_or(mask, std::memory_order_relaxed) & mask) == 0U;
+  }
+
+  // Start a sweep of all current allocations, returns the amount of sweep units. The units can be
+  // swept (in parallel) while new allocations are being made.
+  // Marking for the sweep can happen after it began, allocations made after this are not swept.
+  // Note: Should not be called concurrently with allocations or another sweep.
+  auto beginSweep() noexcept -> unsigned int;
+
+  // Bytes of the allocations that survived the current sweep.
+  // Note: Only complete once all sweep units have been swept.
+  [[nodiscard]] auto getSweepLiveBytes() const noexcept -> uint64_t {
+    return m_sweepLiveBytes.load(std::memory_order_relaxed);
+  }
+
+  // Sweep a unit, every allocation that is not marked is passed to 'freeFunc' and then freed. Marks
+  // of the remaining allocations are cleared.
+  // When 'onlyNew' is true then only allocations made since the previous sweep are considered.
+  template <typename FreeFunc>
+  auto sweep(unsigned int unit, bool onlyNew, FreeFunc freeFunc) noexcept -> void {
+    if (unit == m_sweepPages.size()) {
+      sweepLarge(onlyNew, freeFunc);
+      return;
+    }
+    auto* page = m_sweepPages[unit];
+    for (auto word = 0U; word != heapBitmapWords; ++word) {
+      auto marks = page->markBits[word].load(std::memory_order_relaxed);
+      auto dead  = (onlyNew ? page->newBits[word] : page->allocBits[word]) & ~marks;
+      page->allocBits[word] &= ~dead;
+      page->newBits[word] = 0U;
+      page->markBits[word].store(0U, std::memory_order_relaxed);
+
+      for (; dead != 0U; dead &= dead - 1U) {
+        auto* slot = page->getSlot(word * 64U + countTrailingZeros(dead));
+        freeFunc(slot);
+        freeSlot(page, slot);
+      }
+    }
+    const auto liveSlots = page->slotCount - page->freeCount;
+    m_sweepLiveBytes.fetch_add(uint64_t{liveSlots} << page->slotShift, std::memory_order_relaxed);
+    releasePage(page);
+  }
+
+  // Invoke the given function for every allocation.
+  // Note: Should not be called concurrently with allocations or a sweep.
+  template <typename Func>
+  auto forEachAlloc(Func func) noexcept -> void {
+    for (auto* page : m_pages) {
+      for (auto word = 0U; word != heapBitmapWords; ++word) {
+        for (auto bits = page->allocBits[word]; bits != 0U; bits &= bits - 1U) {
+          func(page->getSlot(word * 64U + countTrailingZeros(bits)));
+        }
+      }
+    }
+    for (auto* large = m_largeHead.load(std::memory_order_acquire); large; large = large->next) {
+      func(getLargePayload(large));
+    }
+  }
+
+private:
+  unsigned int m_maxEmptyPages;  // Empty pages to keep before returning them to the system.
+  std::atomic<uint64_t> m_epoch; // Changes on every sweep, invalidates pages cached by threads.
+  std::mutex m_pagesMutex;
+  std::vector<HeapPage*> m_pages;
+  std::array<std::vector<HeapPage*>, heapSizeClassCount> m_freePages;
+  std::vector<HeapPage*> m_emptyPages;
+  std::vector<HeapPage*> m_sweepPages;
+  std::atomic<LargeAlloc*> m_largeHead;
+  LargeAlloc* m_sweepLargeHead;
+  std::atomic<uint64_t> m_sweepLiveBytes;
+
+  std::atomic<uint64_t> m_statPageAcquires;
+  std::atomic<uint64_t> m_statPagesMapped;
+  std::atomic<uint64_t> m_statPagesUnmapped;
+  std::atomic<uint64_t> m_statLargeAllocs;
+  std::atomic<uint64_t> m_statLargeBytes;
+
+  [[nodiscard]] inline static auto countTrailingZeros(uint64_t bits) noexcept -> unsigned int {
+    assert(bits != 0U);
+#if defined(__clang__) || defined(__GNUG__)
+    return static_cast<unsigned int>(__builtin_ctzll(bits));
+#else
+    auto res = 0U;
+    for (; (bits & 1U) == 0U; bits >>= 1U) {
+      ++res;
+    }
+    return res;
+#endif
+  }
+
+  [[nodiscard]] inline static auto getPage(const void* memoryPtr) noexcept -> HeapPage* {
+    const auto addr = reinterpret_cast<uintptr_t>(memoryPtr); // NOLINT: Reinterpret cast
+    return reinterpret_cast<HeapPage*>(addr & ~uintptr_t{heapPageSize - 1U}); // NOLINT
+  }
+
+  [[nodiscard]] inline static auto getLargeAlloc(const void* memoryPtr) noexcept -> LargeAlloc* {
+    return const_cast<LargeAlloc*>(static_cast<const LargeAlloc*>(memoryPtr)) - 1;
+  }
+
+  [[nodiscard]] inline static auto getLargePayload(LargeAlloc* large) noexcept -> void* {
+    return static_cast<void*>(large + 1);
+  }
+
+  inline static auto freeSlot(HeapPage* page, void* slotPtr) noexcept -> void {
+    auto* slot     = static_cast<HeapPage::Slot*>(slotPtr);
+    slot->next     = page->freeList;
+    page->freeList = slot;
+    ++page->freeCount;
+  }
+
+  auto allocLarge(unsigned int size) noexcept -> void*;
+  auto acquirePage(unsigned int sizeClass) noexcept -> HeapPage*;
+  auto releasePage(HeapPage* page) noexcept -> void;
+  auto addPage(HeapPage* page) noexcept -> void;
+  auto removePage(HeapPage* page) noexcept -> void;
+
+  template <typename FreeFunc>
+  auto sweepLarge(bool onlyNew, FreeFunc freeFunc) noexcept -> void {
+    /* Walks the list of large allocations that existed when the sweep began. This won't ever free
+    the head node, reason is that would require syncronization as new allocations might be linked
+    to it. */
+    auto* head = m_sweepLargeHead;
+    if (head == nullptr) {
+      return;
+    }
+    head->marked.store(false, std::memory_order_relaxed);
+    head->isNew = false;
+
+    auto liveBytes = uint64_t{head->size};
+    auto* prev     = head;
+    auto* cur      = head->next;
+    while (cur) {
+      auto* next = cur->next;
+      if (cur->marked.load(std::memory_order_relaxed) || (onlyNew && !cur->isNew)) {
+        cur->marked.store(false, std::memory_order_relaxed);
+        cur->isNew = false;
+        prev       = cur;
+        liveBytes += cur->size;
+      } else {
+        prev->next = next;
+        freeFunc(getLargePayload(cur));
+        std::free(cur);
+      }
+      cur = next;
+    }
+    m_sweepLiveBytes.fetch_add(liveBytes, std::memory_order_relaxed);
+  }
 };
 
 } // namespace vm::internal
@@ -1,5 +1,6 @@
 #pragma once
 #include "internal/executor_handle.hpp"
+#include "internal/garbage_collector.hpp"
 #include "internal/ref_long.hpp"
 #include "internal/ref_stream_console.hpp"
 #include "internal/ref_stream_file.hpp"
@@ -24,7 +25,7 @@ auto inline pcall(
     const Settings& settings,
     PlatformInterface* iface,
     RefAllocator* refAlloc,
-    BasicStack* stack,
+    Stack* stack,
     ExecutorHandle* execHandle,
     novasm::PCallCode code) noexcept -> void {
   assert(iface && refAlloc && stack && execHandle);
@@ -41,17 +42,20 @@ auto inline pcall(
     }                                                                                              \
   }
 #define PUSH(VAL)                                                                                  \
-  if (unlikely(!stack->push(VAL))) {                                                               \
-    execHandle->setState(ExecState::StackOverflow);                                                \
-    return;                                                                                        \
+  {                                                                                                \
+    if (unlikely(!stack->hasSpace(1U))) {                                                          \
+      execHandle->setState(ExecState::StackOverflow);                                              \
+      return;                                                                                      \
+    }                                                                                              \
+    stack->push(VAL);                                                                              \
   }
 #define PUSH_INT(VAL) PUSH(intValue(VAL))
 #define PUSH_BOOL(VAL) PUSH(intValue(VAL))
 #define PUSH_LONG(VAL)                                                                             \
   {                                                                                                \
     int64_t v = VAL;                                                                               \
-    if (v >= 0L) {                                                                                 \
-      PUSH(posLongValue(v));                                                                       \
+    if (likely(isInlineLong(v))) {                                                                 \
+      PUSH(inlineLongValue(v));                                                                    \
     } else {                                                                                       \
       PUSH_REF(refAlloc->allocPlain<LongRef>(v));                                                  \
     }                                                                                              \
@@ -71,19 +75,32 @@ auto inline pcall(
 
   switch (code) {
   case PCallCode::StreamCheckValid: {
-    PUSH_BOOL(streamCheckValid(POP()));
+    // Note: Keep the stream on the stack, checking a tcp stream waits until its connected.
+    auto valid = streamCheckValid(execHandle, PEEK());
+    if (unlikely(execHandle->hasIoWait())) {
+      break;
+    }
+
+    POP(); // Pop the stream off the stack.
+    PUSH_BOOL(valid);
   } break;
   case PCallCode::StreamReadString: {
-    auto maxChars = POP_INT();
+    // Note: Keep the arguments on the stack, reason is gc could run while we are blocked and the
+    // call is executed again when it has to wait for the stream (see 'requestIoWait').
+    auto maxChars = PEEK_INT();
+    auto stream   = PEEK_BEHIND(1);
 
-    // Note: Keep the stream on the stack, reason is gc could run while we are blocked.
-    auto stream = PEEK();
     // Allocate a new string, and push it on the stack (so its already visible to the gc).
     auto str = refAlloc->allocStr(maxChars <= 0 ? 0U : static_cast<unsigned int>(maxChars));
     PUSH_REF(str);
 
     streamReadString(execHandle, stream, str);
+    if (unlikely(execHandle->hasIoWait())) {
+      POP(); // Pop the result string off the stack.
+      break;
+    }
 
+    POP_AT(1); // Pop the max-chars off the stack, 1 because its behind the result string.
     POP_AT(1); // Pop the stream off the stack, 1 because its behind the result string.
   } break;
   case PCallCode::StreamReadChar: {
@@ -91,6 +108,9 @@ auto inline pcall(
     auto stream = PEEK();
 
     auto readChar = streamReadChar(execHandle, stream);
+    if (unlikely(execHandle->hasIoWait())) {
+      break;
+    }
 
     POP(); // Pop the stream off the stack.
     PUSH_INT(readChar);
@@ -103,18 +123,25 @@ auto inline pcall(
     // Note: Keep the stream on the stack, reason is gc could run while we are blocked.
     auto stream = PEEK_BEHIND(1);
     auto result = streamWriteString(execHandle, stream, strRef);
+    if (unlikely(execHandle->hasIoWait())) {
+      break;
+    }
 
     POP(); // Pop the string off the stack.
     POP(); // Pop the stream off the stack.
     PUSH_BOOL(result);
   } break;
   case PCallCode::StreamWriteChar: {
-    uint8_t val = static_cast<uint8_t>(POP_INT());
+    // Note: Keep the arguments on the stack, reason is gc could run while we are blocked.
+    uint8_t val = static_cast<uint8_t>(PEEK_INT());
+    auto stream = PEEK_BEHIND(1);
 
-    // Note: Keep the stream on the stack, reason is gc could run while we are blocked.
-    auto stream = PEEK();
     auto result = streamWriteChar(execHandle, stream, val);
+    if (unlikely(execHandle->hasIoWait())) {
+      break;
+    }
 
+    POP(); // Pop the value off the stack.
     POP(); // Pop the stream off the stack.
     PUSH_BOOL(result);
   } break;
@@ -131,6 +158,34 @@ auto inline pcall(
     auto stream  = POP();
     PUSH_BOOL(streamUnsetOpts(stream, static_cast<StreamOpts>(options)));
   } break;
+  case PCallCode::StreamReadLine: {
+    // Note: Keep the stream on the stack, reason is gc could run while we are blocked.
+    auto stream = PEEK();
+
+    auto* str = streamReadLine(execHandle, refAlloc, stream);
+    if (unlikely(execHandle->hasIoWait())) {
+      break;
+    }
+    CHECK_ALLOC(str);
+
+    POP(); // Pop the stream off the stack.
+    PUSH_REF(str);
+  } break;
+  case PCallCode::StreamReadUntil: {
+    // Note: Keep the arguments on the stack, reason is gc could run while we are blocked.
+    auto delim  = static_cast<char>(PEEK_INT());
+    auto stream = PEEK_BEHIND(1);
+
+    auto* str = streamReadUntil(execHandle, refAlloc, stream, delim);
+    if (unlikely(execHandle->hasIoWait())) {
+      break;
+    }
+    CHECK_ALLOC(str);
+
+    POP(); // Pop the delimiter off the stack.
+    POP(); // Pop the stream off the stack.
+    PUSH_REF(str);
+  } break;
 
   case PCallCode::FileOpenStream: {
     auto options = POP_INT();
@@ -138,13 +193,13 @@ auto inline pcall(
     // Flags is stored in the 8 bits before (more significant) then mode.
     auto mode        = static_cast<FileStreamMode>(static_cast<uint8_t>(options));
     auto flags       = static_cast<FileStreamFlags>(static_cast<uint8_t>(options >> 8U));
-    auto* pathStrRef = getStringRef(refAlloc, POP());
+    auto* pathStrRef = getTerminatedStringRef(refAlloc, POP());
     CHECK_ALLOC(pathStrRef);
 
     PUSH_REF(openFileStream(refAlloc, pathStrRef, mode, flags));
   } break;
   case PCallCode::FileRemove: {
-    auto* pathStrRef = getStringRef(refAlloc, POP());
+    auto* pathStrRef = getTerminatedStringRef(refAlloc, POP());
     CHECK_ALLOC(pathStrRef);
 
     PUSH_BOOL(removeFile(pathStrRef));
@@ -154,9 +209,9 @@ auto inline pcall(
     auto port = POP_INT();
 
     // Note: Keep the 'address' string on the stack, reason is gc could run while we are blocked.
-    auto addr = PEEK();
-    auto* result =
-        tcpOpenConnection(settings, execHandle, refAlloc, addr.getDowncastRef<StringRef>(), port);
+    auto* addrStrRef = getTerminatedStringRef(refAlloc, POP());
+    PUSH_REF(addrStrRef);
+    auto* result = tcpOpenConnection(settings, execHandle, refAlloc, addrStrRef, port);
 
     POP(); // Pop the 'address' string off the stack.
     PUSH_REF(result);
@@ -171,6 +226,9 @@ auto inline pcall(
     // Note: Keep the stream on the stack, reason is gc could run while we are blocked.
     auto stream  = PEEK();
     auto* result = tcpAcceptConnection(settings, execHandle, refAlloc, stream);
+    if (unlikely(execHandle->hasIoWait())) {
+      break;
+    }
 
     POP(); // Pop the stream off the stack.
     PUSH_REF(result);
@@ -178,9 +236,9 @@ auto inline pcall(
   case PCallCode::IpLookupAddress: {
 
     // Note: Keep the 'hostname' string on the stack, reason is gc could run while we are blocked.
-    auto hostname = PEEK();
-    auto* result =
-        ipLookupAddress(settings, execHandle, refAlloc, hostname.getDowncastRef<StringRef>());
+    auto* hostNameStrRef = getTerminatedStringRef(refAlloc, POP());
+    PUSH_REF(hostNameStrRef);
+    auto* result = ipLookupAddress(settings, execHandle, refAlloc, hostNameStrRef);
 
     POP(); // Pop the hostname off the stack.
     PUSH_REF(result);
@@ -214,7 +272,7 @@ auto inline pcall(
     PUSH_INT(iface->getEnvArgCount());
   } break;
   case PCallCode::GetEnvVar: {
-    auto* nameStrRef = getStringRef(refAlloc, POP());
+    auto* nameStrRef = getTerminatedStringRef(refAlloc, POP());
     CHECK_ALLOC(nameStrRef);
 
     auto* res = std::getenv(nameStrRef->getCharDataPtr());
@@ -230,11 +288,21 @@ auto inline pcall(
     PUSH_LONG(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
   } break;
 
+  case PCallCode::RuntimeMemStat: {
+    const auto id = POP_INT();
+    auto stats    = MemoryStats{};
+    settings.gc->getStats(&stats);
+
+    // Unknown statistics return -1.
+    const auto val = stats.getById(id);
+    PUSH_LONG(val ? static_cast<int64_t>(*val) : -1);
+  } break;
+
   case PCallCode::SleepNano: {
     auto sleepTime = std::chrono::nanoseconds(getLong(PEEK()));
-    execHandle->setState(ExecState::Paused);
+    execHandle->beginBlocking();
     std::this_thread::sleep_for(sleepTime);
-    execHandle->setState(ExecState::Running);
+    execHandle->endBlocking();
     if (execHandle->trap()) {
       return;
     }
@@ -0,0 +1,74 @@
+#include "internal/profiler.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace vm::internal {
+
+Profiler::Profiler(
+    ExecutorRegistry* execRegistry,
+    const DecodedAssembly* assembly,
+    std::chrono::microseconds interval) noexcept :
+    m_execRegistry{execRegistry},
+    m_interval{std::max(interval, std::chrono::microseconds{1})},
+    m_stopRequested{false} {
+
+  assembly->forEachFunctionEntry([this](uint32_t ipOffset) { m_profile.addFunction(ipOffset); });
+}
+
+Profiler::~Profiler() noexcept { stop(); }
+
+auto Profiler::start() noexcept -> void {
+  assert(!m_samplerThread.joinable());
+  m_stopRequested = false;
+  m_samplerThread = std::thread(&Profiler::samplerLoop, this);
+}
+
+auto Profiler::stop() noexcept -> void {
+  if (!m_samplerThread.joinable()) {
+    return;
+  }
+  {
+    auto lk         = std::lock_guard<std::mutex>{m_stopMutex};
+    m_stopRequested = true;
+  }
+  m_stopCondVar.notify_one();
+  m_samplerThread.join();
+}
+
+auto Profiler::sample(const Instruction* instr, const Value* sh, const Value* rootSh) noexcept
+    -> void {
+
+  /* Stack-frames start with the return instruction pointer and the stack-home of the caller (see
+  'call' in the executor), the return instruction follows the call instruction. */
+
+  auto frames          = std::array<uint32_t, profilerMaxDepth + 1U>{};
+  auto frameCount      = 0U;
+  frames[frameCount++] = instr->ipOffset;
+  for (; sh != rootSh && frameCount != profilerMaxDepth; ++frameCount) {
+    const auto* retIp  = (sh - 2)->getRawPtr<const Instruction>();
+    frames[frameCount] = (retIp - 1)->ipOffset;
+    sh                 = (sh - 1)->getRawPtr<const Value>();
+  }
+  if (sh != rootSh) {
+    frames[frameCount++] = Profile::truncatedFrame;
+  }
+
+  const auto stack = Profile::Stack(frames.begin(), frames.begin() + frameCount);
+  auto lk          = std::lock_guard<std::mutex>{m_profileMutex};
+  m_profile.addSample(stack);
+}
+
+auto Profiler::takeProfile() noexcept -> Profile {
+  auto lk = std::lock_guard<std::mutex>{m_profileMutex};
+  return std::move(m_profile);
+}
+
+auto Profiler::samplerLoop() noexcept -> void {
+  auto lk = std::unique_lock<std::mutex>{m_stopMutex};
+  while (!m_stopCondVar.wait_for(lk, m_interval, [this]() { return m_stopRequested; })) {
+    m_execRegistry->requestSamples();
+  }
+}
+
+} // namespace vm::internal
@@ -0,0 +1,62 @@
+#pragma once
+#include "internal/decoded_assembly.hpp"
+#include "internal/executor_registry.hpp"
+#include "internal/instruction.hpp"
+#include "internal/value.hpp"
+#include "vm/profile.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace vm::internal {
+
+const auto profilerMaxDepth = 128U; // Deeper stacks only record their innermost frames.
+
+// Sampling profiler, records the call-stacks of the running executors at a fixed interval.
+//
+// A sampler thread periodically requests the running executors to take a sample, each executor
+// records its own call-stack at its next safe-point (returns and tail-calls) by walking the chain
+// of stack-frames. This keeps the cost for the executors to a single flag check per safe-point,
+// the downside is that samples are biased towards the safe-points: a sample is attributed to the
+// function that was running when the executor reached its next safe-point.
+//
+// Note: Executors that are paused, blocked or suspended are not sampled.
+class Profiler final {
+public:
+  Profiler(
+      ExecutorRegistry* execRegistry,
+      const DecodedAssembly* assembly,
+      std::chrono::microseconds interval) noexcept;
+  Profiler(const Profiler& rhs) = delete;
+  Profiler(Profiler&& rhs)      = delete;
+  ~Profiler() noexcept;
+
+  auto operator=(const Profiler& rhs) -> Profiler& = delete;
+  auto operator=(Profiler&& rhs) -> Profiler& = delete;
+
+  auto start() noexcept -> void;
+  auto stop() noexcept -> void;
+
+  // Record a sample of the call-stack of an executor, 'instr' is the instruction it is executing.
+  // Note: Can be called from multiple executors concurrently.
+  auto sample(const Instruction* instr, const Value* sh, const Value* rootSh) noexcept -> void;
+
+  // Take the samples that have been recorded so far.
+  [[nodiscard]] auto takeProfile() noexcept -> Profile;
+
+private:
+  ExecutorRegistry* m_execRegistry;
+  std::chrono::microseconds m_interval;
+  Profile m_profile;
+  std::mutex m_profileMutex;
+
+  std::thread m_samplerThread;
+  bool m_stopRequested;
+  std::mutex m_stopMutex;
+  std::condition_variable m_stopCondVar;
+
+  auto samplerLoop() noexcept -> void;
+};
+
+} // namespace vm::internal
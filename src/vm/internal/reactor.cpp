@@ -0,0 +1,129 @@
+#include "internal/reactor.hpp"
+#include "internal/executor.hpp"
+#include "internal/executor_pool.hpp"
+#include <cerrno>
+#include <thread>
+
+#if defined(VM_REACTOR_SUPPORTED)
+#include <poll.h>
+#include <sys/epoll.h>
+#endif
+
+namespace vm::internal {
+
+const auto reactorMaxEvents = 64U; // Maximum amount of events to handle per wakeup.
+
+Reactor::Reactor() noexcept : m_epollFd{-1} {}
+
+auto Reactor::get() noexcept -> Reactor& {
+  // Intentionally never destroyed, see the note on the class.
+  static auto* reactor = new Reactor{};
+  return *reactor;
+}
+
+#if defined(VM_REACTOR_SUPPORTED)
+
+auto Reactor::isSupported() noexcept -> bool { return true; }
+
+auto Reactor::block(int fd, IoEvent event) noexcept -> void {
+  auto pollFd   = pollfd{};
+  pollFd.fd     = fd;
+  pollFd.events = event == IoEvent::Read ? POLLIN : POLLOUT;
+  while (poll(&pollFd, 1, -1) < 0 && errno == EINTR) {
+  }
+}
+
+auto Reactor::wait(int fd, IoEvent event, Executor* executor) noexcept -> bool {
+  auto lk = std::lock_guard<std::mutex>{m_mutex};
+  if (m_epollFd < 0) {
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epollFd < 0) {
+      return false;
+    }
+    std::thread(&Reactor::loop, this).detach();
+  }
+
+  auto& waiters    = m_waiters[fd];
+  auto epollEvt    = epoll_event{};
+  epollEvt.data.fd = fd;
+  epollEvt.events  = waiters.events | (event == IoEvent::Read ? EPOLLIN : EPOLLOUT);
+  if (epoll_ctl(m_epollFd, waiters.head ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &epollEvt) != 0) {
+    if (waiters.head == nullptr) {
+      m_waiters.erase(fd);
+    }
+    return false;
+  }
+  waiters.events       = epollEvt.events;
+  executor->nextWaiter = waiters.head;
+  waiters.head         = executor;
+  return true;
+}
+
+auto Reactor::cancel(ExecutorRegistry* execRegistry) noexcept -> void {
+  auto lk = std::lock_guard<std::mutex>{m_mutex};
+  for (auto itr = m_waiters.begin(); itr != m_waiters.end();) {
+    // Unlink the executors of the registry, drop the file descriptor if none are left.
+    auto** link = &itr->second.head;
+    while (*link) {
+      if ((*link)->execRegistry == execRegistry) {
+        *link = (*link)->nextWaiter;
+      } else {
+        link = &(*link)->nextWaiter;
+      }
+    }
+    if (itr->second.head == nullptr) {
+      epoll_ctl(m_epollFd, EPOLL_CTL_DEL, itr->first, nullptr);
+      itr = m_waiters.erase(itr);
+    } else {
+      ++itr;
+    }
+  }
+}
+
+auto Reactor::loop() noexcept -> void {
+  epoll_event events[reactorMaxEvents];
+  while (true) {
+    const auto count = epoll_wait(m_epollFd, events, reactorMaxEvents, -1);
+    if (count < 0) {
+      continue; // Interrupted by a signal.
+    }
+
+    auto lk = std::lock_guard<std::mutex>{m_mutex};
+    for (auto i = 0; i != count; ++i) {
+      const auto fd = events[i].data.fd;
+      auto itr      = m_waiters.find(fd);
+      if (itr == m_waiters.end()) {
+        continue; // Waiters were cancelled meanwhile.
+      }
+      epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+      auto* waiter = itr->second.head;
+      m_waiters.erase(itr);
+
+      // Queue all waiters to be resumed, the ones that cannot make progress yet will wait again.
+      while (waiter) {
+        auto* next        = waiter->nextWaiter;
+        auto task         = ForkTask{};
+        task.execRegistry = waiter->execRegistry;
+        task.executor     = waiter;
+        ExecutorPool::get().push(task);
+        waiter = next;
+      }
+    }
+  }
+}
+
+#else // !VM_REACTOR_SUPPORTED
+
+auto Reactor::isSupported() noexcept -> bool { return false; }
+
+auto Reactor::block(int /*unused*/, IoEvent /*unused*/) noexcept -> void {}
+
+auto Reactor::wait(int /*unused*/, IoEvent /*unused*/, Executor* /*unused*/) noexcept -> bool {
+  return false;
+}
+
+auto Reactor::cancel(ExecutorRegistry* /*unused*/) noexcept -> void {}
+
+#endif // !VM_REACTOR_SUPPORTED
+
+} // namespace vm::internal
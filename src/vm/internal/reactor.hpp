@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#if defined(__linux__)
+#define VM_REACTOR_SUPPORTED
+#endif
+
+namespace vm::internal {
+
+class ExecutorRegistry;
+struct Executor;
+
+enum class IoEvent : uint8_t {
+  Read  = 0, // File descriptor has data to read (or a connection to accept).
+  Write = 1, // File descriptor can be written to.
+};
+
+// Event loop that resumes suspended executors once the file descriptor they wait for is ready.
+//
+// Sockets are non-blocking (on platforms that support the reactor), when a platform call would
+// block the executor waits for the socket and executes the platform call again once its ready. On
+// the executor pool threads the executor is suspended and registered with the reactor, which
+// queues it to be resumed on the pool when the socket is ready. This way a handful of threads can
+// serve many connections. Other executors (the main executor) block their thread in 'block'.
+//
+// The reactor runs a single thread (started on first use) that waits for all registered file
+// descriptors using epoll. Multiple executors can wait for the same file descriptor, all of them
+// are resumed when it becomes ready (they will wait again when the call would still block).
+//
+// Note: The reactor is shared by all vm instances in the process and is never destroyed, same as
+// the executor pool.
+class Reactor final {
+public:
+  Reactor(const Reactor& rhs) = delete;
+  Reactor(Reactor&& rhs)      = delete;
+  ~Reactor() noexcept         = default;
+
+  auto operator=(const Reactor& rhs) -> Reactor& = delete;
+  auto operator=(Reactor&& rhs) -> Reactor& = delete;
+
+  [[nodiscard]] static auto get() noexcept -> Reactor&;
+
+  [[nodiscard]] static auto isSupported() noexcept -> bool;
+
+  // Block the current thread until the file descriptor is ready for the event.
+  static auto block(int fd, IoEvent event) noexcept -> void;
+
+  // Queue the executor to be resumed once the file descriptor is ready for the event, returns
+  // false if the file descriptor could not be registered (then the caller has to 'block' instead).
+  // Note: The executor should be suspended right after, it can be resumed before that.
+  [[nodiscard]] auto wait(int fd, IoEvent event, Executor* executor) noexcept -> bool;
+
+  // Drop all waiting executors of the given registry.
+  // Note: Should be called after aborting the executors of the registry and before cancelling the
+  // executor pool tasks of the registry.
+  auto cancel(ExecutorRegistry* execRegistry) noexcept -> void;
+
+private:
+  struct Waiters final {
+    Executor* head; // Linked through 'Executor::nextWaiter'.
+    uint32_t events;
+  };
+
+  int m_epollFd;
+  std::mutex m_mutex;
+  std::unordered_map<int, Waiters> m_waiters; // Protected by the mutex.
+
+  Reactor() noexcept;
+
+  auto loop() noexcept -> void;
+};
+
+} // namespace vm::internal
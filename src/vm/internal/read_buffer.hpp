@@ -0,0 +1,126 @@
+#pragma once
+#include "internal/likely.hpp"
+#include "internal/ref_allocator.hpp"
+#include "internal/ref_string.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+namespace vm::internal {
+
+const auto readBufferMinSize = 4U * 1024U; // Size of the first allocation of a read buffer.
+
+// Buffer for data that has been read from a stream but not consumed yet.
+//
+// The memory is allocated on first use and grows when a caller needs more (for example when a
+// line does not fit), data is consumed from the front and the free space is filled at the back.
+class ReadBuffer final {
+public:
+  ReadBuffer() noexcept : m_data{nullptr}, m_capacity{0U}, m_begin{0U}, m_end{0U} {}
+  ReadBuffer(const ReadBuffer& rhs) = delete;
+  ReadBuffer(ReadBuffer&& rhs)      = delete;
+  ~ReadBuffer() noexcept { std::free(m_data); }
+
+  auto operator=(const ReadBuffer& rhs) -> ReadBuffer& = delete;
+  auto operator=(ReadBuffer&& rhs) -> ReadBuffer& = delete;
+
+  [[nodiscard]] inline auto getData() const noexcept -> char* { return m_data + m_begin; }
+
+  [[nodiscard]] inline auto getSize() const noexcept -> unsigned int { return m_end - m_begin; }
+
+  [[nodiscard]] inline auto isEmpty() const noexcept -> bool { return m_begin == m_end; }
+
+  // Free space at the back of the buffer, call 'reserve' first to make space.
+  [[nodiscard]] inline auto getFree() const noexcept -> unsigned int {
+    return m_capacity - m_end;
+  }
+
+  [[nodiscard]] inline auto getFreePtr() const noexcept -> char* { return m_data + m_end; }
+
+  // Mark 'amount' bytes of the free space as filled.
+  inline auto commit(unsigned int amount) noexcept -> void {
+    assert(amount <= getFree());
+    m_end += amount;
+  }
+
+  // Remove 'amount' bytes from the front of the buffer.
+  inline auto consume(unsigned int amount) noexcept -> void {
+    assert(amount <= getSize());
+    m_begin += amount;
+    if (m_begin == m_end) {
+      m_begin = m_end = 0U;
+    }
+  }
+
+  inline auto clear() noexcept -> void { m_begin = m_end = 0U; }
+
+  // Make space for at least 'amount' more bytes, returns false if the allocation failed.
+  [[nodiscard]] auto reserve(unsigned int amount) noexcept -> bool {
+    if (likely(getFree() >= amount)) {
+      return true;
+    }
+    const auto size = getSize();
+    if (m_capacity - size >= amount) {
+      // Enough space when the data is moved to the front.
+      std::memmove(m_data, m_data + m_begin, size);
+    } else {
+      const auto newCapacity = std::max({m_capacity * 2U, size + amount, readBufferMinSize});
+      auto* newData          = static_cast<char*>(std::malloc(newCapacity));
+      if (unlikely(newData == nullptr)) {
+        return false;
+      }
+      if (size != 0U) {
+        std::memcpy(newData, m_data + m_begin, size);
+      }
+      std::free(m_data);
+      m_data     = newData;
+      m_capacity = newCapacity;
+    }
+    m_begin = 0U;
+    m_end   = size;
+    return true;
+  }
+
+  // Copy the first 'amount' bytes to a new string and consume them, upon failure returns nullptr.
+  [[nodiscard]] auto consumeStr(RefAllocator* alloc, unsigned int amount) noexcept -> StringRef* {
+    assert(amount <= getSize());
+    auto* str = alloc->allocStr(amount);
+    if (unlikely(str == nullptr)) {
+      return nullptr;
+    }
+    if (amount != 0U) {
+      std::memcpy(str->getCharDataPtr(), getData(), amount);
+    }
+    consume(amount);
+    return str;
+  }
+
+private:
+  char* m_data;
+  unsigned int m_capacity;
+  unsigned int m_begin;
+  unsigned int m_end;
+};
+
+// Collect characters into the buffer until the delimiter (which is consumed but not collected) or
+// until 'getChar' returns a negative value. Used for streams that are already buffered (like stdio
+// files). Returns false if the buffer failed to grow.
+template <typename GetChar>
+auto readCharsUntil(ReadBuffer* buffer, char delim, GetChar getChar) noexcept -> bool {
+  buffer->clear();
+  while (true) {
+    const int c = getChar();
+    if (c < 0 || c == static_cast<unsigned char>(delim)) {
+      break;
+    }
+    if (unlikely(!buffer->reserve(1U))) {
+      return false;
+    }
+    *buffer->getFreePtr() = static_cast<char>(c);
+    buffer->commit(1U);
+  }
+  return true;
+}
+
+} // namespace vm::internal
@@ -1,4 +1,5 @@
 #include "internal/ref.hpp"
+#include "internal/ref_array.hpp"
 #include "internal/ref_future.hpp"
 #include "internal/ref_long.hpp"
 #include "internal/ref_stream_console.hpp"
@@ -26,9 +27,15 @@ auto Ref::destroy() noexcept -> void {
   case RefKind::String:
     downcastRef<StringRef>(this)->~StringRef();
     break;
+  case RefKind::StringSlice:
+    downcastRef<StringSliceRef>(this)->~StringSliceRef();
+    break;
   case RefKind::StringLink:
     downcastRef<StringLinkRef>(this)->~StringLinkRef();
     break;
+  case RefKind::CharBuffer:
+    downcastRef<CharBufferRef>(this)->~CharBufferRef();
+    break;
   case RefKind::Long:
     downcastRef<LongRef>(this)->~LongRef();
     break;
@@ -41,6 +48,9 @@ auto Ref::destroy() noexcept -> void {
   case RefKind::StreamTcp:
     downcastRef<TcpStreamRef>(this)->~TcpStreamRef();
     break;
+  case RefKind::Array:
+    downcastRef<ArrayRef>(this)->~ArrayRef();
+    break;
   }
 }
 
@@ -1,12 +1,14 @@
 #pragma once
 #include "internal/ref_flags.hpp"
 #include "internal/ref_kind.hpp"
+#include <atomic>
 #include <cassert>
 
 namespace vm::internal {
 
 // Base class for a reference.
-class Ref {
+// Note: Aligned to 8 bytes so that pointers to refs have unused low bits (used to tag values).
+class alignas(8) Ref {
   friend class RefAllocator;
 
 public:
@@ -21,36 +23,62 @@ public:
 
   [[nodiscard]] inline auto getKind() const noexcept { return m_kind; }
 
+  // Note: Flags are updated atomically, as the garbage collector marks refs from multiple threads.
   template <RefFlags F>
   [[nodiscard]] inline auto hasFlag() const noexcept -> bool {
-    return (m_flags & F) == F;
+    return (m_flags.load(std::memory_order_relaxed) & F) == F;
   }
 
   template <RefFlags F>
   inline auto setFlag() noexcept -> void {
-    m_flags = m_flags | F;
+    trySetFlag<F>();
+  }
+
+  // Set the flag, returns true if this call set it and false if it was already set.
+  template <RefFlags F>
+  inline auto trySetFlag() noexcept -> bool {
+    auto cur = m_flags.load(std::memory_order_relaxed);
+    do {
+      if ((cur & F) == F) {
+        return false;
+      }
+    } while (!m_flags.compare_exchange_weak(cur, cur | F, std::memory_order_relaxed));
+    return true;
   }
 
   template <RefFlags F>
   inline auto unsetFlag() noexcept -> void {
-    m_flags = m_flags & ~F;
+    auto cur = m_flags.load(std::memory_order_relaxed);
+    while (!m_flags.compare_exchange_weak(cur, cur & ~F, std::memory_order_relaxed)) {
+    }
   }
 
+  // Refs that survived a garbage collection are part of the 'old' generation.
+  // Note: Refs are promoted by the garbage collector while marking, which runs concurrently with
+  // the executors, so a ref can become old at any moment.
+  [[nodiscard]] inline auto isOld() const noexcept -> bool {
+    return m_old.load(std::memory_order_relaxed);
+  }
+
+  inline auto promote() noexcept -> void { m_old.store(true, std::memory_order_relaxed); }
+
 protected:
-  inline explicit Ref(RefKind kind) noexcept : m_next{nullptr}, m_kind{kind}, m_flags{} {}
+  inline explicit Ref(RefKind kind) noexcept :
+      m_memTag{0U}, m_kind{kind}, m_flags{RefFlags::None}, m_old{false}, m_remembered{false} {}
 
   // Get a raw pointer to the begining of the Ref struct. Can be used by ref implementations to
   // calculate their end-pointer.
   // For obvious reasons this is a dangernous api and care must be taken.
   [[nodiscard]] inline auto getPtr() noexcept -> uint8_t* {
-    return static_cast<uint8_t*>(static_cast<void*>(&m_next));
+    return static_cast<uint8_t*>(static_cast<void*>(this));
   }
 
 private:
-  Ref* m_next; // Used by the RefAllocator to track all references.
-  uint8_t m_memTag;
+  uint8_t m_memTag; // Identifies where the MemoryAllocator allocated the memory from.
   RefKind m_kind;
-  RefFlags m_flags;
+  std::atomic<RefFlags> m_flags;
+  std::atomic_bool m_old;
+  std::atomic_bool m_remembered; // Is this ref in the remembered-set of the RefAllocator.
 };
 
 // Downcast a reference to a child-type, be sure that the types match before calling this.
@@ -1,36 +1,102 @@
 #include "internal/ref_allocator.hpp"
+#include "internal/ref_array.hpp"
 #include "internal/ref_future.hpp"
 #include "internal/ref_long.hpp"
 #include "internal/ref_string.hpp"
 #include "internal/ref_string_link.hpp"
 #include "internal/ref_struct.hpp"
+#include <algorithm>
 #include <atomic>
+#include <cstdlib>
+#include <mutex>
 #include <new>
 
 namespace vm::internal {
 
 RefAllocator::RefAllocator(MemoryAllocator* memAlloc) noexcept :
-    m_memAlloc(memAlloc), m_head{nullptr} {}
+    m_memAlloc(memAlloc),
+    m_marking{false},
+    m_id{nextId.fetch_add(1U, std::memory_order_relaxed)},
+    m_markLogBlocks{nullptr},
+    m_heapProfiler{nullptr} {}
 
 RefAllocator::~RefAllocator() noexcept {
-  /* Delete all allocations. Note this assumes no new allocations are being made while we are
-  running the destructor. */
+  /* Destroy all references. Note this assumes no new allocations are being made while we are
+  running the destructor, the memory itself is released by the MemoryAllocator. */
 
-  auto* ref = m_head.load(std::memory_order_acquire);
-  while (ref) {
-    auto next = ref->m_next;
-    RefAllocator::freeUnsafe(ref);
-    ref = next;
+  m_memAlloc->forEachAlloc([](void* mem) { static_cast<Ref*>(mem)->destroy(); });
+
+  for (auto* ref : m_immortals) {
+    ref->destroy();
+    std::free(ref);
+  }
+
+  while (m_markLogBlocks) {
+    auto* next = m_markLogBlocks->next;
+    delete m_markLogBlocks;
+    m_markLogBlocks = next;
   }
 }
 
 auto RefAllocator::subscribe(RefAllocObserver* observer) -> void {
   // Only allowed to be called before allocating any references.
-  assert(m_head.load(std::memory_order_acquire) == nullptr);
+  assert(m_memAlloc->isEmpty());
 
   m_observers.push_back(observer);
 }
 
+auto RefAllocator::takeRemembered(std::vector<Ref*>* out) noexcept -> void {
+  auto lk = std::lock_guard<std::mutex>{m_rememberedMutex};
+  for (auto* ref : m_remembered) {
+    ref->m_remembered.store(false, std::memory_order_relaxed);
+  }
+  out->insert(out->end(), m_remembered.begin(), m_remembered.end());
+  m_remembered.clear();
+}
+
+auto RefAllocator::takeMarkLog(std::vector<Ref*>* out) noexcept -> void {
+  auto lk = std::lock_guard<std::mutex>{m_markLogMutex};
+  out->insert(out->end(), m_markLog.begin(), m_markLog.end());
+  m_markLog.clear();
+}
+
+auto RefAllocator::flushMarkLogs() noexcept -> void {
+  auto lk = std::lock_guard<std::mutex>{m_markLogMutex};
+  for (auto* block = m_markLogBlocks; block; block = block->next) {
+    m_markLog.insert(m_markLog.end(), block->refs.begin(), block->refs.end());
+    block->refs.clear();
+  }
+}
+
+auto RefAllocator::getStats(MemoryStats* out) const noexcept -> void {
+  using Counter = MemoryStats::Counter;
+  static_assert(MemoryStats::refKindCount == refKindCount);
+
+  m_memAlloc->getStats(out);
+
+  auto allocs = uint64_t{0U};
+  auto frees  = uint64_t{0U};
+  for (auto kind = 0U; kind != refKindCount; ++kind) {
+    const auto kindAllocs = m_stats.get(statAllocBase + kind);
+    const auto kindFrees  = m_stats.get(statFreeBase + kind);
+
+    // Note: Counters are read one by one, a free can be counted before its allocation.
+    out->setLiveRefs(kind, kindAllocs > kindFrees ? kindAllocs - kindFrees : 0U);
+    allocs += kindAllocs;
+    frees += kindFrees;
+  }
+  out->set(Counter::Allocations, allocs);
+  out->set(Counter::AllocatedBytes, m_stats.get(statAllocBytes));
+  out->set(Counter::LiveRefs, allocs > frees ? allocs - frees : 0U);
+  out->set(Counter::FreedRefs, frees);
+
+  // Allocations that did not acquire a page were served from the page cached by the thread.
+  const auto pageAllocs = allocs - std::min(allocs, out->get(Counter::LargeAllocations));
+  out->set(
+      Counter::PageCacheHits,
+      pageAllocs - std::min(pageAllocs, out->get(Counter::PageCacheMisses)));
+}
+
 auto RefAllocator::allocStr(const unsigned int size) noexcept -> StringRef* {
   auto mem = alloc<StringRef>(size + 1); // +1 for null-terminator.
   if (unlikely(mem.refPtr == nullptr)) {
@@ -40,7 +106,7 @@ auto RefAllocator::allocStr(const unsigned int size) noexcept -> StringRef* {
   auto payloadPtr  = static_cast<uint8_t*>(mem.payloadPtr);
   payloadPtr[size] = '\0'; // Null-terminate the payload.
   auto* refPtr     = static_cast<StringRef*>(new (mem.refPtr) StringRef{payloadPtr, size});
-  initRef(refPtr, mem.memTag);
+  initRef(refPtr, mem);
   return refPtr;
 }
 
@@ -57,18 +123,51 @@ auto RefAllocator::allocStrLit(const std::string& lit) noexcept -> StringRef* {
   auto litSize   = static_cast<unsigned int>(lit.size());
   auto* charData = const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(lit.data()));
   auto* refPtr   = static_cast<StringRef*>(new (mem.refPtr) StringRef{charData, litSize});
-  initRef(refPtr, mem.memTag);
+  initRef(refPtr, mem);
+  return refPtr;
+}
+
+auto RefAllocator::allocStrLitImmortal(const std::string& lit) noexcept -> StringRef* {
+  auto* mem = std::malloc(sizeof(StringRef));
+  if (unlikely(mem == nullptr)) {
+    return nullptr;
+  }
+
+  // Note: Same as 'allocStrLit' the string is backed by the memory of the literal.
+  auto litSize   = static_cast<unsigned int>(lit.size());
+  auto* charData = const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(lit.data()));
+  auto* refPtr   = static_cast<StringRef*>(new (mem) StringRef{charData, litSize});
+
+  // Immortal refs are part of the old generation, this way the write-barrier never records refs
+  // that point to them.
+  refPtr->setFlag<RefFlags::Immortal>();
+  refPtr->promote();
+
+  m_immortals.push_back(refPtr);
   return refPtr;
 }
 
-auto RefAllocator::allocStrLink(Ref* prev, Value val) noexcept -> StringLinkRef* {
+auto RefAllocator::allocStrLink(
+    Ref* prev, unsigned int prevSize, Value val, unsigned int valSize) noexcept -> StringLinkRef* {
   auto mem = alloc<StringLinkRef>(0);
   if (unlikely(mem.refPtr == nullptr)) {
     return nullptr;
   }
 
-  auto* refPtr = static_cast<StringLinkRef*>(new (mem.refPtr) StringLinkRef{prev, val});
-  initRef(refPtr, mem.memTag);
+  auto* refPtr = static_cast<StringLinkRef*>(
+      new (mem.refPtr) StringLinkRef{prev, prevSize, val, valSize});
+  initRef(refPtr, mem);
+  return refPtr;
+}
+
+auto RefAllocator::allocCharBuffer(unsigned int capacity) noexcept -> CharBufferRef* {
+  auto mem = alloc<CharBufferRef>(capacity);
+  if (unlikely(mem.refPtr == nullptr)) {
+    return nullptr;
+  }
+
+  auto* refPtr = static_cast<CharBufferRef*>(new (mem.refPtr) CharBufferRef{capacity});
+  initRef(refPtr, mem);
   return refPtr;
 }
 
@@ -79,20 +178,86 @@ auto RefAllocator::allocStruct(uint8_t fieldCount) noexcept -> StructRef* {
   }
 
   auto* refPtr = static_cast<StructRef*>(new (mem.refPtr) StructRef{fieldCount});
-  initRef(refPtr, mem.memTag);
+  initRef(refPtr, mem);
   return refPtr;
 }
 
-auto RefAllocator::initRef(Ref* ref, uint8_t memTag) noexcept -> void {
+auto RefAllocator::allocArray(unsigned int size) noexcept -> ArrayRef* {
+  if (unlikely(size > arrayMaxSize)) {
+    return nullptr;
+  }
+  auto mem = alloc<ArrayRef>(sizeof(Value) * size);
+  if (unlikely(mem.refPtr == nullptr)) {
+    return nullptr;
+  }
 
-  // Store the memory-tag as we need it when free-ing the memory.
-  ref->m_memTag = memTag;
+  auto* refPtr = static_cast<ArrayRef*>(new (mem.refPtr) ArrayRef{size});
+  initRef(refPtr, mem);
+  return refPtr;
+}
+
+auto RefAllocator::initRef(Ref* ref, const Allocation& mem) noexcept -> void {
+  // Store the memory-tag as we need it when marking the reference.
+  ref->m_memTag = mem.memTag;
 
-  // Keep track of all allocated references by linking them as a singly linked list.
-  ref->m_next = m_head.load(std::memory_order_relaxed);
-  while (!m_head.compare_exchange_weak(
-      ref->m_next, ref, std::memory_order_release, std::memory_order_relaxed)) {
+  if (unlikely(m_heapProfiler != nullptr)) {
+    m_heapProfiler->notifyAlloc(ref, mem.size);
+  }
+}
+
+auto RefAllocator::remember(Ref* ref) noexcept -> void {
+  // Only add each ref once, the flag is reset when the garbage collector takes the set.
+  if (ref->m_remembered.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  auto lk = std::lock_guard<std::mutex>{m_rememberedMutex};
+  m_remembered.push_back(ref);
+}
+
+auto RefAllocator::logOverwrite(Ref* ref) noexcept -> void {
+  if (ref == nullptr) {
+    return;
+  }
+  auto* block = getMarkLogBlock();
+  if (unlikely(block == nullptr)) {
+    auto lk = std::lock_guard<std::mutex>{m_markLogMutex};
+    m_markLog.push_back(ref);
+    return;
+  }
+
+  // Add the overwrites in batches, this way the collector can mark them while marking is running.
+  block->refs.push_back(ref);
+  if (unlikely(block->refs.size() >= markLogFlushSize)) {
+    auto lk = std::lock_guard<std::mutex>{m_markLogMutex};
+    m_markLog.insert(m_markLog.end(), block->refs.begin(), block->refs.end());
+    block->refs.clear();
+  }
+}
+
+auto RefAllocator::getMarkLogBlock() noexcept -> MarkLogBlock* {
+  if (likely(markLogCache.allocatorId == m_id)) {
+    return markLogCache.block;
+  }
+
+  // Thread last logged to a different allocator, find (or create) the block of this thread.
+  const auto threadId = std::this_thread::get_id();
+  auto lk             = std::lock_guard<std::mutex>{m_markLogMutex};
+  auto* block         = m_markLogBlocks;
+  while (block && block->owner != threadId) {
+    block = block->next;
+  }
+  if (block == nullptr) {
+    block = new (std::nothrow) MarkLogBlock{};
+    if (unlikely(block == nullptr)) {
+      return nullptr;
+    }
+    block->owner    = threadId;
+    block->next     = m_markLogBlocks;
+    m_markLogBlocks = block;
   }
+  markLogCache.allocatorId = m_id;
+  markLogCache.block       = block;
+  return block;
 }
 
 } // namespace vm::internal
@@ -2,24 +2,42 @@
 #include "gsl.hpp"
 #include "internal/executor_registry.hpp"
 #include "internal/garbage_collector.hpp"
+#include "internal/heap_profiler.hpp"
 #include "internal/likely.hpp"
 #include "internal/memory_allocator.hpp"
 #include "internal/ref_alloc_observer.hpp"
+#include "internal/thread_counters.hpp"
+#include "internal/value.hpp"
+#include "vm/memory_stats.hpp"
+#include <algorithm>
 #include <atomic>
+#include <mutex>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace vm::internal {
 
+const auto markLogFlushSize = 256U; // Overwrites a thread logs before adding them to the mark-log.
+
+class ArrayRef;
 class FutureRef;
 class LongRef;
 class StreamRef;
 class StringRef;
 class StringLinkRef;
+class CharBufferRef;
 class StructRef;
 
 // Reference Allocator is responsible for acquiring raw memory from the MemoryAllocator and then
 // initialing references in it.
-// Also responsible for keeping track of all live references.
+// Live references are tracked by the MemoryAllocator (in the allocation bitmaps of its pages),
+// unreachable references are destroyed when sweeping.
+//
+// Allocations and frees are counted per kind of reference, the counters are per thread so counting
+// does not add contention to the allocation path. For the same reason every thread logs the refs
+// it overwrites while marking to its own mark-log, which is added to the shared mark-log in batches
+// and when the garbage collector flushes the logs of all threads at a safe-point.
 class RefAllocator final {
 public:
   RefAllocator(MemoryAllocator* memAlloc) noexcept;
@@ -34,18 +52,39 @@ public:
   // Note: NOT synchronized has to be called before the application makes any allocations.
   auto subscribe(RefAllocObserver* observer) -> void;
 
+  // Report allocations (and the frees of the sampled ones) to the given heap profiler.
+  // Note: NOT synchronized has to be called before the application makes any allocations.
+  auto setHeapProfiler(HeapProfiler* heapProfiler) noexcept -> void {
+    m_heapProfiler = heapProfiler;
+  }
+
   // Allocate a string, upon failure returns nullptr.
   [[nodiscard]] auto allocStr(unsigned int size) noexcept -> StringRef*;
 
   // Allocate a string from a literal, upon failure returns nullptr.
   [[nodiscard]] auto allocStrLit(const std::string& literal) noexcept -> StringRef*;
 
+  // Allocate an immortal string from a literal, upon failure returns nullptr.
+  // Immortal refs live outside of the heap, the garbage collector never marks or frees them and
+  // they are only destroyed when the allocator is destroyed.
+  [[nodiscard]] auto allocStrLitImmortal(const std::string& literal) noexcept -> StringRef*;
+
   // Allocate a string-link, upon failure returns nullptr.
-  [[nodiscard]] auto allocStrLink(Ref* prev, Value val) noexcept -> StringLinkRef*;
+  // Note: 'prevSize' is the size of the chain up to 'prev' and 'valSize' the size of 'val'.
+  [[nodiscard]] auto
+  allocStrLink(Ref* prev, unsigned int prevSize, Value val, unsigned int valSize) noexcept
+      -> StringLinkRef*;
+
+  // Allocate a (empty) character buffer for string-links, upon failure returns nullptr.
+  [[nodiscard]] auto allocCharBuffer(unsigned int capacity) noexcept -> CharBufferRef*;
 
   // Allocate a struct, upon failure returns nullptr.
   [[nodiscard]] auto allocStruct(uint8_t fieldCount) noexcept -> StructRef*;
 
+  // Allocate an array, upon failure returns nullptr.
+  // Note: The values are not initialized, they have to be written before the array is reachable.
+  [[nodiscard]] auto allocArray(unsigned int size) noexcept -> ArrayRef*;
+
   // Allocate a plain ref type, upon failure returns nullptr.
   template <typename RefType, class... ArgTypes>
   [[nodiscard]] auto allocPlain(ArgTypes&&... args) noexcept -> RefType* {
@@ -57,46 +96,158 @@ public:
     }
 
     auto* refPtr = static_cast<RefType*>(new (mem.refPtr) RefType{std::forward<ArgTypes>(args)...});
-    initRef(refPtr, mem.memTag);
+    initRef(refPtr, mem);
     return refPtr;
   }
 
-  // The 'head' allocation is the newest created reference. In combination with the 'getNextAlloc'
-  // allows walking all live references.
-  [[nodiscard]] inline auto getHeadAlloc() noexcept -> Ref* {
-    return m_head.load(std::memory_order_acquire);
+  // Mark the reference, returns true if this call marked it and false if it was already marked.
+  // Note: Can be called from multiple threads concurrently.
+  inline auto tryMark(Ref* ref) noexcept -> bool { return m_memAlloc->tryMark(ref, ref->m_memTag); }
+
+  // Is the reference marked, refs allocated after the current sweep began are always marked.
+  [[nodiscard]] inline auto isMarked(Ref* ref) const noexcept -> bool {
+    return m_memAlloc->isMarked(ref, ref->m_memTag);
+  }
+
+  // Start a sweep of all current references, returns the amount of units to pass to 'sweep'.
+  // Note: Should only be called while all executors are paused.
+  [[nodiscard]] inline auto beginSweep() noexcept -> unsigned int {
+    return m_memAlloc->beginSweep();
+  }
+
+  // Destroy and free all references in the sweep unit that are not marked. When 'onlyYoung' is true
+  // only refs allocated since the previous sweep (the young generation) are considered.
+  // Note: Units can be swept in parallel and concurrently with new allocations being made.
+  inline auto sweep(unsigned int unit, bool onlyYoung) noexcept -> void {
+    m_memAlloc->sweep(unit, onlyYoung, [this](void* mem) {
+      auto* ref = static_cast<Ref*>(mem);
+      m_stats.add(statFreeBase + static_cast<unsigned int>(ref->getKind()), 1U);
+      if (unlikely(ref->hasFlag<RefFlags::HeapSampled>())) {
+        m_heapProfiler->notifyFree(ref);
+      }
+      ref->destroy();
+    });
+  }
+
+  // Bytes of the refs that survived the last sweep (including old refs that were not swept).
+  // Note: Only complete once all sweep units have been swept.
+  [[nodiscard]] inline auto getSweepLiveBytes() const noexcept -> uint64_t {
+    return m_memAlloc->getSweepLiveBytes();
+  }
+
+  // Enable or disable the marking part of the write-barrier.
+  // Note: Should only be called while all executors are paused.
+  inline auto setMarking(bool marking) noexcept -> void {
+    m_marking.store(marking, std::memory_order_relaxed);
+  }
+
+  // Write-barrier, has to be called when storing a reference into an existing ref.
+  //
+  // Old refs that point to young refs are recorded in the remembered-set, this allows minor
+  // collections to find the young refs that are only reachable from the old generation without
+  // scanning it. While marking refs can be promoted at any moment, so then all refs that point to
+  // young refs are recorded.
+  inline auto writeBarrier(Ref* ref, Ref* target) noexcept -> void {
+    if ((unlikely(ref->isOld()) || unlikely(m_marking.load(std::memory_order_relaxed))) &&
+        target != nullptr && !target->isOld()) {
+      remember(ref);
+    }
+  }
+
+  inline auto writeBarrier(Ref* ref, Value val) noexcept -> void {
+    if (val.isRef()) {
+      writeBarrier(ref, val.getRef());
+    }
   }
 
-  // Retreive the 'next' references for a given reference, allows walking all live references.
-  [[nodiscard]] inline auto getNextAlloc(Ref* ref) noexcept -> Ref* { return ref->m_next; }
-
-  // Free the reference after the given one.
-  // Note: Not thread-safe, should not be called concurrently.
-  // Frees the next one instead of the given one because then we can more efficiently keep our
-  // linked list of references up to date.
-  inline auto freeNext(Ref* ref) noexcept -> Ref* {
-    auto* toFree = ref->m_next;
-    if (toFree) {
-      auto* next  = toFree->m_next;
-      ref->m_next = next;
-      freeUnsafe(toFree);
-      return next;
+  // Write-barrier for overwriting a value in an existing ref, has to be called before the store.
+  // While marking the overwritten reference is recorded in the mark-log of the thread ('snapshot at
+  // the beginning'), this guarantees that refs that were reachable when marking began are marked
+  // even if the program removes the last reference to them while marking is in progress.
+  inline auto writeBarrier(Ref* ref, Value oldVal, Value newVal) noexcept -> void {
+    if (unlikely(m_marking.load(std::memory_order_relaxed)) && oldVal.isRef()) {
+      logOverwrite(oldVal.getRef());
     }
-    return nullptr;
+    writeBarrier(ref, newVal);
+  }
+
+  // Move the remembered-set into the given vector and clear it.
+  // Note: Should only be called while all executors are paused.
+  auto takeRemembered(std::vector<Ref*>* out) noexcept -> void;
+
+  // Remove all refs from the remembered-set for which the predicate returns false.
+  template <typename Predicate>
+  auto filterRemembered(Predicate pred) noexcept -> void {
+    auto lk  = std::lock_guard<std::mutex>{m_rememberedMutex};
+    auto end = std::remove_if(m_remembered.begin(), m_remembered.end(), [&pred](Ref* ref) {
+      if (pred(ref)) {
+        return false;
+      }
+      ref->m_remembered.store(false, std::memory_order_relaxed);
+      return true;
+    });
+    m_remembered.erase(end, m_remembered.end());
   }
 
+  // Move the mark-log into the given vector and clear it.
+  // Note: Only contains the overwrites that the threads have added to it so far, the rest is added
+  // by 'flushMarkLogs'.
+  auto takeMarkLog(std::vector<Ref*>* out) noexcept -> void;
+
+  // Add the mark-logs of all threads to the mark-log.
+  // Note: Should only be called while all executors are paused.
+  auto flushMarkLogs() noexcept -> void;
+
+  // Write the allocation statistics (including the ones of the MemoryAllocator) to the given stats.
+  // Note: Can be called concurrently with allocations and sweeps, the result is a snapshot.
+  auto getStats(MemoryStats* out) const noexcept -> void;
+
 private:
+  // Layout of the statistics: allocations per ref kind, frees per ref kind and allocated bytes.
+  static constexpr auto statAllocBase  = 0U;
+  static constexpr auto statFreeBase   = refKindCount;
+  static constexpr auto statAllocBytes = refKindCount * 2U;
+  static constexpr auto statCount      = refKindCount * 2U + 1U;
+
   struct Allocation {
     void* refPtr;
     void* payloadPtr;
     uint8_t memTag;
+    size_t size;
   };
 
+  // Mark-log of a single thread, only the owning thread writes to it while it is running.
+  struct MarkLogBlock final {
+    std::vector<Ref*> refs;
+    std::thread::id owner;
+    MarkLogBlock* next;
+  };
+
+  struct MarkLogCache final {
+    uint64_t allocatorId;
+    MarkLogBlock* block;
+  };
+
+  inline static std::atomic<uint64_t> nextId{1U};
+  inline static thread_local MarkLogCache markLogCache{0U, nullptr};
+
   MemoryAllocator* m_memAlloc;
-  std::atomic<Ref*> m_head;
   std::vector<RefAllocObserver*> m_observers;
+  std::vector<Ref*> m_remembered;
+  std::mutex m_rememberedMutex;
+  std::atomic_bool m_marking;
+  uint64_t m_id; // Unique id, identifies the allocator in the mark-log cache of the threads.
+  std::vector<Ref*> m_markLog;
+  MarkLogBlock* m_markLogBlocks;
+  std::mutex m_markLogMutex;
+  std::vector<Ref*> m_immortals;
+  ThreadCounters<statCount> m_stats;
+  HeapProfiler* m_heapProfiler;
 
-  auto initRef(Ref* ref, uint8_t memTag) noexcept -> void;
+  auto initRef(Ref* ref, const Allocation& mem) noexcept -> void;
+  auto remember(Ref* ref) noexcept -> void;
+  auto logOverwrite(Ref* ref) noexcept -> void;
+  auto getMarkLogBlock() noexcept -> MarkLogBlock*;
 
   // Allocate raw memory for a structure + a payload for that structure. When 'payloadsize' is 0
   // only enough memory to hold the structure is allocated. When 'payloadsize' is 10 then 10
@@ -112,21 +263,17 @@ private:
     auto alloc           = m_memAlloc->alloc(allocSize);
     void* payloadPtr     = static_cast<char*>(alloc.first) + refSize;
 
+    if (likely(alloc.first != nullptr)) {
+      m_stats.add(statAllocBase + static_cast<unsigned int>(ConcreteRef::getKind()), 1U);
+      m_stats.add(statAllocBytes, allocSize);
+    }
+
     // Notify any observers about this allocation.
     for (auto* observer : m_observers) {
       observer->notifyAlloc(allocSize);
     }
 
-    return Allocation{alloc.first, payloadPtr, alloc.second};
-  }
-
-  // Destruct and free the given ref, unsafe because it doesn't update any of the bookkeeping.
-  inline auto freeUnsafe(Ref* ref) noexcept -> void {
-    // 'Destroy' the reference, which will call the destructor of the implementation.
-    // Note: Reason why its not using a virtual destructor is that this way we can avoid the vtable.
-    ref->destroy();
-    // Free the backing memory.
-    m_memAlloc->free(ref, ref->m_memTag);
+    return Allocation{alloc.first, payloadPtr, alloc.second, allocSize};
   }
 };
 
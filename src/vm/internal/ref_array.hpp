@@ -0,0 +1,48 @@
+#pragma once
+#include "internal/ref.hpp"
+#include "internal/value.hpp"
+
+namespace vm::internal {
+
+const auto arrayMaxSize = 256U * 1024U * 1024U; // Maximum amount of values in a single array.
+
+// Immutable contiguous sequence of values.
+// Note: the values of the array are allocated right after this class.
+class ArrayRef final : public Ref {
+  friend class RefAllocator;
+
+public:
+  ArrayRef(const ArrayRef& rhs) = delete;
+  ArrayRef(ArrayRef&& rhs)      = delete;
+  ~ArrayRef() noexcept          = default;
+
+  auto operator=(const ArrayRef& rhs) -> ArrayRef& = delete;
+  auto operator=(ArrayRef&& rhs) -> ArrayRef& = delete;
+
+  [[nodiscard]] constexpr static auto getKind() { return RefKind::Array; }
+
+  // Get a pointer to the first value (In memory right after this class).
+  [[nodiscard]] inline auto getValuesBegin() noexcept -> Value* {
+    return static_cast<Value*>(static_cast<void*>(getPtr() + sizeof(ArrayRef)));
+  }
+
+  [[nodiscard]] inline auto getValuesEnd() noexcept -> Value* { return getValuesBegin() + m_size; }
+
+  [[nodiscard]] inline auto getSize() const noexcept { return m_size; }
+
+  [[nodiscard]] inline auto getValue(unsigned int index) noexcept { return *getValuePtr(index); }
+
+  [[nodiscard]] inline auto getValuePtr(unsigned int index) noexcept -> Value* {
+    assert(index < getSize());
+    return getValuesBegin() + index;
+  }
+
+private:
+  unsigned int m_size;
+
+  inline explicit ArrayRef(unsigned int size) noexcept : Ref(getKind()), m_size{size} {}
+};
+
+inline auto getArrayRef(const Value& val) noexcept { return val.getDowncastRef<ArrayRef>(); }
+
+} // namespace vm::internal
@@ -4,8 +4,9 @@
 namespace vm::internal {
 
 enum class RefFlags : uint8_t {
-  None     = 0U,
-  GcMarked = 1U,
+  None        = 0U,
+  Immortal    = 1U << 0U, // Never freed by the garbage collector (not part of the heap).
+  HeapSampled = 1U << 1U, // Sampled by the heap profiler, it is notified when the ref is freed.
 };
 
 constexpr auto operator|(RefFlags lhs, RefFlags rhs) noexcept {
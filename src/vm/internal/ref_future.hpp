@@ -1,7 +1,6 @@
 #pragma once
 #include "internal/value.hpp"
 #include "vm/exec_state.hpp"
-#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
@@ -9,10 +8,12 @@
 namespace vm::internal {
 
 class Value;
+struct Executor;
 
 // A future is a handle to a forked executor that is asynchronously computing (or has computed) a
 // value.
 class FutureRef final : public Ref {
+  friend class ExecutorRegistry;
   friend class RefAllocator;
 
 public:
@@ -45,8 +46,8 @@ public:
     return m_state;
   }
 
-  // Check if the executor has started computing the value.
-  [[nodiscard]] inline auto getStarted() noexcept -> std::atomic_bool& { return m_started; }
+  // Arguments for the forked call (a struct), taken by the executor when it starts.
+  [[nodiscard]] inline auto getArgs() noexcept -> Value { return m_args; }
 
   [[nodiscard]] inline auto getResult() noexcept -> Value { return m_result; }
 
@@ -54,23 +55,34 @@ public:
 
   [[nodiscard]] inline auto getCondVar() noexcept -> std::condition_variable& { return m_condVar; }
 
+  // Executors that are suspended until the future is done, linked through 'Executor::nextWaiter'.
+  // Note: The state and the waiters should only be accessed while holding the mutex.
+  [[nodiscard]] inline auto getState() noexcept -> ExecState { return m_state; }
+  [[nodiscard]] inline auto getWaiters() noexcept -> Executor* { return m_waiters; }
+
+  inline auto setArgs(Value args) noexcept { m_args = args; }
   inline auto setResult(Value result) noexcept { m_result = result; }
   inline auto setState(ExecState state) noexcept { m_state = state; }
+  inline auto setWaiters(Executor* waiters) noexcept { m_waiters = waiters; }
 
 private:
-  std::atomic_bool m_started;
   ExecState m_state;
   std::mutex m_mutex;
   std::condition_variable m_condVar;
+  Value m_args;
   Value m_result;
+  Executor* m_waiters;
+  unsigned int m_forkIndex; // Index in the pending forks of the registry until the fork started.
 
   inline explicit FutureRef() noexcept :
       Ref(getKind()),
-      m_started{false},
       m_state{ExecState::Running},
       m_mutex{},
       m_condVar{},
-      m_result{} {}
+      m_args{nullRefValue()},
+      m_result{},
+      m_waiters{nullptr},
+      m_forkIndex{0U} {}
 };
 
 inline auto getFutureRef(const Value& val) noexcept { return val.getDowncastRef<FutureRef>(); }
@@ -12,6 +12,11 @@ enum class RefKind : uint8_t {
   StreamFile    = 5U,
   StreamConsole = 6U,
   StreamTcp     = 7U,
+  Array         = 8U,
+  StringSlice   = 9U,
+  CharBuffer    = 10U,
 };
 
+const auto refKindCount = 11U;
+
 } // namespace vm::internal
@@ -1,4 +1,5 @@
 #pragma once
+#include "internal/likely.hpp"
 #include "internal/ref.hpp"
 #include "internal/value.hpp"
 #include <cstdint>
@@ -6,9 +7,8 @@
 namespace vm::internal {
 
 // Reference to a 64 bit integer value.
-// We cannot store full 64 bit integers in a 'Value' because only 63 bits are available for storage.
-// As an optimization all positive longs (most significant bit being 0) are stored directly in a
-// 'Value' while negative longs are stored as references.
+// Almost all longs are stored directly in a 'Value', only the (odd) longs close to the minimum
+// that would be indistinguishable from references are stored as a 'LongRef' (see 'Value').
 class LongRef final : public Ref {
   friend class RefAllocator;
 
@@ -31,13 +31,13 @@ private:
 };
 
 inline auto getLong(const Value& val) noexcept -> int64_t {
-  // Positive long's (most significant bit always 0) are stored in the value directly, while
-  // negative longs are stored as references.
-  if (val.isRef()) {
+  // Longs are stored in the value directly, except for the longs that would be indistinguishable
+  // from references.
+  if (unlikely(val.isRef())) {
     auto* longRef = val.getDowncastRef<LongRef>();
     return longRef->getVal();
   }
-  return val.getPosLong();
+  return val.getInlineLong();
 }
 
 } // namespace vm::internal
@@ -2,6 +2,7 @@
 #include "gsl.hpp"
 #include "internal/fd_utilities.hpp"
 #include "internal/os_include.hpp"
+#include "internal/read_buffer.hpp"
 #include "internal/ref.hpp"
 #include "internal/ref_allocator.hpp"
 #include "internal/ref_string.hpp"
@@ -56,12 +57,12 @@ public:
 #endif
 
     // Can block so we mark ourselves as paused so the gc can trigger in the mean time.
-    execHandle->setState(ExecState::Paused);
+    execHandle->beginBlocking();
 
     auto bytesRead = std::fread(str->getCharDataPtr(), 1U, str->getSize(), m_filePtr);
 
     // After resuming check if we should wait for gc (or if we are aborted).
-    execHandle->setState(ExecState::Running);
+    execHandle->endBlocking();
     if (execHandle->trap()) {
       return false;
     }
@@ -81,12 +82,12 @@ public:
 #endif
 
     // Can block so we mark ourselves as paused so the gc can trigger in the mean time.
-    execHandle->setState(ExecState::Paused);
+    execHandle->beginBlocking();
 
     const auto res = std::getc(m_filePtr);
 
     // After resuming check if we should wait for gc (or if we are aborted).
-    execHandle->setState(ExecState::Running);
+    execHandle->endBlocking();
     if (execHandle->trap()) {
       return '\0';
     }
@@ -94,15 +95,43 @@ public:
     return res > 0 ? static_cast<char>(res) : '\0';
   }
 
+  // Read until the delimiter, the delimiter is consumed but not included in the result.
+  // Note: Reads are already buffered by stdio, 'm_lineBuffer' only collects the characters.
+  auto readUntil(ExecutorHandle* execHandle, RefAllocator* alloc, char delim) noexcept
+      -> StringRef* {
+#if defined(_WIN32)
+    if (m_nonblockWinTerm) {
+      if (!readCharsUntil(&m_lineBuffer, delim, [] { return _kbhit() ? getch() : -1; })) {
+        return nullptr;
+      }
+      return m_lineBuffer.consumeStr(alloc, m_lineBuffer.getSize());
+    }
+#endif
+
+    // Can block so we mark ourselves as paused so the gc can trigger in the mean time.
+    execHandle->beginBlocking();
+
+    const auto res = readCharsUntil(&m_lineBuffer, delim, [this] { return std::getc(m_filePtr); });
+
+    // After resuming check if we should wait for gc (or if we are aborted).
+    execHandle->endBlocking();
+    if (execHandle->trap() || !res) {
+      return nullptr;
+    }
+
+    // Note: Allocate after resuming, allocating is not allowed while the gc can run.
+    return m_lineBuffer.consumeStr(alloc, m_lineBuffer.getSize());
+  }
+
   auto writeString(ExecutorHandle* execHandle, StringRef* str) noexcept -> bool {
 
     // Can block so we mark ourselves as paused so the gc can trigger in the mean time.
-    execHandle->setState(ExecState::Paused);
+    execHandle->beginBlocking();
 
     const auto res = std::fwrite(str->getDataPtr(), str->getSize(), 1, m_filePtr) == 1;
 
     // After resuming check if we should wait for gc (or if we are aborted).
-    execHandle->setState(ExecState::Running);
+    execHandle->endBlocking();
     if (execHandle->trap()) {
       return false;
     }
@@ -113,12 +142,12 @@ public:
   auto writeChar(ExecutorHandle* execHandle, uint8_t val) noexcept -> bool {
 
     // Can block so we mark ourselves as paused so the gc can trigger in the mean time.
-    execHandle->setState(ExecState::Paused);
+    execHandle->beginBlocking();
 
     const auto res = std::fputc(val, m_filePtr) == val;
 
     // After resuming check if we should wait for gc (or if we are aborted).
-    execHandle->setState(ExecState::Running);
+    execHandle->endBlocking();
     if (execHandle->trap()) {
       return false;
     }
@@ -160,6 +189,7 @@ private:
   bool m_nonblockWinTerm = false;
 #endif
   FILE* m_filePtr;
+  ReadBuffer m_lineBuffer;
 
   inline explicit ConsoleStreamRef(FILE* filePtr) noexcept : Ref{getKind()}, m_filePtr{filePtr} {}
 };
@@ -1,6 +1,7 @@
 #pragma once
 #include "gsl.hpp"
 #include "internal/fd_utilities.hpp"
+#include "internal/read_buffer.hpp"
 #include "internal/ref.hpp"
 #include "internal/ref_allocator.hpp"
 #include "internal/ref_string.hpp"
@@ -61,6 +62,16 @@ public:
     return res > 0 ? static_cast<char>(res) : '\0';
   }
 
+  // Read until the delimiter, the delimiter is consumed but not included in the result.
+  // Note: Reads are already buffered by stdio, 'm_lineBuffer' only collects the characters.
+  auto readUntil(ExecutorHandle* /*unused*/, RefAllocator* alloc, char delim) noexcept
+      -> StringRef* {
+    if (!readCharsUntil(&m_lineBuffer, delim, [this] { return std::getc(m_filePtr); })) {
+      return nullptr;
+    }
+    return m_lineBuffer.consumeStr(alloc, m_lineBuffer.getSize());
+  }
+
   auto writeString(ExecutorHandle* /*unused*/, StringRef* str) noexcept -> bool {
     return std::fwrite(str->getDataPtr(), str->getSize(), 1, m_filePtr) == 1;
   }
@@ -79,6 +90,7 @@ private:
   FileStreamFlags m_flags;
   gsl::owner<FILE*> m_filePtr;
   gsl::owner<char*> m_filePath;
+  ReadBuffer m_lineBuffer;
 
   inline explicit FileStreamRef(
       gsl::owner<FILE*> filePtr, gsl::owner<char*> filePath, FileStreamFlags flags) noexcept :
@@ -1,13 +1,20 @@
 #pragma once
 #include "internal/fd_utilities.hpp"
 #include "internal/os_include.hpp"
+#include "internal/reactor.hpp"
+#include "internal/read_buffer.hpp"
 #include "internal/ref.hpp"
 #include "internal/ref_allocator.hpp"
 #include "internal/ref_string.hpp"
 #include "internal/settings.hpp"
 #include "likely.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cstring>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 #if defined(_WIN32)
 
@@ -27,12 +34,78 @@ namespace vm::internal {
 
 constexpr int32_t defaultConnectionBacklog = 64;
 
+// Interval at which executors that wait for another executor to finish a read check if they have
+// been aborted.
+constexpr auto streamOwnerWaitInterval = std::chrono::milliseconds{10};
+
+// Perform a socket call that could block. Returns false if the call did not complete, either
+// because the socket is not ready (then the executor is requested to wait for it and the platform
+// call is executed again afterwards) or because the executor was aborted while it was blocked.
+template <typename Result, typename Call>
+inline auto socketCall(
+    ExecutorHandle* execHandle,
+    [[maybe_unused]] SOCKET sock,
+    [[maybe_unused]] IoEvent event,
+    Result* result,
+    Call call) noexcept -> bool {
+#if defined(VM_REACTOR_SUPPORTED)
+  // Sockets are non-blocking, when the call would block wait for the socket to be ready.
+  *result = call();
+  if (*result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+    execHandle->requestIoWait(sock, event);
+    return false;
+  }
+  return true;
+#else  // !VM_REACTOR_SUPPORTED
+  // Call can block so we mark ourselves as paused so the gc can trigger in the mean time.
+  execHandle->beginBlocking();
+
+  *result = call();
+
+  // After resuming check if we should wait for gc (or if we are aborted).
+  execHandle->endBlocking();
+  return !execHandle->trap();
+#endif // !VM_REACTOR_SUPPORTED
+}
+
+// Lock a mutex of a stream. When another executor holds it then wait for it as a blocking call, as
+// the other executor could be blocked on the socket. Returns a lock that does not own the mutex if
+// the executor was aborted while waiting.
+inline auto lockStream(ExecutorHandle* execHandle, std::mutex* mutex) noexcept
+    -> std::unique_lock<std::mutex> {
+  auto lk = std::unique_lock<std::mutex>{*mutex, std::try_to_lock};
+  if (unlikely(!lk.owns_lock())) {
+    execHandle->beginBlocking();
+    lk.lock();
+    execHandle->endBlocking();
+    if (execHandle->trap()) {
+      lk.unlock();
+    }
+  }
+  return lk;
+}
+
+// Switch the socket to non-blocking mode when the reactor is used to wait for sockets.
+inline auto setSocketNonBlocking([[maybe_unused]] SOCKET sock) noexcept -> void {
+#if defined(VM_REACTOR_SUPPORTED)
+  setFileOpts(sock, StreamOpts::NoBlock);
+#endif
+}
+
 enum class TcpStreamType : uint8_t {
   Server     = 0, // Server cannot be used for sending or receiving but can accept new connections.
   Connection = 1, // Connections are be used for sending and receiving.
 };
 
 // Tcp implementation of the 'stream' interface.
+//
+// Forked executors can share a stream, so reads and writes are serialized by a per-stream lock for
+// each direction. A string that is partially sent when the executor has to wait for the socket is
+// finished by that executor before any other executor can write ('m_sendOwner'), so strings are
+// never interleaved. Likewise a read that has to wait for the socket completes before any other
+// read starts ('m_readOwner'), otherwise the other reads could wait for data that the waiting read
+// has already received into the read buffer.
+//
 // Note: To avoid needing a vtable there is no abstract 'Stream' class but instead there are wrapper
 // functions that dispatch based on the 'RefKind' (see stream_utilities.hpp).
 class TcpStreamRef final : public Ref {
@@ -62,6 +135,33 @@ public:
 
   [[nodiscard]] auto isValid() noexcept -> bool { return SOCKET_VALID(m_socket) && m_err == -1; }
 
+  // Wait for a connection that is still being established (see 'tcpOpenConnection'). Returns false
+  // if its not established yet, then the executor is requested to wait for the socket.
+  auto awaitConnect([[maybe_unused]] ExecutorHandle* execHandle) noexcept -> bool {
+    if (likely(!m_connecting)) {
+      return true;
+    }
+#if defined(VM_REACTOR_SUPPORTED)
+    auto pollFd   = pollfd{};
+    pollFd.fd     = m_socket;
+    pollFd.events = POLLOUT;
+    if (poll(&pollFd, 1, 0) == 0) {
+      execHandle->requestIoWait(m_socket, IoEvent::Write);
+      return false;
+    }
+    int err      = 0;
+    auto errSize = static_cast<socklen_t>(sizeof(int));
+    if (getsockopt(m_socket, SOL_SOCKET, SO_ERROR, &err, &errSize) < 0) {
+      err = errno;
+    }
+    if (err != 0) {
+      m_err = err;
+    }
+#endif // VM_REACTOR_SUPPORTED
+    m_connecting = false;
+    return true;
+  }
+
   auto readString(ExecutorHandle* execHandle, StringRef* str) noexcept -> bool {
     if (unlikely(m_type != TcpStreamType::Connection)) {
       str->updateSize(0);
@@ -70,54 +170,54 @@ public:
     if (unlikely(str->getSize() == 0)) {
       return false;
     }
-
-    // 'recv' call can block so we mark ourselves as paused so the gc can trigger in the mean time.
-    execHandle->setState(ExecState::Paused);
-
-    auto bytesRead = recv(m_socket, str->getCharDataPtr(), str->getSize(), 0);
-
-    // After resuming check if we should wait for gc (or if we are aborted).
-    execHandle->setState(ExecState::Running);
-    if (execHandle->trap()) {
+    if (!awaitConnect(execHandle)) {
+      str->updateSize(0);
       return false;
     }
-
-    if (bytesRead < 0) {
-      m_err = SOCKET_ERR;
+    auto lk = lockRead(execHandle);
+    if (!lk.owns_lock()) {
       str->updateSize(0);
       return false;
     }
-
-    str->updateSize(bytesRead);
-    return bytesRead > 0;
+    const auto res = readStringLocked(execHandle, str);
+    endRead(execHandle);
+    return res;
   }
 
   auto readChar(ExecutorHandle* execHandle) noexcept -> char {
     if (unlikely(m_type != TcpStreamType::Connection)) {
       return '\0';
     }
-
-    // 'recv' call can block so we mark ourselves as paused so the gc can trigger in the mean time.
-    execHandle->setState(ExecState::Paused);
-
-    char res       = '\0';
-    auto bytesRead = recv(m_socket, &res, 1, 0);
-
-    // After resuming check if we should wait for gc (or if we are aborted).
-    execHandle->setState(ExecState::Running);
-    if (execHandle->trap()) {
+    if (!awaitConnect(execHandle)) {
       return '\0';
     }
-
-    switch (bytesRead) {
-    case -1:
-      m_err = SOCKET_ERR;
-      [[fallthrough]];
-    case 0:
+    auto lk = lockRead(execHandle);
+    if (!lk.owns_lock()) {
       return '\0';
-    default:
-      return res;
     }
+    const auto res = readCharLocked(execHandle);
+    endRead(execHandle);
+    return res;
+  }
+
+  // Read until the delimiter, the delimiter is consumed but not included in the result. When the
+  // connection ends before the delimiter the remaining data is returned. Returns nullptr if the
+  // call did not complete (executor has to wait for the socket) or if allocating failed.
+  auto readUntil(ExecutorHandle* execHandle, RefAllocator* alloc, char delim) noexcept
+      -> StringRef* {
+    if (unlikely(m_type != TcpStreamType::Connection)) {
+      return alloc->allocStr(0);
+    }
+    if (!awaitConnect(execHandle)) {
+      return nullptr;
+    }
+    auto lk = lockRead(execHandle);
+    if (!lk.owns_lock()) {
+      return nullptr;
+    }
+    auto* res = readUntilLocked(execHandle, alloc, delim);
+    endRead(execHandle);
+    return res;
   }
 
   auto writeString(ExecutorHandle* execHandle, StringRef* str) noexcept -> bool {
@@ -125,22 +225,40 @@ public:
       return false;
     }
 
-    // 'send' call can block so we mark ourselves as paused so the gc can trigger in the mean time.
-    execHandle->setState(ExecState::Paused);
-
-    auto bytesWritten = send(m_socket, str->getCharDataPtr(), str->getSize(), 0);
-
-    // After resuming check if we should wait for gc (or if we are aborted).
-    execHandle->setState(ExecState::Running);
-    if (execHandle->trap()) {
+    if (!awaitConnect(execHandle)) {
       return false;
     }
-
-    if (bytesWritten < 0) {
-      m_err = SOCKET_ERR;
+    auto lk = lockStream(execHandle, &m_writeMutex);
+    if (!lk.owns_lock() || !isValid() || !awaitSendOwner(execHandle)) {
       return false;
     }
-    return bytesWritten == static_cast<int>(str->getSize());
+
+    /* Keep sending until the whole string is written. When the socket is not ready the call is
+    executed again later, 'm_sendOffset' keeps track of the part that was already sent. */
+    m_sendOwner = execHandle;
+    while (m_sendOffset != str->getSize()) {
+      int64_t bytesWritten;
+      if (!socketCall(execHandle, m_socket, IoEvent::Write, &bytesWritten, [&] {
+            return send(
+                m_socket,
+                str->getCharDataPtr() + m_sendOffset,
+                str->getSize() - m_sendOffset,
+                0);
+          })) {
+        if (!execHandle->hasIoWait()) {
+          endSend(); // Aborted.
+        }
+        return false;
+      }
+      if (bytesWritten < 0) {
+        m_err = SOCKET_ERR;
+        endSend();
+        return false;
+      }
+      m_sendOffset += static_cast<unsigned int>(bytesWritten);
+    }
+    endSend();
+    return true;
   }
 
   auto writeChar(ExecutorHandle* execHandle, uint8_t val) noexcept -> bool {
@@ -148,15 +266,19 @@ public:
       return false;
     }
 
-    // 'send' call can block so we mark ourselves as paused so the gc can trigger in the mean time.
-    execHandle->setState(ExecState::Paused);
-
-    auto* valChar     = static_cast<char*>(static_cast<void*>(&val));
-    auto bytesWritten = send(m_socket, valChar, 1, 0);
+    if (!awaitConnect(execHandle)) {
+      return false;
+    }
+    auto lk = lockStream(execHandle, &m_writeMutex);
+    if (!lk.owns_lock() || !isValid() || !awaitSendOwner(execHandle)) {
+      return false;
+    }
 
-    // After resuming check if we should wait for gc (or if we are aborted).
-    execHandle->setState(ExecState::Running);
-    if (execHandle->trap()) {
+    auto* valChar = static_cast<char*>(static_cast<void*>(&val));
+    int64_t bytesWritten;
+    if (!socketCall(execHandle, m_socket, IoEvent::Write, &bytesWritten, [&] {
+          return send(m_socket, valChar, 1, 0);
+        })) {
       return false;
     }
 
@@ -188,15 +310,15 @@ public:
       return alloc->allocPlain<TcpStreamRef>(TcpStreamType::Connection, INVALID_SOCKET, -1);
     }
 
-    // 'accept' call blocks so we mark ourselves as paused so the gc can trigger in the mean time.
-    execHandle->setState(ExecState::Paused);
-
     // Accept a new connection from the socket.
-    const auto sock = accept(m_socket, nullptr, nullptr);
-
-    // After resuming check if we should wait for gc (or if we are aborted).
-    execHandle->setState(ExecState::Running);
-    if (execHandle->trap()) {
+    SOCKET sock;
+    if (!socketCall(execHandle, m_socket, IoEvent::Read, &sock, [this] {
+#if defined(VM_REACTOR_SUPPORTED)
+          return accept4(m_socket, nullptr, nullptr, SOCK_NONBLOCK);
+#else
+          return accept(m_socket, nullptr, nullptr);
+#endif
+        })) {
       return nullptr;
     }
 
@@ -209,18 +331,185 @@ public:
 private:
   TcpStreamType m_type;
   SOCKET m_socket;
-  int m_err;
+  std::atomic<int> m_err;
+  std::atomic<bool> m_connecting; // Connection is still being established in the background.
+  std::mutex m_writeMutex;        // Protects the send state.
+  ExecutorHandle* m_sendOwner;    // Executor that is sending a string, if any.
+  unsigned int m_sendOffset;      // Part of the current 'writeString' that has already been sent.
+  std::mutex m_readMutex;         // Protects the read state.
+  std::condition_variable m_readCondVar; // Signaled when a read that waited for the socket ends.
+  ExecutorHandle* m_readOwner;    // Executor with a read that is waiting for the socket, if any.
+  unsigned int m_scanOffset;      // Part of the read buffer that 'readUntil' has already scanned.
+  ReadBuffer m_readBuffer;        // Received data that has not been read yet.
 
   inline explicit TcpStreamRef(TcpStreamType type, SOCKET sock) noexcept :
-      Ref{getKind()}, m_type{type}, m_socket{sock}, m_err{-1} {}
+      TcpStreamRef{type, sock, -1} {}
+
+  inline TcpStreamRef(TcpStreamType type, SOCKET sock, int err, bool connecting = false) noexcept :
+      Ref{getKind()},
+      m_type{type},
+      m_socket{sock},
+      m_err{err},
+      m_connecting{connecting},
+      m_sendOwner{nullptr},
+      m_sendOffset{0U},
+      m_readOwner{nullptr},
+      m_scanOffset{0U} {}
+
+  // Wait until the string that another executor is sending has been sent, the executor is requested
+  // to wait for the socket the same as the sending executor. Should be called with the write lock.
+  auto awaitSendOwner(ExecutorHandle* execHandle) noexcept -> bool {
+    if (likely(m_sendOwner == nullptr || m_sendOwner == execHandle)) {
+      return true;
+    }
+    execHandle->requestIoWait(m_socket, IoEvent::Write);
+    return false;
+  }
+
+  auto endSend() noexcept -> void {
+    m_sendOwner  = nullptr;
+    m_sendOffset = 0U;
+  }
 
-  inline TcpStreamRef(TcpStreamType type, SOCKET sock, int err) noexcept :
-      Ref{getKind()}, m_type{type}, m_socket{sock}, m_err{err} {}
+  // Lock the read state, waits while the read of another executor is waiting for the socket.
+  // Returns a lock that does not own the mutex if the executor was aborted while waiting.
+  auto lockRead(ExecutorHandle* execHandle) noexcept -> std::unique_lock<std::mutex> {
+    auto lk = lockStream(execHandle, &m_readMutex);
+    while (lk.owns_lock() && unlikely(m_readOwner != nullptr && m_readOwner != execHandle)) {
+      // Wake up periodically to notice being aborted, the owner might never complete its read.
+      execHandle->beginBlocking();
+      m_readCondVar.wait_for(lk, streamOwnerWaitInterval);
+      execHandle->endBlocking();
+      if (execHandle->trap()) {
+        lk.unlock();
+      }
+    }
+    return lk;
+  }
+
+  // End a read, when it has to wait for the socket it keeps owning the read side until it is
+  // executed again. Should be called with the read lock.
+  auto endRead(ExecutorHandle* execHandle) noexcept -> void {
+    if (execHandle->hasIoWait()) {
+      m_readOwner = execHandle;
+      return;
+    }
+    m_scanOffset = 0U;
+    if (unlikely(m_readOwner == execHandle)) {
+      m_readOwner = nullptr;
+      m_readCondVar.notify_all();
+    }
+  }
+
+  auto readStringLocked(ExecutorHandle* execHandle, StringRef* str) noexcept -> bool {
+    // Serve the read from the buffered data, only receive when there is none.
+    if (m_readBuffer.isEmpty()) {
+      if (!isValid()) {
+        str->updateSize(0);
+        return false;
+      }
+      if (str->getSize() >= readBufferMinSize) {
+        // Big reads receive directly into the string, no point in copying them.
+        int64_t bytesRead;
+        if (!receive(execHandle, str->getCharDataPtr(), str->getSize(), &bytesRead)) {
+          str->updateSize(0);
+          return false;
+        }
+        str->updateSize(static_cast<unsigned int>(bytesRead));
+        return bytesRead > 0;
+      }
+      int64_t bytesRead;
+      if (!fill(execHandle, &bytesRead) || bytesRead == 0) {
+        str->updateSize(0);
+        return false;
+      }
+    }
+
+    const auto size = std::min(str->getSize(), m_readBuffer.getSize());
+    std::memcpy(str->getCharDataPtr(), m_readBuffer.getData(), size);
+    m_readBuffer.consume(size);
+    str->updateSize(size);
+    return true;
+  }
+
+  auto readCharLocked(ExecutorHandle* execHandle) noexcept -> char {
+    if (m_readBuffer.isEmpty()) {
+      int64_t bytesRead;
+      if (!isValid() || !fill(execHandle, &bytesRead) || bytesRead == 0) {
+        return '\0';
+      }
+    }
+    const auto res = *m_readBuffer.getData();
+    m_readBuffer.consume(1U);
+    return res;
+  }
+
+  auto readUntilLocked(ExecutorHandle* execHandle, RefAllocator* alloc, char delim) noexcept
+      -> StringRef* {
+    /* Data that was already scanned stays in the buffer while waiting for more, when the call is
+    executed again scanning continues where it left off ('m_scanOffset'). As the read keeps owning
+    the read side meanwhile no other read can consume the scanned data. */
+    while (true) {
+      const auto size   = m_readBuffer.getSize();
+      const auto* data  = m_readBuffer.getData();
+      const auto offset = m_scanOffset;
+      const auto* match =
+          static_cast<const char*>(std::memchr(data + offset, delim, size - offset));
+      if (match) {
+        auto* str = m_readBuffer.consumeStr(alloc, static_cast<unsigned int>(match - data));
+        if (str) {
+          m_readBuffer.consume(1U); // Consume the delimiter.
+        }
+        return str;
+      }
+      m_scanOffset = size;
+
+      int64_t bytesRead = 0;
+      if (isValid() && !fill(execHandle, &bytesRead)) {
+        return nullptr;
+      }
+      if (bytesRead == 0) {
+        // Connection ended (or failed), return the remaining data.
+        return m_readBuffer.consumeStr(alloc, size);
+      }
+    }
+  }
+
+  // Receive into the given memory. Returns false if the call did not complete, 'bytesRead' is 0
+  // when the connection has ended or failed.
+  auto
+  receive(ExecutorHandle* execHandle, char* data, unsigned int size, int64_t* bytesRead) noexcept
+      -> bool {
+    if (!socketCall(execHandle, m_socket, IoEvent::Read, bytesRead, [&] {
+          return recv(m_socket, data, size, 0);
+        })) {
+      return false;
+    }
+    if (*bytesRead < 0) {
+      m_err      = SOCKET_ERR;
+      *bytesRead = 0;
+    }
+    return true;
+  }
+
+  // Receive more data into the read buffer, see 'receive'.
+  auto fill(ExecutorHandle* execHandle, int64_t* bytesRead) noexcept -> bool {
+    if (unlikely(!m_readBuffer.reserve(readBufferMinSize / 2U))) {
+      m_err      = ENOMEM;
+      *bytesRead = 0;
+      return true;
+    }
+    if (!receive(execHandle, m_readBuffer.getFreePtr(), m_readBuffer.getFree(), bytesRead)) {
+      return false;
+    }
+    m_readBuffer.commit(static_cast<unsigned int>(*bytesRead));
+    return true;
+  }
 };
 
 inline auto tcpOpenConnection(
     const Settings& settings,
-    ExecutorHandle* execHandle,
+    [[maybe_unused]] ExecutorHandle* execHandle,
     RefAllocator* alloc,
     StringRef* address,
     int32_t port) -> TcpStreamRef* {
@@ -244,17 +533,27 @@ inline auto tcpOpenConnection(
     return alloc->allocPlain<TcpStreamRef>(TcpStreamType::Connection, sock, SOCKET_ERR);
   }
 
+#if defined(VM_REACTOR_SUPPORTED)
+  /* Socket is non-blocking, the connection is established in the background and the first use of
+  the stream waits for it (see 'awaitConnect'). */
+  setSocketNonBlocking(sock);
+  auto res = connect(sock, static_cast<sockaddr*>(static_cast<void*>(&addr)), sizeof(sockaddr_in));
+  if (res < 0 && errno == EINPROGRESS) {
+    return alloc->allocPlain<TcpStreamRef>(TcpStreamType::Connection, sock, -1, true);
+  }
+#else  // !VM_REACTOR_SUPPORTED
   // 'connect' call blocks so we mark ourselves as paused so the gc can trigger in the mean time.
-  execHandle->setState(ExecState::Paused);
+  execHandle->beginBlocking();
 
   // Connect to the remote address.
   auto res = connect(sock, static_cast<sockaddr*>(static_cast<void*>(&addr)), sizeof(sockaddr_in));
 
   // After resuming check if we should wait for gc (or if we are aborted).
-  execHandle->setState(ExecState::Running);
+  execHandle->endBlocking();
   if (execHandle->trap()) {
     return nullptr;
   }
+#endif // !VM_REACTOR_SUPPORTED
 
   if (res < 0) {
     return alloc->allocPlain<TcpStreamRef>(TcpStreamType::Connection, sock, SOCKET_ERR);
@@ -299,6 +598,7 @@ tcpStartServer(const Settings& settings, RefAllocator* alloc, int32_t port, int3
   }
 
   // Socket is now ready to accept connections.
+  setSocketNonBlocking(sock);
   return alloc->allocPlain<TcpStreamRef>(TcpStreamType::Server, sock);
 }
 
@@ -336,13 +636,13 @@ inline auto ipLookupAddress(
   hints.ai_socktype = SOCK_STREAM;
 
   // 'getaddrinfo' call blocks so mark ourselves as paused so the gc can trigger in the mean time.
-  execHandle->setState(ExecState::Paused);
+  execHandle->beginBlocking();
 
   addrinfo* res = nullptr;
   auto resCode  = getaddrinfo(hostName->getCharDataPtr(), nullptr, &hints, &res);
 
   // After resuming check if we should wait for gc (or if we are aborted).
-  execHandle->setState(ExecState::Running);
+  execHandle->endBlocking();
   if (execHandle->trap()) {
 
     // Cleanup the addinfo's incase any where allocated.
@@ -5,7 +5,10 @@
 
 namespace vm::internal {
 
-class StringRef final : public Ref {
+// Sequence of characters.
+// Note: Plain strings own their characters and are null-terminated, string-slices (see below) point
+// into the characters of another string and are NOT null-terminated.
+class StringRef : public Ref {
   friend class RefAllocator;
 
 public:
@@ -26,8 +29,14 @@ public:
 
   [[nodiscard]] inline auto getSize() const noexcept { return m_size; }
 
+  // Is this a slice of another string (not null-terminated).
+  [[nodiscard]] inline auto isSlice() const noexcept {
+    return Ref::getKind() == RefKind::StringSlice;
+  }
+
   // Note: Size can only be updated to be less then the original.
   inline auto updateSize(unsigned int size) noexcept {
+    assert(!isSlice());
     assert(size <= m_size);
     m_size = size;
 
@@ -35,12 +44,55 @@ public:
     m_data[size] = '\0';
   }
 
+protected:
+  inline StringRef(RefKind kind, uint8_t* data, unsigned int size) noexcept :
+      Ref(kind), m_size{size}, m_data{data} {}
+
 private:
   unsigned int m_size;
   uint8_t* m_data;
 
   inline explicit StringRef(uint8_t* data, unsigned int size) noexcept :
-      Ref(getKind()), m_size{size}, m_data{data} {}
+      StringRef(getKind(), data, size) {}
 };
 
+// String that references a range of the characters of a parent string, the parent is kept alive
+// for as long as the slice is alive.
+// Note: The parent is always a plain string, slices of slices reference the original parent.
+class StringSliceRef final : public StringRef {
+  friend class RefAllocator;
+
+public:
+  StringSliceRef(const StringSliceRef& rhs) = delete;
+  StringSliceRef(StringSliceRef&& rhs)      = delete;
+  ~StringSliceRef() noexcept                = default;
+
+  auto operator=(const StringSliceRef& rhs) -> StringSliceRef& = delete;
+  auto operator=(StringSliceRef&& rhs) -> StringSliceRef& = delete;
+
+  [[nodiscard]] constexpr static auto getKind() { return RefKind::StringSlice; }
+
+  [[nodiscard]] inline auto getParent() const noexcept { return m_parent; }
+
+private:
+  StringRef* m_parent;
+
+  inline StringSliceRef(StringRef* parent, unsigned int offset, unsigned int size) noexcept :
+      StringRef(getKind(), parent->getDataPtr() + offset, size), m_parent{parent} {
+    assert(!parent->isSlice());
+    assert(offset + size <= parent->getSize());
+  }
+};
+
+// Is the reference a string (either a plain string or a slice).
+inline auto isStringRef(const Ref* ref) noexcept {
+  return ref->getKind() == RefKind::String || ref->getKind() == RefKind::StringSlice;
+}
+
+// Cast a reference to a string, be sure that its a string (plain or slice) before calling this.
+inline auto asStringRef(Ref* ref) noexcept -> StringRef* {
+  assert(isStringRef(ref));
+  return static_cast<StringRef*>(ref); // NOLINT: Down-cast.
+}
+
 } // namespace vm::internal
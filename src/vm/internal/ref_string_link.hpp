@@ -1,14 +1,72 @@
 #pragma once
 #include "internal/ref.hpp"
 #include "internal/ref_string.hpp"
-#include "internal/value.hpp"
+#include <atomic>
 
 namespace vm::internal {
 
-class RefAllocator;
+const auto charBufferMinCapacity = 16U;       // Capacity of the first buffer of a chain.
+const auto charBufferMaxCapacity = 4U * 1024U; // Buffers grow (by doubling) up to this capacity.
 
-// A 'StringLink' can be used to create a linked list of StringRef's. Used as an optimization when
+// Buffer that string-links append characters to.
+// Multiple links can share the same buffer, each link uses a prefix of the characters. Characters
+// are only ever appended so the prefix that an existing link uses never changes.
+// Note: The characters of the buffer are allocated right after this class.
+class CharBufferRef final : public Ref {
+  friend class RefAllocator;
+
+public:
+  CharBufferRef(const CharBufferRef& rhs) = delete;
+  CharBufferRef(CharBufferRef&& rhs)      = delete;
+  ~CharBufferRef() noexcept               = default;
+
+  auto operator=(const CharBufferRef& rhs) -> CharBufferRef& = delete;
+  auto operator=(CharBufferRef&& rhs) -> CharBufferRef& = delete;
+
+  [[nodiscard]] constexpr static auto getKind() { return RefKind::CharBuffer; }
+
+  // Get a pointer to the first character (In memory right after this class).
+  [[nodiscard]] inline auto getCharsBegin() noexcept -> uint8_t* {
+    return getPtr() + sizeof(CharBufferRef);
+  }
+
+  [[nodiscard]] inline auto getCapacity() const noexcept { return m_capacity; }
+
+  // Append a character at the given index, only succeeds if the index is the current end of the
+  // buffer (no other link appended after it yet) and if there is space left.
+  [[nodiscard]] inline auto tryAppend(unsigned int index, uint8_t c) noexcept -> bool {
+    if (index >= m_capacity) {
+      return false;
+    }
+    auto expected = index;
+    if (!m_used.compare_exchange_strong(expected, index + 1U, std::memory_order_relaxed)) {
+      return false;
+    }
+    getCharsBegin()[index] = c;
+    return true;
+  }
+
+private:
+  std::atomic<unsigned int> m_used;
+  unsigned int m_capacity;
+
+  inline explicit CharBufferRef(unsigned int capacity) noexcept :
+      Ref(getKind()), m_used{0U}, m_capacity{capacity} {}
+};
+
+// A 'StringLink' can be used to create a linked list of strings. Used as an optimization when
 // concatenation strings, only when the 'result' is needed is the actual concatenation performed.
+// Every link caches the size of the entire chain so the length is known without walking it.
+//
+// A single appended character is stored in the link itself, when appending more characters they
+// are stored in a CharBufferRef. When appending to a link that is the last user of its buffer the
+// character is written in place and the new link shares the buffer (and the previous link) with
+// the original link, this way the chain does not grow with every character.
+//
+// Once the chain has been collapsed into a normal string the 'prev' reference is replaced by the
+// collapsed string, a collapsed string can be recognized as it has the size of the entire chain
+// (the 'value' of a link is never empty). This way a link fits in the same size-class as a string.
+//
 // Note: Only forward links are supported as the common case is building up a string forwards, but
 // if building a string backwards turns out to be common also we could support a configurable
 // direction.
@@ -25,61 +83,80 @@ public:
 
   [[nodiscard]] constexpr static auto getKind() { return RefKind::StringLink; }
 
-  // Prev can either be a StringRef or another StringLinkRef.
-  [[nodiscard]] inline auto getPrev() const noexcept { return m_prev; }
+  // Prev can either be a StringRef (plain or slice) or another StringLinkRef, once the link has
+  // been collapsed it is the collapsed string (see 'isCollapsedPrev').
+  // Note: Other threads can collapse the link at any moment, so read it once and then inspect it.
+  [[nodiscard]] inline auto getPrev() const noexcept {
+    return m_prev.load(std::memory_order_acquire);
+  }
 
-  // The 'value' of the link is either a StringRef or a single character as an int.
+  // The 'value' of the link is either a StringRef (plain or slice), a CharBufferRef or a single
+  // character as an int.
+  // Note: Only valid if the link has not been collapsed.
   [[nodiscard]] inline auto getVal() const noexcept { return m_val; }
 
-  // Size of the 'value' of the link, either the size of the StringRef or 1 incase of a character.
-  [[nodiscard]] inline auto getValSize() const noexcept {
-    if (m_val.isRef()) {
-      return m_val.getDowncastRef<StringRef>()->getSize();
-    }
-    // If its not a string it has to be a single character.
-    return 1U;
-  }
+  // Size of the 'value' of the link, for char-buffers the amount of characters this link uses.
+  [[nodiscard]] inline auto getValSize() const noexcept { return m_valSize; }
 
-  // Has a collapsed version been computed.
-  [[nodiscard]] inline auto isCollapsed() const noexcept { return m_collapsed != nullptr; }
+  // Size of the entire chain (up to and including this link).
+  [[nodiscard]] inline auto getSize() const noexcept { return m_size; }
+
+  // Is the given 'prev' (as returned from 'getPrev') the collapsed version of this chain.
+  [[nodiscard]] inline auto isCollapsedPrev(Ref* prev) const noexcept {
+    return prev->getKind() == RefKind::String &&
+        downcastRef<StringRef>(prev)->getSize() == m_size;
+  }
 
   // A collapsed version of the chain if it has been computed, otherwise null.
-  [[nodiscard]] inline auto getCollapsed() const noexcept { return m_collapsed; }
+  [[nodiscard]] inline auto getCollapsed() const noexcept -> StringRef* {
+    auto* prev = getPrev();
+    return isCollapsedPrev(prev) ? downcastRef<StringRef>(prev) : nullptr;
+  }
 
   // Set a collapsed version of the chain.
-  // Note: We cannot yet clear the 'prev' and 'val' references as multiple threads might be
-  // accessing this same link. Instead we wait until the next gc cycle before we clear those.
-  inline auto setCollapsed(StringRef* stringRef) noexcept { m_collapsed = stringRef; }
+  // Note: We cannot yet clear the 'val' reference as other threads might still be walking the old
+  // chain. Instead we wait until the next gc cycle before we clear it.
+  inline auto setCollapsed(StringRef* stringRef) noexcept {
+    assert(stringRef->getSize() == m_size);
+    m_prev.store(stringRef, std::memory_order_release);
+  }
 
-  // Clear the 'prev' and 'val references.
+  // Clear the 'val' reference.
   // Note: Should ONLY be called after a 'collapsed' version has been computed and its guaranteed no
-  // other thread is still accessing 'prev' and 'val'.
-  [[nodiscard]] inline auto clearLink() noexcept {
-    assert(m_collapsed != nullptr);
-    m_prev = nullptr;
-    m_val  = Value();
+  // other thread is still accessing 'val'.
+  inline auto clearLink() noexcept {
+    assert(getCollapsed() != nullptr);
+    m_val = nullRefValue();
   }
 
 private:
-  Ref* m_prev;
+  std::atomic<Ref*> m_prev;
   Value m_val;
-  StringRef* m_collapsed;
-
-  inline explicit StringLinkRef(Ref* prev, Value val) noexcept :
-      Ref(getKind()), m_prev{prev}, m_val{val}, m_collapsed{nullptr} {
-
-    assert(m_prev != nullptr);
-    assert(m_prev->getKind() == RefKind::String || m_prev->getKind() == RefKind::StringLink);
+  unsigned int m_size;
+  unsigned int m_valSize;
+
+  inline StringLinkRef(Ref* prev, unsigned int prevSize, Value val, unsigned int valSize) noexcept :
+      Ref(getKind()), m_prev{prev}, m_val{val}, m_size{prevSize + valSize}, m_valSize{valSize} {
+
+    assert(prev != nullptr);
+    assert(isStringRef(prev) || prev->getKind() == RefKind::StringLink);
+    assert(
+        !m_val.isRef() || isStringRef(m_val.getRef()) ||
+        m_val.getRef()->getKind() == RefKind::CharBuffer);
+    assert(m_val.isRef() || m_valSize == 1U);
+    assert(m_valSize != 0U);
   }
 };
 
+static_assert(sizeof(StringLinkRef) == 32U, "String-links should fit in the 32 byte size-class");
+
 inline auto getStringLinkRef(const Value& val) noexcept {
   return val.getDowncastRef<StringLinkRef>();
 }
 
 inline auto getStringOrLinkRef(const Value& val) noexcept {
   auto* ref = val.getRef();
-  assert(ref->getKind() == RefKind::String || ref->getKind() == RefKind::StringLink);
+  assert(isStringRef(ref) || ref->getKind() == RefKind::StringLink);
   return ref;
 }
 
@@ -2,8 +2,14 @@
 
 namespace vm::internal {
 
+class GarbageCollector;
+class Profiler;
+
 struct Settings {
   bool socketsEnabled;
+  unsigned int stackLimit;    // Maximum amount of values on the stack of an executor.
+  Profiler* profiler;         // Null when the program is not being profiled.
+  const GarbageCollector* gc; // Provides the memory statistics to the program.
 };
 
 } // namespace vm::internal
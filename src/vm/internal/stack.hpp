@@ -1,90 +1,227 @@
 #pragma once
+#include "internal/likely.hpp"
 #include "internal/value.hpp"
-#include <array>
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
 
 namespace vm::internal {
 
+const auto stackSegmentMinSize = 512U;        // Size (in values) of the first segment.
+const auto stackSegmentMaxSize = 64U * 1024U; // Segments double in size up to this size.
+
 // Virtual memory stack used by executors.
-// Note: stored on the hardware stack so capacity x 64 bit needs to fit in the platform's
-// stack-size.
-template <unsigned int Capacity>
+//
+// The stack is stored on the heap as a list of segments. It starts with a small segment and when
+// more space is needed a new (bigger) segment is added, until the total size of the segments would
+// exceed the limit of the stack. A stack-frame is never split over multiple segments, when growing
+// the current stack-frame is moved to the new segment. When that stack-frame returns (and rewinds
+// to the start of the segment) the previous segment becomes the current segment again. When a
+// stack-frame that was already moved grows again its segment is replaced by a bigger one.
+//
+// Note: Values are not checked for space when pushed, callers have to check 'hasSpace' first.
 class Stack final {
 public:
-  Stack() noexcept :
-      m_stack{}, m_stackNext{m_stack.data()}, m_stackMax{m_stack.data() + Capacity} {}
+  explicit Stack(unsigned int limit) noexcept :
+      m_segment{nullptr},
+      m_stackBase{nullptr},
+      m_stackNext{nullptr},
+      m_stackMax{nullptr},
+      m_size{0U},
+      m_limit{limit} {}
   Stack(const Stack& rhs) = delete;
   Stack(Stack&& rhs)      = delete;
-  ~Stack() noexcept       = default;
+  ~Stack() noexcept {
+    if (m_segment) {
+      std::free(m_segment->next); // Segment that was kept for reuse.
+    }
+    while (m_segment) {
+      auto* prev = m_segment->prev;
+      std::free(m_segment);
+      m_segment = prev;
+    }
+  }
 
   auto operator=(const Stack& rhs) -> Stack& = delete;
   auto operator=(Stack&& rhs) -> Stack& = delete;
 
-  [[nodiscard]] inline auto getBottom() noexcept -> Value* { return m_stack.data(); }
-
   [[nodiscard]] inline auto getTop() const noexcept -> Value* { return m_stackNext - 1; }
 
   [[nodiscard]] inline auto getNext() const noexcept -> Value* { return m_stackNext; }
 
-  [[nodiscard]] inline auto isEmpty() const noexcept -> bool {
-    return m_stackNext == m_stack.data();
+  // End of the current segment.
+  [[nodiscard]] inline auto getMax() const noexcept -> Value* { return m_stackMax; }
+
+  [[nodiscard]] inline auto hasSpace(unsigned int amount) const noexcept -> bool {
+    return static_cast<size_t>(m_stackMax - m_stackNext) >= amount;
   }
 
-  [[nodiscard]] inline auto getSize() const noexcept -> unsigned int {
-    return m_stackNext - m_stack.data();
+  // Invoke the function for all values on the stack (from all segments).
+  template <typename Func>
+  inline auto forEach(Func func) const noexcept -> void {
+    auto* end = m_stackNext;
+    for (auto* segment = m_segment; segment; segment = segment->prev) {
+      for (auto* sp = segment->getValues(); sp != end; ++sp) {
+        func(*sp);
+      }
+      end = segment->prevNext;
+    }
   }
 
   inline auto rewindToNext(Value* next) noexcept -> void {
-    assert(next <= getNext()); // Not allowed to go forwards.
+    assert(next >= m_stackBase && next <= getNext()); // Not allowed to go forwards.
     m_stackNext = next;
   }
 
-  inline auto rewindToTop(Value* top) noexcept -> void {
-    assert(top <= getTop()); // Not allowed to go forwards.
-    m_stackNext = top + 1;
+  // Rewind to the start of a stack-frame that returns, if the stack-frame was moved to the current
+  // segment (see 'grow') then continue on the previous segment.
+  inline auto rewindToFrame(Value* frame) noexcept -> void {
+    if (unlikely(frame == m_stackBase)) {
+      popSegment();
+      return;
+    }
+    rewindToNext(frame);
   }
 
-  [[nodiscard]] inline auto alloc(unsigned int amount) noexcept -> bool {
+  // Set the next free position, used to sync the stack after it was modified by native code.
+  inline auto setNext(Value* next) noexcept -> void {
+    assert(next >= m_stackBase && next <= m_stackMax);
+    m_stackNext = next;
+  }
+
+  inline auto alloc(unsigned int amount) noexcept -> void {
     assert(amount != 0);
+    assert(hasSpace(amount));
     m_stackNext += amount;
-    return m_stackNext < m_stackMax;
   }
 
-  inline auto push(Value value) noexcept -> bool {
+  inline auto push(Value value) noexcept -> void {
+    assert(hasSpace(1U));
     *m_stackNext++ = value;
-    return m_stackNext < m_stackMax;
   }
 
   inline auto peek() noexcept -> Value { return *getTop(); }
 
   inline auto peek(unsigned int behind) noexcept -> Value {
-    assert(behind < getSize());
+    assert(getTop() - behind >= m_stackBase);
     return *(getTop() - behind);
   }
 
   inline auto pop() noexcept -> Value {
-    assert(m_stackNext - m_stack.data() != 0);
+    assert(m_stackNext != m_stackBase);
     return *--m_stackNext;
   }
 
   inline auto popAt(unsigned int behind) noexcept -> Value {
-    assert(behind < getSize());
+    assert(getTop() - behind >= m_stackBase);
 
     auto* tgtPtr = getTop() - behind;
     auto result  = *tgtPtr;
     std::memmove(tgtPtr, tgtPtr + 1, sizeof(Value) * behind);
 
-    --m_stackMax;
+    --m_stackNext;
     return result;
   }
 
+  // Continue on a new segment with space for at least 'amount' more values, the values from
+  // 'frame' up to the top of the stack are moved to the new segment. Returns the new location of
+  // 'frame' or nullptr if the limit of the stack has been reached.
+  // Note: 'frame' cannot point before the start of the current segment.
+  [[nodiscard]] auto grow(Value* frame, unsigned int amount) noexcept -> Value* {
+    assert(frame >= m_stackBase && frame <= m_stackNext);
+
+    /* If the frame already starts the current segment (because it grew before) then the new
+    segment replaces the current one, otherwise returning from the frame would only pop a single
+    segment and not continue on the segment of the caller. */
+
+    const auto replace   = m_segment && frame == m_stackBase;
+    const auto available = m_limit - m_size + (replace ? m_segment->size : 0U);
+    const auto frameSize = static_cast<unsigned int>(m_stackNext - frame);
+    const auto minSize   = frameSize + amount;
+    if (minSize > available) {
+      return nullptr;
+    }
+    auto size = m_segment ? m_segment->size * 2U : stackSegmentMinSize;
+    if (!replace) {
+      size = std::min(size, stackSegmentMaxSize); // Replaced segments keep doubling.
+    }
+    size = std::min(std::max(size, minSize), available);
+
+    // Reuse the segment that was kept after returning from it, if it fits.
+    Segment* segment = m_segment ? m_segment->next : nullptr;
+    if (segment && (segment->size < minSize || segment->size > available)) {
+      std::free(segment);
+      segment = nullptr;
+    }
+    if (segment == nullptr) {
+      segment = static_cast<Segment*>(std::malloc(sizeof(Segment) + sizeof(Value) * size));
+      if (unlikely(segment == nullptr)) {
+        if (m_segment) {
+          m_segment->next = nullptr;
+        }
+        return nullptr;
+      }
+      segment->size = size;
+    }
+    segment->next     = nullptr;
+    segment->prevNext = replace ? m_segment->prevNext : frame;
+
+    auto* newFrame = segment->getValues();
+    if (frameSize != 0U) {
+      std::memcpy(newFrame, frame, sizeof(Value) * frameSize);
+    }
+    if (replace) {
+      auto* replaced = m_segment;
+      m_segment      = replaced->prev;
+      m_size -= replaced->size;
+      std::free(replaced);
+    }
+    segment->prev = m_segment;
+    if (m_segment) {
+      m_segment->next = segment;
+    }
+    m_segment   = segment;
+    m_stackBase = newFrame;
+    m_stackNext = newFrame + frameSize;
+    m_stackMax  = newFrame + segment->size;
+    m_size += segment->size;
+    return newFrame;
+  }
+
 private:
-  std::array<Value, Capacity + 1> m_stack; // + 1 to be able to delay the bounds check.
+  struct Segment final {
+    Segment* prev;
+    Segment* next;   // Segment that follows this one, kept for reuse after returning from it.
+    Value* prevNext; // Next free position of the previous segment.
+    unsigned int size;
+
+    [[nodiscard]] inline auto getValues() noexcept -> Value* {
+      return reinterpret_cast<Value*>(this + 1); // NOLINT: Reinterpret cast
+    }
+  };
+
+  Segment* m_segment; // Current segment.
+  Value* m_stackBase;
   Value* m_stackNext;
   Value* m_stackMax;
+  unsigned int m_size; // Total size of the current and the previous segments.
+  unsigned int m_limit;
+
+  auto popSegment() noexcept -> void {
+    auto* segment = m_segment;
+    assert(segment->prev);
+
+    // Keep the segment around to avoid allocating again when the next call needs it.
+    std::free(segment->next);
+    segment->next = nullptr;
+    m_size -= segment->size;
+
+    m_segment   = segment->prev;
+    m_stackBase = m_segment->getValues();
+    m_stackNext = segment->prevNext;
+    m_stackMax  = m_stackBase + m_segment->size;
+  }
 };
 
-using BasicStack = Stack<10240>;
-
 } // namespace vm::internal
@@ -32,6 +32,16 @@ inline auto streamCheckValid(const Value& stream) noexcept -> bool {
   STREAM_DISPATCH(stream, isValid())
 }
 
+// Check if the stream is valid, waits for tcp streams that are still connecting.
+inline auto streamCheckValid(ExecutorHandle* execHandle, const Value& stream) noexcept -> bool {
+  auto* ref = stream.getRef();
+  if (ref->getKind() == RefKind::StreamTcp &&
+      !downcastRef<TcpStreamRef>(ref)->awaitConnect(execHandle)) {
+    return false;
+  }
+  return streamCheckValid(stream);
+}
+
 inline auto
 streamReadString(ExecutorHandle* execHandle, const Value& stream, StringRef* tgt) noexcept -> bool {
 
@@ -49,6 +59,28 @@ inline auto streamReadChar(ExecutorHandle* execHandle, const Value& stream) noex
   STREAM_DISPATCH(stream, readChar(execHandle))
 }
 
+// Read until the delimiter, returns nullptr if the call did not complete or if allocating failed.
+inline auto streamReadUntil(
+    ExecutorHandle* execHandle, RefAllocator* alloc, const Value& stream, char delim) noexcept
+    -> StringRef* {
+
+  if (!streamCheckValid(stream)) {
+    return alloc->allocStr(0);
+  }
+  STREAM_DISPATCH(stream, readUntil(execHandle, alloc, delim))
+}
+
+// Read until the end of the line, the line ending ('\n' or '\r\n') is not included in the result.
+inline auto
+streamReadLine(ExecutorHandle* execHandle, RefAllocator* alloc, const Value& stream) noexcept
+    -> StringRef* {
+  auto* str = streamReadUntil(execHandle, alloc, stream, '\n');
+  if (str && str->getSize() != 0 && str->getCharDataPtr()[str->getSize() - 1] == '\r') {
+    str->updateSize(str->getSize() - 1);
+  }
+  return str;
+}
+
 inline auto
 streamWriteString(ExecutorHandle* execHandle, const Value& stream, StringRef* str) noexcept
     -> bool {
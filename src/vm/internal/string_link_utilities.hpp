@@ -3,48 +3,89 @@
 #include "internal/ref_allocator.hpp"
 #include "internal/ref_string.hpp"
 #include "internal/ref_string_link.hpp"
+#include <algorithm>
 #include <cstring>
 
 namespace vm::internal {
 
-// Compute the total size of a string-link.
-inline auto getStringLinkSize(StringLinkRef& l) noexcept -> unsigned int {
-  // If we've precomputed this chain then we can return that size.
-  if (l.isCollapsed()) {
-    return l.getCollapsed()->getSize();
+// Size of a string or string-link, for string-links the size of the entire chain is cached so
+// this does not require collapsing the link.
+inline auto getStringOrLinkSize(Ref* ref) noexcept -> unsigned int {
+  if (isStringRef(ref)) {
+    return asStringRef(ref)->getSize();
   }
+  return downcastRef<StringLinkRef>(ref)->getSize();
+}
 
-  // Otherwise walk the chain to compute the full size.
-  auto result = l.getValSize();
-  auto* cur   = l.getPrev();
-  while (true) {
-    if (cur->getKind() == RefKind::String) {
-      result += downcastRef<StringRef>(cur)->getSize();
-      break;
-    }
-    auto* curLink = downcastRef<StringLinkRef>(cur);
-    if (curLink->isCollapsed()) {
-      result += curLink->getCollapsed()->getSize();
-      break;
+// Append a string to a string or string-link, upon failure returns nullptr.
+// Note: Appending an empty string returns 'prev' itself.
+inline auto appendStringLink(RefAllocator* refAlloc, Ref* prev, StringRef* str) noexcept -> Ref* {
+  if (str->getSize() == 0U) {
+    return prev;
+  }
+  return refAlloc->allocStrLink(prev, getStringOrLinkSize(prev), refValue(str), str->getSize());
+}
+
+// Append a character to a string or string-link, upon failure returns nullptr.
+inline auto appendCharLink(RefAllocator* refAlloc, Ref* prev, uint8_t c) noexcept
+    -> StringLinkRef* {
+  if (prev->getKind() == RefKind::StringLink) {
+    auto* prevLink     = downcastRef<StringLinkRef>(prev);
+    auto* prevLinkPrev = prevLink->getPrev();
+    auto prevVal       = prevLink->getVal();
+    const auto live    = !prevLink->isCollapsedPrev(prevLinkPrev);
+
+    // Appending to a single character: start a buffer holding both characters.
+    if (live && !prevVal.isRef()) {
+      auto* buffer = refAlloc->allocCharBuffer(charBufferMinCapacity);
+      if (unlikely(buffer == nullptr)) {
+        return nullptr;
+      }
+      [[maybe_unused]] const auto appended =
+          buffer->tryAppend(0U, static_cast<uint8_t>(prevVal.getInt())) && buffer->tryAppend(1U, c);
+      assert(appended);
+      return refAlloc->allocStrLink(prevLinkPrev, prevLink->getSize() - 1U, refValue(buffer), 2U);
     }
 
-    result += curLink->getValSize();
-    cur = curLink->getPrev();
-    assert(cur != nullptr);
+    if (live && prevVal.getRef()->getKind() == RefKind::CharBuffer) {
+      auto* buffer = downcastRef<CharBufferRef>(prevVal.getRef());
+
+      // If no other link has appended to the buffer yet we can write the character in place, the
+      // new link then replaces 'prevLink' (same 'prev', same buffer but one more character).
+      if (buffer->tryAppend(prevLink->getValSize(), c)) {
+        return refAlloc->allocStrLink(
+            prevLinkPrev,
+            prevLink->getSize() - prevLink->getValSize(),
+            refValue(buffer),
+            prevLink->getValSize() + 1U);
+      }
+
+      // Otherwise start a new (bigger) buffer at the end of the chain.
+      auto* newBuffer = refAlloc->allocCharBuffer(
+          std::min(buffer->getCapacity() * 2U, charBufferMaxCapacity));
+      if (unlikely(newBuffer == nullptr)) {
+        return nullptr;
+      }
+      [[maybe_unused]] const auto appended = newBuffer->tryAppend(0U, c);
+      assert(appended);
+      return refAlloc->allocStrLink(prev, prevLink->getSize(), refValue(newBuffer), 1U);
+    }
   }
 
-  return result;
+  // Single characters are stored in the link itself.
+  return refAlloc->allocStrLink(prev, getStringOrLinkSize(prev), intValue(c), 1U);
 }
 
 // Collapse a string-link into a normal string.
 inline auto collapseStringLink(RefAllocator* refAlloc, StringLinkRef& l) noexcept -> StringRef* {
   // If we've collapsed this link before return the previous result.
-  if (l.isCollapsed()) {
-    return l.getCollapsed();
+  auto* prev = l.getPrev();
+  if (l.isCollapsedPrev(prev)) {
+    return downcastRef<StringRef>(prev);
   }
 
   // Allocate a new string big enough to the hold the entire chain.
-  auto size = getStringLinkSize(l);
+  auto size = l.getSize();
   auto str  = refAlloc->allocStr(size);
   if (unlikely(str == nullptr)) {
     return nullptr;
@@ -53,46 +94,55 @@ inline auto collapseStringLink(RefAllocator* refAlloc, StringLinkRef& l) noexcep
   auto* charDataStartPtr = str->getDataPtr();
   auto* charDataPtr      = charDataStartPtr + size;
 
-  // Utility macro for copying to the end to our string.
+  // Utility macros for copying to the end to our string.
 #define CPY_STR(STR_SRC)                                                                           \
   {                                                                                                \
     charDataPtr -= (STR_SRC)->getSize();                                                           \
     std::memcpy(charDataPtr, (STR_SRC)->getDataPtr(), (STR_SRC)->getSize());                       \
   }
+#define CPY_LINK_VAL(LINK)                                                                         \
+  {                                                                                                \
+    auto val = (LINK)->getVal();                                                                   \
+    if (!val.isRef()) {                                                                            \
+      *--charDataPtr = static_cast<uint8_t>(val.getInt());                                         \
+    } else {                                                                                       \
+      auto* valRef = val.getRef();                                                                 \
+      charDataPtr -= (LINK)->getValSize();                                                         \
+      std::memcpy(                                                                                 \
+          charDataPtr,                                                                             \
+          isStringRef(valRef) ? asStringRef(valRef)->getDataPtr()                                  \
+                              : downcastRef<CharBufferRef>(valRef)->getCharsBegin(),               \
+          (LINK)->getValSize());                                                                   \
+    }                                                                                              \
+  }
 
   // Copy our own value into the string.
-  if (l.getVal().isRef()) {
-    CPY_STR(l.getVal().getDowncastRef<StringRef>());
-  } else {
-    *--charDataPtr = static_cast<uint8_t>(l.getVal().getInt());
-  }
+  CPY_LINK_VAL(&l);
 
   // Copy the rest of the chain into the string.
-  auto* cur = l.getPrev();
+  auto* cur = prev;
   while (true) {
-    if (cur->getKind() == RefKind::String) {
-      CPY_STR(downcastRef<StringRef>(cur));
+    if (isStringRef(cur)) {
+      CPY_STR(asStringRef(cur));
       break;
     }
     auto* curLink = downcastRef<StringLinkRef>(cur);
-    if (curLink->isCollapsed()) {
-      CPY_STR(curLink->getCollapsed());
+    auto* curPrev = curLink->getPrev();
+    if (curLink->isCollapsedPrev(curPrev)) {
+      CPY_STR(downcastRef<StringRef>(curPrev));
       break;
     }
 
-    if (curLink->getVal().isRef()) {
-      CPY_STR(curLink->getVal().getDowncastRef<StringRef>());
-    } else {
-      *--charDataPtr = static_cast<uint8_t>(curLink->getVal().getInt());
-    }
-    cur = curLink->getPrev();
-    assert(cur != nullptr);
+    CPY_LINK_VAL(curLink);
+    cur = curPrev;
   }
 
-#undef CPY_LINK
+#undef CPY_STR
+#undef CPY_LINK_VAL
 
   // Set the new string as the 'collapsed' representation for that link, this caches the value for
   // future requests on the same link.
+  refAlloc->writeBarrier(&l, refValue(prev), refValue(str));
   l.setCollapsed(str);
 
   return str;
@@ -0,0 +1,254 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NOVUS_STRING_SEARCH_SIMD
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NOVUS_STRING_SEARCH_SIMD
+#endif
+
+namespace vm::internal {
+
+// Kernels for searching in strings.
+//
+// Candidates are filtered a block of characters at a time using SIMD compares (AVX2 when the vm is
+// compiled with AVX2 support, otherwise SSE2 which every x86-64 cpu supports), the remaining tail
+// of the string is handled by scalar code. On other architectures only the scalar code is used.
+//
+// Note: Strings are not required to be null-terminated (slices are not), so never read past 'size'.
+
+#if defined(__AVX2__)
+
+using SimdBlock            = __m256i;
+const auto simdBlockSize   = 32U;
+const auto simdMaskAllBits = 0xFFFF'FFFFU;
+
+inline auto simdLoad(const uint8_t* ptr) noexcept -> SimdBlock {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)); // NOLINT: Reinterpret cast
+}
+inline auto simdSplat(uint8_t c) noexcept -> SimdBlock {
+  return _mm256_set1_epi8(static_cast<char>(c));
+}
+inline auto simdEq(SimdBlock a, SimdBlock b) noexcept -> SimdBlock {
+  return _mm256_cmpeq_epi8(a, b);
+}
+inline auto simdOr(SimdBlock a, SimdBlock b) noexcept -> SimdBlock { return _mm256_or_si256(a, b); }
+inline auto simdAnd(SimdBlock a, SimdBlock b) noexcept -> SimdBlock {
+  return _mm256_and_si256(a, b);
+}
+inline auto simdZero() noexcept -> SimdBlock { return _mm256_setzero_si256(); }
+inline auto simdMask(SimdBlock a) noexcept -> uint32_t {
+  return static_cast<uint32_t>(_mm256_movemask_epi8(a));
+}
+
+#elif defined(NOVUS_STRING_SEARCH_SIMD)
+
+using SimdBlock            = __m128i;
+const auto simdBlockSize   = 16U;
+const auto simdMaskAllBits = 0xFFFFU;
+
+inline auto simdLoad(const uint8_t* ptr) noexcept -> SimdBlock {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)); // NOLINT: Reinterpret cast
+}
+inline auto simdSplat(uint8_t c) noexcept -> SimdBlock {
+  return _mm_set1_epi8(static_cast<char>(c));
+}
+inline auto simdEq(SimdBlock a, SimdBlock b) noexcept -> SimdBlock { return _mm_cmpeq_epi8(a, b); }
+inline auto simdOr(SimdBlock a, SimdBlock b) noexcept -> SimdBlock { return _mm_or_si128(a, b); }
+inline auto simdAnd(SimdBlock a, SimdBlock b) noexcept -> SimdBlock { return _mm_and_si128(a, b); }
+inline auto simdZero() noexcept -> SimdBlock { return _mm_setzero_si128(); }
+inline auto simdMask(SimdBlock a) noexcept -> uint32_t {
+  return static_cast<uint32_t>(_mm_movemask_epi8(a));
+}
+
+#endif
+
+[[nodiscard]] inline auto lowestBitIndex(uint32_t bits) noexcept -> unsigned int {
+  assert(bits != 0U);
+#if defined(__clang__) || defined(__GNUG__)
+  return static_cast<unsigned int>(__builtin_ctz(bits));
+#else
+  auto res = 0U;
+  for (; (bits & 1U) == 0U; bits >>= 1U) {
+    ++res;
+  }
+  return res;
+#endif
+}
+
+[[nodiscard]] inline auto highestBitIndex(uint32_t bits) noexcept -> unsigned int {
+  assert(bits != 0U);
+#if defined(__clang__) || defined(__GNUG__)
+  return 31U - static_cast<unsigned int>(__builtin_clz(bits));
+#else
+  auto res = 0U;
+  for (; bits != 1U; bits >>= 1U) {
+    ++res;
+  }
+  return res;
+#endif
+}
+
+// Check if 'sub' occurs in 'str' at the given candidate, the first and last characters of the
+// candidate are assumed to already match.
+[[nodiscard]] inline auto
+isSubstrCandidate(const uint8_t* str, const uint8_t* sub, unsigned int subSize) noexcept -> bool {
+  return subSize <= 2U || std::memcmp(str + 1U, sub + 1U, subSize - 2U) == 0;
+}
+
+// Index of the first occurrence of 'sub' in 'str' that starts at or after 'start', -1 if not found.
+// Note: 'sub' should not be empty.
+[[nodiscard]] inline auto searchSubstr(
+    const uint8_t* str,
+    unsigned int strSize,
+    const uint8_t* sub,
+    unsigned int subSize,
+    unsigned int start) noexcept -> int32_t {
+  assert(subSize != 0U);
+  if (subSize > strSize || start > strSize - subSize) {
+    return -1;
+  }
+  const auto end   = strSize - subSize + 1U; // Exclusive end of the candidates.
+  const auto first = sub[0];
+  const auto last  = sub[subSize - 1U];
+  auto i           = start;
+
+#if defined(NOVUS_STRING_SEARCH_SIMD)
+  // Find candidates where both the first and the last character match.
+  const auto firstBlock = simdSplat(first);
+  const auto lastBlock  = simdSplat(last);
+  for (; i + simdBlockSize <= end; i += simdBlockSize) {
+    const auto firstMatches = simdEq(firstBlock, simdLoad(str + i));
+    const auto lastMatches  = simdEq(lastBlock, simdLoad(str + i + subSize - 1U));
+    auto mask               = simdMask(simdAnd(firstMatches, lastMatches));
+    for (; mask != 0U; mask &= mask - 1U) {
+      const auto candidate = i + lowestBitIndex(mask);
+      if (isSubstrCandidate(str + candidate, sub, subSize)) {
+        return static_cast<int32_t>(candidate);
+      }
+    }
+  }
+#endif
+
+  for (; i != end; ++i) {
+    if (str[i] == first && str[i + subSize - 1U] == last &&
+        isSubstrCandidate(str + i, sub, subSize)) {
+      return static_cast<int32_t>(i);
+    }
+  }
+  return -1;
+}
+
+// Index of the last occurrence of 'sub' in 'str' that starts at or before 'start', -1 if not found.
+// Note: 'sub' should not be empty.
+[[nodiscard]] inline auto searchSubstrLast(
+    const uint8_t* str,
+    unsigned int strSize,
+    const uint8_t* sub,
+    unsigned int subSize,
+    unsigned int start) noexcept -> int32_t {
+  assert(subSize != 0U);
+  if (subSize > strSize) {
+    return -1;
+  }
+  auto end         = std::min(start, strSize - subSize) + 1U; // Exclusive end of the candidates.
+  const auto first = sub[0];
+  const auto last  = sub[subSize - 1U];
+
+#if defined(NOVUS_STRING_SEARCH_SIMD)
+  // Same as the forward search but walks the blocks (and the candidates in them) backwards.
+  const auto firstBlock = simdSplat(first);
+  const auto lastBlock  = simdSplat(last);
+  for (; end >= simdBlockSize; end -= simdBlockSize) {
+    const auto i            = end - simdBlockSize;
+    const auto firstMatches = simdEq(firstBlock, simdLoad(str + i));
+    const auto lastMatches  = simdEq(lastBlock, simdLoad(str + i + subSize - 1U));
+    auto mask               = simdMask(simdAnd(firstMatches, lastMatches));
+    while (mask != 0U) {
+      const auto bit = highestBitIndex(mask);
+      if (isSubstrCandidate(str + i + bit, sub, subSize)) {
+        return static_cast<int32_t>(i + bit);
+      }
+      mask &= ~(1U << bit);
+    }
+  }
+#endif
+
+  while (end != 0U) {
+    --end;
+    if (str[end] == first && str[end + subSize - 1U] == last &&
+        isSubstrCandidate(str + end, sub, subSize)) {
+      return static_cast<int32_t>(end);
+    }
+  }
+  return -1;
+}
+
+// Set of characters to search for.
+// Small sets are compared a block of characters at a time, larger sets use a (scalar) lookup table.
+class CharSet final {
+public:
+  static const auto maxSimdChars = 16U;
+
+  CharSet(const uint8_t* chars, unsigned int size) noexcept : m_table{}, m_size{size} {
+    for (auto i = 0U; i != size; ++i) {
+      m_table[chars[i]] = true;
+    }
+#if defined(NOVUS_STRING_SEARCH_SIMD)
+    if (size <= maxSimdChars) {
+      for (auto i = 0U; i != size; ++i) {
+        m_blocks[i] = simdSplat(chars[i]);
+      }
+    }
+#endif
+  }
+
+  [[nodiscard]] inline auto contains(uint8_t c) const noexcept -> bool {
+    return m_table[c];
+  }
+
+  // Index of the first character at or after 'start' whose membership of this set equals
+  // 'inSet', -1 if not found.
+  [[nodiscard]] inline auto search(
+      const uint8_t* str, unsigned int strSize, unsigned int start, bool inSet) const noexcept
+      -> int32_t {
+    auto i = start;
+
+#if defined(NOVUS_STRING_SEARCH_SIMD)
+    if (m_size <= maxSimdChars) {
+      for (; i + simdBlockSize <= strSize; i += simdBlockSize) {
+        const auto block = simdLoad(str + i);
+        auto matches     = simdZero();
+        for (auto j = 0U; j != m_size; ++j) {
+          matches = simdOr(matches, simdEq(block, m_blocks[j]));
+        }
+        const auto mask = inSet ? simdMask(matches) : ~simdMask(matches) & simdMaskAllBits;
+        if (mask != 0U) {
+          return static_cast<int32_t>(i + lowestBitIndex(mask));
+        }
+      }
+    }
+#endif
+
+    for (; i < strSize; ++i) {
+      if (contains(str[i]) == inSet) {
+        return static_cast<int32_t>(i);
+      }
+    }
+    return -1;
+  }
+
+private:
+  bool m_table[256]; // NOLINT: C-style array.
+  unsigned int m_size;
+#if defined(NOVUS_STRING_SEARCH_SIMD)
+  SimdBlock m_blocks[maxSimdChars]; // NOLINT: C-style array.
+#endif
+};
+
+} // namespace vm::internal
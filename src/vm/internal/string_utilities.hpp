@@ -4,15 +4,19 @@
 #include "internal/ref_allocator.hpp"
 #include "internal/ref_string.hpp"
 #include "internal/string_link_utilities.hpp"
+#include "internal/string_search.hpp"
 #include <cmath>
 #include <cstdio>
 #include <cstring>
 
 namespace vm::internal {
 
-// Get a StringRef* from a value. Supports direct StringRef's or StringLinkRefs.
+const auto stringSliceMinSize     = 64U; // Smaller slices are copied.
+const auto stringSliceParentRatio = 4U;  // Slices smaller then 1/ratio of the parent are copied.
+
+// Get a StringRef* from a value. Supports direct StringRef's, StringSliceRefs or StringLinkRefs.
 // Requires a allocator as in-case of a StringLinkRef we might need to allocate a new string.
-inline auto getStringRef(RefAllocator* refAlloc, const Value& val) noexcept {
+inline auto getStringRef(RefAllocator* refAlloc, const Value& val) noexcept -> StringRef* {
   auto* ref = val.getRef();
   if (ref->getKind() == RefKind::String) {
     auto strRef = downcastRef<StringRef>(ref);
@@ -20,6 +24,9 @@ inline auto getStringRef(RefAllocator* refAlloc, const Value& val) noexcept {
     assert(strRef->getDataPtr()[strRef->getSize()] == '\0');
     return strRef;
   }
+  if (ref->getKind() == RefKind::StringSlice) {
+    return asStringRef(ref);
+  }
 
   // If its not a string we assume its a string-link.
   assert(ref->getKind() == RefKind::StringLink);
@@ -29,6 +36,22 @@ inline auto getStringRef(RefAllocator* refAlloc, const Value& val) noexcept {
   return collapseStringLink(refAlloc, *strLinkRef);
 }
 
+// Get a null-terminated StringRef* from a value, slices are copied into a new string.
+// Use this when the characters are passed to apis that expect null-terminated strings.
+inline auto getTerminatedStringRef(RefAllocator* refAlloc, const Value& val) noexcept
+    -> StringRef* {
+  auto* strRef = getStringRef(refAlloc, val);
+  if (likely(strRef == nullptr || !strRef->isSlice())) {
+    return strRef;
+  }
+  auto* str = refAlloc->allocStr(strRef->getSize());
+  if (unlikely(str == nullptr)) {
+    return nullptr;
+  }
+  std::memcpy(str->getDataPtr(), strRef->getDataPtr(), strRef->getSize());
+  return str;
+}
+
 template <typename IntType>
 [[nodiscard]] auto inline intToString(RefAllocator* refAlloc, IntType val) noexcept -> StringRef* {
   static_assert(std::is_same<IntType, int32_t>::value || std::is_same<IntType, int64_t>::value);
@@ -167,10 +190,24 @@ template <typename IntType>
   if (start == end) {
     return refAlloc->allocStr(0);
   }
+  const auto sliceSize = static_cast<unsigned>(end - start);
+
+  // Slices of slices reference the original parent string.
+  auto* parent = target;
+  auto offset  = static_cast<unsigned>(start);
+  if (target->isSlice()) {
+    parent = static_cast<StringSliceRef*>(target)->getParent(); // NOLINT: Down-cast.
+    offset += static_cast<unsigned>(target->getDataPtr() - parent->getDataPtr());
+  }
+
+  // Large slices reference the characters of the parent instead of copying them. Small slices are
+  // copied, this way a slice can never keep a parent alive that is much bigger then itself.
+  if (sliceSize >= stringSliceMinSize && sliceSize * stringSliceParentRatio >= parent->getSize()) {
+    return refAlloc->allocPlain<StringSliceRef>(parent, offset, sliceSize);
+  }
 
   // Copy the slice into a new string.
-  const auto sliceSize = end - start;
-  const auto str       = refAlloc->allocStr(sliceSize);
+  const auto str = refAlloc->allocStr(sliceSize);
   if (str == nullptr) {
     return nullptr;
   }
@@ -179,6 +216,68 @@ template <typename IntType>
   return str;
 }
 
+// Index of the first occurrence of 'sub' at or after 'start', -1 if not found or 'sub' is empty.
+[[nodiscard]] auto inline indexOfString(StringRef* target, StringRef* sub, int32_t start) noexcept
+    -> int32_t {
+  if (sub->getSize() == 0U) {
+    return -1;
+  }
+  return searchSubstr(
+      target->getDataPtr(),
+      target->getSize(),
+      sub->getDataPtr(),
+      sub->getSize(),
+      start < 0 ? 0U : static_cast<unsigned>(start));
+}
+
+// Index of the last occurrence of 'sub' at or before 'start', -1 if not found or 'sub' is empty.
+[[nodiscard]] auto inline indexOfLastString(
+    StringRef* target, StringRef* sub, int32_t start) noexcept -> int32_t {
+  if (start < 0 || sub->getSize() == 0U) {
+    return -1;
+  }
+  return searchSubstrLast(
+      target->getDataPtr(),
+      target->getSize(),
+      sub->getDataPtr(),
+      sub->getSize(),
+      static_cast<unsigned>(start));
+}
+
+// Index of the first character at or after 'start' that is contained in 'chars', -1 if not found.
+[[nodiscard]] auto inline indexOfAnyString(
+    StringRef* target, StringRef* chars, int32_t start) noexcept -> int32_t {
+  const auto set = CharSet{chars->getDataPtr(), chars->getSize()};
+  return set.search(
+      target->getDataPtr(),
+      target->getSize(),
+      start < 0 ? 0U : static_cast<unsigned>(start),
+      true);
+}
+
+// Index of the first character at or after 'start' that is not contained in 'chars', the length
+// of the string if all characters are.
+[[nodiscard]] auto inline spanString(StringRef* target, StringRef* chars, int32_t start) noexcept
+    -> int32_t {
+  const auto set = CharSet{chars->getDataPtr(), chars->getSize()};
+  const auto res = set.search(
+      target->getDataPtr(),
+      target->getSize(),
+      start < 0 ? 0U : static_cast<unsigned>(start),
+      false);
+  return res < 0 ? static_cast<int32_t>(target->getSize()) : res;
+}
+
+// Check if 'sub' occurs in the string at the given offset.
+[[nodiscard]] auto inline startsWithString(
+    StringRef* target, StringRef* sub, int32_t offset) noexcept -> bool {
+  if (offset < 0 || static_cast<unsigned>(offset) > target->getSize() ||
+      sub->getSize() > target->getSize() - static_cast<unsigned>(offset)) {
+    return false;
+  }
+  return std::memcmp(target->getDataPtr() + offset, sub->getDataPtr(), sub->getSize()) == 0;
+}
+
 [[nodiscard]] auto inline concatString(RefAllocator* refAlloc, StringRef* a, StringRef* b) noexcept
     -> StringRef* {
 
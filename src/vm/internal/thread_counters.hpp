@@ -0,0 +1,107 @@
+#pragma once
+#include "internal/likely.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace vm::internal {
+
+// Set of counters that are cheap to increment from many threads concurrently.
+//
+// Every thread increments its own (cache-line aligned) block of counters, so incrementing is a
+// plain load and store without contention. Reading a counter sums the blocks of all threads, the
+// result is a snapshot that can lag slightly behind the increments of other threads.
+//
+// Note: Blocks are kept until the counters are destroyed, so the amount of memory is bounded by
+// the amount of threads that ever incremented the counters.
+template <unsigned int Count>
+class ThreadCounters final {
+public:
+  ThreadCounters() noexcept :
+      m_id{nextId.fetch_add(1U, std::memory_order_relaxed)}, m_head{nullptr}, m_shared{} {}
+  ThreadCounters(const ThreadCounters& rhs) = delete;
+  ThreadCounters(ThreadCounters&& rhs)      = delete;
+  ~ThreadCounters() noexcept {
+    for (auto* block = m_head.load(std::memory_order_acquire); block;) {
+      auto* next = block->next;
+      delete block;
+      block = next;
+    }
+  }
+
+  auto operator=(const ThreadCounters& rhs) -> ThreadCounters& = delete;
+  auto operator=(ThreadCounters&& rhs) -> ThreadCounters& = delete;
+
+  inline auto add(unsigned int counter, uint64_t amount) noexcept -> void {
+    auto* block = getBlock();
+    if (unlikely(block == &m_shared)) {
+      block->values[counter].fetch_add(amount, std::memory_order_relaxed);
+      return;
+    }
+    // Only this thread writes to the block, readers only need to see a consistent value.
+    auto& value = block->values[counter];
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] auto get(unsigned int counter) const noexcept -> uint64_t {
+    auto res = m_shared.values[counter].load(std::memory_order_relaxed);
+    for (auto* block = m_head.load(std::memory_order_acquire); block; block = block->next) {
+      res += block->values[counter].load(std::memory_order_relaxed);
+    }
+    return res;
+  }
+
+private:
+  struct alignas(64) Block final {
+    std::array<std::atomic<uint64_t>, Count> values;
+    std::thread::id owner;
+    Block* next;
+  };
+
+  struct ThreadCache final {
+    uint64_t countersId;
+    Block* block;
+  };
+
+  inline static std::atomic<uint64_t> nextId{1U};
+  inline static thread_local ThreadCache threadCache{0U, nullptr};
+
+  uint64_t m_id; // Unique id, identifies the counters in the cache of the threads.
+  std::atomic<Block*> m_head;
+  std::mutex m_blocksMutex;
+  Block m_shared; // Used when allocating a block for the thread fails.
+
+  inline auto getBlock() noexcept -> Block* {
+    if (likely(threadCache.countersId == m_id)) {
+      return threadCache.block;
+    }
+    // Thread last used different counters, find (or create) the block of this thread.
+    auto* block            = findOrCreateBlock();
+    threadCache.countersId = m_id;
+    threadCache.block      = block;
+    return block;
+  }
+
+  auto findOrCreateBlock() noexcept -> Block* {
+    const auto threadId = std::this_thread::get_id();
+    auto lk             = std::lock_guard<std::mutex>{m_blocksMutex};
+    for (auto* block = m_head.load(std::memory_order_relaxed); block; block = block->next) {
+      if (block->owner == threadId) {
+        return block;
+      }
+    }
+    auto* block = new (std::nothrow) Block{};
+    if (unlikely(block == nullptr)) {
+      return &m_shared;
+    }
+    block->owner = threadId;
+    block->next  = m_head.load(std::memory_order_relaxed);
+    m_head.store(block, std::memory_order_release);
+    return block;
+  }
+};
+
+} // namespace vm::internal
@@ -5,14 +5,23 @@
 
 namespace vm::internal {
 
-static const uint64_t refTag  = static_cast<uint64_t>(1U);
-static const uint64_t valMask = ~static_cast<uint64_t>(1U);
-
-// Storage for a novus 'value'. Can either store 63 bits of data or a pointer to a reference.
+static const uint64_t refTag     = static_cast<uint64_t>(1U);
+static const uint64_t refTagMask = 0xFFFF'0000'0000'0001ULL;
+static const uint64_t valMask    = ~static_cast<uint64_t>(1U);
+static const uint64_t longKey    = static_cast<uint64_t>(1U) << 63U;
+
+// Storage for a novus 'value'. Can either store 64 bits of data or a pointer to a reference.
+//
+// References are tagged by setting the least significant bit, as pointers to references are
+// aligned that bit is otherwise always zero. User-space addresses fit in 48 bits, so only values
+// with the upper 16 bits clear can be references. This leaves room to store (almost) any 64 bit
+// integer directly: longs are stored with their sign bit flipped, the only longs that would look
+// like references are odd values in the range [INT64_MIN, INT64_MIN + 2^48), those are stored as
+// 'LongRef' references instead.
 class Value final {
   friend auto uintValue(uint32_t val) noexcept -> Value;
   friend auto intValue(int32_t val) noexcept -> Value;
-  friend auto posLongValue(int64_t val) noexcept -> Value;
+  friend auto inlineLongValue(int64_t val) noexcept -> Value;
   friend auto floatValue(float val) noexcept -> Value;
   friend auto refValue(Ref* ref) noexcept -> Value;
   friend auto nullRefValue() noexcept -> Value;
@@ -30,7 +39,9 @@ class Value final {
 public:
   Value() = default;
 
-  [[nodiscard]] inline auto isRef() const noexcept -> bool { return (m_raw & refTag) != 0U; }
+  [[nodiscard]] inline auto isRef() const noexcept -> bool {
+    return (m_raw & refTagMask) == refTag;
+  }
 
   [[nodiscard]] inline auto getUInt() const noexcept -> uint32_t {
     assert(!isRef());
@@ -43,9 +54,9 @@ public:
     return reinterpret_cast<int32_t&>(upperRaw); // NOLINT: Reinterpret cast
   }
 
-  [[nodiscard]] inline auto getPosLong() const noexcept -> int64_t {
+  [[nodiscard]] inline auto getInlineLong() const noexcept -> int64_t {
     assert(!isRef());
-    return static_cast<int64_t>(m_raw >> 1U);
+    return static_cast<int64_t>(m_raw ^ longKey);
   }
 
   [[nodiscard]] inline auto getFloat() const noexcept -> float {
@@ -94,11 +105,16 @@ private:
   return Value{static_cast<uint64_t>(upperRaw) << 32U};
 }
 
-[[nodiscard]] inline auto posLongValue(int64_t val) noexcept -> Value {
-  assert(val >= 0L);
+// Can the given long be stored directly in a value (without being mistaken for a reference).
+[[nodiscard]] inline auto isInlineLong(int64_t val) noexcept -> bool {
+  return ((static_cast<uint64_t>(val) ^ longKey) & refTagMask) != refTag;
+}
+
+[[nodiscard]] inline auto inlineLongValue(int64_t val) noexcept -> Value {
+  assert(isInlineLong(val));
 
-  // Positive longs (most significant bit is always zero), can be stored in the upper 63 bits.
-  return Value{static_cast<uint64_t>(val) << 1U};
+  // Longs are stored with their sign bit flipped, see the 'Value' documentation.
+  return Value{static_cast<uint64_t>(val) ^ longKey};
 }
 
 [[nodiscard]] inline auto floatValue(float val) noexcept -> Value {
@@ -114,6 +130,7 @@ private:
   auto rawRef = reinterpret_cast<uintptr_t>(ref); // NOLINT: Reinterpret cast
 
   // Then expand to 64 bit and tag it.
+  assert((static_cast<uint64_t>(rawRef) & refTagMask) == 0U);
   return Value{static_cast<uint64_t>(rawRef) | refTag};
 }
 
@@ -0,0 +1,105 @@
+#include "vm/memory_stats.hpp"
+
+namespace vm {
+
+MemoryStats::MemoryStats() noexcept : m_counters{}, m_liveRefs{}, m_pauses{} {}
+
+auto MemoryStats::getById(int32_t id) const noexcept -> std::optional<uint64_t> {
+  if (id >= 0 && static_cast<uint32_t>(id) < counterCount) {
+    return m_counters[id];
+  }
+  if (id >= static_cast<int32_t>(liveRefsIdBase) &&
+      static_cast<uint32_t>(id) < liveRefsIdBase + refKindCount) {
+    return m_liveRefs[id - liveRefsIdBase];
+  }
+  return std::nullopt;
+}
+
+auto MemoryStats::getName(Counter counter) noexcept -> const char* {
+  switch (counter) {
+  case Counter::Collections:
+    return "collections";
+  case Counter::MajorCollections:
+    return "major-collections";
+  case Counter::PauseCount:
+    return "pause-count";
+  case Counter::PauseTotalNs:
+    return "pause-total-ns";
+  case Counter::PauseMaxNs:
+    return "pause-max-ns";
+  case Counter::Allocations:
+    return "allocations";
+  case Counter::AllocatedBytes:
+    return "allocated-bytes";
+  case Counter::LargeAllocations:
+    return "large-allocations";
+  case Counter::LargeAllocatedBytes:
+    return "large-allocated-bytes";
+  case Counter::PageCacheHits:
+    return "page-cache-hits";
+  case Counter::PageCacheMisses:
+    return "page-cache-misses";
+  case Counter::PagesMapped:
+    return "pages-mapped";
+  case Counter::PagesUnmapped:
+    return "pages-unmapped";
+  case Counter::HeapPages:
+    return "heap-pages";
+  case Counter::LiveRefs:
+    return "live-refs";
+  case Counter::FreedRefs:
+    return "freed-refs";
+  case Counter::HeapLiveBytes:
+    return "heap-live-bytes";
+  case Counter::HeapTriggerBytes:
+    return "heap-trigger-bytes";
+  }
+  return "unknown";
+}
+
+auto MemoryStats::getRefKindName(unsigned int refKind) noexcept -> const char* {
+  // Note: Order matches 'vm::internal::RefKind'.
+  static const std::array<const char*, refKindCount> names = {
+      "struct",
+      "future",
+      "string",
+      "string-link",
+      "long",
+      "stream-file",
+      "stream-console",
+      "stream-tcp",
+      "array",
+      "string-slice",
+      "char-buffer",
+  };
+  return refKind < refKindCount ? names[refKind] : "unknown";
+}
+
+auto operator<<(std::ostream& out, const MemoryStats& rhs) noexcept -> std::ostream& {
+  using Counter = MemoryStats::Counter;
+
+  out << "gc collections: " << rhs.get(Counter::Collections)
+      << ", major: " << rhs.get(Counter::MajorCollections) << '\n';
+  out << rhs.getPauses();
+  out << "allocations: " << rhs.get(Counter::Allocations)
+      << ", bytes: " << rhs.get(Counter::AllocatedBytes) << '\n';
+  out << "  large (malloc): " << rhs.get(Counter::LargeAllocations)
+      << ", bytes: " << rhs.get(Counter::LargeAllocatedBytes) << '\n';
+  out << "  page-cache hits: " << rhs.get(Counter::PageCacheHits)
+      << ", misses: " << rhs.get(Counter::PageCacheMisses) << '\n';
+  out << "heap pages: " << rhs.get(Counter::HeapPages)
+      << ", mapped: " << rhs.get(Counter::PagesMapped)
+      << ", unmapped: " << rhs.get(Counter::PagesUnmapped) << '\n';
+  out << "heap live bytes: " << rhs.get(Counter::HeapLiveBytes)
+      << ", next collection after: " << rhs.get(Counter::HeapTriggerBytes) << '\n';
+  out << "live refs: " << rhs.get(Counter::LiveRefs)
+      << ", freed: " << rhs.get(Counter::FreedRefs) << '\n';
+  for (auto kind = 0U; kind != MemoryStats::refKindCount; ++kind) {
+    if (rhs.getLiveRefs(kind) != 0U) {
+      out << "  " << MemoryStats::getRefKindName(kind) << ": " << rhs.getLiveRefs(kind) << '\n';
+    }
+  }
+  return out;
+}
+
+} // namespace vm
@@ -0,0 +1,38 @@
+#include "vm/pause_histogram.hpp"
+
+namespace vm {
+
+PauseHistogram::PauseHistogram() noexcept : m_buckets{}, m_count{0U}, m_totalNs{0U}, m_maxNs{0U} {}
+
+auto PauseHistogram::add(uint64_t durationNs) noexcept -> void {
+  const auto durationUs = durationNs / 1000U;
+  auto idx              = 0U;
+  while (idx != bucketCount - 1U && durationUs >= getBucketLimitUs(idx)) {
+    ++idx;
+  }
+  ++m_buckets[idx];
+  ++m_count;
+  m_totalNs += durationNs;
+  if (durationNs > m_maxNs) {
+    m_maxNs = durationNs;
+  }
+}
+
+auto operator<<(std::ostream& out, const PauseHistogram& rhs) noexcept -> std::ostream& {
+  out << "gc pauses: " << rhs.getCount() << ", total: " << rhs.getTotalNs() / 1000U
+      << "us, max: " << rhs.getMaxNs() / 1000U << "us\n";
+  for (auto i = 0U; i != PauseHistogram::bucketCount; ++i) {
+    if (rhs.getBucket(i) == 0U) {
+      continue;
+    }
+    if (i == PauseHistogram::bucketCount - 1U) {
+      out << "  >= " << PauseHistogram::getBucketLimitUs(i - 1U);
+    } else {
+      out << "  < " << PauseHistogram::getBucketLimitUs(i);
+    }
+    out << "us: " << rhs.getBucket(i) << '\n';
+  }
+  return out;
+}
+
+} // namespace vm
@@ -0,0 +1,56 @@
+#include "vm/profile.hpp"
+#include <algorithm>
+
+namespace vm {
+
+Profile::Profile() noexcept : m_sampleCount{0U} {}
+
+auto Profile::addSample(const Stack& stack) noexcept -> void {
+  ++m_samples[stack];
+  ++m_sampleCount;
+}
+
+auto Profile::addFunction(uint32_t entryIpOffset) noexcept -> void {
+  auto itr = std::lower_bound(m_functions.begin(), m_functions.end(), entryIpOffset);
+  if (itr == m_functions.end() || *itr != entryIpOffset) {
+    m_functions.insert(itr, entryIpOffset);
+  }
+}
+
+auto Profile::getFunction(uint32_t ipOffset) const noexcept -> uint32_t {
+  auto itr = std::upper_bound(m_functions.begin(), m_functions.end(), ipOffset);
+  return itr == m_functions.begin() ? 0U : *(itr - 1);
+}
+
+auto Profile::writeCollapsed(std::ostream& out, const FunctionLabels& labels) const noexcept
+    -> void {
+
+  // Samples are recorded per instruction, merge the stacks that are in the same functions.
+  auto functionSamples = std::map<std::string, uint64_t>{};
+  for (const auto& [stack, count] : m_samples) {
+    auto line = std::string{};
+    for (auto itr = stack.rbegin(); itr != stack.rend(); ++itr) {
+      if (!line.empty()) {
+        line += ';';
+      }
+      if (*itr == truncatedFrame) {
+        line += "[truncated]";
+        continue;
+      }
+      const auto func     = getFunction(*itr);
+      const auto labelItr = labels.find(func);
+      if (labelItr != labels.end() && !labelItr->second.empty()) {
+        line += labelItr->second.front();
+      } else {
+        line += "func@" + std::to_string(func);
+      }
+    }
+    functionSamples[line] += count;
+  }
+
+  for (const auto& [line, count] : functionSamples) {
+    out << line << ' ' << count << '\n';
+  }
+}
+
+} // namespace vm
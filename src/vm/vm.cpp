@@ -1,10 +1,19 @@
 #include "vm/vm.hpp"
+#include "internal/decoded_assembly.hpp"
 #include "internal/executor.hpp"
+#include "internal/executor_pool.hpp"
 #include "internal/executor_registry.hpp"
+#include "internal/heap_profiler.hpp"
+#include "internal/jit.hpp"
+#include "internal/profiler.hpp"
+#include "internal/reactor.hpp"
 #include "internal/ref_allocator.hpp"
 #include "internal/os_include.hpp"
 #include "vm/platform_interface.hpp"
+#include <algorithm>
 #include <csignal>
+#include <limits>
+#include <optional>
 
 namespace vm {
 
@@ -44,36 +53,103 @@ static auto teardown(const internal::Settings* /*unused*/) { }
 
 #endif // !_WIN32
 
-auto run(const novasm::Assembly* assembly, PlatformInterface* iface) noexcept -> ExecState {
+auto run(
+    const novasm::Assembly* assembly,
+    PlatformInterface* iface,
+    const Settings& settings) noexcept -> ExecState {
 
-  auto settings           = internal::Settings{};
-  settings.socketsEnabled = true;
+  auto execSettings           = internal::Settings{};
+  execSettings.socketsEnabled = true;
+  execSettings.stackLimit     = static_cast<unsigned int>(std::min<size_t>(
+      settings.stackLimit / sizeof(internal::Value), std::numeric_limits<unsigned int>::max()));
 
-  setup(&settings);
+  setup(&execSettings);
+  internal::ExecutorPool::get().setTargetCount(settings.threadPoolSize);
 
   auto execRegistry = internal::ExecutorRegistry{};
-  auto memAlloc     = internal::MemoryAllocator{};
+  auto memAlloc     = internal::MemoryAllocator{settings.heapCachePages};
   auto refAlloc     = internal::RefAllocator{&memAlloc};
-  auto gc           = internal::GarbageCollector{&refAlloc, &execRegistry};
+
+  // Decode the assembly into the format that the executors run.
+  // Note: Declared after the allocator as the instructions point to immortal refs it owns.
+  auto decodedAssembly = internal::DecodedAssembly{assembly, &refAlloc};
+
+  // Optionally sample the call-stacks of the executors while the program runs.
+  // Note: Created before jit compiling as it inspects the decoded instructions.
+  auto profiler = std::optional<internal::Profiler>{};
+  if (settings.profile) {
+    profiler.emplace(
+        &execRegistry, &decodedAssembly, std::chrono::microseconds{settings.profileIntervalUs});
+    execSettings.profiler = &*profiler;
+  }
+
+  // Optionally sample the allocations of the program.
+  auto heapProfiler = std::optional<internal::HeapProfiler>{};
+  if (settings.heapProfile) {
+    heapProfiler.emplace(
+        &decodedAssembly, settings.heapProfileRate, settings.heapProfileSnapshot);
+    refAlloc.setHeapProfiler(&*heapProfiler);
+  }
+
+  // Optionally compile parts of the assembly to native code.
+  // Note: Declared after the assembly so the native code is released before the instructions.
+  auto jitCode = internal::JitCode{};
+  if (settings.jitEnabled) {
+    jitCode.compile(&decodedAssembly);
+  }
+
+  auto gcSettings         = internal::GcSettings{};
+  gcSettings.heapGrowth   = settings.gcHeapGrowth;
+  gcSettings.minHeap      = settings.gcMinHeap;
+  gcSettings.heapLimit    = settings.gcHeapLimit;
+  gcSettings.idleInterval = std::chrono::milliseconds{settings.gcIdleIntervalMs};
+  gcSettings.workers      = settings.gcWorkers;
+
+  auto gc         = internal::GarbageCollector{&refAlloc, &execRegistry, gcSettings};
+  execSettings.gc = &gc;
+
+  if (profiler) {
+    profiler->start();
+  }
+  if (heapProfiler) {
+    heapProfiler->start();
+  }
 
   auto resultState = execute(
-      settings,
-      assembly,
+      execSettings,
+      &decodedAssembly,
       iface,
       &execRegistry,
       &refAlloc,
-      assembly->getEntrypoint(),
-      0,
-      nullptr,
+      decodedAssembly.getEntrypoint(),
       nullptr);
 
-  // Abort all executors that are still running.
+  // Abort all executors that are still running and drop the forks that did not start yet (and the
+  // executors that are waiting for sockets).
   execRegistry.abortExecutors();
+  internal::Reactor::get().cancel(&execRegistry);
+  internal::ExecutorPool::get().cancel(&execRegistry);
+
+  if (profiler) {
+    profiler->stop();
+    *settings.profile = profiler->takeProfile();
+  }
 
   // Terminate the garbage-collector (finishes any ongoing collections).
   gc.terminateCollector();
+  if (settings.gcPauses) {
+    *settings.gcPauses = gc.getPauses();
+  }
+  if (settings.memStats) {
+    gc.getStats(settings.memStats);
+    settings.memStats->setPauses(gc.getPauses());
+  }
+  if (heapProfiler) {
+    heapProfiler->stop();
+    *settings.heapProfile = heapProfiler->takeProfile();
+  }
 
-  teardown(&settings);
+  teardown(&execSettings);
 
   return resultState;
 }
@@ -0,0 +1,158 @@
+#include "catch2/catch.hpp"
+#include "helpers.hpp"
+
+namespace backend {
+
+// Expected assembly for the equality function of 'array{int}'.
+static auto buildIntArrayEq(novasm::Assembler* asmb) -> void {
+  asmb->label("__array_intEq");
+  asmb->addStackAlloc(1);
+
+  // Check if the lengths are the same.
+  asmb->addStackLoad(0);
+  asmb->addLengthArray();
+  asmb->addStackLoad(1);
+  asmb->addLengthArray();
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("length equal");
+  asmb->addLoadLitInt(0);
+  asmb->addRet();
+
+  asmb->label("length equal");
+  asmb->addLoadLitInt(0);
+  asmb->addStackStore(2);
+
+  // Loop over all the elements.
+  asmb->label("eq loop");
+  asmb->addStackLoad(2);
+  asmb->addStackLoad(0);
+  asmb->addLengthArray();
+  asmb->addCheckLeInt();
+  asmb->addJumpIf("eq body");
+  asmb->addLoadLitInt(1);
+  asmb->addRet();
+
+  asmb->label("eq body");
+  asmb->addStackLoad(0);
+  asmb->addStackLoad(2);
+  asmb->addIndexArray();
+  asmb->addStackLoad(1);
+  asmb->addStackLoad(2);
+  asmb->addIndexArray();
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("element equal");
+  asmb->addLoadLitInt(0);
+  asmb->addRet();
+
+  asmb->label("element equal");
+  asmb->addStackLoad(2);
+  asmb->addLoadLitInt(1);
+  asmb->addAddInt();
+  asmb->addStackStore(2);
+  asmb->addJump("eq loop");
+}
+
+// Expected assembly for the generator helper that is included when a program uses arrays.
+static auto buildArrayGenerate(novasm::Assembler* asmb) -> void {
+  asmb->label("array_generate");
+  asmb->addStackAlloc(2);
+  asmb->addStackLoad(0);
+  asmb->addAllocArray();
+  asmb->addStackStore(2);
+  asmb->addLoadLitInt(0);
+  asmb->addStackStore(3);
+
+  asmb->label("generate loop");
+  asmb->addStackLoad(3);
+  asmb->addStackLoad(2);
+  asmb->addLengthArray();
+  asmb->addCheckLeInt();
+  asmb->addJumpIf("generate body");
+  asmb->addStackLoad(2);
+  asmb->addRet();
+
+  asmb->label("generate body");
+  asmb->addStackLoad(2);
+  asmb->addStackLoad(3);
+  asmb->addStackLoad(3);
+  asmb->addStackLoad(1);
+  asmb->addCallDyn(1, novasm::CallMode::Normal);
+  asmb->addArrayStore();
+  asmb->addStackLoad(3);
+  asmb->addLoadLitInt(1);
+  asmb->addAddInt();
+  asmb->addStackStore(3);
+  asmb->addJump("generate loop");
+}
+
+TEST_CASE("Generate assembly for arrays", "[backend]") {
+
+  SECTION("Make array") {
+    CHECK_PROG("fun f() -> array{int} array{int}(1, 2)", [](novasm::Assembler* asmb) -> void {
+      buildIntArrayEq(asmb);
+      buildArrayGenerate(asmb);
+
+      asmb->label("f");
+      asmb->addLoadLitInt(1);
+      asmb->addLoadLitInt(2);
+      asmb->addLoadLitInt(2);
+      asmb->addMakeArray();
+      asmb->addRet();
+
+      asmb->label("entry");
+      asmb->addRet();
+
+      asmb->setEntrypoint("entry");
+    });
+  }
+
+  SECTION("Index and slice array") {
+    CHECK_PROG(
+        "fun f(array{int} a) -> int a[1] "
+        "fun g(array{int} a) -> array{int} a[1, 2]",
+        [](novasm::Assembler* asmb) -> void {
+          buildIntArrayEq(asmb);
+          buildArrayGenerate(asmb);
+
+          asmb->label("f");
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addIndexArray();
+          asmb->addRet();
+
+          asmb->label("g");
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addLoadLitInt(2);
+          asmb->addSliceArray();
+          asmb->addRet();
+
+          asmb->label("entry");
+          asmb->addRet();
+
+          asmb->setEntrypoint("entry");
+        });
+  }
+
+  SECTION("Generate array") {
+    CHECK_PROG(
+        "fun f(function{int, int} g) -> array{int} array{int}(3, g)",
+        [](novasm::Assembler* asmb) -> void {
+          buildIntArrayEq(asmb);
+          buildArrayGenerate(asmb);
+
+          asmb->label("f");
+          asmb->addLoadLitInt(3);
+          asmb->addStackLoad(0);
+          asmb->addCall("array_generate", 2, novasm::CallMode::Tail);
+          asmb->addRet();
+
+          asmb->label("entry");
+          asmb->addRet();
+
+          asmb->setEntrypoint("entry");
+        });
+  }
+}
+
+} // namespace backend
@@ -508,9 +508,7 @@ TEST_CASE("Generate assembly for call expressions", "[backend]") {
         "assert(test(42, 1337), \"test\")",
         [](novasm::Assembler* asmb) -> void {
           asmb->label("test");
-          asmb->addStackLoad(0);
-          asmb->addStackLoad(1);
-          asmb->addCheckEqInt();
+          asmb->addStackCheckEqInt(0, 1);
           asmb->addRet();
 
           asmb->label("prog");
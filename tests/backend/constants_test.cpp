@@ -35,9 +35,35 @@ TEST_CASE("Generate assembly for storing and loading constants", "[backend]") {
     asmb->addLoadLitInt(1337);
     asmb->addStackStore(1);
 
-    asmb->addStackLoad(0);
-    asmb->addStackLoad(1);
-    asmb->addAddInt();
+    asmb->addStackAddInt(0, 1);
+  });
+
+  CHECK_EXPR("x = 42; y = 1337; z = x - y; z", [](novasm::Assembler* asmb) -> void {
+    asmb->addStackAlloc(3);
+
+    asmb->addLoadLitInt(42);
+    asmb->addStackStore(0);
+
+    asmb->addLoadLitInt(1337);
+    asmb->addStackStore(1);
+
+    asmb->addStackSubInt(0, 1);
+    asmb->addStackStore(2);
+
+    asmb->addStackLoad(2);
+  });
+
+  CHECK_EXPR("x = 1.0; y = 2.0; x <= y", [](novasm::Assembler* asmb) -> void {
+    asmb->addStackAlloc(2);
+
+    asmb->addLoadLitFloat(1.0F);
+    asmb->addStackStore(0);
+
+    asmb->addLoadLitFloat(2.0F);
+    asmb->addStackStore(1);
+
+    asmb->addStackCheckGtFloat(0, 1);
+    asmb->addLogicInvInt();
   });
 
   CHECK_EXPR("x = y = 42; y", [](novasm::Assembler* asmb) -> void {
@@ -0,0 +1,142 @@
+#include "catch2/catch.hpp"
+#include "helpers.hpp"
+#include "novasm/assembler.hpp"
+#include "novasm/debug_info.hpp"
+#include <algorithm>
+
+namespace novasm {
+
+TEST_CASE("Assembly debug information", "[novasm]") {
+
+  SECTION("Assemblies without recorded debug information have none") {
+    auto asmb = Assembler{};
+    asmb.label("entry");
+    asmb.addLoadLitInt(42);
+    asmb.addRet();
+    asmb.setEntrypoint("entry");
+    const auto assembly = asmb.close();
+    CHECK(assembly.getDebugInfo() == nullptr);
+  }
+
+  SECTION("Spans are recorded when they change") {
+    auto asmb        = Assembler{};
+    const auto file  = asmb.addSourceFile("test.nov");
+    const auto spanA = SourceSpan{file, 1U, 1U, 1U, 5U};
+    const auto spanB = SourceSpan{file, 2U, 3U, 4U, 1U};
+
+    asmb.label("entry");
+    asmb.setSourceSpan(spanA);
+    asmb.addLoadLitInt(1000); // Offset 0, 5 bytes.
+    asmb.addDup();            // Offset 5, 1 byte.
+    asmb.setSourceSpan(spanB);
+    asmb.addAddInt(); // Offset 6, 1 byte.
+    asmb.setSourceSpan(std::nullopt);
+    asmb.addRet(); // Offset 7.
+    asmb.setEntrypoint("entry");
+    const auto assembly = asmb.close();
+
+    const auto* debugInfo = assembly.getDebugInfo();
+    REQUIRE(debugInfo != nullptr);
+    CHECK(debugInfo->getFiles() == std::vector<std::string>{"test.nov"});
+    CHECK(
+        debugInfo->getSpans() ==
+        std::vector<DebugInfo::SpanEntry>{{0U, spanA}, {6U, spanB}, {7U, std::nullopt}});
+
+    CHECK(debugInfo->findSpan(0U) == spanA);
+    CHECK(debugInfo->findSpan(5U) == spanA);
+    CHECK(debugInfo->findSpan(6U) == spanB);
+    CHECK(debugInfo->findSpan(7U) == std::nullopt);
+  }
+
+  SECTION("Spans of replaced instructions are dropped") {
+    auto asmb        = Assembler{};
+    const auto file  = asmb.addSourceFile("test.nov");
+    const auto spanA = SourceSpan{file, 1U, 1U, 1U, 5U};
+    const auto spanB = SourceSpan{file, 2U, 1U, 2U, 5U};
+
+    asmb.label("entry");
+    asmb.setSourceSpan(spanA);
+    asmb.addLoadLitInt(1); // Offset 0.
+    asmb.setSourceSpan(spanB);
+    asmb.addLoadLitInt(1); // Offset 1.
+    asmb.setSourceSpan(spanA);
+    asmb.addAddInt(); // Replaces the literal at offset 1 with a fused 'AddIntLit'.
+    asmb.addRet();
+    asmb.setEntrypoint("entry");
+    const auto assembly = asmb.close();
+
+    const auto* debugInfo = assembly.getDebugInfo();
+    REQUIRE(debugInfo != nullptr);
+    CHECK(debugInfo->getSpans() == std::vector<DebugInfo::SpanEntry>{{0U, spanA}});
+  }
+
+  SECTION("Function boundaries are recorded") {
+    auto asmb = Assembler{};
+    asmb.label("entry");
+    asmb.beginFunction("main");
+    asmb.addCall("func", 0, CallMode::Normal);
+    asmb.addRet();
+    asmb.endFunction();
+    asmb.label("func");
+    asmb.beginFunction("func");
+    asmb.addLoadLitInt(1);
+    asmb.addRet();
+    asmb.endFunction();
+    asmb.setEntrypoint("entry");
+    const auto assembly = asmb.close();
+
+    const auto* debugInfo = assembly.getDebugInfo();
+    REQUIRE(debugInfo != nullptr);
+    REQUIRE(debugInfo->getFunctions().size() == 2U);
+
+    const auto& main = debugInfo->getFunctions()[0];
+    const auto& func = debugInfo->getFunctions()[1];
+    CHECK(main.name == "main");
+    CHECK(main.ipBegin == 0U);
+    CHECK(func.name == "func");
+    CHECK(func.ipBegin == main.ipEnd);
+    CHECK(func.ipEnd == assembly.getInstructions().size());
+
+    CHECK(debugInfo->findFunction(0U) == &main);
+    CHECK(debugInfo->findFunction(func.ipBegin) == &func);
+    CHECK(debugInfo->findFunction(func.ipEnd) == nullptr);
+  }
+
+  SECTION("Generated assemblies map instructions to the source") {
+    const auto assembly = GEN_ASM("fun square(int x) x * x\n"
+                                  "\n"
+                                  "act main() square(42)\n"
+                                  "main()");
+    const auto* debugInfo = assembly.getDebugInfo();
+    REQUIRE(debugInfo != nullptr);
+    CHECK(debugInfo->getFiles() == std::vector<std::string>{"test"});
+
+    auto squareFunc = std::find_if(
+        debugInfo->getFunctions().begin(),
+        debugInfo->getFunctions().end(),
+        [](const DebugInfo::Function& func) { return func.name == "square(int)"; });
+    REQUIRE(squareFunc != debugInfo->getFunctions().end());
+
+    // All instructions of the function are attributed to its body: 'x * x'.
+    for (auto ip = squareFunc->ipBegin; ip != squareFunc->ipEnd; ++ip) {
+      const auto span = debugInfo->findSpan(ip);
+      REQUIRE(span);
+      CHECK(span->startLine == 1U);
+      CHECK(span->startCol >= 19U);
+      CHECK(span->endLine == 1U);
+      CHECK(span->endCol <= 23U);
+    }
+
+    auto mainFunc = std::find_if(
+        debugInfo->getFunctions().begin(),
+        debugInfo->getFunctions().end(),
+        [](const DebugInfo::Function& func) { return func.name == "main()"; });
+    REQUIRE(mainFunc != debugInfo->getFunctions().end());
+
+    const auto mainSpan = debugInfo->findSpan(mainFunc->ipBegin);
+    REQUIRE(mainSpan);
+    CHECK(mainSpan->startLine == 3U);
+  }
+}
+
+} // namespace novasm
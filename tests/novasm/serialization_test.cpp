@@ -32,6 +32,38 @@ TEST_CASE("Assembly serialization", "[novasm]") {
                                            "  strA + strB "
                                            "main(\"hello\", \"world\")"));
   }
+
+  SECTION("Debug information is only loaded when requested") {
+    const auto a = GEN_ASM("fun square(int x) x * x\n"
+                           "act main() square(42)\n"
+                           "main()");
+    REQUIRE(a.getDebugInfo() != nullptr);
+
+    auto outputString = std::string{};
+    serialize(a, std::back_inserter(outputString));
+
+    const auto withoutDebugInfo = deserialize(outputString.begin(), outputString.end());
+    REQUIRE(withoutDebugInfo);
+    CHECK(*withoutDebugInfo == a);
+    CHECK(withoutDebugInfo->getDebugInfo() == nullptr);
+
+    const auto withDebugInfo = deserialize(outputString.begin(), outputString.end(), true);
+    REQUIRE(withDebugInfo);
+    CHECK(*withDebugInfo == a);
+    REQUIRE(withDebugInfo->getDebugInfo() != nullptr);
+    CHECK(*withDebugInfo->getDebugInfo() == *a.getDebugInfo());
+  }
+
+  SECTION("Corrupt debug information fails to load") {
+    const auto a = GEN_ASM("act main() 42 main()");
+
+    auto outputString = std::string{};
+    serialize(a, std::back_inserter(outputString));
+    outputString.pop_back();
+
+    CHECK(deserialize(outputString.begin(), outputString.end()));
+    CHECK(!deserialize(outputString.begin(), outputString.end(), true));
+  }
 }
 
 } // namespace novasm
@@ -176,6 +176,19 @@ TEST_CASE("Precompute literals", "[opt]") {
     ASSERT_EXPR(precomputeLiterals, "\"hello\" == \"hello\"", litBoolNode(prog, true));
     ASSERT_EXPR(precomputeLiterals, "\"hello\" != \"world\"", litBoolNode(prog, true));
     ASSERT_EXPR(precomputeLiterals, "string()", litStringNode(prog, ""));
+    ASSERT_EXPR(
+        precomputeLiterals, "stringIndexOf(\"wasd wasd\", \"wasd\", 1)", litIntNode(prog, 5));
+    ASSERT_EXPR(precomputeLiterals, "stringIndexOf(\"wasd\", \"\", 0)", litIntNode(prog, -1));
+    ASSERT_EXPR(
+        precomputeLiterals, "stringIndexOfLast(\"wasd wasd\", \"wasd\", 4)", litIntNode(prog, 0));
+    ASSERT_EXPR(
+        precomputeLiterals, "stringIndexOfAny(\"hello world\", \"wr\", 0)", litIntNode(prog, 6));
+    ASSERT_EXPR(precomputeLiterals, "stringSpan(\"  hello\", \" \", 0)", litIntNode(prog, 2));
+    ASSERT_EXPR(precomputeLiterals, "stringSpan(\"hello\", \"ehlo\", 0)", litIntNode(prog, 5));
+    ASSERT_EXPR(
+        precomputeLiterals, "stringStartsWith(\"hello\", \"llo\", 2)", litBoolNode(prog, true));
+    ASSERT_EXPR(
+        precomputeLiterals, "stringStartsWith(\"hello\", \"llo\", 3)", litBoolNode(prog, false));
   }
 
   SECTION("identity conversions") {
@@ -0,0 +1,222 @@
+#include "catch2/catch.hpp"
+#include "helpers.hpp"
+
+namespace vm {
+
+TEST_CASE("Execute array operations", "[vm]") {
+
+  SECTION("Make array") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello");
+          asmb->addLoadLitString(" ");
+          asmb->addLoadLitString("world");
+          asmb->addLoadLitInt(3);
+          asmb->addMakeArray();
+          asmb->addLengthArray();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "3");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitInt(0);
+          asmb->addMakeArray();
+          asmb->addLengthArray();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "0");
+  }
+
+  SECTION("Index array") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(1);
+          asmb->addLoadLitString("hello");
+          asmb->addLoadLitString(" ");
+          asmb->addLoadLitString("world");
+          asmb->addLoadLitInt(3);
+          asmb->addMakeArray();
+          asmb->addStackStore(0);
+
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(2);
+          asmb->addIndexArray();
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(0);
+          asmb->addIndexArray();
+          asmb->addAddString();
+          ADD_PRINT(asmb);
+          asmb->addPop();
+        },
+        "input",
+        "worldhello");
+    CHECK_EXPR_RESULTCODE(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitInt(42);
+          asmb->addLoadLitInt(1);
+          asmb->addMakeArray();
+          asmb->addLoadLitInt(1);
+          asmb->addIndexArray();
+          asmb->addPop();
+        },
+        "input",
+        ExecState::IndexOutOfBounds);
+    CHECK_EXPR_RESULTCODE(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitInt(42);
+          asmb->addLoadLitInt(1);
+          asmb->addMakeArray();
+          asmb->addLoadLitInt(-1);
+          asmb->addIndexArray();
+          asmb->addPop();
+        },
+        "input",
+        ExecState::IndexOutOfBounds);
+  }
+
+  SECTION("Slice array") {
+    auto buildSlice = [](int32_t start, int32_t end) {
+      return [start, end](novasm::Assembler* asmb) -> void {
+        asmb->addLoadLitString("a");
+        asmb->addLoadLitString("b");
+        asmb->addLoadLitString("c");
+        asmb->addLoadLitString("d");
+        asmb->addLoadLitInt(4);
+        asmb->addMakeArray();
+        asmb->addLoadLitInt(start);
+        asmb->addLoadLitInt(end);
+        asmb->addSliceArray();
+
+        // Print the length followed by the first value.
+        asmb->addDup();
+        asmb->addLengthArray();
+        asmb->addConvIntString();
+        asmb->addSwap();
+        asmb->addLoadLitInt(0);
+        asmb->addIndexArray();
+        asmb->addAddString();
+        ADD_PRINT(asmb);
+      };
+    };
+    CHECK_EXPR(buildSlice(0, 4), "input", "4a");
+    CHECK_EXPR(buildSlice(1, 3), "input", "2b");
+    CHECK_EXPR(buildSlice(-99, 1), "input", "1a");
+    CHECK_EXPR(buildSlice(3, 99), "input", "1d");
+    CHECK_EXPR_RESULTCODE(buildSlice(2, 2), "input", ExecState::IndexOutOfBounds);
+    CHECK_EXPR_RESULTCODE(buildSlice(3, 1), "input", ExecState::IndexOutOfBounds);
+  }
+
+  SECTION("Concatenate arrays") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(1);
+          asmb->addLoadLitString("a");
+          asmb->addLoadLitString("b");
+          asmb->addLoadLitInt(2);
+          asmb->addMakeArray();
+          asmb->addLoadLitString("c");
+          asmb->addLoadLitInt(1);
+          asmb->addMakeArray();
+          asmb->addAddArray();
+          asmb->addStackStore(0);
+
+          asmb->addStackLoad(0);
+          asmb->addLengthArray();
+          asmb->addConvIntString();
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(0);
+          asmb->addIndexArray();
+          asmb->addAddString();
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(2);
+          asmb->addIndexArray();
+          asmb->addAddString();
+          ADD_PRINT(asmb);
+          asmb->addPop();
+        },
+        "input",
+        "3ac");
+  }
+
+  SECTION("Make array from list") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(1);
+
+          // List of 'a', 'b' represented as a chain of (value, next) structs.
+          asmb->addLoadLitString("a");
+          asmb->addLoadLitString("b");
+          asmb->addMakeNullStruct();
+          asmb->addMakeStruct(2);
+          asmb->addMakeStruct(2);
+          asmb->addMakeArrayList();
+          asmb->addStackStore(0);
+
+          asmb->addStackLoad(0);
+          asmb->addLengthArray();
+          asmb->addConvIntString();
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addIndexArray();
+          asmb->addAddString();
+          ADD_PRINT(asmb);
+          asmb->addPop();
+        },
+        "input",
+        "2b");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addMakeNullStruct();
+          asmb->addMakeArrayList();
+          asmb->addLengthArray();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "0");
+  }
+
+  SECTION("Store into new array") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(1);
+          asmb->addLoadLitInt(2);
+          asmb->addAllocArray();
+          asmb->addStackStore(0);
+
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addLoadLitString("world");
+          asmb->addArrayStore();
+
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(0);
+          asmb->addIndexArray();
+          asmb->addConvIntString();
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addIndexArray();
+          asmb->addAddString();
+          ADD_PRINT(asmb);
+          asmb->addPop();
+        },
+        "input",
+        "0world");
+    CHECK_EXPR_RESULTCODE(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitInt(2);
+          asmb->addAllocArray();
+          asmb->addLoadLitInt(2);
+          asmb->addLoadLitInt(42);
+          asmb->addArrayStore();
+        },
+        "input",
+        ExecState::IndexOutOfBounds);
+  }
+}
+
+} // namespace vm
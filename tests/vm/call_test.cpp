@@ -158,6 +158,63 @@ TEST_CASE("Execute calls", "[vm]") {
       },
       "input",
       "1379");
+
+  CHECK_PROG(
+      [](novasm::Assembler* asmb) -> void {
+        asmb->label("section1");
+        asmb->addLoadLitInt(100'000);
+        asmb->addCall("depth", 1, novasm::CallMode::Normal);
+        asmb->addConvIntString();
+        ADD_PRINT(asmb);
+        asmb->addRet();
+
+        // Non-tail recursion, needs more stack than fits in the initial stack segment.
+        asmb->label("depth");
+        asmb->addStackLoad(0);
+        asmb->addLoadLitInt(0);
+        asmb->addCheckEqInt();
+        asmb->addJumpIf("depth-end");
+        asmb->addLoadLitInt(1);
+        asmb->addStackLoad(0);
+        asmb->addLoadLitInt(1);
+        asmb->addSubInt();
+        asmb->addCall("depth", 1, novasm::CallMode::Normal);
+        asmb->addAddInt();
+        asmb->addRet();
+
+        asmb->label("depth-end");
+        asmb->addLoadLitInt(0);
+        asmb->addRet();
+
+        asmb->setEntrypoint("section1");
+      },
+      "input",
+      "100000");
+
+  CHECK_PROG(
+      [](novasm::Assembler* asmb) -> void {
+        asmb->label("section1");
+        asmb->addLoadLitInt(100'000);
+        asmb->addCall("section2", 0, novasm::CallMode::Normal);
+        asmb->addAddInt();
+        asmb->addConvIntString();
+        ADD_PRINT(asmb);
+        asmb->addRet();
+
+        // Single stack-frame that grows past multiple stack segments.
+        asmb->label("section2");
+        for (auto i = 0; i != 3'000; ++i) {
+          asmb->addLoadLitInt(1);
+        }
+        for (auto i = 1; i != 3'000; ++i) {
+          asmb->addAddInt();
+        }
+        asmb->addRet();
+
+        asmb->setEntrypoint("section1");
+      },
+      "input",
+      "103000");
 }
 
 } // namespace vm
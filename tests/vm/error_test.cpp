@@ -46,6 +46,35 @@ TEST_CASE("Runtime errors", "[vm]") {
         "input",
         ExecState::StackOverflow);
   }
+
+  SECTION("Invalid op-code") {
+    CHECK_ASM_RESULTCODE(
+        novasm::Assembly("", 0U, {}, {static_cast<uint8_t>(novasm::OpCode::LoadLitInt0), 1U}),
+        "input",
+        ExecState::Failed);
+  }
+
+  SECTION("Truncated instruction") {
+    CHECK_ASM_RESULTCODE(
+        novasm::Assembly("", 0U, {}, {static_cast<uint8_t>(novasm::OpCode::LoadLitInt), 42U}),
+        "input",
+        ExecState::Failed);
+  }
+
+  SECTION("Execute past the end") {
+    CHECK_ASM_RESULTCODE(
+        novasm::Assembly("", 0U, {}, {static_cast<uint8_t>(novasm::OpCode::LoadLitInt0)}),
+        "input",
+        ExecState::Failed);
+  }
+
+  SECTION("Invalid jump target") {
+    CHECK_ASM_RESULTCODE(
+        novasm::Assembly(
+            "", 0U, {}, {static_cast<uint8_t>(novasm::OpCode::Jump), 2U, 0U, 0U, 0U}),
+        "input",
+        ExecState::Failed);
+  }
 }
 
 } // namespace vm
@@ -62,6 +62,126 @@ TEST_CASE("Execute forks", "[vm]") {
         "84");
   }
 
+  SECTION("Forks can fork and wait for their own forks") {
+    CHECK_PROG(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->setEntrypoint("entry");
+          // --- Main function start.
+          asmb->label("entry");
+          asmb->addLoadLitInt(10);
+          asmb->addLoadLitInt(1);
+          asmb->addCall("tree", 2, novasm::CallMode::Forked);
+          asmb->addFutureBlock();
+
+          // Print the results.
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+          asmb->addRet();
+          // --- Main function end.
+
+          // --- Tree function start (takes a depth and a leaf value).
+          // Forks itself twice until the depth reaches zero and sums the results.
+          asmb->label("tree");
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(0);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("tree-leaf");
+
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addSubInt();
+          asmb->addStackLoad(1);
+          asmb->addCall("tree", 2, novasm::CallMode::Forked);
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addSubInt();
+          asmb->addStackLoad(1);
+          asmb->addCall("tree", 2, novasm::CallMode::Forked);
+
+          asmb->addFutureBlock();
+          asmb->addSwap();
+          asmb->addFutureBlock();
+          asmb->addAddInt();
+          asmb->addRet();
+
+          asmb->label("tree-leaf");
+          asmb->addStackLoad(1);
+          asmb->addRet();
+          // --- Tree function end.
+        },
+        "input",
+        "1024");
+  }
+
+  SECTION("Forks can wait for the same future") {
+    CHECK_PROG(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->setEntrypoint("entry");
+          // --- Main function start.
+          asmb->label("entry");
+          asmb->addLoadLitInt(8);
+          asmb->addLoadLitInt(100'000);
+          asmb->addCall("count", 1, novasm::CallMode::Forked);
+          asmb->addCall("tree", 2, novasm::CallMode::Forked);
+          asmb->addFutureBlock();
+
+          // Print the results.
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+          asmb->addRet();
+          // --- Main function end.
+
+          // --- Tree function start (takes a depth and a future).
+          // Forks itself twice until the depth reaches zero, the leaves wait for the future.
+          asmb->label("tree");
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(0);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("tree-leaf");
+
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addSubInt();
+          asmb->addStackLoad(1);
+          asmb->addCall("tree", 2, novasm::CallMode::Forked);
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addSubInt();
+          asmb->addStackLoad(1);
+          asmb->addCall("tree", 2, novasm::CallMode::Forked);
+
+          asmb->addFutureBlock();
+          asmb->addSwap();
+          asmb->addFutureBlock();
+          asmb->addAddInt();
+          asmb->addRet();
+
+          asmb->label("tree-leaf");
+          asmb->addStackLoad(1);
+          asmb->addFutureBlock();
+          asmb->addRet();
+          // --- Tree function end.
+
+          // --- Count function start (counts down to zero and returns 1).
+          asmb->label("count");
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(0);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("count-end");
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addSubInt();
+          asmb->addCall("count", 1, novasm::CallMode::Tail);
+
+          asmb->label("count-end");
+          asmb->addLoadLitInt(1);
+          asmb->addRet();
+          // --- Count function end.
+        },
+        "input",
+        "256");
+  }
+
   SECTION("Error in fork is transferred on wait") {
     CHECK_PROG_RESULTCODE(
         [](novasm::Assembler* asmb) -> void {
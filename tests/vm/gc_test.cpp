@@ -0,0 +1,650 @@
+#include "catch2/catch.hpp"
+#include "helpers.hpp"
+#include "vm/memory_stats.hpp"
+#include <string>
+
+namespace vm {
+
+// Settings that collect every time (roughly) a MiB has been allocated.
+static auto getGcTestSettings() -> std::vector<Settings> {
+  auto result = getTestSettings();
+  for (auto& settings : result) {
+    settings.gcMinHeap        = 0U;
+    settings.gcIdleIntervalMs = 0U;
+  }
+  return result;
+}
+
+// Add a 'garbage' function that allocates the given amount of structs that are garbage right away.
+// Note: The structs have a single field (with value -1), so they quickly reuse the memory of other
+// single field structs that are freed (too early).
+static auto addGarbageFunc(novasm::Assembler* asmb) -> void {
+  asmb->label("garbage");
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(0);
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("garbage-end");
+  asmb->addLoadLitInt(-1);
+  asmb->addMakeStruct(1);
+  asmb->addPop();
+  asmb->addStackLoad(0);
+  asmb->addLoadLitInt(-1);
+  asmb->addAddInt();
+  asmb->addCall("garbage", 1, novasm::CallMode::Tail);
+
+  asmb->label("garbage-end");
+  asmb->addLoadLitInt(0);
+  asmb->addRet();
+}
+
+// Add a 'make-ring' function that returns the first cell of a ring of the given amount of cells.
+// Cells are structs with two fields: a value (initially the index of the cell) and the next cell,
+// the last cell links back to the first one.
+static auto addMakeRingFunc(novasm::Assembler* asmb) -> void {
+  asmb->label("make-ring");
+  asmb->addStackAlloc(4); // First, last, index and new cell.
+  asmb->addLoadLitInt(0);
+  asmb->addMakeNullStruct();
+  asmb->addMakeStruct(2);
+  asmb->addDup();
+  asmb->addStackStore(1);
+  asmb->addStackStore(2);
+  asmb->addLoadLitInt(1);
+  asmb->addStackStore(3);
+
+  asmb->label("make-ring-cell");
+  asmb->addStackLoad(3);
+  asmb->addStackLoad(0);
+  asmb->addCheckEqInt();
+  asmb->addJumpIf("make-ring-end");
+  asmb->addStackLoad(3);
+  asmb->addMakeNullStruct();
+  asmb->addMakeStruct(2);
+  asmb->addStackStore(4);
+  asmb->addStackLoad(2);
+  asmb->addStackLoad(4);
+  asmb->addStructStoreField(1); // last.next = cell
+  asmb->addStackLoad(4);
+  asmb->addStackStore(2);
+  asmb->addStackLoad(3);
+  asmb->addLoadLitInt(1);
+  asmb->addAddInt();
+  asmb->addStackStore(3);
+  asmb->addJump("make-ring-cell");
+
+  asmb->label("make-ring-end");
+  asmb->addStackLoad(2);
+  asmb->addStackLoad(1);
+  asmb->addStructStoreField(1); // last.next = first
+  asmb->addStackLoad(1);
+  asmb->addRet();
+}
+
+// Increment the int at the given stack offset.
+static auto addIncrement(novasm::Assembler* asmb, uint8_t offset) -> void {
+  asmb->addStackLoad(offset);
+  asmb->addLoadLitInt(1);
+  asmb->addAddInt();
+  asmb->addStackStore(offset);
+}
+
+// Replace the cell at the given stack offset with the next cell of the ring.
+static auto addNextCell(novasm::Assembler* asmb, uint8_t offset) -> void {
+  asmb->addStackLoad(offset);
+  asmb->addStructLoadField(1);
+  asmb->addStackStore(offset);
+}
+
+TEST_CASE("Garbage collection", "[vm]") {
+
+  using Counter = MemoryStats::Counter;
+  auto iface    = PlatformInterface{0, nullptr, nullptr, nullptr, nullptr};
+
+  SECTION("Old refs keep the young refs they point to alive") {
+    const auto refCount      = 1'000;
+    const auto roundCount    = 8;
+    const auto garbagePerRef = 150;
+
+    /* Store new structs in a ring of cells that is old (it survived a collection) and allocate
+    garbage in between to trigger collections. The new structs are only reachable through the
+    cells, so the minor collections have to find them through the remembered-set. */
+
+    auto asmb = novasm::Assembler{};
+    asmb.label("entrypoint");
+    asmb.addStackAlloc(4); // Ring, round, cell and index.
+    asmb.addLoadLitInt(refCount);
+    asmb.addCall("make-ring", 1, novasm::CallMode::Normal);
+    asmb.addStackStore(0);
+    asmb.addLoadLitInt(roundCount);
+    asmb.addStackStore(1);
+
+    asmb.label("round");
+    asmb.addStackLoad(1);
+    asmb.addLoadLitInt(0);
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("verify");
+    asmb.addStackLoad(0);
+    asmb.addStackStore(2);
+    asmb.addLoadLitInt(0);
+    asmb.addStackStore(3);
+
+    asmb.label("store");
+    asmb.addStackLoad(3);
+    asmb.addLoadLitInt(refCount);
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("store-end");
+    asmb.addStackLoad(2);
+    asmb.addStackLoad(3);
+    asmb.addStackLoad(1);
+    asmb.addAddInt();
+    asmb.addMakeStruct(1);
+    asmb.addStructStoreField(0); // cell.value = {index + round}
+    asmb.addLoadLitInt(garbagePerRef);
+    asmb.addCall("garbage", 1, novasm::CallMode::Normal);
+    asmb.addPop();
+    addNextCell(&asmb, 2);
+    addIncrement(&asmb, 3);
+    asmb.addJump("store");
+
+    asmb.label("store-end");
+    asmb.addStackLoad(1);
+    asmb.addLoadLitInt(-1);
+    asmb.addAddInt();
+    asmb.addStackStore(1);
+    asmb.addJump("round");
+
+    // The structs of the last round (round 1) have to be intact, also after more collections.
+    asmb.label("verify");
+    asmb.addLoadLitInt(garbagePerRef * refCount);
+    asmb.addCall("garbage", 1, novasm::CallMode::Normal);
+    asmb.addPop();
+    asmb.addStackLoad(0);
+    asmb.addStackStore(2);
+    asmb.addLoadLitInt(0);
+    asmb.addStackStore(3);
+
+    asmb.label("verify-loop");
+    asmb.addStackLoad(3);
+    asmb.addLoadLitInt(refCount);
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("end");
+    asmb.addStackLoad(2);
+    asmb.addStructLoadField(0);
+    asmb.addStructLoadField(0);
+    asmb.addStackLoad(3);
+    asmb.addLoadLitInt(1);
+    asmb.addAddInt();
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("verify-next");
+    asmb.addFail();
+
+    asmb.label("verify-next");
+    addNextCell(&asmb, 2);
+    addIncrement(&asmb, 3);
+    asmb.addJump("verify-loop");
+
+    asmb.label("end");
+    asmb.addLoadLitInt(0);
+    asmb.addRet();
+
+    addGarbageFunc(&asmb);
+    addMakeRingFunc(&asmb);
+
+    asmb.setEntrypoint("entrypoint");
+    const auto assembly = asmb.close();
+
+    for (auto settings : getGcTestSettings()) {
+      INFO("jit: " << settings.jitEnabled);
+
+      auto stats        = MemoryStats{};
+      settings.memStats = &stats;
+
+      CHECK(run(&assembly, &iface, settings) == ExecState::Success);
+      CHECK(stats.get(Counter::Collections) - stats.get(Counter::MajorCollections) >= 4U);
+    }
+  }
+
+  SECTION("Parallel marking keeps deep and wide graphs alive") {
+    const auto listCount    = 100'000;
+    const auto wideCount    = 200; // Fields of the wide struct.
+    const auto wideInner    = 100; // Fields of the structs in the wide struct.
+    const auto garbageCount = 1'500'000;
+
+    /* Build a linked list of 'listCount' structs and a struct with 'wideCount' fields that each
+    hold a struct with 'wideInner' fields, allocate garbage to trigger collections and then verify
+    both graphs. The structs are numbered in order, so the wide graph holds 0 to 19999. */
+
+    auto asmb = novasm::Assembler{};
+    asmb.label("entrypoint");
+    asmb.addStackAlloc(3); // List, wide struct and index.
+
+    asmb.addMakeNullStruct();
+    asmb.addStackStore(0);
+    asmb.addLoadLitInt(listCount);
+    asmb.addStackStore(2);
+    asmb.label("list");
+    asmb.addStackLoad(2);
+    asmb.addLoadLitInt(0);
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("list-end");
+    asmb.addStackLoad(2);
+    asmb.addStackLoad(0);
+    asmb.addMakeStruct(2);
+    asmb.addStackStore(0); // list = {index, list}
+    asmb.addStackLoad(2);
+    asmb.addLoadLitInt(-1);
+    asmb.addAddInt();
+    asmb.addStackStore(2);
+    asmb.addJump("list");
+    asmb.label("list-end");
+
+    for (auto i = 0; i != wideCount; ++i) {
+      asmb.addLoadLitInt(i * wideInner);
+      asmb.addCall("make-inner", 1, novasm::CallMode::Normal);
+    }
+    asmb.addMakeStruct(wideCount);
+    asmb.addStackStore(1);
+
+    asmb.addLoadLitInt(garbageCount);
+    asmb.addCall("garbage", 1, novasm::CallMode::Normal);
+    asmb.addPop();
+
+    // The list contains the numbers 1 to 'listCount' in order.
+    asmb.addLoadLitInt(1);
+    asmb.addStackStore(2);
+    asmb.label("verify-list");
+    asmb.addStackLoad(0);
+    asmb.addCheckStructNull();
+    asmb.addJumpIf("verify-list-end");
+    asmb.addStackLoad(0);
+    asmb.addStructLoadField(0);
+    asmb.addStackLoad(2);
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("verify-list-next");
+    asmb.addFail();
+    asmb.label("verify-list-next");
+    asmb.addStackLoad(0);
+    asmb.addStructLoadField(1);
+    asmb.addStackStore(0);
+    addIncrement(&asmb, 2);
+    asmb.addJump("verify-list");
+    asmb.label("verify-list-end");
+    asmb.addStackLoad(2);
+    asmb.addLoadLitInt(listCount + 1);
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("verify-wide");
+    asmb.addFail();
+
+    asmb.label("verify-wide");
+    for (auto i = 0; i != wideCount; ++i) {
+      asmb.addStackLoad(1);
+      asmb.addStructLoadField(static_cast<uint8_t>(i));
+      asmb.addLoadLitInt(i * wideInner);
+      asmb.addCall("verify-inner", 2, novasm::CallMode::Normal);
+      asmb.addPop();
+    }
+    asmb.addLoadLitInt(0);
+    asmb.addRet();
+
+    // --- Make-inner function (takes the number of the first struct).
+    asmb.label("make-inner");
+    for (auto i = 0; i != wideInner; ++i) {
+      asmb.addStackLoad(0);
+      asmb.addLoadLitInt(i);
+      asmb.addAddInt();
+      asmb.addMakeStruct(1);
+    }
+    asmb.addMakeStruct(wideInner);
+    asmb.addRet();
+
+    // --- Verify-inner function (takes the inner struct and the number of its first struct).
+    asmb.label("verify-inner");
+    for (auto i = 0; i != wideInner; ++i) {
+      const auto next = "verify-inner-" + std::to_string(i);
+      asmb.addStackLoad(0);
+      asmb.addStructLoadField(static_cast<uint8_t>(i));
+      asmb.addStructLoadField(0);
+      asmb.addStackLoad(1);
+      asmb.addLoadLitInt(i);
+      asmb.addAddInt();
+      asmb.addCheckEqInt();
+      asmb.addJumpIf(next);
+      asmb.addFail();
+      asmb.label(next);
+    }
+    asmb.addLoadLitInt(0);
+    asmb.addRet();
+
+    addGarbageFunc(&asmb);
+
+    asmb.setEntrypoint("entrypoint");
+    const auto assembly = asmb.close();
+
+    for (auto settings : getGcTestSettings()) {
+      INFO("jit: " << settings.jitEnabled);
+
+      auto stats         = MemoryStats{};
+      settings.memStats  = &stats;
+      settings.gcWorkers = 4U;
+
+      CHECK(run(&assembly, &iface, settings) == ExecState::Success);
+      CHECK(stats.get(Counter::MajorCollections) >= 1U);
+    }
+  }
+
+  SECTION("Allocations of all size-classes survive collections") {
+    const auto strCount        = 1'101; // Strings of 0 to 1100 characters: 25 to 1125 bytes.
+    const auto structCount     = 135;   // Structs of 1 to 135 fields: 16 to 1088 bytes.
+    const auto garbagePerAlloc = 1'000;
+    const auto garbageCount    = 1'000'000;
+
+    /* Every size-class boundary (16 to 1024 bytes) is hit exactly, and the allocations of 1025
+    bytes and up are large allocations. The strings are sliced from a literal that is more than
+    four times as long as the longest slice, so that every slice is copied into a new string. */
+
+    auto literal = std::string(4'500U, ' ');
+    for (auto i = 0U; i != literal.size(); ++i) {
+      literal[i] = static_cast<char>('a' + i % 26U);
+    }
+
+    auto asmb = novasm::Assembler{};
+    asmb.label("entrypoint");
+    asmb.addStackAlloc(3); // String list, struct list and index.
+    asmb.addMakeNullStruct();
+    asmb.addStackStore(0);
+    asmb.addMakeNullStruct();
+    asmb.addStackStore(1);
+
+    asmb.addLoadLitInt(0);
+    asmb.addStackStore(2);
+    asmb.label("strings");
+    asmb.addStackLoad(2);
+    asmb.addLoadLitInt(strCount);
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("strings-end");
+    asmb.addLoadLitString(literal);
+    asmb.addLoadLitInt(0);
+    asmb.addStackLoad(2);
+    asmb.addSliceString();
+    asmb.addStackLoad(0);
+    asmb.addMakeStruct(2);
+    asmb.addStackStore(0); // strings = {literal[0:index], strings}
+    asmb.addLoadLitInt(garbagePerAlloc);
+    asmb.addCall("garbage", 1, novasm::CallMode::Normal);
+    asmb.addPop();
+    addIncrement(&asmb, 2);
+    asmb.addJump("strings");
+    asmb.label("strings-end");
+
+    // Struct with 'n' fields holds the numbers 0 to 'n - 1'.
+    for (auto n = 1; n <= structCount; ++n) {
+      for (auto i = 0; i != n; ++i) {
+        asmb.addLoadLitInt(i);
+      }
+      asmb.addMakeStruct(static_cast<uint8_t>(n));
+      asmb.addStackLoad(1);
+      asmb.addMakeStruct(2);
+      asmb.addStackStore(1); // structs = {{0, .., n - 1}, structs}
+      asmb.addLoadLitInt(garbagePerAlloc);
+      asmb.addCall("garbage", 1, novasm::CallMode::Normal);
+      asmb.addPop();
+    }
+
+    asmb.addLoadLitInt(garbageCount);
+    asmb.addCall("garbage", 1, novasm::CallMode::Normal);
+    asmb.addPop();
+
+    // The string list starts with the longest string.
+    asmb.addLoadLitInt(strCount - 1);
+    asmb.addStackStore(2);
+    asmb.label("verify-strings");
+    asmb.addStackLoad(0);
+    asmb.addCheckStructNull();
+    asmb.addJumpIf("verify-strings-end");
+    asmb.addStackLoad(0);
+    asmb.addStructLoadField(0);
+    asmb.addLoadLitString(literal);
+    asmb.addLoadLitInt(0);
+    asmb.addStackLoad(2);
+    asmb.addSliceString();
+    asmb.addCheckEqString();
+    asmb.addJumpIf("verify-strings-next");
+    asmb.addFail();
+    asmb.label("verify-strings-next");
+    asmb.addStackLoad(0);
+    asmb.addStructLoadField(1);
+    asmb.addStackStore(0);
+    asmb.addStackLoad(2);
+    asmb.addLoadLitInt(-1);
+    asmb.addAddInt();
+    asmb.addStackStore(2);
+    asmb.addJump("verify-strings");
+    asmb.label("verify-strings-end");
+    asmb.addStackLoad(2);
+    asmb.addLoadLitInt(-1);
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("verify-structs");
+    asmb.addFail();
+
+    // The struct list starts with the biggest struct, verify its first and its last field.
+    asmb.label("verify-structs");
+    for (auto n = structCount; n >= 1; --n) {
+      const auto next = "verify-structs-" + std::to_string(n);
+      asmb.addStackLoad(1);
+      asmb.addStructLoadField(0);
+      asmb.addStructLoadField(0);
+      asmb.addStackLoad(1);
+      asmb.addStructLoadField(0);
+      asmb.addStructLoadField(static_cast<uint8_t>(n - 1));
+      asmb.addAddInt();
+      asmb.addLoadLitInt(n - 1);
+      asmb.addCheckEqInt();
+      asmb.addJumpIf(next);
+      asmb.addFail();
+      asmb.label(next);
+      asmb.addStackLoad(1);
+      asmb.addStructLoadField(1);
+      asmb.addStackStore(1);
+    }
+    asmb.addLoadLitInt(0);
+    asmb.addRet();
+
+    addGarbageFunc(&asmb);
+
+    asmb.setEntrypoint("entrypoint");
+    const auto assembly = asmb.close();
+
+    for (auto settings : getGcTestSettings()) {
+      INFO("jit: " << settings.jitEnabled);
+
+      auto stats        = MemoryStats{};
+      settings.memStats = &stats;
+
+      CHECK(run(&assembly, &iface, settings) == ExecState::Success);
+      CHECK(stats.get(Counter::MajorCollections) >= 1U);
+      CHECK(stats.get(Counter::LargeAllocations) >= 109U); // 101 strings and 8 structs.
+    }
+  }
+
+  SECTION("Empty pages are released and reused") {
+    const auto smallCount = 1'000'000;
+    const auto bigCount   = 250'000;
+
+    /* Allocate only garbage, first in the smallest size-class and then in a bigger one, so all
+    pages are empty after sweeping. Pages that are kept can be reused for the other size-class. */
+
+    auto asmb = novasm::Assembler{};
+    asmb.label("entrypoint");
+    asmb.addStackAlloc(1); // Index.
+    asmb.addLoadLitInt(smallCount);
+    asmb.addCall("garbage", 1, novasm::CallMode::Normal);
+    asmb.addPop();
+
+    asmb.addLoadLitInt(bigCount);
+    asmb.addStackStore(0);
+    asmb.label("big");
+    asmb.addStackLoad(0);
+    asmb.addLoadLitInt(0);
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("end");
+    for (auto i = 0U; i != 12U; ++i) {
+      asmb.addLoadLitInt(-1);
+    }
+    asmb.addMakeStruct(12);
+    asmb.addPop();
+    asmb.addStackLoad(0);
+    asmb.addLoadLitInt(-1);
+    asmb.addAddInt();
+    asmb.addStackStore(0);
+    asmb.addJump("big");
+
+    asmb.label("end");
+    asmb.addLoadLitInt(0);
+    asmb.addRet();
+
+    addGarbageFunc(&asmb);
+
+    asmb.setEntrypoint("entrypoint");
+    const auto assembly = asmb.close();
+
+    for (auto settings : getGcTestSettings()) {
+      INFO("jit: " << settings.jitEnabled);
+
+      auto stats        = MemoryStats{};
+      settings.memStats = &stats;
+
+      // Without a cache empty pages are returned to the system.
+      settings.heapCachePages = 0U;
+      CHECK(run(&assembly, &iface, settings) == ExecState::Success);
+      CHECK(stats.get(Counter::PagesUnmapped) >= 1U);
+      CHECK(
+          stats.get(Counter::PagesMapped) - stats.get(Counter::PagesUnmapped) ==
+          stats.get(Counter::HeapPages));
+
+      // With a cache empty pages are reused instead of mapping new ones.
+      stats                   = MemoryStats{};
+      settings.heapCachePages = 1'024U;
+      CHECK(run(&assembly, &iface, settings) == ExecState::Success);
+      CHECK(stats.get(Counter::PagesUnmapped) == 0U);
+      CHECK(stats.get(Counter::PagesMapped) * 2U < stats.get(Counter::PageCacheMisses));
+      CHECK(stats.get(Counter::PagesMapped) == stats.get(Counter::HeapPages));
+    }
+  }
+
+  SECTION("Refs overwritten while marking stay alive") {
+    const auto refCount  = 60'000;
+    const auto swapCount = 1'000'000;
+    const auto swapSkip  = 7; // Cells between the swapped cells.
+
+    /* Keep swapping the values of cells in a ring while allocating garbage, so collections mark
+    the ring while it is being modified. The swapped cells are far apart, when a value moves from a
+    cell that was not marked yet to a cell that was, the collector can only find it through the
+    mark-log of the overwrite. */
+
+    auto asmb = novasm::Assembler{};
+    asmb.label("entrypoint");
+    asmb.addStackAlloc(5); // Ring, counter, cell a, cell b and tmp.
+    asmb.addLoadLitInt(refCount);
+    asmb.addCall("make-ring", 1, novasm::CallMode::Normal);
+    asmb.addStackStore(0);
+
+    // Wrap the values in structs, so the swaps move refs between the cells.
+    asmb.addStackLoad(0);
+    asmb.addStackStore(2);
+    asmb.addLoadLitInt(0);
+    asmb.addStackStore(1);
+    asmb.label("wrap");
+    asmb.addStackLoad(1);
+    asmb.addLoadLitInt(refCount);
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("wrap-end");
+    asmb.addStackLoad(2);
+    asmb.addStackLoad(2);
+    asmb.addStructLoadField(0);
+    asmb.addMakeStruct(1);
+    asmb.addStructStoreField(0); // a.value = {a.value}
+    addNextCell(&asmb, 2);
+    addIncrement(&asmb, 1);
+    asmb.addJump("wrap");
+    asmb.label("wrap-end");
+
+    asmb.addStackLoad(0);
+    asmb.addStackStore(3);
+    asmb.addLoadLitInt(0);
+    asmb.addStackStore(1);
+    asmb.label("swap");
+    asmb.addStackLoad(1);
+    asmb.addLoadLitInt(swapCount);
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("verify");
+    addNextCell(&asmb, 2);
+    for (auto i = 0; i != swapSkip; ++i) {
+      addNextCell(&asmb, 3); // b moves through the ring faster then a.
+    }
+    asmb.addStackLoad(2);
+    asmb.addStructLoadField(0);
+    asmb.addStackStore(4); // tmp = a.value
+    asmb.addStackLoad(2);
+    asmb.addStackLoad(3);
+    asmb.addStructLoadField(0);
+    asmb.addStructStoreField(0); // a.value = b.value
+    asmb.addStackLoad(3);
+    asmb.addStackLoad(4);
+    asmb.addStructStoreField(0); // b.value = tmp
+    for (auto i = 0U; i != 4U; ++i) {
+      asmb.addLoadLitInt(-1);
+      asmb.addMakeStruct(1);
+      asmb.addPop();
+    }
+    addIncrement(&asmb, 1);
+    asmb.addJump("swap");
+
+    // The ring still contains all numbers from 0 to 'refCount', so their sum is unchanged.
+    asmb.label("verify");
+    asmb.addLoadLitInt(0);
+    asmb.addStackStore(1);
+    asmb.addLoadLitInt(0);
+    asmb.addStackStore(4);
+    asmb.label("verify-loop");
+    asmb.addStackLoad(1);
+    asmb.addLoadLitInt(refCount);
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("verify-end");
+    asmb.addStackLoad(4);
+    asmb.addStackLoad(2);
+    asmb.addStructLoadField(0);
+    asmb.addStructLoadField(0);
+    asmb.addAddInt();
+    asmb.addStackStore(4);
+    addNextCell(&asmb, 2);
+    addIncrement(&asmb, 1);
+    asmb.addJump("verify-loop");
+    asmb.label("verify-end");
+    asmb.addStackLoad(4);
+    asmb.addLoadLitInt(refCount / 2 * (refCount - 1));
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("end");
+    asmb.addFail();
+
+    asmb.label("end");
+    asmb.addLoadLitInt(0);
+    asmb.addRet();
+
+    addMakeRingFunc(&asmb);
+
+    asmb.setEntrypoint("entrypoint");
+    const auto assembly = asmb.close();
+
+    for (auto settings : getGcTestSettings()) {
+      INFO("jit: " << settings.jitEnabled);
+
+      auto stats        = MemoryStats{};
+      settings.memStats = &stats;
+
+      CHECK(run(&assembly, &iface, settings) == ExecState::Success);
+      CHECK(stats.get(Counter::MajorCollections) >= 2U);
+    }
+  }
+}
+
+} // namespace vm
@@ -0,0 +1,123 @@
+#include "catch2/catch.hpp"
+#include "helpers.hpp"
+#include "vm/heap_profile.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace vm {
+
+TEST_CASE("Heap profile", "[vm]") {
+
+  SECTION("Sites accumulate allocations and frees") {
+    auto profile = HeapProfile{};
+    profile.addAlloc(12U, 0U, 2U, 64U);
+    profile.addAlloc(12U, 0U, 1U, 32U);
+    profile.addFree(12U, 0U, 1U, 32U);
+
+    CHECK(profile.getSampleCount() == 2U);
+    REQUIRE(profile.getSites().size() == 1U);
+    const auto& site = profile.getSites().at({12U, 0U});
+    CHECK(site.allocCount == 3U);
+    CHECK(site.allocBytes == 96U);
+    CHECK(site.getRetainedCount() == 2U);
+    CHECK(site.getRetainedBytes() == 64U);
+  }
+
+  SECTION("Report has a line per function ordered by allocated bytes") {
+    auto profile = HeapProfile{};
+    profile.setSampleRate(128U);
+    profile.addFunction(0U);
+    profile.addFunction(10U);
+    profile.addAlloc(3U, 0U, 1U, 100U);
+    profile.addAlloc(12U, 0U, 1U, 200U);
+    profile.addAlloc(15U, 2U, 1U, 300U);
+    profile.addFree(15U, 2U, 1U, 300U);
+    profile.addAlloc(HeapProfile::unknownSite, 2U, 1U, 50U);
+
+    auto labels = HeapProfile::FunctionLabels{{0U, {"main"}}};
+    auto str    = std::ostringstream{};
+    profile.writeReport(str, labels);
+    CHECK(
+        str.str() ==
+        "heap profile: 4 samples, 1 per 128 bytes (estimated totals)\n"
+        "     allocated      retained      allocs  function [bytes per kind]\n"
+        "           500           200           2  func@10 [struct: 200, string: 300]\n"
+        "           100           100           1  main [struct: 100]\n"
+        "            50            50           1  [runtime] [string: 50]\n");
+  }
+}
+
+TEST_CASE("Heap profile a program", "[vm]") {
+
+  const auto structCount = 10'000;
+
+  auto asmb = novasm::Assembler{};
+  asmb.label("entrypoint");
+  asmb.addLoadLitInt(structCount);
+  asmb.addCall("loop", 1, novasm::CallMode::Normal);
+  asmb.addRet();
+
+  asmb.label("loop");
+  asmb.addStackLoad(0);
+  asmb.addLoadLitInt(0);
+  asmb.addCheckEqInt();
+  asmb.addJumpIf("loop-end");
+  asmb.addLoadLitInt(1);
+  asmb.addLoadLitInt(2);
+  asmb.addMakeStruct(2);
+  asmb.addPop();
+  asmb.addStackLoad(0);
+  asmb.addLoadLitInt(-1);
+  asmb.addAddInt();
+  asmb.addCall("loop", 1, novasm::CallMode::Tail);
+
+  asmb.label("loop-end");
+  asmb.addLoadLitInt(0);
+  asmb.addRet();
+
+  asmb.setEntrypoint("entrypoint");
+  const auto labels   = asmb.getLabels();
+  const auto assembly = asmb.close();
+
+  auto loopIp = 0U;
+  for (const auto& [ipOffset, names] : labels) {
+    if (std::find(names.begin(), names.end(), "loop") != names.end()) {
+      loopIp = ipOffset;
+    }
+  }
+
+  for (auto settings : getTestSettings()) {
+    INFO("jit: " << settings.jitEnabled);
+
+    auto heapProfile         = HeapProfile{};
+    auto stats               = MemoryStats{};
+    settings.heapProfile     = &heapProfile;
+    settings.heapProfileRate = 64U;
+    settings.memStats        = &stats;
+
+    auto iface = PlatformInterface{0, nullptr, nullptr, nullptr, nullptr};
+    CHECK(run(&assembly, &iface, settings) == ExecState::Success);
+    CHECK(heapProfile.getSampleRate() == 64U);
+    CHECK(heapProfile.getSampleCount() != 0U);
+
+    // All allocations are made by the struct instruction in the loop.
+    auto allocBytes = uint64_t{0U};
+    for (const auto& [key, site] : heapProfile.getSites()) {
+      CHECK(heapProfile.getFunction(key.first) == loopIp);
+      CHECK(site.freedCount <= site.allocCount);
+      CHECK(site.freedBytes <= site.allocBytes);
+      allocBytes += site.allocBytes;
+    }
+
+    // The totals are estimates, but with this many samples they are close to the real amount.
+    const auto realBytes = stats.get(MemoryStats::Counter::AllocatedBytes);
+    CHECK(allocBytes > realBytes / 2U);
+    CHECK(allocBytes < realBytes * 2U);
+
+    auto str = std::ostringstream{};
+    heapProfile.writeReport(str, labels);
+    CHECK(str.str().find("  loop [struct: ") != std::string::npos);
+  }
+}
+
+} // namespace vm
@@ -6,6 +6,7 @@
 #include "vm/vm.hpp"
 #include <cstdio>
 #include <functional>
+#include <vector>
 
 namespace vm {
 
@@ -39,6 +40,13 @@ inline auto getString(FILE* file) -> std::string {
   return result;
 }
 
+// Every program is run both in the interpreter and with the jit compiler enabled.
+inline auto getTestSettings() -> std::vector<Settings> {
+  auto jitSettings       = Settings{};
+  jitSettings.jitEnabled = true;
+  return {Settings{}, jitSettings};
+}
+
 inline auto makeTmpFile() -> FILE* {
   gsl::owner<std::FILE*> stdInFile = std::tmpfile();
   if (stdInFile == nullptr) {
@@ -50,43 +58,49 @@ inline auto makeTmpFile() -> FILE* {
 #define CHECK_ASM(ASM, INPUT, EXPECTED)                                                            \
   {                                                                                                \
     auto assembly = ASM;                                                                           \
+    for (const auto& settings : getTestSettings()) {                                               \
+      INFO("jit: " << settings.jitEnabled);                                                        \
                                                                                                    \
-    /* Open temporary files to use as stdIn and StdOut. */                                         \
-    gsl::owner<std::FILE*> stdInFile = makeTmpFile();                                              \
-    std::string input                = INPUT;                                                      \
-    std::fwrite(input.data(), input.size(), 1, stdInFile);                                         \
-    std::fflush(stdInFile);                                                                        \
-    std::fseek(stdInFile, 0, SEEK_SET);                                                            \
+      /* Open temporary files to use as stdIn and StdOut. */                                       \
+      gsl::owner<std::FILE*> stdInFile = makeTmpFile();                                            \
+      std::string input                = INPUT;                                                    \
+      std::fwrite(input.data(), input.size(), 1, stdInFile);                                       \
+      std::fflush(stdInFile);                                                                      \
+      std::fseek(stdInFile, 0, SEEK_SET);                                                          \
                                                                                                    \
-    gsl::owner<std::FILE*> stdOutFile = makeTmpFile();                                             \
-    auto iface = PlatformInterface{0, nullptr, stdInFile, stdOutFile, nullptr};                    \
+      gsl::owner<std::FILE*> stdOutFile = makeTmpFile();                                           \
+      auto iface = PlatformInterface{0, nullptr, stdInFile, stdOutFile, nullptr};                  \
                                                                                                    \
-    CHECK(run(&assembly, &iface) == ExecState::Success);                                           \
+      CHECK(run(&assembly, &iface, settings) == ExecState::Success);                               \
                                                                                                    \
-    /* Verify that the correct stdOut output was generated. */                                     \
-    CHECK_THAT(getString(stdOutFile), Catch::Equals(EXPECTED));                                    \
+      /* Verify that the correct stdOut output was generated. */                                   \
+      CHECK_THAT(getString(stdOutFile), Catch::Equals(EXPECTED));                                  \
                                                                                                    \
-    /* Close the temporary files (they will auto destruct). */                                     \
-    std::fclose(stdInFile);                                                                        \
-    std::fclose(stdOutFile);                                                                       \
+      /* Close the temporary files (they will auto destruct). */                                   \
+      std::fclose(stdInFile);                                                                      \
+      std::fclose(stdOutFile);                                                                     \
+    }                                                                                              \
   }
 
 #define CHECK_ASM_RESULTCODE(ASM, INPUT, EXPECTED)                                                 \
   {                                                                                                \
     auto assembly = ASM;                                                                           \
+    for (const auto& settings : getTestSettings()) {                                               \
+      INFO("jit: " << settings.jitEnabled);                                                        \
                                                                                                    \
-    /* Open temporary file to use as stdIn. */                                                     \
-    gsl::owner<std::FILE*> stdInFile = makeTmpFile();                                              \
-    std::string input                = INPUT;                                                      \
-    std::fwrite(input.data(), input.size(), 1, stdInFile);                                         \
-    std::fflush(stdInFile);                                                                        \
-    std::fseek(stdInFile, 0, SEEK_SET);                                                            \
+      /* Open temporary file to use as stdIn. */                                                   \
+      gsl::owner<std::FILE*> stdInFile = makeTmpFile();                                            \
+      std::string input                = INPUT;                                                    \
+      std::fwrite(input.data(), input.size(), 1, stdInFile);                                       \
+      std::fflush(stdInFile);                                                                      \
+      std::fseek(stdInFile, 0, SEEK_SET);                                                          \
                                                                                                    \
-    auto iface = PlatformInterface{0, nullptr, stdInFile, nullptr, nullptr};                       \
-    CHECK(run(&assembly, &iface) == (EXPECTED));                                                   \
+      auto iface = PlatformInterface{0, nullptr, stdInFile, nullptr, nullptr};                     \
+      CHECK(run(&assembly, &iface, settings) == (EXPECTED));                                       \
                                                                                                    \
-    /* Close the temporary file (it will auto destruct). */                                        \
-    std::fclose(stdInFile);                                                                        \
+      /* Close the temporary file (it will auto destruct). */                                      \
+      std::fclose(stdInFile);                                                                      \
+    }                                                                                              \
   }
 
 #define CHECK_EXPR(BUILD, INPUT, EXPECTED) CHECK_ASM(buildAssemblyExpr(BUILD), INPUT, EXPECTED)
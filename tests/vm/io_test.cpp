@@ -68,6 +68,41 @@ TEST_CASE("Execute input and output", "[vm]") {
         "Hello world");
   }
 
+  SECTION("Read lines from console") {
+    CHECK_PROG(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->label("entry");
+          asmb->setEntrypoint("entry");
+          asmb->addStackAlloc(1);
+
+          // Open console stdin stream.
+          asmb->addLoadLitInt(0); // Stdin.
+          asmb->addPCall(novasm::PCallCode::ConsoleOpenStream);
+          asmb->addStackStore(0);
+
+          // Read two lines, then read until a comma and then until the end of the input.
+          asmb->addStackLoad(0);
+          asmb->addPCall(novasm::PCallCode::StreamReadLine);
+          asmb->addStackLoad(0);
+          asmb->addPCall(novasm::PCallCode::StreamReadLine);
+          asmb->addAddString();
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(',');
+          asmb->addPCall(novasm::PCallCode::StreamReadUntil);
+          asmb->addAddString();
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(',');
+          asmb->addPCall(novasm::PCallCode::StreamReadUntil);
+          asmb->addAddString();
+
+          // Print the combined string back out.
+          ADD_PRINT(asmb);
+          asmb->addRet();
+        },
+        "Hello\r\n world\n!,?",
+        "Hello world!?");
+  }
+
   SECTION("Write file") {
     const auto filePath = "test.tmp";
     CHECK_PROG(
@@ -238,6 +273,332 @@ TEST_CASE("Execute input and output", "[vm]") {
         "input",
         "Hello world");
   }
+
+  SECTION("Tcp read lines") {
+    CHECK_PROG(
+        [&](novasm::Assembler* asmb) -> void {
+          asmb->label("entry");
+          asmb->setEntrypoint("entry");
+          asmb->addStackAlloc(2);
+
+          // Start server.
+          asmb->addLoadLitInt(8082); // Port.
+          asmb->addLoadLitInt(-1);   // Backlog (-1 uses the default backlog).
+          asmb->addPCall(novasm::PCallCode::TcpStartServer);
+          asmb->addStackStore(0); // Store the server stream.
+
+          // Open connection to server and send the lines.
+          asmb->addLoadLitString("127.0.0.1"); // Address.
+          asmb->addLoadLitInt(8082);           // Port.
+          asmb->addPCall(novasm::PCallCode::TcpOpenCon);
+          asmb->addLoadLitString("Hello\r\n world\n!,?!");
+          asmb->addPCall(novasm::PCallCode::StreamWriteString);
+          asmb->addPop(); // Ignore the write result.
+
+          // Accept the connection on the server.
+          asmb->addStackLoad(0);
+          asmb->addPCall(novasm::PCallCode::TcpAcceptCon);
+          asmb->addStackStore(1); // Store the connection stream.
+
+          // Read the lines, then mix with the other reads that are served from the same buffer.
+          asmb->addStackLoad(1);
+          asmb->addPCall(novasm::PCallCode::StreamReadLine);
+          asmb->addStackLoad(1);
+          asmb->addPCall(novasm::PCallCode::StreamReadLine);
+          asmb->addAddString();
+          asmb->addStackLoad(1);
+          asmb->addLoadLitInt(',');
+          asmb->addPCall(novasm::PCallCode::StreamReadUntil);
+          asmb->addAddString();
+          asmb->addStackLoad(1);
+          asmb->addPCall(novasm::PCallCode::StreamReadChar);
+          asmb->addConvCharString();
+          asmb->addAddString();
+          asmb->addStackLoad(1);
+          asmb->addLoadLitInt(64); // Max string size.
+          asmb->addPCall(novasm::PCallCode::StreamReadString);
+          asmb->addAddString();
+
+          // Print the received message.
+          ADD_PRINT(asmb);
+          asmb->addRet();
+        },
+        "input",
+        "Hello world!?!");
+  }
+
+  SECTION("Tcp forks wait for connections and messages") {
+    CHECK_PROG(
+        [&](novasm::Assembler* asmb) -> void {
+          asmb->label("entry");
+          asmb->setEntrypoint("entry");
+          asmb->addStackAlloc(1);
+
+          // Start server.
+          asmb->addLoadLitInt(8081); // Port.
+          asmb->addLoadLitInt(-1);   // Backlog (-1 uses the default backlog).
+          asmb->addPCall(novasm::PCallCode::TcpStartServer);
+          asmb->addStackStore(0); // Store the server stream.
+
+          // Fork the receivers, they wait until the connections and messages arrive.
+          asmb->addLoadLitInt(4); // Depth.
+          asmb->addStackLoad(0);
+          asmb->addCall("receive", 2, novasm::CallMode::Forked);
+
+          // Open connections to the server and send messages.
+          asmb->addLoadLitInt(16); // Amount.
+          asmb->addCall("send", 1, novasm::CallMode::Normal);
+          asmb->addPop();
+
+          // Wait for the receivers and print the total amount of received characters.
+          asmb->addFutureBlock();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+          asmb->addRet();
+
+          // --- Receive function start (takes a depth and the server stream).
+          // Forks itself twice until the depth reaches zero, the leaves accept a connection and
+          // return the length of the message that they receive.
+          asmb->label("receive");
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(0);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("receive-leaf");
+
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addSubInt();
+          asmb->addStackLoad(1);
+          asmb->addCall("receive", 2, novasm::CallMode::Forked);
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addSubInt();
+          asmb->addStackLoad(1);
+          asmb->addCall("receive", 2, novasm::CallMode::Forked);
+
+          asmb->addFutureBlock();
+          asmb->addSwap();
+          asmb->addFutureBlock();
+          asmb->addAddInt();
+          asmb->addRet();
+
+          asmb->label("receive-leaf");
+          asmb->addStackLoad(1);
+          asmb->addPCall(novasm::PCallCode::TcpAcceptCon);
+          asmb->addLoadLitInt(5); // Length of 'Hello'.
+          asmb->addPCall(novasm::PCallCode::StreamReadString);
+          asmb->addLengthString();
+          asmb->addRet();
+          // --- Receive function end.
+
+          // --- Send function start (takes the amount of connections to open).
+          asmb->label("send");
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(0);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("send-end");
+
+          asmb->addLoadLitString("127.0.0.1"); // Address.
+          asmb->addLoadLitInt(8081);           // Port.
+          asmb->addPCall(novasm::PCallCode::TcpOpenCon);
+          asmb->addLoadLitString("Hello");
+          asmb->addPCall(novasm::PCallCode::StreamWriteString);
+          asmb->addPop(); // Ignore the write result.
+
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addSubInt();
+          asmb->addCall("send", 1, novasm::CallMode::Tail);
+
+          asmb->label("send-end");
+          asmb->addLoadLitInt(0);
+          asmb->addRet();
+          // --- Send function end.
+        },
+        "input",
+        "80");
+  }
+  SECTION("Tcp forks write to the same connection") {
+    const auto lineSize = 1'000'000U;
+
+    CHECK_PROG(
+        [&](novasm::Assembler* asmb) -> void {
+          asmb->label("entry");
+          asmb->setEntrypoint("entry");
+          asmb->addStackAlloc(3);
+
+          // Start server.
+          asmb->addLoadLitInt(8083); // Port.
+          asmb->addLoadLitInt(-1);   // Backlog (-1 uses the default backlog).
+          asmb->addPCall(novasm::PCallCode::TcpStartServer);
+          asmb->addStackStore(0); // Store the server stream.
+
+          // Open connection to server and fork the writers, the lines are too big to be sent at
+          // once so the writers have to wait for the socket in the middle of a line.
+          asmb->addLoadLitString("127.0.0.1"); // Address.
+          asmb->addLoadLitInt(8083);           // Port.
+          asmb->addPCall(novasm::PCallCode::TcpOpenCon);
+          asmb->addStackStore(1); // Store the connection stream.
+          for (auto i = 0; i != 4; ++i) {
+            asmb->addStackLoad(1);
+            asmb->addLoadLitString(std::string(lineSize, static_cast<char>('a' + i)) + "\n");
+            asmb->addCall("write", 2, novasm::CallMode::Forked);
+          }
+
+          // Give the writers time to fill the socket buffers.
+          asmb->addLoadLitLong(50'000'000); // 50 milliseconds.
+          asmb->addPCall(novasm::PCallCode::SleepNano);
+          asmb->addPop();
+
+          // Accept the connection on the server and count the lines that are received intact.
+          asmb->addStackLoad(0);
+          asmb->addPCall(novasm::PCallCode::TcpAcceptCon);
+          asmb->addStackStore(0); // Replace the server stream with the connection stream.
+          asmb->addLoadLitInt(0);
+          asmb->addStackStore(2);
+
+          asmb->label("read");
+          asmb->addStackLoad(0);
+          asmb->addPCall(novasm::PCallCode::StreamReadLine);
+          for (auto i = 0; i != 4; ++i) {
+            asmb->addDup();
+            asmb->addLoadLitString(std::string(lineSize, static_cast<char>('a' + i)));
+            asmb->addCheckEqString();
+            asmb->addJumpIf("read-intact");
+          }
+          asmb->addFail();
+          asmb->label("read-intact");
+          asmb->addPop();
+          asmb->addStackLoad(2);
+          asmb->addLoadLitInt(1);
+          asmb->addAddInt();
+          asmb->addStackStore(2);
+          asmb->addStackLoad(2);
+          asmb->addLoadLitInt(32); // 4 writers of 8 lines.
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("read-end");
+          asmb->addJump("read");
+          asmb->label("read-end");
+
+          // Wait for the writers and print the amount of received lines.
+          for (auto i = 0; i != 4; ++i) {
+            asmb->addFutureBlock();
+            asmb->addPop();
+          }
+          asmb->addStackLoad(2);
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+          asmb->addRet();
+
+          // --- Write function start (takes the connection stream and a line).
+          asmb->label("write");
+          asmb->addStackAlloc(1);
+          asmb->addLoadLitInt(8); // Lines to write.
+          asmb->addStackStore(2);
+
+          asmb->label("write-line");
+          asmb->addStackLoad(0);
+          asmb->addStackLoad(1);
+          asmb->addPCall(novasm::PCallCode::StreamWriteString);
+          asmb->addJumpIf("write-next");
+          asmb->addFail();
+          asmb->label("write-next");
+          asmb->addStackLoad(2);
+          asmb->addLoadLitInt(-1);
+          asmb->addAddInt();
+          asmb->addStackStore(2);
+          asmb->addStackLoad(2);
+          asmb->addLoadLitInt(0);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("write-end");
+          asmb->addJump("write-line");
+
+          asmb->label("write-end");
+          asmb->addLoadLitInt(0);
+          asmb->addRet();
+          // --- Write function end.
+        },
+        "input",
+        "32");
+  }
+  SECTION("Tcp forks read from the same connection") {
+    CHECK_PROG(
+        [&](novasm::Assembler* asmb) -> void {
+          asmb->label("entry");
+          asmb->setEntrypoint("entry");
+          asmb->addStackAlloc(2);
+
+          // Start server.
+          asmb->addLoadLitInt(8084); // Port.
+          asmb->addLoadLitInt(-1);   // Backlog (-1 uses the default backlog).
+          asmb->addPCall(novasm::PCallCode::TcpStartServer);
+          asmb->addStackStore(0); // Store the server stream.
+
+          // Open connection to server and send the first line.
+          asmb->addLoadLitString("127.0.0.1"); // Address.
+          asmb->addLoadLitInt(8084);           // Port.
+          asmb->addPCall(novasm::PCallCode::TcpOpenCon);
+          asmb->addStackStore(1); // Store the connection stream.
+          asmb->addStackLoad(1);
+          asmb->addLoadLitString("abc\n");
+          asmb->addPCall(novasm::PCallCode::StreamWriteString);
+          asmb->addPop(); // Ignore the write result.
+
+          // Accept the connection on the server and fork a reader that waits for a ',', it scans
+          // the first line while waiting for more data.
+          asmb->addStackLoad(0);
+          asmb->addPCall(novasm::PCallCode::TcpAcceptCon);
+          asmb->addStackStore(0); // Replace the server stream with the connection stream.
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(',');
+          asmb->addCall("read-until", 2, novasm::CallMode::Forked);
+          asmb->addLoadLitLong(20'000'000); // 20 milliseconds.
+          asmb->addPCall(novasm::PCallCode::SleepNano);
+          asmb->addPop();
+
+          // Send the rest later from a fork, then read a line. The reader is waiting for the socket
+          // so the line is only read after the reader completes.
+          asmb->addStackLoad(1);
+          asmb->addCall("send-later", 1, novasm::CallMode::Forked);
+          asmb->addStackLoad(0);
+          asmb->addPCall(novasm::PCallCode::StreamReadLine);
+
+          // Print the line and the result of the reader.
+          asmb->addSwap();
+          asmb->addFutureBlock();
+          asmb->addPop();
+          asmb->addSwap();
+          asmb->addFutureBlock();
+          asmb->addSwap();
+          asmb->addLoadLitString("|");
+          asmb->addAddString();
+          asmb->addSwap();
+          asmb->addAddString();
+          ADD_PRINT(asmb);
+          asmb->addRet();
+
+          // --- Read-until function start (takes the connection stream and the delimiter).
+          asmb->label("read-until");
+          asmb->addStackLoad(0);
+          asmb->addStackLoad(1);
+          asmb->addPCall(novasm::PCallCode::StreamReadUntil);
+          asmb->addRet();
+          // --- Read-until function end.
+
+          // --- Send-later function start (takes the connection stream).
+          asmb->label("send-later");
+          asmb->addLoadLitLong(50'000'000); // 50 milliseconds.
+          asmb->addPCall(novasm::PCallCode::SleepNano);
+          asmb->addPop();
+          asmb->addStackLoad(0);
+          asmb->addLoadLitString("def,\n,");
+          asmb->addPCall(novasm::PCallCode::StreamWriteString);
+          asmb->addRet();
+          // --- Send-later function end.
+        },
+        "input",
+        "|abc\ndef");
+  }
 }
 
 } // namespace vm
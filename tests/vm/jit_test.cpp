@@ -0,0 +1,161 @@
+#include "catch2/catch.hpp"
+#include "helpers.hpp"
+#include "vm/exec_state.hpp"
+
+namespace vm {
+
+// Note: All vm tests are also executed with the jit enabled, these cover the cases that only occur
+// in native code (loops and jumps that stay inside a compiled run).
+TEST_CASE("Execute jit compiled code", "[vm]") {
+
+  SECTION("Loop") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(2);
+          asmb->addLoadLitInt(10);
+          asmb->addStackStore(0);
+
+          asmb->label("loop");
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(0);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("end");
+
+          asmb->addStackLoad(1);
+          asmb->addStackLoad(0);
+          asmb->addAddInt();
+          asmb->addStackStore(1);
+
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(-1);
+          asmb->addAddInt();
+          asmb->addStackStore(0);
+          asmb->addJump("loop");
+
+          asmb->label("end");
+          asmb->addStackLoad(1);
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "55");
+  }
+
+  SECTION("Float loop") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(2);
+          asmb->addLoadLitFloat(1.0F);
+          asmb->addStackStore(0);
+
+          asmb->label("loop");
+          asmb->addStackLoad(0);
+          asmb->addLoadLitFloat(2.0F);
+          asmb->addMulFloat();
+          asmb->addStackStore(0);
+          asmb->addStackLoad(0);
+          asmb->addLoadLitFloat(100.0F); // NOLINT: Magic numbers
+          asmb->addCheckLeFloat();
+          asmb->addJumpIf("loop");
+
+          asmb->addStackLoad(0);
+          asmb->addConvFloatString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "128");
+  }
+
+  SECTION("Jump into the middle of a compiled run") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitInt(1);
+          asmb->addJumpIf("middle");
+          asmb->addLoadLitInt(1);
+          asmb->addLoadLitInt(2);
+          asmb->addLoadLitInt(3);
+          asmb->label("middle");
+          asmb->addLoadLitInt(4);
+          asmb->addLoadLitInt(5);
+          asmb->addAddInt();
+          asmb->addLoadLitInt(6);
+          asmb->addMulInt();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "54");
+  }
+
+  SECTION("Stack overflow in compiled code") {
+    CHECK_EXPR_RESULTCODE(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->label("push");
+          asmb->addLoadLitInt(1);
+          asmb->addLoadLitInt(2);
+          asmb->addLoadLitInt(3);
+          asmb->addJump("push");
+        },
+        "input",
+        ExecState::StackOverflow);
+    CHECK_EXPR_RESULTCODE(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->label("alloc");
+          asmb->addStackAlloc(10);
+          asmb->addLoadLitInt(1);
+          asmb->addPop();
+          asmb->addJump("alloc");
+        },
+        "input",
+        ExecState::StackOverflow);
+  }
+
+  SECTION("Loops reach safe-points") {
+    CHECK_PROG(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->label("entrypoint");
+          asmb->addCall("spin", 0, novasm::CallMode::Forked);
+          asmb->addPop();
+
+          // Allocate enough to trigger collections, they have to pause the spinning executor.
+          asmb->addLoadLitInt(200'000);
+          asmb->addCall("alloc", 1, novasm::CallMode::Normal);
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+
+          // Returning aborts the spinning executor.
+          asmb->addRet();
+
+          asmb->label("spin");
+          asmb->addLoadLitInt(1);
+          asmb->addLoadLitInt(2);
+          asmb->addAddInt();
+          asmb->addPop();
+          asmb->addJump("spin");
+
+          asmb->label("alloc");
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(0);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("alloc-end");
+          asmb->addLoadLitInt(1);
+          asmb->addLoadLitInt(2);
+          asmb->addMakeStruct(2);
+          asmb->addPop();
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(-1);
+          asmb->addAddInt();
+          asmb->addCall("alloc", 1, novasm::CallMode::Tail);
+
+          asmb->label("alloc-end");
+          asmb->addLoadLitInt(42);
+          asmb->addRet();
+
+          asmb->setEntrypoint("entrypoint");
+        },
+        "input",
+        "42");
+  }
+}
+
+} // namespace vm
@@ -77,6 +77,61 @@ TEST_CASE("Execute jump", "[vm]") {
         "input",
         "42");
   }
+
+  SECTION("Conditional Jump on equality") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitInt(42);
+          asmb->addLoadLitInt(42);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("write42");
+
+          asmb->addLoadLitString("1337");
+          ADD_PRINT(asmb);
+          asmb->addPop();
+
+          asmb->label("write42");
+          asmb->addLoadLitString("42");
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "42");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitInt(42);
+          asmb->addLoadLitInt(1337);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("write42");
+
+          asmb->addLoadLitString("1337");
+          ADD_PRINT(asmb);
+          asmb->addPop();
+
+          asmb->label("write42");
+          asmb->addLoadLitString("42");
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "133742");
+  }
+
+  SECTION("Jump to the middle of a fusable sequence") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitInt(1);
+          asmb->addLoadLitInt(41);
+          asmb->addJump("add");
+
+          asmb->addLoadLitInt(40);
+          asmb->label("add");
+          asmb->addAddInt();
+
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "42");
+  }
 }
 
 } // namespace vm
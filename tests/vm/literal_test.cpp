@@ -87,6 +87,41 @@ TEST_CASE("Execute literals", "[vm]") {
         "input",
         "hello world !");
   }
+
+  SECTION("String literals survive garbage collections") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(2);
+          asmb->addLoadLitInt(2'000'000); // NOLINT: Magic numbers
+          asmb->addStackStore(0);
+          asmb->addLoadLitString("hello");
+          asmb->addStackStore(1);
+
+          // Allocate enough strings to trigger garbage collections.
+          asmb->label("loop");
+          asmb->addLoadLitString("hello");
+          asmb->addLoadLitString(" world");
+          asmb->addAddString();
+          asmb->addPop();
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addSubInt();
+          asmb->addDup();
+          asmb->addStackStore(0);
+          asmb->addLoadLitInt(0);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("end");
+          asmb->addJump("loop");
+
+          asmb->label("end");
+          asmb->addStackLoad(1);
+          asmb->addLoadLitString(" world");
+          asmb->addAddString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "hello world");
+  }
 }
 
 } // namespace vm
@@ -151,5 +151,117 @@ TEST_CASE("Execute long operations", "[vm]") {
         "input",
         "42");
   }
+  SECTION("Negative longs") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitLong(-5);
+          asmb->addLoadLitLong(3);
+          asmb->addMulLong();
+          asmb->addLoadLitLong(1);
+          asmb->addSubLong();
+          asmb->addConvLongString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "-16");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitLong(-9223372036854775807L - 1L);
+          asmb->addConvLongString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "-9223372036854775808");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitLong(-1);
+          asmb->addLoadLitLong(-9223372036854775807L);
+          asmb->addCheckGtLong();
+          asmb->addConvBoolString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "true");
+  }
+
+  SECTION("Longs close to the minimum") {
+    // Odd longs in the range [INT64_MIN, INT64_MIN + 2^48) are stored as references.
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitLong(-9223372036854775807L);
+          asmb->addLoadLitLong(2);
+          asmb->addAddLong();
+          asmb->addConvLongString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "-9223372036854775805");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitLong(-9223090561878065153L); // INT64_MIN + 2^48 - 1.
+          asmb->addLoadLitLong(2);
+          asmb->addAddLong();
+          asmb->addConvLongString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "-9223090561878065151");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitLong(-9223372036854775807L);
+          asmb->addLoadLitLong(-9223372036854775807L);
+          asmb->addCheckEqLong();
+          asmb->addConvBoolString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "true");
+  }
+
+  SECTION("Negative longs survive garbage collections") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(3);
+          asmb->addLoadLitInt(2'000'000); // NOLINT: Magic numbers
+          asmb->addStackStore(0);
+          asmb->addLoadLitLong(0);
+          asmb->addStackStore(1);
+          asmb->addLoadLitLong(-9223372036854775807L);
+          asmb->addStackStore(2);
+
+          asmb->label("loop");
+          asmb->addStackLoad(1);
+          asmb->addLoadLitLong(3);
+          asmb->addSubLong();
+          asmb->addStackStore(1);
+          asmb->addStackLoad(2);
+          asmb->addLoadLitLong(2);
+          asmb->addAddLong();
+          asmb->addLoadLitLong(2);
+          asmb->addSubLong();
+          asmb->addStackStore(2);
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addSubInt();
+          asmb->addDup();
+          asmb->addStackStore(0);
+          asmb->addLoadLitInt(0);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("end");
+          asmb->addJump("loop");
+
+          asmb->label("end");
+          asmb->addStackLoad(1);
+          asmb->addConvLongString();
+          asmb->addLoadLitString(" ");
+          asmb->addAddString();
+          asmb->addStackLoad(2);
+          asmb->addConvLongString();
+          asmb->addAddString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "-6000000 -9223372036854775807");
+  }
 }
 } // namespace vm
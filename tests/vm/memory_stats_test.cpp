@@ -0,0 +1,214 @@
+#include "catch2/catch.hpp"
+#include "helpers.hpp"
+#include "vm/memory_stats.hpp"
+#include <sstream>
+
+namespace vm {
+
+TEST_CASE("Memory stats", "[vm]") {
+
+  SECTION("Statistics can be looked up by id") {
+    auto stats = MemoryStats{};
+    stats.set(MemoryStats::Counter::Allocations, 42U);
+    stats.set(MemoryStats::Counter::FreedRefs, 7U);
+    stats.setLiveRefs(2U, 5U);
+
+    CHECK(stats.getById(5) == 42U);
+    CHECK(stats.getById(15) == 7U);
+    CHECK(stats.getById(MemoryStats::liveRefsIdBase + 2) == 5U);
+    CHECK(stats.getById(MemoryStats::liveRefsIdBase) == 0U);
+    CHECK(!stats.getById(-1));
+    CHECK(!stats.getById(MemoryStats::counterCount));
+    CHECK(!stats.getById(MemoryStats::liveRefsIdBase + MemoryStats::refKindCount));
+  }
+
+  SECTION("Summary includes the pause histogram and the live refs per kind") {
+    auto stats  = MemoryStats{};
+    auto pauses = PauseHistogram{};
+    pauses.add(3'500);
+    stats.setPauses(pauses);
+    stats.set(MemoryStats::Counter::Collections, 1U);
+    stats.set(MemoryStats::Counter::LiveRefs, 3U);
+    stats.setLiveRefs(0U, 3U);
+
+    auto str = std::ostringstream{};
+    str << stats;
+    CHECK(str.str().find("gc collections: 1, major: 0\n") != std::string::npos);
+    CHECK(str.str().find("gc pauses: 1, total: 3us, max: 3us\n  < 4us: 1\n") != std::string::npos);
+    CHECK(str.str().find("live refs: 3, freed: 0\n  struct: 3\n") != std::string::npos);
+  }
+}
+
+TEST_CASE("Memory stats of a program", "[vm]") {
+
+  // Allocate 'structCount' structs and a single string that is too big for the heap pages.
+  const auto structCount = 10'000;
+  const auto bigStr      = std::string(600U, 'a');
+
+  auto asmb = novasm::Assembler{};
+  asmb.label("entrypoint");
+  asmb.addLoadLitString(bigStr);
+  asmb.addLoadLitString(bigStr);
+  asmb.addAddString();
+  asmb.addLoadLitInt(0);
+  asmb.addIndexString(); // Observing the string-link collapses it into a single string.
+  asmb.addPop();
+  asmb.addLoadLitInt(structCount);
+  asmb.addCall("loop", 1, novasm::CallMode::Normal);
+  asmb.addRet();
+
+  asmb.label("loop");
+  asmb.addStackLoad(0);
+  asmb.addLoadLitInt(0);
+  asmb.addCheckEqInt();
+  asmb.addJumpIf("loop-end");
+  asmb.addLoadLitInt(1);
+  asmb.addLoadLitInt(2);
+  asmb.addMakeStruct(2);
+  asmb.addPop();
+  asmb.addStackLoad(0);
+  asmb.addLoadLitInt(-1);
+  asmb.addAddInt();
+  asmb.addCall("loop", 1, novasm::CallMode::Tail);
+
+  asmb.label("loop-end");
+  asmb.addLoadLitInt(0);
+  asmb.addRet();
+
+  asmb.setEntrypoint("entrypoint");
+  const auto assembly = asmb.close();
+
+  for (auto settings : getTestSettings()) {
+    INFO("jit: " << settings.jitEnabled);
+
+    auto stats        = MemoryStats{};
+    settings.memStats = &stats;
+
+    auto iface = PlatformInterface{0, nullptr, nullptr, nullptr, nullptr};
+    CHECK(run(&assembly, &iface, settings) == ExecState::Success);
+
+    using Counter = MemoryStats::Counter;
+    CHECK(stats.get(Counter::Allocations) >= structCount + 2U);
+    CHECK(stats.get(Counter::AllocatedBytes) > stats.get(Counter::Allocations));
+    CHECK(stats.get(Counter::LargeAllocations) == 1U);
+    CHECK(stats.get(Counter::LargeAllocatedBytes) > 1200U);
+    CHECK(
+        stats.get(Counter::PageCacheHits) + stats.get(Counter::PageCacheMisses) ==
+        stats.get(Counter::Allocations) - stats.get(Counter::LargeAllocations));
+    CHECK(stats.get(Counter::PageCacheMisses) >= 1U);
+    CHECK(stats.get(Counter::PagesMapped) >= 1U);
+    CHECK(stats.get(Counter::HeapPages) >= 1U);
+    CHECK(
+        stats.get(Counter::LiveRefs) + stats.get(Counter::FreedRefs) ==
+        stats.get(Counter::Allocations));
+    CHECK(stats.getLiveRefs(0U) + stats.get(Counter::FreedRefs) >= structCount);
+    CHECK(stats.get(Counter::PauseCount) == stats.getPauses().getCount());
+  }
+}
+
+TEST_CASE("Garbage collection triggers", "[vm]") {
+
+  // Allocate 'structCount' structs that are garbage right away and then sleep for 'sleepMs'.
+  const auto makeProgram = [](int32_t structCount, int64_t sleepMs) {
+    auto asmb = novasm::Assembler{};
+    asmb.label("entrypoint");
+    asmb.addLoadLitInt(structCount);
+    asmb.addCall("loop", 1, novasm::CallMode::Normal);
+    asmb.addPop();
+    asmb.addLoadLitLong(sleepMs * 1'000'000);
+    asmb.addPCall(novasm::PCallCode::SleepNano);
+    asmb.addRet();
+
+    asmb.label("loop");
+    asmb.addStackLoad(0);
+    asmb.addLoadLitInt(0);
+    asmb.addCheckEqInt();
+    asmb.addJumpIf("loop-end");
+    asmb.addLoadLitInt(1);
+    asmb.addLoadLitInt(2);
+    asmb.addMakeStruct(2);
+    asmb.addPop();
+    asmb.addStackLoad(0);
+    asmb.addLoadLitInt(-1);
+    asmb.addAddInt();
+    asmb.addCall("loop", 1, novasm::CallMode::Tail);
+
+    asmb.label("loop-end");
+    asmb.addLoadLitInt(0);
+    asmb.addRet();
+
+    asmb.setEntrypoint("entrypoint");
+    return asmb.close();
+  };
+
+  using Counter = MemoryStats::Counter;
+  auto iface    = PlatformInterface{0, nullptr, nullptr, nullptr, nullptr};
+  auto settings = Settings{};
+  auto stats    = MemoryStats{};
+
+  settings.memStats         = &stats;
+  settings.gcIdleIntervalMs = 0U;
+
+  SECTION("Collect once the minimum heap is allocated") {
+    const auto assembly = makeProgram(1'000'000, 0);
+    settings.gcMinHeap  = 0U;
+
+    CHECK(run(&assembly, &iface, settings) == ExecState::Success);
+    CHECK(stats.get(Counter::Collections) >= 1U);
+    CHECK(stats.get(Counter::HeapTriggerBytes) >= 1024U * 1024U);
+  }
+
+  SECTION("No collections before the minimum heap is allocated") {
+    const auto assembly = makeProgram(100'000, 0);
+    settings.gcMinHeap  = 1024U * 1024U * 1024U;
+
+    CHECK(run(&assembly, &iface, settings) == ExecState::Success);
+    CHECK(stats.get(Counter::Collections) == 0U);
+    CHECK(stats.get(Counter::HeapTriggerBytes) == settings.gcMinHeap);
+  }
+
+  SECTION("Idle programs that allocated are collected") {
+    const auto assembly       = makeProgram(100'000, 250);
+    settings.gcMinHeap        = 1024U * 1024U * 1024U;
+    settings.gcIdleIntervalMs = 10U;
+
+    CHECK(run(&assembly, &iface, settings) == ExecState::Success);
+    CHECK(stats.get(Counter::MajorCollections) >= 1U);
+    CHECK(stats.get(Counter::HeapTriggerBytes) == settings.gcMinHeap);
+  }
+}
+
+TEST_CASE("Memory stats platform call", "[vm]") {
+
+  SECTION("Allocations are visible to the program") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitInt(1);
+          asmb->addLoadLitInt(2);
+          asmb->addMakeStruct(2);
+          asmb->addPop();
+          asmb->addLoadLitInt(static_cast<int32_t>(MemoryStats::Counter::Allocations));
+          asmb->addPCall(novasm::PCallCode::RuntimeMemStat);
+          asmb->addLoadLitLong(0);
+          asmb->addCheckGtLong();
+          asmb->addConvBoolString();
+          ADD_PRINT(asmb);
+        },
+        "",
+        "true");
+  }
+
+  SECTION("Unknown statistics return -1") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitInt(99);
+          asmb->addPCall(novasm::PCallCode::RuntimeMemStat);
+          asmb->addConvLongString();
+          ADD_PRINT(asmb);
+        },
+        "",
+        "-1");
+  }
+}
+
+} // namespace vm
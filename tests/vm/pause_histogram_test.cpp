@@ -0,0 +1,43 @@
+#include "catch2/catch.hpp"
+#include "vm/pause_histogram.hpp"
+#include <sstream>
+
+namespace vm {
+
+TEST_CASE("Pause histogram", "[vm]") {
+
+  SECTION("Pauses are counted in power of two microsecond buckets") {
+    auto hist = PauseHistogram{};
+    hist.add(500);       // 0.5 us.
+    hist.add(1'000);     // 1 us.
+    hist.add(3'500);     // 3.5 us.
+    hist.add(1'000'000); // 1 ms.
+
+    CHECK(hist.getCount() == 4U);
+    CHECK(hist.getTotalNs() == 1'005'000U);
+    CHECK(hist.getMaxNs() == 1'000'000U);
+    CHECK(hist.getBucket(0U) == 1U);
+    CHECK(hist.getBucket(1U) == 1U);
+    CHECK(hist.getBucket(2U) == 1U);
+    CHECK(hist.getBucket(10U) == 1U);
+  }
+
+  SECTION("Long pauses are counted in the last bucket") {
+    auto hist = PauseHistogram{};
+    hist.add(60'000'000'000); // 1 minute.
+
+    CHECK(hist.getBucket(PauseHistogram::bucketCount - 1U) == 1U);
+  }
+
+  SECTION("Only non-empty buckets are printed") {
+    auto hist = PauseHistogram{};
+    hist.add(3'500);
+    hist.add(3'900);
+
+    auto str = std::ostringstream{};
+    str << hist;
+    CHECK(str.str() == "gc pauses: 2, total: 7us, max: 3us\n  < 4us: 2\n");
+  }
+}
+
+} // namespace vm
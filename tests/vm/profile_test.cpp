@@ -0,0 +1,110 @@
+#include "catch2/catch.hpp"
+#include "helpers.hpp"
+#include "vm/profile.hpp"
+#include <sstream>
+
+namespace vm {
+
+TEST_CASE("Profile", "[vm]") {
+
+  SECTION("Instructions are attributed to the function that contains them") {
+    auto profile = Profile{};
+    profile.addFunction(10U);
+    profile.addFunction(0U);
+    profile.addFunction(30U);
+    profile.addFunction(10U);
+
+    CHECK(profile.getFunction(0U) == 0U);
+    CHECK(profile.getFunction(9U) == 0U);
+    CHECK(profile.getFunction(10U) == 10U);
+    CHECK(profile.getFunction(29U) == 10U);
+    CHECK(profile.getFunction(1000U) == 30U);
+  }
+
+  SECTION("Stacks are written from root to leaf with the samples per function") {
+    auto profile = Profile{};
+    profile.addFunction(0U);
+    profile.addFunction(10U);
+    profile.addFunction(30U);
+    profile.addSample({12U, 2U});
+    profile.addSample({15U, 2U});
+    profile.addSample({31U, 11U, 2U});
+    profile.addSample({5U});
+
+    CHECK(profile.getSampleCount() == 4U);
+    CHECK(profile.getSamples().size() == 4U);
+
+    auto labels = Profile::FunctionLabels{{0U, {"main"}}, {30U, {"leaf", "leaf-alias"}}};
+    auto str    = std::ostringstream{};
+    profile.writeCollapsed(str, labels);
+    CHECK(str.str() == "main 1\nmain;func@10 2\nmain;func@10;leaf 1\n");
+  }
+
+  SECTION("Truncated stacks are marked at the root") {
+    auto profile = Profile{};
+    profile.addFunction(0U);
+    profile.addSample({5U, 3U, Profile::truncatedFrame});
+
+    auto str = std::ostringstream{};
+    profile.writeCollapsed(str);
+    CHECK(str.str() == "[truncated];func@0;func@0 1\n");
+  }
+}
+
+TEST_CASE("Profile a program", "[vm]") {
+
+  auto asmb = novasm::Assembler{};
+  asmb.label("entrypoint");
+  asmb.addLoadLitInt(2'000'000);
+  asmb.addCall("loop", 1, novasm::CallMode::Normal);
+  asmb.addRet();
+
+  asmb.label("loop");
+  asmb.addStackLoad(0);
+  asmb.addLoadLitInt(0);
+  asmb.addCheckEqInt();
+  asmb.addJumpIf("loop-end");
+  asmb.addCall("work", 0, novasm::CallMode::Normal);
+  asmb.addPop();
+  asmb.addStackLoad(0);
+  asmb.addLoadLitInt(-1);
+  asmb.addAddInt();
+  asmb.addCall("loop", 1, novasm::CallMode::Tail);
+
+  asmb.label("loop-end");
+  asmb.addLoadLitInt(0);
+  asmb.addRet();
+
+  asmb.label("work");
+  asmb.addLoadLitInt(1);
+  asmb.addRet();
+
+  asmb.setEntrypoint("entrypoint");
+  const auto labels   = asmb.getLabels();
+  const auto assembly = asmb.close();
+
+  for (auto settings : getTestSettings()) {
+    INFO("jit: " << settings.jitEnabled);
+
+    auto profile               = Profile{};
+    settings.profile           = &profile;
+    settings.profileIntervalUs = 100U;
+
+    auto iface = PlatformInterface{0, nullptr, nullptr, nullptr, nullptr};
+    CHECK(run(&assembly, &iface, settings) == ExecState::Success);
+    CHECK(profile.getSampleCount() != 0U);
+
+    auto str = std::ostringstream{};
+    profile.writeCollapsed(str, labels);
+
+    // Every stack starts at the entrypoint, the leafs are at the returns and tail-calls.
+    auto line = std::string{};
+    auto in   = std::istringstream{str.str()};
+    while (std::getline(in, line)) {
+      CHECK(line.rfind("entrypoint", 0) == 0U);
+    }
+    CHECK(str.str().find("entrypoint;loop;work ") != std::string::npos);
+  }
+}
+
+} // namespace vm
@@ -0,0 +1,145 @@
+#include "catch2/catch.hpp"
+#include "helpers.hpp"
+
+namespace vm {
+
+TEST_CASE("Execute stack-slot operations", "[vm]") {
+
+  SECTION("Int operations") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(2);
+          asmb->addLoadLitInt(42);
+          asmb->addStackStore(0);
+          asmb->addLoadLitInt(1337);
+          asmb->addStackStore(1);
+
+          asmb->addStackAddInt(0, 1);
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+          asmb->addPop();
+
+          asmb->addStackSubInt(0, 1);
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+          asmb->addPop();
+
+          asmb->addStackMulInt(1, 0);
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "1379-129556154");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(2);
+          asmb->addLoadLitInt(2147483647); // NOLINT: Magic numbers
+          asmb->addStackStore(0);
+          asmb->addLoadLitInt(1);
+          asmb->addStackStore(1);
+
+          asmb->addStackAddInt(0, 1);
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "-2147483648");
+  }
+
+  SECTION("Float operations") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(2);
+          asmb->addLoadLitFloat(3.0F);
+          asmb->addStackStore(0);
+          asmb->addLoadLitFloat(0.5F); // NOLINT: Magic numbers
+          asmb->addStackStore(1);
+
+          asmb->addStackAddFloat(0, 1);
+          asmb->addStackSubFloat(0, 1);
+          asmb->addStackMulFloat(0, 1);
+          asmb->addStackDivFloat(0, 1);
+          asmb->addAddFloat();
+          asmb->addAddFloat();
+          asmb->addAddFloat();
+          asmb->addConvFloatString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "13.5");
+  }
+
+  SECTION("Checks") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(4);
+          asmb->addLoadLitInt(42);
+          asmb->addStackStore(0);
+          asmb->addLoadLitInt(1337);
+          asmb->addStackStore(1);
+          asmb->addLoadLitFloat(0.1F); // NOLINT: Magic numbers
+          asmb->addStackStore(2);
+          asmb->addLoadLitFloat(0.2F); // NOLINT: Magic numbers
+          asmb->addStackStore(3);
+
+          asmb->addStackCheckEqInt(0, 0);
+          asmb->addStackCheckEqInt(0, 1);
+          asmb->addStackCheckGtInt(1, 0);
+          asmb->addStackCheckGtInt(0, 1);
+          asmb->addStackCheckLeInt(0, 1);
+          asmb->addStackCheckLeInt(1, 0);
+          asmb->addStackCheckGtFloat(3, 2);
+          asmb->addStackCheckGtFloat(2, 3);
+          asmb->addStackCheckLeFloat(2, 3);
+          asmb->addStackCheckLeFloat(3, 2);
+          for (auto i = 0; i != 10; ++i) {
+            asmb->addConvIntString();
+            ADD_PRINT(asmb);
+            asmb->addPop();
+          }
+        },
+        "input",
+        "0101010101");
+  }
+
+  SECTION("Store result") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(3);
+          asmb->addLoadLitInt(42);
+          asmb->addStackStore(0);
+          asmb->addLoadLitInt(1337);
+          asmb->addStackStore(1);
+
+          asmb->addStackAddInt(0, 1);
+          asmb->addStackStore(2);
+          asmb->addStackMulInt(2, 0);
+          asmb->addStackStore(0);
+
+          asmb->addStackLoad(0);
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "57918");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(2);
+          asmb->addLoadLitFloat(3.0F);
+          asmb->addStackStore(0);
+          asmb->addLoadLitFloat(0.5F); // NOLINT: Magic numbers
+          asmb->addStackStore(1);
+
+          asmb->addStackDivFloat(0, 1);
+          asmb->addStackStore(1);
+
+          asmb->addStackLoad(1);
+          asmb->addConvFloatString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "6");
+  }
+}
+
+} // namespace vm
@@ -63,6 +63,74 @@ TEST_CASE("Execute string operations", "[vm]") {
         },
         "input",
         "h");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(3);
+          asmb->addLoadLitString("a");
+          asmb->addLoadLitInt('b');
+          asmb->addAppendChar();
+          asmb->addStackStore(0);
+
+          // Append different chars to the same string, both have to see their own char.
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt('c');
+          asmb->addAppendChar();
+          asmb->addStackStore(1);
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt('d');
+          asmb->addAppendChar();
+          asmb->addStackStore(2);
+
+          asmb->addStackLoad(1);
+          asmb->addStackLoad(2);
+          asmb->addAddString();
+          asmb->addStackLoad(0);
+          asmb->addAddString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "abcabdab");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(2);
+          asmb->addLoadLitInt(10'000); // NOLINT: Magic numbers
+          asmb->addStackStore(0);
+          asmb->addLoadLitString("");
+          asmb->addStackStore(1);
+
+          // Append enough chars to fill multiple char buffers.
+          asmb->label("loop");
+          asmb->addStackLoad(1);
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(10); // NOLINT: Magic numbers
+          asmb->addRemInt();
+          asmb->addLoadLitInt('0');
+          asmb->addAddInt();
+          asmb->addAppendChar();
+          asmb->addStackStore(1);
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addSubInt();
+          asmb->addDup();
+          asmb->addStackStore(0);
+          asmb->addLoadLitInt(0);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("end");
+          asmb->addJump("loop");
+
+          asmb->label("end");
+          asmb->addStackLoad(1);
+          asmb->addLengthString();
+          asmb->addConvIntString();
+          asmb->addStackLoad(1);
+          asmb->addLoadLitInt(9'990); // NOLINT: Magic numbers
+          asmb->addLoadLitInt(10'000); // NOLINT: Magic numbers
+          asmb->addSliceString();
+          asmb->addAddString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "100000987654321");
   }
 
   SECTION("Length") {
@@ -97,6 +165,23 @@ TEST_CASE("Execute string operations", "[vm]") {
         },
         "input",
         "11");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello");
+          asmb->addLoadLitInt(' ');
+          asmb->addAppendChar();
+          asmb->addLoadLitInt('w');
+          asmb->addAppendChar();
+          asmb->addLoadLitString("orld");
+          asmb->addAddString();
+          asmb->addLoadLitInt('!');
+          asmb->addAppendChar();
+          asmb->addLengthString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "12");
   }
 
   SECTION("Indexing") {
@@ -275,6 +360,481 @@ TEST_CASE("Execute string operations", "[vm]") {
         "");
   }
 
+  SECTION("Slicing large strings") {
+    // Large slices reference the characters of the original string instead of copying them.
+    const auto digits = std::string{"0123456789"} + "0123456789" + "0123456789" + "0123456789" +
+        "0123456789" + "0123456789" + "0123456789" + "0123456789" + "0123456789" + "0123456789";
+    CHECK_EXPR(
+        [&digits](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(digits);
+          asmb->addLoadLitInt(10);
+          asmb->addLoadLitInt(90);
+          asmb->addSliceString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        digits.substr(10, 80));
+    CHECK_EXPR(
+        [&digits](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(digits);
+          asmb->addLoadLitInt(10);
+          asmb->addLoadLitInt(90);
+          asmb->addSliceString();
+          asmb->addLoadLitInt(5);
+          asmb->addLoadLitInt(75);
+          asmb->addSliceString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        digits.substr(15, 70));
+    CHECK_EXPR(
+        [&digits](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(digits);
+          asmb->addLoadLitInt(20);
+          asmb->addLoadLitInt(100);
+          asmb->addSliceString();
+          asmb->addLoadLitString("!");
+          asmb->addAddString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        digits.substr(20) + "!");
+    CHECK_EXPR(
+        [&digits](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("!");
+          asmb->addLoadLitString(digits);
+          asmb->addLoadLitInt(20);
+          asmb->addLoadLitInt(100);
+          asmb->addSliceString();
+          asmb->addAddString();
+          asmb->addLoadLitString("?");
+          asmb->addAddString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "!" + digits.substr(20) + "?");
+    CHECK_EXPR(
+        [&digits](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(digits);
+          asmb->addLoadLitInt(10);
+          asmb->addLoadLitInt(90);
+          asmb->addSliceString();
+          asmb->addDup();
+          asmb->addLengthString();
+          asmb->addConvIntString();
+          asmb->addSwap();
+          asmb->addLoadLitInt(5);
+          asmb->addIndexString();
+          asmb->addConvCharString();
+          asmb->addAddString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "805");
+    CHECK_EXPR(
+        [&digits](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(digits);
+          asmb->addLoadLitInt(10);
+          asmb->addLoadLitInt(100);
+          asmb->addSliceString();
+          asmb->addLoadLitString(digits.substr(0, 90));
+          asmb->addCheckEqString();
+          asmb->addConvBoolString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "true");
+  }
+
+  SECTION("Slices keep their parent alive") {
+    const auto half = std::string(64, 'a');
+    CHECK_EXPR(
+        [&half](novasm::Assembler* asmb) -> void {
+          asmb->addStackAlloc(2);
+          asmb->addLoadLitInt(1'000'000); // NOLINT: Magic numbers
+          asmb->addStackStore(0);
+
+          // Slice a string that is not reachable from anything else.
+          asmb->addLoadLitString(half);
+          asmb->addLoadLitString(half);
+          asmb->addAddString();
+          asmb->addLoadLitInt(1);
+          asmb->addLoadLitInt(127);
+          asmb->addSliceString();
+          asmb->addStackStore(1);
+
+          // Allocate enough strings to trigger garbage collections.
+          asmb->label("loop");
+          asmb->addLoadLitString(half);
+          asmb->addLoadLitString(half);
+          asmb->addAddString();
+          asmb->addLengthString();
+          asmb->addPop();
+          asmb->addStackLoad(0);
+          asmb->addLoadLitInt(1);
+          asmb->addSubInt();
+          asmb->addDup();
+          asmb->addStackStore(0);
+          asmb->addLoadLitInt(0);
+          asmb->addCheckEqInt();
+          asmb->addJumpIf("end");
+          asmb->addJump("loop");
+
+          asmb->label("end");
+          asmb->addStackLoad(1);
+          ADD_PRINT(asmb);
+        },
+        "input",
+        std::string(126, 'a'));
+  }
+
+  SECTION("Searching") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello world");
+          asmb->addLoadLitString("o");
+          asmb->addLoadLitInt(0);
+          asmb->addIndexOfString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "4");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello world");
+          asmb->addLoadLitString("o");
+          asmb->addLoadLitInt(5);
+          asmb->addIndexOfString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "7");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello world");
+          asmb->addLoadLitString("o w");
+          asmb->addLoadLitInt(-1);
+          asmb->addIndexOfString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "4");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello world");
+          asmb->addLoadLitString("world");
+          asmb->addLoadLitInt(7);
+          asmb->addIndexOfString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "-1");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello world");
+          asmb->addLoadLitString("");
+          asmb->addLoadLitInt(0);
+          asmb->addIndexOfString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "-1");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("aaab");
+          asmb->addLoadLitString("aab");
+          asmb->addLoadLitInt(0);
+          asmb->addIndexOfString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "1");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello");
+          asmb->addLoadLitString(" world");
+          asmb->addAddString();
+          asmb->addLoadLitString("o w");
+          asmb->addLoadLitInt(0);
+          asmb->addIndexOfString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "4");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("wasd wasd");
+          asmb->addLoadLitString("wasd");
+          asmb->addLoadLitInt(100);
+          asmb->addIndexOfLastString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "5");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("wasd wasd");
+          asmb->addLoadLitString("wasd");
+          asmb->addLoadLitInt(4);
+          asmb->addIndexOfLastString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "0");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("wasd wasd");
+          asmb->addLoadLitString("wasd");
+          asmb->addLoadLitInt(-1);
+          asmb->addIndexOfLastString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "-1");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("wasd wasd");
+          asmb->addLoadLitString("");
+          asmb->addLoadLitInt(100);
+          asmb->addIndexOfLastString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "-1");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello world");
+          asmb->addLoadLitString("wr");
+          asmb->addLoadLitInt(0);
+          asmb->addIndexOfAnyString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "6");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello world");
+          asmb->addLoadLitString("xyz");
+          asmb->addLoadLitInt(0);
+          asmb->addIndexOfAnyString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "-1");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello world");
+          asmb->addLoadLitString("");
+          asmb->addLoadLitInt(0);
+          asmb->addIndexOfAnyString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "-1");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("  \t hello");
+          asmb->addLoadLitString(" \t");
+          asmb->addLoadLitInt(0);
+          asmb->addSpanString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "4");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello");
+          asmb->addLoadLitString("ehlo");
+          asmb->addLoadLitInt(0);
+          asmb->addSpanString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "5");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello");
+          asmb->addLoadLitString("ehlo");
+          asmb->addLoadLitInt(42);
+          asmb->addSpanString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "5");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello world");
+          asmb->addLoadLitString("world");
+          asmb->addLoadLitInt(6);
+          asmb->addStartsWithString();
+          asmb->addConvBoolString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "true");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello world");
+          asmb->addLoadLitString("world");
+          asmb->addLoadLitInt(7);
+          asmb->addStartsWithString();
+          asmb->addConvBoolString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "false");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello world");
+          asmb->addLoadLitString("");
+          asmb->addLoadLitInt(11);
+          asmb->addStartsWithString();
+          asmb->addConvBoolString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "true");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello world");
+          asmb->addLoadLitString("hello");
+          asmb->addLoadLitInt(-1);
+          asmb->addStartsWithString();
+          asmb->addConvBoolString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "false");
+  }
+
+  SECTION("Searching large strings") {
+    // Large strings are searched a block of characters at a time.
+    const auto text = std::string(100, '-') + "needle" + std::string(50, '-') + "needle--";
+    CHECK_EXPR(
+        [&text](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(text);
+          asmb->addLoadLitString("needle");
+          asmb->addLoadLitInt(0);
+          asmb->addIndexOfString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "100");
+    CHECK_EXPR(
+        [&text](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(text);
+          asmb->addLoadLitString("needle");
+          asmb->addLoadLitInt(101);
+          asmb->addIndexOfString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "156");
+    CHECK_EXPR(
+        [&text](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(text);
+          asmb->addLoadLitString("needle");
+          asmb->addLoadLitInt(1000);
+          asmb->addIndexOfLastString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "156");
+    CHECK_EXPR(
+        [&text](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(text);
+          asmb->addLoadLitString("needle");
+          asmb->addLoadLitInt(155);
+          asmb->addIndexOfLastString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "100");
+    CHECK_EXPR(
+        [&text](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(text);
+          asmb->addLoadLitString("xyzn");
+          asmb->addLoadLitInt(0);
+          asmb->addIndexOfAnyString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "100");
+    CHECK_EXPR(
+        [&text](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(text);
+          asmb->addLoadLitString("-");
+          asmb->addLoadLitInt(0);
+          asmb->addSpanString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "100");
+    CHECK_EXPR(
+        [&text](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(text);
+          asmb->addLoadLitString("-ndel");
+          asmb->addLoadLitInt(0);
+          asmb->addSpanString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "164");
+    // Searches in slices should not look past the end of the slice.
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(std::string(100, 'a') + "b");
+          asmb->addLoadLitInt(0);
+          asmb->addLoadLitInt(100);
+          asmb->addSliceString();
+          asmb->addLoadLitString("ab");
+          asmb->addLoadLitInt(0);
+          asmb->addIndexOfString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "-1");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString(std::string(100, 'a') + "b");
+          asmb->addLoadLitInt(0);
+          asmb->addLoadLitInt(100);
+          asmb->addSliceString();
+          asmb->addLoadLitString("a");
+          asmb->addLoadLitInt(0);
+          asmb->addSpanString();
+          asmb->addConvIntString();
+          ADD_PRINT(asmb);
+        },
+        "input",
+        "100");
+  }
+
   SECTION("Unsigned chars") {
     CHECK_EXPR(
         [](novasm::Assembler* asmb) -> void {
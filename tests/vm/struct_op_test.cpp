@@ -90,6 +90,50 @@ TEST_CASE("Execute struct operations", "[vm]") {
         "input",
         "hello moto");
   }
+
+  SECTION("Peek field") {
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitString("hello ");
+          asmb->addLoadLitString("world");
+          asmb->addMakeStruct(2);
+
+          // Load the field while keeping the struct on the stack.
+          asmb->addDup();
+          asmb->addStructLoadField(0);
+          asmb->addSwap();
+          asmb->addStructLoadField(1);
+
+          asmb->addAddString();
+          ADD_PRINT(asmb);
+          asmb->addPop();
+        },
+        "input",
+        "hello world");
+    CHECK_EXPR(
+        [](novasm::Assembler* asmb) -> void {
+          asmb->addLoadLitInt(1);
+          asmb->addLoadLitString("hello");
+          asmb->addMakeStruct(2);
+
+          // Jump on the first field while keeping the struct on the stack.
+          asmb->addDup();
+          asmb->addStructLoadField(0);
+          asmb->addJumpIf("set");
+
+          asmb->addLoadLitString("not set");
+          ADD_PRINT(asmb);
+          asmb->addJump("end");
+
+          asmb->label("set");
+          asmb->addStructLoadField(1);
+          ADD_PRINT(asmb);
+
+          asmb->label("end");
+        },
+        "input",
+        "hello");
+  }
 }
 
 } // namespace vm